@@ -64,6 +64,10 @@ struct LevelStats
   double dbMaxTime;
   double dbTotalTime;
 
+  double indexMinTime;
+  double indexMaxTime;
+  double indexTotalTime;
+
   double drawMinTime;
   double drawMaxTime;
   double drawTotalTime;
@@ -72,6 +76,9 @@ struct LevelStats
   size_t wayCount;
   size_t areaCount;
 
+  size_t nodeOffsetCount;
+  size_t wayOffsetCount;
+
   size_t tileCount;
 
   LevelStats(size_t level)
@@ -79,12 +86,17 @@ struct LevelStats
     dbMinTime(std::numeric_limits<double>::max()),
     dbMaxTime(0.0),
     dbTotalTime(0.0),
+    indexMinTime(std::numeric_limits<double>::max()),
+    indexMaxTime(0.0),
+    indexTotalTime(0.0),
     drawMinTime(std::numeric_limits<double>::max()),
     drawMaxTime(0.0),
     drawTotalTime(0.0),
     nodeCount(0),
     wayCount(0),
     areaCount(0),
+    nodeOffsetCount(0),
+    wayOffsetCount(0),
     tileCount(0)
   {
     // no code
@@ -227,12 +239,23 @@ int main(int argc, char* argv[])
 
   osmscout::DatabaseRef       database=std::make_shared<osmscout::Database>(databaseParameter);
   osmscout::MapServiceRef     mapService=std::make_shared<osmscout::MapService>(database);
+  osmscout::AreaNodeIndexRef  areaNodeIndex;
+  osmscout::AreaWayIndexRef   areaWayIndex;
 
   if (!database->Open(map.c_str())) {
     std::cerr << "Cannot open database" << std::endl;
     return 1;
   }
 
+  areaNodeIndex=database->GetAreaNodeIndex();
+  areaWayIndex=database->GetAreaWayIndex();
+
+  if (!areaNodeIndex ||
+      !areaWayIndex) {
+    std::cerr << "Cannot open area node or area way index" << std::endl;
+    return 1;
+  }
+
   osmscout::StyleConfigRef styleConfig=std::make_shared<osmscout::StyleConfig>(database->GetTypeConfig());
 
   if (!styleConfig->Load(style)) {
@@ -252,10 +275,17 @@ int main(int argc, char* argv[])
        level++) {
     LevelStats              stats(level);
     osmscout::Magnification magnification;
+    osmscout::TypeInfoSet   nodeTypes;
+    osmscout::TypeInfoSet   wayTypes;
     int                     xTileStart,xTileEnd,xTileCount,yTileStart,yTileEnd,yTileCount;
 
     magnification.SetLevel(level);
 
+    styleConfig->GetNodeTypesWithMaxMag(magnification,
+                                        nodeTypes);
+    styleConfig->GetWayTypesWithMaxMag(magnification,
+                                       wayTypes);
+
     xTileStart=osmscout::LonToTileX(std::min(lonLeft,lonRight),
                                     magnification);
     xTileEnd=osmscout::LonToTileX(std::max(lonLeft,lonRight),
@@ -313,11 +343,41 @@ int main(int argc, char* argv[])
 
         projection.GetDimensions(boundingBox);
 
-        osmscout::StopClock dbTimer;
-
         osmscout::GeoBox dataBoundingBox(osmscout::GeoCoord(osmscout::TileYToLat(y-1,magnification),osmscout::TileXToLon(x-1,magnification)),
                                          osmscout::GeoCoord(osmscout::TileYToLat(y+1,magnification),osmscout::TileXToLon(x+1,magnification)));
 
+        // Measure the index lookup separately. MapService repeats the same lookup
+        // below, which then profits from the index pages and file system caches
+        // warmed up here, so the db time does not contain the full cost of
+        // the index lookup.
+        osmscout::StopClock               indexTimer;
+        std::vector<osmscout::FileOffset> nodeOffsets;
+        std::vector<osmscout::FileOffset> wayOffsets;
+        osmscout::TypeInfoSet             loadedNodeTypes;
+        osmscout::TypeInfoSet             loadedWayTypes;
+
+        areaNodeIndex->GetOffsets(dataBoundingBox,
+                                  nodeTypes,
+                                  nodeOffsets,
+                                  loadedNodeTypes);
+        areaWayIndex->GetOffsets(dataBoundingBox,
+                                 wayTypes,
+                                 wayOffsets,
+                                 loadedWayTypes);
+
+        indexTimer.Stop();
+
+        double indexTime=indexTimer.GetMilliseconds();
+
+        stats.indexMinTime=std::min(stats.indexMinTime,indexTime);
+        stats.indexMaxTime=std::max(stats.indexMaxTime,indexTime);
+        stats.indexTotalTime+=indexTime;
+
+        stats.nodeOffsetCount+=nodeOffsets.size();
+        stats.wayOffsetCount+=wayOffsets.size();
+
+        osmscout::StopClock dbTimer;
+
         std::list<osmscout::TileRef> tiles;
 
         mapService->LookupTiles(magnification,dataBoundingBox,tiles);
@@ -403,6 +463,14 @@ int main(int argc, char* argv[])
     std::cout << "avg: " << stats.dbTotalTime/stats.tileCount << " ";
     std::cout << "max: " << stats.dbMaxTime << " " << std::endl;
 
+    std::cout << " Index    : ";
+    std::cout << "total: " << stats.indexTotalTime << " ";
+    std::cout << "min: " << stats.indexMinTime << " ";
+    std::cout << "avg: " << stats.indexTotalTime/stats.tileCount << " ";
+    std::cout << "max: " << stats.indexMaxTime << " ";
+    std::cout << "node offsets: " << stats.nodeOffsetCount << " ";
+    std::cout << "way offsets: " << stats.wayOffsetCount << std::endl;
+
     std::cout << " Map      : ";
     std::cout << "total: " << stats.drawTotalTime << " ";
     std::cout << "min: " << stats.drawMinTime << " ";
@@ -21,6 +21,7 @@
 #include <stdio.h>
 
 #include <iostream>
+#include <limits>
 #include <memory>
 
 #include <osmscout/util/File.h>
@@ -118,6 +119,14 @@ void DumpHelp(osmscout::ImportParameter& parameter)
   std::cout << " --wayDataCacheSize <number>          way data cache size (default: " << parameter.GetWayDataCacheSize() << ")" << std::endl;
 
   std::cout << " --routeNodeBlockSize <number>        number of route nodes resolved in block (default: " << parameter.GetRouteNodeBlockSize() << ")" << std::endl;
+
+  std::cout << " --rtreeIndex true|false              generate R-tree indexes (default: " << BoolToString(parameter.GetRTreeIndex()) << ")" << std::endl;
+  std::cout << " --rtreeNodeSize <number>             maximum children of a R-tree node (default: " << parameter.GetRTreeNodeSize() << ")" << std::endl;
+
+  std::cout << " --poiNameIndex true|false            generate POI name index (default: " << BoolToString(parameter.GetPOINameIndex()) << ")" << std::endl;
+
+  std::cout << " --compressDataFiles true|false       block compress data files (default: " << BoolToString(parameter.GetCompressDataFiles()) << ")" << std::endl;
+  std::cout << " --compressionBlockSize <number>      size of one compressed block (default: " << parameter.GetCompressionBlockSize() << ")" << std::endl;
 }
 
 bool ParseBoolArgument(int argc,
@@ -606,6 +615,78 @@ int main(int argc, char* argv[])
         parameterError=true;
       }
     }
+    else if (strcmp(argv[i],"--rtreeIndex")==0) {
+      bool rtreeIndex;
+
+      if (ParseBoolArgument(argc,
+                            argv,
+                            i,
+                            rtreeIndex)) {
+        parameter.SetRTreeIndex(rtreeIndex);
+      }
+      else {
+        parameterError=true;
+      }
+    }
+    else if (strcmp(argv[i],"--rtreeNodeSize")==0) {
+      size_t rtreeNodeSize;
+
+      if (ParseSizeTArgument(argc,
+                             argv,
+                             i,
+                             rtreeNodeSize)) {
+        parameter.SetRTreeNodeSize(rtreeNodeSize);
+      }
+      else {
+        parameterError=true;
+      }
+    }
+    else if (strcmp(argv[i],"--poiNameIndex")==0) {
+      bool poiNameIndex;
+
+      if (ParseBoolArgument(argc,
+                            argv,
+                            i,
+                            poiNameIndex)) {
+        parameter.SetPOINameIndex(poiNameIndex);
+      }
+      else {
+        parameterError=true;
+      }
+    }
+    else if (strcmp(argv[i],"--compressDataFiles")==0) {
+      bool compressDataFiles;
+
+      if (ParseBoolArgument(argc,
+                            argv,
+                            i,
+                            compressDataFiles)) {
+        parameter.SetCompressDataFiles(compressDataFiles);
+      }
+      else {
+        parameterError=true;
+      }
+    }
+    else if (strcmp(argv[i],"--compressionBlockSize")==0) {
+      size_t compressionBlockSize;
+
+      if (ParseSizeTArgument(argc,
+                             argv,
+                             i,
+                             compressionBlockSize)) {
+        if (compressionBlockSize==0 ||
+            compressionBlockSize>std::numeric_limits<uint32_t>::max()) {
+          std::cerr << "Compression block size must be in the range [1.." << std::numeric_limits<uint32_t>::max() << "]" << std::endl;
+          parameterError=true;
+        }
+        else {
+          parameter.SetCompressionBlockSize(compressionBlockSize);
+        }
+      }
+      else {
+        parameterError=true;
+      }
+    }
     else if (strncmp(argv[i],"--",2)==0) {
       std::cerr << "Unknown option: " << argv[i] << std::endl;
 
@@ -691,6 +772,19 @@ int main(int argc, char* argv[])
   progress.Info(std::string("RouteNodeBlockSize: ")+
                 osmscout::NumberToString(parameter.GetRouteNodeBlockSize()));
 
+  progress.Info(std::string("RTreeIndex: ")+
+                (parameter.GetRTreeIndex() ? "true" : "false"));
+  progress.Info(std::string("RTreeNodeSize: ")+
+                osmscout::NumberToString(parameter.GetRTreeNodeSize()));
+
+  progress.Info(std::string("POINameIndex: ")+
+                (parameter.GetPOINameIndex() ? "true" : "false"));
+
+  progress.Info(std::string("CompressDataFiles: ")+
+                (parameter.GetCompressDataFiles() ? "true" : "false"));
+  progress.Info(std::string("CompressionBlockSize: ")+
+                osmscout::NumberToString(parameter.GetCompressionBlockSize()));
+
   osmscout::Importer importer(parameter);
 
   bool result=importer.Import(progress);
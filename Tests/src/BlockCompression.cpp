@@ -0,0 +1,215 @@
+/*
+  BlockCompression - a test program for libosmscout
+  Copyright (C) 2016  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <osmscout/util/BlockCompression.h>
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+
+static const char* const sourceFilename="BlockCompression.dat";
+static const char* const targetFilename="BlockCompression.dat.cmp";
+
+/**
+ * Create data, that is partially compressible and partially random
+ */
+static std::vector<char> CreateData(size_t size)
+{
+  std::mt19937      generator((unsigned int)size);
+  std::vector<char> data(size);
+
+  for (size_t i=0; i<size; i++) {
+    if ((i/64)%2==0) {
+      data[i]=(char)(i%7);
+    }
+    else {
+      data[i]=(char)generator();
+    }
+  }
+
+  return data;
+}
+
+static bool WriteData(const std::vector<char>& data)
+{
+  std::FILE* file=std::fopen(sourceFilename,"wb");
+
+  if (file==NULL) {
+    return false;
+  }
+
+  bool success=std::fwrite(data.data(),1,data.size(),file)==data.size();
+
+  return std::fclose(file)==0 && success;
+}
+
+/**
+ * Read the compressed file completely and at random positions and compare the result
+ * with the original data.
+ */
+static bool CheckRoundTrip(const std::vector<char>& data,
+                           uint32_t blockSize,
+                           bool memoryMapped)
+{
+  osmscout::FileScanner scanner;
+  std::mt19937          generator(blockSize);
+
+  try {
+    scanner.Open(targetFilename,
+                 osmscout::FileScanner::FastRandom,
+                 memoryMapped);
+
+    if (scanner.GetSize()!=data.size()) {
+      std::cerr << "Size " << scanner.GetSize() << " != " << data.size() << std::endl;
+      return false;
+    }
+
+    std::vector<char> buffer(data.size());
+
+    if (!data.empty()) {
+      scanner.Read(buffer.data(),
+                   buffer.size());
+
+      if (buffer!=data) {
+        std::cerr << "Sequential read differs from original data" << std::endl;
+        return false;
+      }
+    }
+
+    for (size_t i=0; i<1000 && !data.empty(); i++) {
+      size_t pos=generator()%data.size();
+      size_t bytes=1+generator()%std::min(data.size()-pos,(size_t)3*blockSize);
+
+      // Read the tail including the short final block every now and then
+      if (i%10==0) {
+        bytes=data.size()-pos;
+      }
+
+      scanner.SetPos(pos);
+      scanner.Read(buffer.data(),
+                   bytes);
+
+      if (!std::equal(buffer.begin(),
+                      buffer.begin()+bytes,
+                      data.begin()+pos)) {
+        std::cerr << "Read of " << bytes << " byte(s) at " << pos << " differs from original data" << std::endl;
+        return false;
+      }
+    }
+
+    // Reading beyond the end of the data must fail
+    bool failed=false;
+
+    try {
+      scanner.SetPos(data.size());
+      scanner.Read(buffer.data(),
+                   1);
+    }
+    catch (osmscout::IOException& /*e*/) {
+      failed=true;
+    }
+
+    if (!failed) {
+      std::cerr << "Read beyond the end of the data did not fail" << std::endl;
+      return false;
+    }
+
+    scanner.CloseFailsafe();
+  }
+  catch (osmscout::IOException& e) {
+    std::cerr << e.GetDescription() << std::endl;
+    scanner.CloseFailsafe();
+    return false;
+  }
+
+  return true;
+}
+
+int main(int /*argc*/, char* /*argv*/[])
+{
+  if (!osmscout::HasBlockCompressionSupport()) {
+    std::cout << "Block compression is not supported, skipping test" << std::endl;
+    return 0;
+  }
+
+  size_t   sizes[]={0,1,100,4096,4097,3*4096+17,100000};
+  uint32_t blockSizes[]={1,7,4096,65536};
+  size_t   errors=0;
+
+  for (size_t size : sizes) {
+    std::vector<char> data=CreateData(size);
+
+    if (!WriteData(data)) {
+      std::cerr << "Cannot write test data" << std::endl;
+      return 1;
+    }
+
+    for (uint32_t blockSize : blockSizes) {
+      // Block size 1 is fine, but slow for larger files
+      if (blockSize==1 &&
+          size>4097) {
+        continue;
+      }
+
+      std::cout << "Size " << size << ", block size " << blockSize << "..." << std::endl;
+
+      if (!osmscout::CompressFile(sourceFilename,
+                                  targetFilename,
+                                  blockSize)) {
+        std::cerr << "Cannot compress file" << std::endl;
+        errors++;
+        continue;
+      }
+
+      if (!osmscout::IsBlockCompressedFile(targetFilename)) {
+        std::cerr << "Compressed file is not detected as block compressed" << std::endl;
+        errors++;
+      }
+
+      if (!CheckRoundTrip(data,blockSize,false) ||
+          !CheckRoundTrip(data,blockSize,true)) {
+        errors++;
+      }
+    }
+  }
+
+  if (osmscout::CompressFile(sourceFilename,
+                             targetFilename,
+                             0)) {
+    std::cerr << "Block size 0 was accepted" << std::endl;
+    errors++;
+  }
+
+  osmscout::RemoveFile(sourceFilename);
+  osmscout::RemoveFile(targetFilename);
+
+  if (errors>0) {
+    std::cerr << errors << " error(s)" << std::endl;
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,254 @@
+/*
+  BlockSpans - a test program for libosmscout
+  Copyright (C) 2016  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <algorithm>
+#include <future>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <osmscout/AreaDataFile.h>
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/MemoryArena.h>
+#include <osmscout/util/ThreadPool.h>
+
+/*
+ * Reads all areas of the given database sequentially and checks, that
+ * DataFile::GetByBlockSpans() with and without prefetching and
+ * DataFile::GetByBlockSpansAsync() (with and without an active MemoryArena)
+ * return the same areas for random sets of DataBlockSpans.
+ */
+
+static const size_t BATCH_COUNT=20;
+static const size_t SPANS_PER_BATCH=50;
+static const size_t MAX_SPAN_SIZE=8;
+
+/**
+ * Read all areas of the given data file
+ */
+static bool ReadAll(const osmscout::TypeConfig& typeConfig,
+                    const std::string& filename,
+                    std::vector<osmscout::Area>& areas)
+{
+  osmscout::FileScanner scanner;
+
+  try {
+    uint32_t dataCount;
+
+    scanner.Open(filename,
+                 osmscout::FileScanner::Sequential,
+                 true);
+
+    scanner.Read(dataCount);
+
+    areas.resize(dataCount);
+
+    for (auto& area : areas) {
+      area.Read(typeConfig,
+                scanner);
+    }
+
+    scanner.Close();
+  }
+  catch (osmscout::IOException& e) {
+    std::cerr << e.GetDescription() << std::endl;
+    scanner.CloseFailsafe();
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Create a sorted list of random, non-overlapping spans of areas. The indexes
+ * of the referenced areas are returned.
+ */
+static std::vector<osmscout::DataBlockSpan> CreateSpans(std::mt19937& generator,
+                                                        const std::vector<osmscout::Area>& areas,
+                                                        std::vector<size_t>& indexes)
+{
+  std::vector<osmscout::DataBlockSpan> spans;
+  size_t                               step=std::max((size_t)1,areas.size()/SPANS_PER_BATCH);
+  std::uniform_int_distribution<size_t> sizeDistribution(1,MAX_SPAN_SIZE);
+
+  indexes.clear();
+
+  for (size_t start=generator()%step; start<areas.size(); start+=step) {
+    osmscout::DataBlockSpan span;
+    size_t                  size=std::min(sizeDistribution(generator),
+                                          std::min(step,areas.size()-start));
+
+    span.startOffset=areas[start].GetFileOffset();
+    span.count=(uint32_t)size;
+
+    spans.push_back(span);
+
+    for (size_t i=start; i<start+size; i++) {
+      indexes.push_back(i);
+    }
+  }
+
+  return spans;
+}
+
+static bool Compare(const std::string& variant,
+                    const std::vector<osmscout::Area>& areas,
+                    const std::vector<size_t>& indexes,
+                    const std::vector<osmscout::AreaRef>& data)
+{
+  if (data.size()!=indexes.size()) {
+    std::cerr << variant << ": " << data.size() << " area(s) read instead of " << indexes.size() << std::endl;
+    return false;
+  }
+
+  for (size_t i=0; i<indexes.size(); i++) {
+    const osmscout::Area& expected=areas[indexes[i]];
+    const osmscout::Area& actual=*data[i];
+
+    if (actual.GetFileOffset()!=expected.GetFileOffset() ||
+        actual.GetType()!=expected.GetType() ||
+        actual.rings.size()!=expected.rings.size()) {
+      std::cerr << variant << ": Area " << expected.GetFileOffset() << " differs" << std::endl;
+      return false;
+    }
+
+    for (size_t r=0; r<expected.rings.size(); r++) {
+      if (actual.rings[r].nodes!=expected.rings[r].nodes) {
+        std::cerr << variant << ": Nodes of area " << expected.GetFileOffset() << " ring " << r << " differ" << std::endl;
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc!=2) {
+    std::cerr << "BlockSpans <map directory>" << std::endl;
+    return 1;
+  }
+
+  osmscout::TypeConfigRef typeConfig=std::make_shared<osmscout::TypeConfig>();
+
+  if (!typeConfig->LoadFromDataFile(argv[1])) {
+    std::cerr << "Cannot load type configuration" << std::endl;
+    return 1;
+  }
+
+  std::vector<osmscout::Area> areas;
+
+  if (!ReadAll(*typeConfig,
+               osmscout::AppendFileToDir(argv[1],osmscout::AreaDataFile::AREAS_DAT),
+               areas)) {
+    return 1;
+  }
+
+  if (areas.empty()) {
+    std::cerr << "Database does not contain areas" << std::endl;
+    return 1;
+  }
+
+  osmscout::AreaDataFile dataFile;
+
+  if (!dataFile.Open(typeConfig,
+                     argv[1],
+                     osmscout::FileScanner::LowMemRandom,
+                     false)) {
+    std::cerr << "Cannot open data file" << std::endl;
+    return 1;
+  }
+
+  osmscout::ThreadPool threadPool(4);
+  std::mt19937         generator(4711);
+  size_t               errors=0;
+
+  for (size_t b=0; b<BATCH_COUNT; b++) {
+    std::vector<size_t>                  indexes;
+    std::vector<osmscout::DataBlockSpan> spans=CreateSpans(generator,
+                                                           areas,
+                                                           indexes);
+    std::vector<osmscout::AreaRef>       data;
+    std::vector<osmscout::AreaRef>       prefetchedData;
+
+    dataFile.SetPrefetchSpans(false);
+
+    if (!dataFile.GetByBlockSpans(spans,data) ||
+        !Compare("GetByBlockSpans",areas,indexes,data)) {
+      errors++;
+    }
+
+    dataFile.SetPrefetchSpans(true);
+
+    if (!dataFile.GetByBlockSpans(spans,prefetchedData) ||
+        !Compare("GetByBlockSpans with prefetch",areas,indexes,prefetchedData)) {
+      errors++;
+    }
+
+    dataFile.SetPrefetchSpans(false);
+
+    // Several concurrent jobs on the same data file, half of them using an arena
+    std::vector<std::vector<osmscout::AreaRef>> asyncData(4);
+    std::vector<osmscout::MemoryArenaRef>       arenas(asyncData.size());
+    std::vector<std::future<bool>>              results;
+
+    for (size_t j=0; j<asyncData.size(); j++) {
+      if (j%2==1) {
+        arenas[j]=std::make_shared<osmscout::MemoryArena>();
+      }
+
+      osmscout::MemoryArenaScope arenaScope(arenas[j]);
+
+      results.push_back(dataFile.GetByBlockSpansAsync(threadPool,
+                                                      spans,
+                                                      asyncData[j]));
+    }
+
+    for (size_t j=0; j<results.size(); j++) {
+      if (!results[j].get() ||
+          !Compare("GetByBlockSpansAsync "+std::to_string(j),areas,indexes,asyncData[j])) {
+        errors++;
+      }
+
+      if (arenas[j] && arenas[j]->GetMemorySize()==0) {
+        std::cerr << "Arena of job " << j << " was not used" << std::endl;
+        errors++;
+      }
+    }
+  }
+
+  threadPool.Stop();
+  dataFile.Close();
+
+  std::cout << BATCH_COUNT << " batch(es) of spans over " << areas.size() << " area(s) compared" << std::endl;
+
+  if (errors>0) {
+    std::cerr << errors << " error(s)" << std::endl;
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
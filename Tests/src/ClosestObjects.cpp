@@ -0,0 +1,310 @@
+/*
+  ClosestObjects - a test program for libosmscout
+  Copyright (C) 2016  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <osmscout/Database.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/Geometry.h>
+
+/*
+ * Compares the result of the nearest neighbour queries of the database
+ * (Database::GetClosestNodes() and friends) with a brute force scan over all
+ * objects of the given database.
+ */
+
+static const size_t QUERY_COUNT=200;
+static const double EPSILON=1e-9;
+
+/**
+ * Read all objects of the given data file
+ */
+template<class N>
+static bool ReadAll(const osmscout::TypeConfig& typeConfig,
+                    const std::string& filename,
+                    std::vector<N>& objects)
+{
+  osmscout::FileScanner scanner;
+
+  try {
+    uint32_t dataCount;
+
+    scanner.Open(filename,
+                 osmscout::FileScanner::Sequential,
+                 true);
+
+    scanner.Read(dataCount);
+
+    objects.resize(dataCount);
+
+    for (auto& object : objects) {
+      object.Read(typeConfig,
+                  scanner);
+    }
+
+    scanner.Close();
+  }
+  catch (osmscout::IOException& e) {
+    std::cerr << e.GetDescription() << std::endl;
+    scanner.CloseFailsafe();
+    return false;
+  }
+
+  return true;
+}
+
+static double GetPolylineDistance(const osmscout::EquirectangularDistance& distance,
+                                  const std::vector<osmscout::GeoCoord>& nodes,
+                                  bool closed)
+{
+  double minDistance=std::numeric_limits<double>::max();
+
+  if (nodes.size()==1) {
+    return distance.GetDistance(nodes.front());
+  }
+
+  for (size_t i=0; i+1<nodes.size() || (closed && i<nodes.size()); i++) {
+    osmscout::GeoCoord closest;
+
+    minDistance=std::min(minDistance,
+                         distance.GetDistance(nodes[i],
+                                              nodes[(i+1)%nodes.size()],
+                                              closest));
+  }
+
+  return minDistance;
+}
+
+static double GetDistance(const osmscout::EquirectangularDistance& distance,
+                          const osmscout::Node& node)
+{
+  return distance.GetDistance(node.GetCoords());
+}
+
+static double GetDistance(const osmscout::EquirectangularDistance& distance,
+                          const osmscout::Way& way)
+{
+  return GetPolylineDistance(distance,
+                             way.nodes,
+                             false);
+}
+
+static double GetDistance(const osmscout::EquirectangularDistance& distance,
+                          const osmscout::Area& area)
+{
+  double minDistance=std::numeric_limits<double>::max();
+  size_t containingRings=0;
+
+  for (const auto& ring : area.rings) {
+    if (ring.nodes.empty()) {
+      continue;
+    }
+
+    minDistance=std::min(minDistance,
+                         GetPolylineDistance(distance,
+                                             ring.nodes,
+                                             true));
+
+    if (ring.ring!=osmscout::Area::masterRingId &&
+        osmscout::IsCoordInArea(distance.GetReference(),
+                                ring.nodes)) {
+      containingRings++;
+    }
+  }
+
+  return containingRings%2==1 ? 0.0 : minDistance;
+}
+
+/**
+ * Return the sorted distances of the count closest objects not further away
+ * than maxDistance
+ */
+template<class N>
+static std::vector<double> GetClosestDistances(const std::vector<N>& objects,
+                                               const osmscout::TypeInfoSet& types,
+                                               const osmscout::GeoCoord& coord,
+                                               size_t count,
+                                               double maxDistance)
+{
+  osmscout::EquirectangularDistance distance(coord);
+  std::vector<double>               distances;
+
+  for (const auto& object : objects) {
+    if (!types.IsSet(object.GetType())) {
+      continue;
+    }
+
+    double objectDistance=GetDistance(distance,
+                                      object);
+
+    if (objectDistance<=maxDistance) {
+      distances.push_back(objectDistance);
+    }
+  }
+
+  std::sort(distances.begin(),
+            distances.end());
+
+  if (distances.size()>count) {
+    distances.resize(count);
+  }
+
+  return distances;
+}
+
+template<class N>
+static osmscout::TypeInfoSet GetTypes(const osmscout::TypeConfig& typeConfig,
+                                      const std::vector<N>& objects)
+{
+  osmscout::TypeInfoSet types(typeConfig);
+
+  for (const auto& object : objects) {
+    if (!object.GetType()->GetIgnore()) {
+      types.Set(object.GetType());
+    }
+  }
+
+  return types;
+}
+
+template<class R>
+static bool Compare(const std::string& kind,
+                    const osmscout::GeoCoord& coord,
+                    const std::vector<double>& expected,
+                    const std::vector<osmscout::ClosestObject<R>>& actual)
+{
+  bool equal=expected.size()==actual.size();
+
+  for (size_t i=0; equal && i<expected.size(); i++) {
+    if (std::fabs(expected[i]-actual[i].distance)>EPSILON) {
+      equal=false;
+    }
+  }
+
+  if (!equal) {
+    std::cerr << "Closest " << kind << " of " << coord.GetDisplayText() << " differ, expected:";
+
+    for (const auto& distance : expected) {
+      std::cerr << " " << distance;
+    }
+
+    std::cerr << ", actual:";
+
+    for (const auto& object : actual) {
+      std::cerr << " " << object.distance;
+    }
+
+    std::cerr << std::endl;
+  }
+
+  return equal;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc!=2) {
+    std::cerr << "ClosestObjects <map directory>" << std::endl;
+    return 1;
+  }
+
+  size_t                      errors=0;
+  osmscout::DatabaseParameter databaseParameter;
+  osmscout::DatabaseRef       database(new osmscout::Database(databaseParameter));
+
+  if (!database->Open(argv[1])) {
+    std::cerr << "Cannot open database" << std::endl;
+    return 1;
+  }
+
+  osmscout::TypeConfigRef    typeConfig=database->GetTypeConfig();
+  std::vector<osmscout::Node> nodes;
+  std::vector<osmscout::Way>  ways;
+  std::vector<osmscout::Area> areas;
+
+  if (!ReadAll(*typeConfig,osmscout::AppendFileToDir(argv[1],osmscout::NodeDataFile::NODES_DAT),nodes) ||
+      !ReadAll(*typeConfig,osmscout::AppendFileToDir(argv[1],osmscout::WayDataFile::WAYS_DAT),ways) ||
+      !ReadAll(*typeConfig,osmscout::AppendFileToDir(argv[1],osmscout::AreaDataFile::AREAS_DAT),areas)) {
+    return 1;
+  }
+
+  osmscout::TypeInfoSet nodeTypes=GetTypes(*typeConfig,nodes);
+  osmscout::TypeInfoSet wayTypes=GetTypes(*typeConfig,ways);
+  osmscout::TypeInfoSet areaTypes=GetTypes(*typeConfig,areas);
+  osmscout::GeoBox      boundingBox;
+
+  if (!database->GetBoundingBox(boundingBox)) {
+    std::cerr << "Cannot get bounding box of database" << std::endl;
+    return 1;
+  }
+
+  std::cout << nodes.size() << " node(s), " << ways.size() << " way(s), " << areas.size() << " area(s), ";
+  std::cout << "R-tree index: " << (database->GetWayRTreeIndex() ? "yes" : "no") << std::endl;
+
+  std::mt19937                           generator(4711);
+  std::uniform_real_distribution<double> latDistribution(boundingBox.GetMinLat(),boundingBox.GetMaxLat());
+  std::uniform_real_distribution<double> lonDistribution(boundingBox.GetMinLon(),boundingBox.GetMaxLon());
+
+  for (size_t q=0; q<QUERY_COUNT; q++) {
+    osmscout::GeoCoord coord(latDistribution(generator),
+                             lonDistribution(generator));
+    size_t             count=1+q%10;
+    double             maxDistance=q%2==0 ? 2.0 : 1000.0;
+
+    std::vector<osmscout::ClosestNode> closestNodes;
+    std::vector<osmscout::ClosestWay>  closestWays;
+    std::vector<osmscout::ClosestArea> closestAreas;
+
+    if (!database->GetClosestNodes(coord,nodeTypes,count,maxDistance,closestNodes) ||
+        !database->GetClosestWays(coord,wayTypes,count,maxDistance,closestWays) ||
+        !database->GetClosestAreas(coord,areaTypes,count,maxDistance,closestAreas)) {
+      std::cerr << "Error during nearest neighbour query" << std::endl;
+      return 1;
+    }
+
+    if (!Compare("nodes",coord,GetClosestDistances(nodes,nodeTypes,coord,count,maxDistance),closestNodes)) {
+      errors++;
+    }
+
+    if (!Compare("ways",coord,GetClosestDistances(ways,wayTypes,coord,count,maxDistance),closestWays)) {
+      errors++;
+    }
+
+    if (!Compare("areas",coord,GetClosestDistances(areas,areaTypes,coord,count,maxDistance),closestAreas)) {
+      errors++;
+    }
+  }
+
+  database->Close();
+
+  if (errors>0) {
+    std::cerr << errors << " error(s)" << std::endl;
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
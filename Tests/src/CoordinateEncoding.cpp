@@ -17,15 +17,20 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#include <cmath>
 #include <cstdlib>
 #include <iostream>
 #include <limits>
+#include <random>
 #include <vector>
 
 #include <osmscout/AreaDataFile.h>
 #include <osmscout/TypeConfig.h>
 #include <osmscout/WayDataFile.h>
 
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
 #include <osmscout/util/StopClock.h>
 
 class Statistics
@@ -391,6 +396,262 @@ public:
   }
 };
 
+/**
+ * Decode a coordinate vector like the original, sequential implementation of
+ * FileScanner::Read(std::vector<GeoCoord>&)
+ */
+static void ReferenceRead(osmscout::FileScanner& scanner,
+                          std::vector<osmscout::GeoCoord>& nodes)
+{
+  size_t  coordBitSize;
+  uint8_t sizeByte;
+
+  nodes.clear();
+
+  scanner.Read(sizeByte);
+
+  if (sizeByte==0) {
+    return;
+  }
+
+  if ((sizeByte & 0x03)==0) {
+    coordBitSize=16;
+  }
+  else if ((sizeByte & 0x03)==1) {
+    coordBitSize=32;
+  }
+  else {
+    coordBitSize=48;
+  }
+
+  size_t nodeCount=(sizeByte & 0x7c) >> 2;
+
+  if ((sizeByte & 0x80)!=0) {
+    scanner.Read(sizeByte);
+
+    nodeCount|=(sizeByte & 0x7f) << 5;
+
+    if ((sizeByte & 0x80)!=0) {
+      scanner.Read(sizeByte);
+
+      nodeCount|=sizeByte << 12;
+    }
+  }
+
+  nodes.resize(nodeCount);
+
+  std::vector<unsigned char> bytes((nodeCount-1)*coordBitSize/8);
+
+  scanner.ReadCoord(nodes[0]);
+
+  uint32_t latValue=(uint32_t)round((nodes[0].GetLat()+90.0)*osmscout::latConversionFactor);
+  uint32_t lonValue=(uint32_t)round((nodes[0].GetLon()+180.0)*osmscout::lonConversionFactor);
+
+  scanner.Read((char*)bytes.data(),bytes.size());
+
+  size_t bytesPerDelta=coordBitSize/16;
+
+  for (size_t i=1; i<nodeCount; i++) {
+    const unsigned char* delta=bytes.data()+(i-1)*bytesPerDelta*2;
+    uint32_t             latUDelta=0;
+    uint32_t             lonUDelta=0;
+
+    for (size_t b=0; b<bytesPerDelta; b++) {
+      latUDelta|=delta[b] << (b*8);
+      lonUDelta|=delta[bytesPerDelta+b] << (b*8);
+    }
+
+    // Sign extension
+    if (latUDelta & (1u << (bytesPerDelta*8-1))) {
+      latUDelta|=0xffffffffu << (bytesPerDelta*8);
+    }
+
+    if (lonUDelta & (1u << (bytesPerDelta*8-1))) {
+      lonUDelta|=0xffffffffu << (bytesPerDelta*8);
+    }
+
+    latValue+=latUDelta;
+    lonValue+=lonUDelta;
+
+    nodes[i].Set(latValue/osmscout::latConversionFactor-90.0,
+                 lonValue/osmscout::lonConversionFactor-180.0);
+  }
+}
+
+/**
+ * Return random coordinate vectors of all lengths up to 100 with deltas of the
+ * given maximum size, so that every encoding and both the vectorized and the
+ * scalar decoding paths are used
+ */
+static std::vector<std::vector<osmscout::GeoCoord>> CreateCoordVectors()
+{
+  std::mt19937                                 generator(4711);
+  std::vector<std::vector<osmscout::GeoCoord>> coordVectors;
+
+  for (double maxDelta : {0.0000001,0.00002,0.001,0.5}) {
+    std::uniform_real_distribution<double> deltaDistribution(-maxDelta,maxDelta);
+
+    for (size_t size=1; size<=100; size++) {
+      std::vector<osmscout::GeoCoord> coords;
+      double                          lat=51.0;
+      double                          lon=7.0;
+
+      for (size_t i=0; i<size; i++) {
+        lat+=deltaDistribution(generator);
+        lon+=deltaDistribution(generator);
+
+        coords.push_back(osmscout::GeoCoord(lat,lon));
+      }
+
+      coordVectors.push_back(coords);
+    }
+  }
+
+  return coordVectors;
+}
+
+/**
+ * Write all coordinate vectors to a temporary file using the current libosmscout
+ * encoding and check, that decoding them returns exactly the same coordinates as
+ * the reference decoder.
+ */
+static bool CheckDecoding(const std::vector<std::vector<osmscout::GeoCoord>>& coordVectors)
+{
+  std::string filename="CoordinateEncoding.tmp";
+  size_t      coordCount=0;
+  size_t      errors=0;
+
+  try {
+    osmscout::FileWriter writer;
+
+    writer.Open(filename);
+
+    for (const auto& coords : coordVectors) {
+      writer.Write(coords);
+    }
+
+    writer.Close();
+
+    for (bool memoryMapped : {false,true}) {
+      osmscout::FileScanner           scanner;
+      std::vector<osmscout::GeoCoord> coords;
+      std::vector<osmscout::GeoCoord> referenceCoords;
+
+      scanner.Open(filename,osmscout::FileScanner::Sequential,memoryMapped);
+
+      for (size_t i=0; i<coordVectors.size(); i++) {
+        osmscout::FileOffset start=scanner.GetPos();
+
+        coords.clear();
+        scanner.Read(coords);
+
+        osmscout::FileOffset end=scanner.GetPos();
+
+        scanner.SetPos(start);
+        ReferenceRead(scanner,referenceCoords);
+
+        if (scanner.GetPos()!=end ||
+            coords.size()!=coordVectors[i].size() ||
+            coords.size()!=referenceCoords.size()) {
+          std::cerr << "Decoded coordinate vector #" << i << " has wrong size" << std::endl;
+          errors++;
+          continue;
+        }
+
+        for (size_t c=0; c<coords.size(); c++) {
+          if (coords[c].GetLat()!=referenceCoords[c].GetLat() ||
+              coords[c].GetLon()!=referenceCoords[c].GetLon()) {
+            std::cerr << "Coordinate " << c << " of vector #" << i << " differs: ";
+            std::cerr << coords[c].GetDisplayText() << " != " << referenceCoords[c].GetDisplayText() << std::endl;
+            errors++;
+            break;
+          }
+        }
+
+        coordCount+=coords.size();
+      }
+
+      scanner.Close();
+    }
+  }
+  catch (osmscout::IOException& e) {
+    std::cerr << e.GetDescription() << std::endl;
+    osmscout::RemoveFile(filename);
+    return false;
+  }
+
+  osmscout::RemoveFile(filename);
+
+  std::cout << "Decoding of " << coordVectors.size() << " vectors with " << coordCount/2 << " coords compared with the reference: ";
+  std::cout << (errors==0 ? "OK" : "FAILED") << std::endl;
+
+  return errors==0;
+}
+
+/**
+ * Write all coordinate vectors to a temporary file using the current libosmscout
+ * encoding and measure the throughput of decoding them again.
+ */
+static bool BenchmarkDecoding(const std::vector<std::vector<osmscout::GeoCoord>>& coordVectors,
+                              size_t coordCount)
+{
+  static const size_t iterations=10;
+
+  std::string filename="CoordinateEncoding.tmp";
+
+  try {
+    osmscout::FileWriter writer;
+
+    writer.Open(filename);
+
+    for (const auto& coords : coordVectors) {
+      writer.Write(coords);
+    }
+
+    writer.Close();
+
+    osmscout::FileScanner           scanner;
+    std::vector<osmscout::GeoCoord> coords;
+    double                          minTime=std::numeric_limits<double>::max();
+
+    scanner.Open(filename,osmscout::FileScanner::Sequential,true);
+
+    for (size_t iteration=0; iteration<iterations; iteration++) {
+      osmscout::StopClock clock;
+
+      scanner.SetPos(0);
+
+      for (size_t i=0; i<coordVectors.size(); i++) {
+        coords.clear();
+        scanner.Read(coords);
+
+        if (coords.size()!=coordVectors[i].size()) {
+          std::cerr << "Decoded coordinate vector #" << i << " has wrong size" << std::endl;
+          return false;
+        }
+      }
+
+      clock.Stop();
+
+      minTime=std::min(minTime,clock.GetMilliseconds());
+    }
+
+    scanner.Close();
+
+    std::cout << "Decoding " << coordVectors.size() << " vectors with " << coordCount << " coords: ";
+    std::cout << minTime << " ms, " << coordCount/minTime/1000.0 << " million coords/s" << std::endl;
+  }
+  catch (osmscout::IOException& e) {
+    std::cerr << e.GetDescription() << std::endl;
+    osmscout::RemoveFile(filename);
+    return false;
+  }
+
+  osmscout::RemoveFile(filename);
+
+  return true;
+}
+
 int main(int argc, char* argv[])
 {
   if (argc!=2) {
@@ -414,6 +675,8 @@ int main(int argc, char* argv[])
   osmscout::FileScanner scanner;
   uint32_t              dataCount;
 
+  std::vector<std::vector<osmscout::GeoCoord>> coordVectors;
+
   std::cout << "Reading type config from map directory '" << mapDirectory << "'..." << std::endl;
 
   if (!typeConfig.LoadFromDataFile(mapDirectory)) {
@@ -468,13 +731,12 @@ int main(int argc, char* argv[])
 
       way.Read(typeConfig,scanner);
 
-      for (size_t n =0; n<way.nodes.size(); n++) {
-        std::cout << way.nodes[n].GetDisplayText() << " ";
-      }
-      std::cout << std::endl;
-
       statistics.Measure(way.nodes);
 
+      if (!way.nodes.empty()) {
+        coordVectors.push_back(way.nodes);
+      }
+
       for (auto& encoder : encoders) {
         encoder->Encode(way.GetFileOffset(),way.nodes);
       }
@@ -515,5 +777,17 @@ int main(int argc, char* argv[])
   std::cout << statistics.fifteenBitDeltaCount*100.0/statistics.deltaCount << "% ";
   std::cout << statistics.twentythreeBitDeltaCount*100.0/statistics.deltaCount << "%" << std::endl;
 
+  std::cout << "---" << std::endl;
+
+  if (!CheckDecoding(coordVectors) ||
+      !CheckDecoding(CreateCoordVectors())) {
+    return 1;
+  }
+
+  if (!BenchmarkDecoding(coordVectors,
+                         statistics.coordCount)) {
+    return 1;
+  }
+
   return 0;
 }
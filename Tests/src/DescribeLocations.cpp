@@ -0,0 +1,273 @@
+/*
+  DescribeLocations - a test program for libosmscout
+  Copyright (C) 2016  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <osmscout/Database.h>
+#include <osmscout/LocationService.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+
+/*
+ * Checks, that LocationService::DescribeLocations() returns the same description
+ * for each location as LocationService::DescribeLocation(), sequentially and in
+ * parallel, and with the R-tree indexes of the database disabled. Locations are
+ * taken from the nodes of the areas of the given database and include pairs of
+ * locations on both sides of the boundaries of the cells used for clustering and
+ * locations around the maximum distance of address areas.
+ */
+
+static const size_t LOCATION_COUNT=500;
+static const double CELL_SIZE=0.01;        //!< Cell size used for clustering by DescribeLocations()
+static const double BOUNDARY_OFFSET=1e-6;  //!< Distance of boundary locations to the cell boundary
+static const double FAR_OFFSET=0.0015;     //!< Maximum offset of far locations, beyond the maximum address distance
+
+/**
+ * Return the nodes of all area rings of the given data file
+ */
+static bool ReadAreaNodes(const osmscout::TypeConfig& typeConfig,
+                          const std::string& filename,
+                          std::vector<osmscout::GeoCoord>& nodes)
+{
+  osmscout::FileScanner scanner;
+
+  try {
+    uint32_t dataCount;
+
+    scanner.Open(filename,
+                 osmscout::FileScanner::Sequential,
+                 true);
+
+    scanner.Read(dataCount);
+
+    for (uint32_t d=0; d<dataCount; d++) {
+      osmscout::Area area;
+
+      area.Read(typeConfig,
+                scanner);
+
+      for (const auto& ring : area.rings) {
+        nodes.insert(nodes.end(),
+                     ring.nodes.begin(),
+                     ring.nodes.end());
+      }
+    }
+
+    scanner.Close();
+  }
+  catch (osmscout::IOException& e) {
+    std::cerr << e.GetDescription() << std::endl;
+    scanner.CloseFailsafe();
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Return the nearest cell boundary of the given value in the cell grid of
+ * DescribeLocations(), with the grid starting at origin
+ */
+static double GetCellBoundary(double value,
+                              double origin)
+{
+  return std::round((value-origin)/CELL_SIZE)*CELL_SIZE+origin;
+}
+
+static bool Equals(const osmscout::LocationDescription& a,
+                   const osmscout::LocationDescription& b)
+{
+  osmscout::LocationCoordDescriptionRef   aCoord=a.GetCoordDescription();
+  osmscout::LocationCoordDescriptionRef   bCoord=b.GetCoordDescription();
+  osmscout::LocationAtPlaceDescriptionRef aAddress=a.GetAtAddressDescription();
+  osmscout::LocationAtPlaceDescriptionRef bAddress=b.GetAtAddressDescription();
+
+  if (!aCoord ||
+      !bCoord ||
+      aCoord->GetLocation()!=bCoord->GetLocation()) {
+    return false;
+  }
+
+  if (!aAddress ||
+      !bAddress) {
+    return !aAddress && !bAddress;
+  }
+
+  return aAddress->GetPlace().GetObject()==bAddress->GetPlace().GetObject() &&
+         aAddress->GetPlace().GetDisplayString()==bAddress->GetPlace().GetDisplayString() &&
+         aAddress->IsAtPlace()==bAddress->IsAtPlace() &&
+         aAddress->GetDistance()==bAddress->GetDistance() &&
+         aAddress->GetBearing()==bAddress->GetBearing();
+}
+
+static std::string GetDisplayString(const osmscout::LocationDescription& description)
+{
+  osmscout::LocationAtPlaceDescriptionRef address=description.GetAtAddressDescription();
+
+  if (!address) {
+    return "-";
+  }
+
+  return address->GetPlace().GetDisplayString()+" ("+std::to_string(address->GetDistance())+"m)";
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc!=2) {
+    std::cerr << "DescribeLocations <map directory>" << std::endl;
+    return 1;
+  }
+
+  osmscout::DatabaseParameter databaseParameter;
+  osmscout::DatabaseParameter noRTreeDatabaseParameter;
+
+  noRTreeDatabaseParameter.SetRTreeIndexes(false);
+
+  osmscout::DatabaseRef database(new osmscout::Database(databaseParameter));
+  osmscout::DatabaseRef noRTreeDatabase(new osmscout::Database(noRTreeDatabaseParameter));
+
+  if (!database->Open(argv[1]) ||
+      !noRTreeDatabase->Open(argv[1])) {
+    std::cerr << "Cannot open database" << std::endl;
+    return 1;
+  }
+
+  if (!database->GetAreaRTreeIndex()) {
+    std::cout << "Database has no area R-tree index, both lookups use the area index" << std::endl;
+  }
+
+  if (noRTreeDatabase->GetAreaRTreeIndex()) {
+    std::cerr << "R-tree index is used although disabled" << std::endl;
+    return 1;
+  }
+
+  std::vector<osmscout::GeoCoord> nodes;
+
+  if (!ReadAreaNodes(*database->GetTypeConfig(),
+                     osmscout::AppendFileToDir(argv[1],osmscout::AreaDataFile::AREAS_DAT),
+                     nodes)) {
+    return 1;
+  }
+
+  if (nodes.empty()) {
+    std::cerr << "Database does not contain areas" << std::endl;
+    return 1;
+  }
+
+  std::mt19937                           generator(4711);
+  std::uniform_int_distribution<size_t>  nodeDistribution(0,nodes.size()-1);
+  std::uniform_real_distribution<double> offsetDistribution(-0.0005,0.0005);
+  std::uniform_real_distribution<double> farOffsetDistribution(-FAR_OFFSET,FAR_OFFSET);
+  std::vector<osmscout::GeoCoord>        locations;
+
+  for (size_t i=0; i<LOCATION_COUNT/2; i++) {
+    const osmscout::GeoCoord& node=nodes[nodeDistribution(generator)];
+
+    locations.push_back(osmscout::GeoCoord(node.GetLat()+offsetDistribution(generator),
+                                           node.GetLon()+offsetDistribution(generator)));
+  }
+
+  for (size_t i=0; i<LOCATION_COUNT/4; i++) {
+    const osmscout::GeoCoord& node=nodes[nodeDistribution(generator)];
+
+    locations.push_back(osmscout::GeoCoord(node.GetLat()+farOffsetDistribution(generator),
+                                           node.GetLon()+farOffsetDistribution(generator)));
+  }
+
+  for (size_t i=0; i<LOCATION_COUNT/8; i++) {
+    const osmscout::GeoCoord& node=nodes[nodeDistribution(generator)];
+    double                    lonBoundary=GetCellBoundary(node.GetLon(),-180.0);
+    double                    latBoundary=GetCellBoundary(node.GetLat(),-90.0);
+
+    // Both sides of the nearest cell boundary in west-east and in north-south direction
+    locations.push_back(osmscout::GeoCoord(node.GetLat(),lonBoundary-BOUNDARY_OFFSET));
+    locations.push_back(osmscout::GeoCoord(node.GetLat(),lonBoundary+BOUNDARY_OFFSET));
+    locations.push_back(osmscout::GeoCoord(latBoundary-BOUNDARY_OFFSET,node.GetLon()));
+    locations.push_back(osmscout::GeoCoord(latBoundary+BOUNDARY_OFFSET,node.GetLon()));
+  }
+
+  osmscout::LocationService                  locationService(database);
+  osmscout::LocationService                  noRTreeLocationService(noRTreeDatabase);
+  std::vector<osmscout::LocationDescription> sequentialDescriptions;
+  std::vector<osmscout::LocationDescription> parallelDescriptions;
+  std::vector<osmscout::LocationDescription> noRTreeDescriptions;
+  size_t                                     addressCount=0;
+  size_t                                     errors=0;
+
+  if (!locationService.DescribeLocations(locations,sequentialDescriptions,false) ||
+      !locationService.DescribeLocations(locations,parallelDescriptions,true) ||
+      !noRTreeLocationService.DescribeLocations(locations,noRTreeDescriptions,false)) {
+    std::cerr << "Error during generation of location descriptions" << std::endl;
+    return 1;
+  }
+
+  if (sequentialDescriptions.size()!=locations.size() ||
+      parallelDescriptions.size()!=locations.size() ||
+      noRTreeDescriptions.size()!=locations.size()) {
+    std::cerr << "Wrong number of location descriptions" << std::endl;
+    return 1;
+  }
+
+  for (size_t i=0; i<locations.size(); i++) {
+    osmscout::LocationDescription description;
+
+    if (!locationService.DescribeLocation(locations[i],
+                                          description)) {
+      std::cerr << "Error during generation of location description" << std::endl;
+      return 1;
+    }
+
+    if (description.GetAtAddressDescription()) {
+      addressCount++;
+    }
+
+    if (!Equals(description,sequentialDescriptions[i]) ||
+        !Equals(description,parallelDescriptions[i])) {
+      std::cerr << "Description of " << locations[i].GetDisplayText() << " differs: ";
+      std::cerr << GetDisplayString(description) << " != " << GetDisplayString(sequentialDescriptions[i]);
+      std::cerr << " / " << GetDisplayString(parallelDescriptions[i]) << std::endl;
+      errors++;
+    }
+
+    if (!Equals(description,noRTreeDescriptions[i])) {
+      std::cerr << "Description of " << locations[i].GetDisplayText() << " without R-tree differs: ";
+      std::cerr << GetDisplayString(description) << " != " << GetDisplayString(noRTreeDescriptions[i]) << std::endl;
+      errors++;
+    }
+  }
+
+  database->Close();
+  noRTreeDatabase->Close();
+
+  std::cout << locations.size() << " location(s) compared, " << addressCount << " with address" << std::endl;
+
+  if (errors>0) {
+    std::cerr << errors << " error(s)" << std::endl;
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,350 @@
+/*
+  LazyGeometry - a test program for libosmscout
+  Copyright (C) 2016  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <osmscout/AreaDataFile.h>
+#include <osmscout/TypeConfig.h>
+#include <osmscout/WayDataFile.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+
+/*
+ * Reads all ways and areas of the given database eagerly and lazily (see
+ * Way::ReadLazy() and Area::ReadLazy()) and checks, that the decoded geometry,
+ * the bounding box and the node count of both are identical. Objects are read
+ * sequentially with and without memory mapping and by offset via the data files.
+ */
+
+static bool Equals(const osmscout::GeoBox& a,
+                   const osmscout::GeoBox& b)
+{
+  return a.GetMinCoord()==b.GetMinCoord() &&
+         a.GetMaxCoord()==b.GetMaxCoord();
+}
+
+static bool CompareGeometry(const std::string& object,
+                            const std::vector<osmscout::GeoCoord>& expectedNodes,
+                            const std::vector<osmscout::Id>& expectedIds,
+                            const std::vector<osmscout::GeoCoord>& nodes,
+                            const std::vector<osmscout::Id>& ids)
+{
+  if (nodes!=expectedNodes) {
+    std::cerr << object << ": Decoded nodes differ" << std::endl;
+    return false;
+  }
+
+  if (ids!=expectedIds) {
+    std::cerr << object << ": Decoded ids differ" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+static bool Compare(const osmscout::Way& eager,
+                    osmscout::Way& lazy)
+{
+  std::string object="Way "+std::to_string(eager.GetFileOffset());
+
+  if (lazy.GetFileOffset()!=eager.GetFileOffset() ||
+      lazy.GetType()!=eager.GetType()) {
+    std::cerr << object << ": Offset or type differ" << std::endl;
+    return false;
+  }
+
+  if (!lazy.HasEncodedGeometry()) {
+    std::cerr << object << ": Geometry is not encoded" << std::endl;
+    return false;
+  }
+
+  if (lazy.GetNodeCount()!=eager.GetNodeCount()) {
+    std::cerr << object << ": Node count " << lazy.GetNodeCount() << " != " << eager.GetNodeCount() << std::endl;
+    return false;
+  }
+
+  osmscout::GeoBox eagerBoundingBox;
+  osmscout::GeoBox lazyBoundingBox;
+
+  eager.GetBoundingBox(eagerBoundingBox);
+  lazy.GetBoundingBox(lazyBoundingBox);
+
+  if (!Equals(lazyBoundingBox,eagerBoundingBox)) {
+    std::cerr << object << ": Bounding box " << lazyBoundingBox.GetDisplayText() << " != " << eagerBoundingBox.GetDisplayText() << std::endl;
+    return false;
+  }
+
+  std::vector<osmscout::GeoCoord> nodes;
+  std::vector<osmscout::Id>       ids;
+
+  lazy.DecodeGeometry(nodes,
+                      ids);
+
+  if (!CompareGeometry(object,eager.nodes,eager.ids,nodes,ids)) {
+    return false;
+  }
+
+  lazy.DecodeGeometry();
+
+  if (lazy.HasEncodedGeometry()) {
+    std::cerr << object << ": Geometry is still encoded after decoding" << std::endl;
+    return false;
+  }
+
+  return CompareGeometry(object,eager.nodes,eager.ids,lazy.nodes,lazy.ids);
+}
+
+static bool Compare(const osmscout::Area& eager,
+                    osmscout::Area& lazy)
+{
+  std::string object="Area "+std::to_string(eager.GetFileOffset());
+
+  if (lazy.GetFileOffset()!=eager.GetFileOffset() ||
+      lazy.rings.size()!=eager.rings.size()) {
+    std::cerr << object << ": Offset or ring count differ" << std::endl;
+    return false;
+  }
+
+  if (!lazy.HasEncodedGeometry()) {
+    std::cerr << object << ": Geometry is not encoded" << std::endl;
+    return false;
+  }
+
+  osmscout::GeoBox eagerBoundingBox;
+  osmscout::GeoBox lazyBoundingBox;
+
+  eager.GetBoundingBox(eagerBoundingBox);
+  lazy.GetBoundingBox(lazyBoundingBox);
+
+  if (!Equals(lazyBoundingBox,eagerBoundingBox)) {
+    std::cerr << object << ": Bounding box " << lazyBoundingBox.GetDisplayText() << " != " << eagerBoundingBox.GetDisplayText() << std::endl;
+    return false;
+  }
+
+  for (size_t r=0; r<eager.rings.size(); r++) {
+    const osmscout::Area::Ring& eagerRing=eager.rings[r];
+    const osmscout::Area::Ring& lazyRing=lazy.rings[r];
+    std::string                 ring=object+" ring "+std::to_string(r);
+
+    if (lazyRing.ring!=eagerRing.ring ||
+        lazyRing.GetType()!=eagerRing.GetType()) {
+      std::cerr << ring << ": Ring number or type differ" << std::endl;
+      return false;
+    }
+
+    if (lazyRing.GetNodeCount()!=eagerRing.GetNodeCount()) {
+      std::cerr << ring << ": Node count " << lazyRing.GetNodeCount() << " != " << eagerRing.GetNodeCount() << std::endl;
+      return false;
+    }
+
+    std::vector<osmscout::GeoCoord> nodes;
+    std::vector<osmscout::Id>       ids;
+
+    lazyRing.DecodeGeometry(nodes,
+                            ids);
+
+    if (!CompareGeometry(ring,eagerRing.nodes,eagerRing.ids,nodes,ids)) {
+      return false;
+    }
+  }
+
+  lazy.DecodeGeometry();
+
+  if (lazy.HasEncodedGeometry()) {
+    std::cerr << object << ": Geometry is still encoded after decoding" << std::endl;
+    return false;
+  }
+
+  for (size_t r=0; r<eager.rings.size(); r++) {
+    if (!CompareGeometry(object+" ring "+std::to_string(r),
+                         eager.rings[r].nodes,eager.rings[r].ids,
+                         lazy.rings[r].nodes,lazy.rings[r].ids)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Read all objects of the given data file eagerly and lazily and compare them.
+ * The offsets of the objects are returned.
+ */
+template<class N>
+static bool CompareSequential(const osmscout::TypeConfig& typeConfig,
+                              const std::string& filename,
+                              bool memoryMapped,
+                              std::vector<osmscout::FileOffset>& offsets)
+{
+  osmscout::FileScanner eagerScanner;
+  osmscout::FileScanner lazyScanner;
+  size_t                errors=0;
+
+  offsets.clear();
+
+  try {
+    uint32_t dataCount;
+
+    eagerScanner.Open(filename,
+                      osmscout::FileScanner::Sequential,
+                      memoryMapped);
+    lazyScanner.Open(filename,
+                     osmscout::FileScanner::Sequential,
+                     memoryMapped);
+
+    eagerScanner.Read(dataCount);
+    lazyScanner.Read(dataCount);
+
+    for (uint32_t d=0; d<dataCount; d++) {
+      N eager;
+      N lazy;
+
+      eager.Read(typeConfig,
+                 eagerScanner);
+      lazy.ReadLazy(typeConfig,
+                    lazyScanner);
+
+      if (lazyScanner.GetPos()!=eagerScanner.GetPos()) {
+        std::cerr << "Lazy read of object " << eager.GetFileOffset() << " ends at " << lazyScanner.GetPos() << " instead of " << eagerScanner.GetPos() << std::endl;
+        return false;
+      }
+
+      if (!Compare(eager,lazy)) {
+        errors++;
+      }
+
+      offsets.push_back(eager.GetFileOffset());
+    }
+
+    eagerScanner.Close();
+    lazyScanner.Close();
+  }
+  catch (osmscout::IOException& e) {
+    std::cerr << e.GetDescription() << std::endl;
+    eagerScanner.CloseFailsafe();
+    lazyScanner.CloseFailsafe();
+    return false;
+  }
+
+  std::cout << offsets.size() << " object(s) of '" << filename << "' compared, memory mapped: " << (memoryMapped ? "yes" : "no") << std::endl;
+
+  return errors==0;
+}
+
+/**
+ * Read the objects at the given offsets via the data file with and without
+ * lazyGeometry and compare them.
+ */
+template<class D>
+static bool CompareByOffset(const osmscout::TypeConfigRef& typeConfig,
+                            const std::string& path,
+                            const std::vector<osmscout::FileOffset>& offsets)
+{
+  D dataFile;
+
+  if (!dataFile.Open(typeConfig,
+                     path,
+                     osmscout::FileScanner::LowMemRandom,
+                     false)) {
+    std::cerr << "Cannot open data file" << std::endl;
+    return false;
+  }
+
+  std::vector<typename D::ValueType> eager;
+  std::vector<typename D::ValueType> lazy;
+
+  if (!dataFile.GetByOffset(offsets,eager,false) ||
+      !dataFile.GetByOffset(offsets,lazy,true)) {
+    std::cerr << "Cannot read data by offset" << std::endl;
+    return false;
+  }
+
+  dataFile.Close();
+
+  if (eager.size()!=offsets.size() ||
+      lazy.size()!=offsets.size()) {
+    std::cerr << "Wrong number of objects read by offset" << std::endl;
+    return false;
+  }
+
+  size_t errors=0;
+
+  for (size_t i=0; i<offsets.size(); i++) {
+    if (eager[i]->HasEncodedGeometry()) {
+      std::cerr << "Object " << offsets[i] << " was read lazily without being requested" << std::endl;
+      errors++;
+    }
+    else if (!Compare(*eager[i],*lazy[i])) {
+      errors++;
+    }
+  }
+
+  return errors==0;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc!=2) {
+    std::cerr << "LazyGeometry <map directory>" << std::endl;
+    return 1;
+  }
+
+  osmscout::TypeConfigRef typeConfig=std::make_shared<osmscout::TypeConfig>();
+
+  if (!typeConfig->LoadFromDataFile(argv[1])) {
+    std::cerr << "Cannot load type configuration" << std::endl;
+    return 1;
+  }
+
+  std::string                       waysFilename=osmscout::AppendFileToDir(argv[1],osmscout::WayDataFile::WAYS_DAT);
+  std::string                       areasFilename=osmscout::AppendFileToDir(argv[1],osmscout::AreaDataFile::AREAS_DAT);
+  std::vector<osmscout::FileOffset> wayOffsets;
+  std::vector<osmscout::FileOffset> areaOffsets;
+  size_t                            errors=0;
+
+  for (bool memoryMapped : {false,true}) {
+    if (!CompareSequential<osmscout::Way>(*typeConfig,waysFilename,memoryMapped,wayOffsets)) {
+      errors++;
+    }
+
+    if (!CompareSequential<osmscout::Area>(*typeConfig,areasFilename,memoryMapped,areaOffsets)) {
+      errors++;
+    }
+  }
+
+  if (!CompareByOffset<osmscout::WayDataFile>(typeConfig,argv[1],wayOffsets)) {
+    errors++;
+  }
+
+  if (!CompareByOffset<osmscout::AreaDataFile>(typeConfig,argv[1],areaOffsets)) {
+    errors++;
+  }
+
+  if (errors>0) {
+    std::cerr << errors << " error(s)" << std::endl;
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,476 @@
+/*
+  LocationTokenSearch - a test program for libosmscout
+  Copyright (C) 2016  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <osmscout/Database.h>
+#include <osmscout/LocationService.h>
+
+#include <osmscout/util/String.h>
+
+/*
+ * Compares the result of the token index based location search with the result
+ * of visiting the complete region tree of the given database.
+ */
+
+static const size_t MAX_PATTERN_COUNT=200;
+static const size_t MAX_REGION_COUNT=50;
+
+/**
+ * Returns true, if every token of the pattern is a prefix of a token of the name,
+ * which is the condition the token index uses for preselection
+ */
+static bool IsTokenMatch(const std::string& name,
+                         const std::vector<std::string>& patternTokens)
+{
+  std::vector<std::string> nameTokens;
+
+  osmscout::LocationIndex::GetNameTokens(name,
+                                         nameTokens);
+
+  for (const auto& patternToken : patternTokens) {
+    bool found=false;
+
+    for (const auto& nameToken : nameTokens) {
+      if (nameToken.compare(0,patternToken.length(),patternToken)==0) {
+        found=true;
+        break;
+      }
+    }
+
+    if (!found) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static std::string GetPrefix(const std::string& token,
+                             size_t characters)
+{
+  size_t length=0;
+
+  while (length<token.length() &&
+         characters>0) {
+    length++;
+
+    while (length<token.length() &&
+           (((unsigned char)token[length]) & 0xC0)==0x80) {
+      length++;
+    }
+
+    characters--;
+  }
+
+  return token.substr(0,length);
+}
+
+class RegionCollector : public osmscout::AdminRegionVisitor
+{
+public:
+  std::vector<osmscout::AdminRegion> regions;
+
+  Action Visit(const osmscout::AdminRegion& region)
+  {
+    regions.push_back(region);
+
+    return visitChildren;
+  }
+};
+
+class LocationCollector : public osmscout::LocationVisitor
+{
+public:
+  std::set<std::string> names;
+  std::set<std::string> keys;
+
+  bool Visit(const osmscout::AdminRegion& adminRegion,
+             const osmscout::POI& poi)
+  {
+    names.insert(poi.name);
+    keys.insert("P "+osmscout::NumberToString(adminRegion.regionOffset)+" "+poi.object.GetName()+"\t"+poi.name);
+
+    return true;
+  }
+
+  bool Visit(const osmscout::AdminRegion& adminRegion,
+             const osmscout::Location& location)
+  {
+    names.insert(location.name);
+    keys.insert("L "+osmscout::NumberToString(adminRegion.regionOffset)+" "+osmscout::NumberToString(location.locationOffset)+"\t"+location.name);
+
+    return true;
+  }
+};
+
+/**
+ * Return all keys of the given set, where the name part (after the tab)
+ * matches the given pattern tokens
+ */
+static std::set<std::string> FilterKeys(const std::set<std::string>& keys,
+                                        const std::vector<std::string>& patternTokens)
+{
+  std::set<std::string> result;
+
+  for (const auto& key : keys) {
+    if (IsTokenMatch(key.substr(key.find('\t')+1),
+                     patternTokens)) {
+      result.insert(key);
+    }
+  }
+
+  return result;
+}
+
+static std::string GetResultKey(const osmscout::LocationSearchResult::Entry& entry)
+{
+  std::string key;
+
+  if (entry.adminRegion) {
+    key+=osmscout::NumberToString(entry.adminRegion->regionOffset);
+  }
+
+  key+=" ";
+
+  if (entry.location) {
+    key+=osmscout::NumberToString(entry.location->locationOffset);
+  }
+
+  key+=" ";
+
+  if (entry.poi) {
+    key+=entry.poi->object.GetName();
+  }
+
+  key+=" ";
+
+  if (entry.address) {
+    key+=osmscout::NumberToString(entry.address->addressOffset);
+  }
+
+  return key;
+}
+
+static bool Search(const osmscout::LocationServiceRef& locationService,
+                   const std::string& regionPattern,
+                   const std::string& locationPattern,
+                   bool useTokenIndex,
+                   std::set<std::string>& keys)
+{
+  osmscout::LocationSearch       search;
+  osmscout::LocationSearch::Entry entry;
+  osmscout::LocationSearchResult result;
+
+  entry.adminRegionPattern=regionPattern;
+  entry.locationPattern=locationPattern;
+
+  search.searches.push_back(entry);
+  search.limit=100000;
+  search.useTokenIndex=useTokenIndex;
+
+  if (!locationService->SearchForLocations(search,
+                                           result)) {
+    return false;
+  }
+
+  keys.clear();
+
+  for (const auto& resultEntry : result.results) {
+    keys.insert(GetResultKey(resultEntry));
+  }
+
+  return true;
+}
+
+/**
+ * Select up to MAX_PATTERN_COUNT patterns from the tokens of the given names: prefixes
+ * of one, two and three characters, the complete token and the complete name.
+ */
+static std::vector<std::string> GetPatterns(const std::set<std::string>& names)
+{
+  std::set<std::string> patterns;
+
+  for (const auto& name : names) {
+    std::vector<std::string> tokens;
+
+    osmscout::LocationIndex::GetNameTokens(name,
+                                           tokens);
+
+    for (const auto& token : tokens) {
+      for (size_t length=1; length<=3; length++) {
+        patterns.insert(GetPrefix(token,
+                                  length));
+      }
+
+      patterns.insert(token);
+    }
+
+    if (!tokens.empty()) {
+      patterns.insert(name);
+    }
+  }
+
+  std::vector<std::string> result(patterns.begin(),
+                                  patterns.end());
+  std::vector<std::string> selection;
+  size_t                   step=(result.size()+MAX_PATTERN_COUNT-1)/MAX_PATTERN_COUNT;
+
+  for (size_t i=0; i<result.size(); i+=step) {
+    selection.push_back(result[i]);
+  }
+
+  return selection;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc!=2) {
+    std::cerr << "LocationTokenSearch <map directory>" << std::endl;
+    return 1;
+  }
+
+  osmscout::DatabaseParameter databaseParameter;
+  osmscout::DatabaseRef       database(new osmscout::Database(databaseParameter));
+
+  if (!database->Open(argv[1])) {
+    std::cerr << "Cannot open database" << std::endl;
+    return 1;
+  }
+
+  osmscout::LocationIndexRef   locationIndex=database->GetLocationIndex();
+  osmscout::LocationServiceRef locationService(new osmscout::LocationService(database));
+  size_t                       errors=0;
+
+  if (!locationIndex) {
+    std::cerr << "Cannot load location index" << std::endl;
+    return 1;
+  }
+
+  if (!locationIndex->HasTokenIndex()) {
+    std::cerr << "Database has no token index" << std::endl;
+    return 1;
+  }
+
+  RegionCollector allRegions;
+
+  if (!locationIndex->VisitAdminRegions(allRegions)) {
+    std::cerr << "Cannot visit admin regions" << std::endl;
+    return 1;
+  }
+
+  std::set<std::string> regionNames;
+  std::set<std::string> locationNames;
+
+  for (const auto& region : allRegions.regions) {
+    regionNames.insert(region.name);
+
+    for (const auto& alias : region.aliases) {
+      regionNames.insert(alias.name);
+    }
+  }
+
+  std::vector<osmscout::AdminRegion> regions;
+
+  for (size_t i=0; i<allRegions.regions.size(); i+=(allRegions.regions.size()+MAX_REGION_COUNT-1)/MAX_REGION_COUNT) {
+    regions.push_back(allRegions.regions[i]);
+  }
+
+  std::vector<LocationCollector> allLocations(regions.size());
+
+  for (size_t r=0; r<regions.size(); r++) {
+    if (!locationIndex->VisitAdminRegionLocations(regions[r],
+                                                  allLocations[r])) {
+      std::cerr << "Cannot visit locations of region '" << regions[r].name << "'" << std::endl;
+      return 1;
+    }
+
+    locationNames.insert(allLocations[r].names.begin(),
+                         allLocations[r].names.end());
+  }
+
+  std::vector<std::string> regionPatterns=GetPatterns(regionNames);
+  std::vector<std::string> locationPatterns=GetPatterns(locationNames);
+
+  std::cout << allRegions.regions.size() << " region(s), " << locationNames.size() << " location name(s)" << std::endl;
+
+  // The regions visited using the token index must be the regions of the
+  // complete traversal, where the name or one of the aliases matches the pattern tokens
+
+  std::cout << "Comparing " << regionPatterns.size() << " region pattern(s)..." << std::endl;
+
+  for (const auto& pattern : regionPatterns) {
+    std::vector<std::string> patternTokens;
+    std::set<std::string>    expected;
+    std::set<std::string>    actual;
+    RegionCollector          matching;
+
+    osmscout::LocationIndex::GetNameTokens(pattern,
+                                           patternTokens);
+
+    for (const auto& region : allRegions.regions) {
+      bool match=IsTokenMatch(region.name,
+                              patternTokens);
+
+      for (const auto& alias : region.aliases) {
+        match=match || IsTokenMatch(alias.name,
+                                    patternTokens);
+      }
+
+      if (match) {
+        expected.insert(osmscout::NumberToString(region.regionOffset));
+      }
+    }
+
+    if (!locationIndex->VisitMatchingAdminRegions(pattern,
+                                                  matching)) {
+      std::cerr << "Cannot visit admin regions matching '" << pattern << "'" << std::endl;
+      return 1;
+    }
+
+    for (const auto& region : matching.regions) {
+      actual.insert(osmscout::NumberToString(region.regionOffset));
+    }
+
+    // Unselective short patterns fall back to visiting all regions
+    if (actual.size()==allRegions.regions.size()) {
+      continue;
+    }
+
+    if (actual!=expected) {
+      std::cerr << "Region pattern '" << pattern << "': " << actual.size() << " region(s) instead of " << expected.size() << std::endl;
+      errors++;
+    }
+  }
+
+  // Same for the locations and POIs of a region
+
+  std::cout << "Comparing " << locationPatterns.size() << " location pattern(s) in " << regions.size() << " region(s)..." << std::endl;
+
+  for (size_t r=0; r<regions.size(); r++) {
+    for (const auto& pattern : locationPatterns) {
+      std::vector<std::string> patternTokens;
+      LocationCollector        matching;
+
+      osmscout::LocationIndex::GetNameTokens(pattern,
+                                             patternTokens);
+
+      if (!locationIndex->VisitMatchingAdminRegionLocations(regions[r],
+                                                            pattern,
+                                                            matching)) {
+        std::cerr << "Cannot visit locations matching '" << pattern << "'" << std::endl;
+        return 1;
+      }
+
+      if (matching.keys==allLocations[r].keys) {
+        continue;
+      }
+
+      if (matching.keys!=FilterKeys(allLocations[r].keys,
+                                    patternTokens)) {
+        std::cerr << "Location pattern '" << pattern << "' in region '" << regions[r].name << "': " << matching.keys.size() << " location(s) instead of " << FilterKeys(allLocations[r].keys,patternTokens).size() << std::endl;
+        errors++;
+      }
+    }
+  }
+
+  // The search using the token index must return a subset of the default search,
+  // the default search must still match substrings within tokens
+
+  std::cout << "Comparing searches..." << std::endl;
+
+  for (size_t i=0; i<regionPatterns.size(); i+=std::max((size_t)1,regionPatterns.size()/20)) {
+    for (size_t j=0; j<locationPatterns.size(); j+=std::max((size_t)1,locationPatterns.size()/20)) {
+      std::set<std::string> defaultKeys;
+      std::set<std::string> tokenKeys;
+
+      if (!Search(locationService,
+                  regionPatterns[i],
+                  locationPatterns[j],
+                  false,
+                  defaultKeys) ||
+          !Search(locationService,
+                  regionPatterns[i],
+                  locationPatterns[j],
+                  true,
+                  tokenKeys)) {
+        std::cerr << "Cannot search for '" << locationPatterns[j] << "' in '" << regionPatterns[i] << "'" << std::endl;
+        return 1;
+      }
+
+      if (!std::includes(defaultKeys.begin(),
+                         defaultKeys.end(),
+                         tokenKeys.begin(),
+                         tokenKeys.end())) {
+        std::cerr << "Search for '" << locationPatterns[j] << "' in '" << regionPatterns[i] << "' using the token index returns results the default search does not return" << std::endl;
+        errors++;
+      }
+    }
+  }
+
+  for (const auto& name : regionNames) {
+    std::vector<std::string> tokens;
+
+    osmscout::LocationIndex::GetNameTokens(name,
+                                           tokens);
+
+    if (tokens.empty() ||
+        tokens.front().length()<4 ||
+        name.length()<4) {
+      continue;
+    }
+
+    // Drop the first character of the name, so the pattern starts within a token
+    std::string           pattern=name.substr(1);
+    std::set<std::string> defaultKeys;
+
+    if ((((unsigned char)pattern[0]) & 0xC0)==0x80) {
+      continue;
+    }
+
+    if (!Search(locationService,
+                pattern,
+                "",
+                false,
+                defaultKeys)) {
+      std::cerr << "Cannot search for region '" << pattern << "'" << std::endl;
+      return 1;
+    }
+
+    if (defaultKeys.empty()) {
+      std::cerr << "Default search for region '" << pattern << "' does not find '" << name << "'" << std::endl;
+      errors++;
+    }
+  }
+
+  database->Close();
+
+  if (errors>0) {
+    std::cerr << errors << " error(s)" << std::endl;
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
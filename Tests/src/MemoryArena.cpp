@@ -0,0 +1,192 @@
+/*
+  MemoryArena - a test program for libosmscout
+  Copyright (C) 2016  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <osmscout/TypeConfig.h>
+#include <osmscout/TypeFeatures.h>
+#include <osmscout/Way.h>
+
+#include <osmscout/util/MemoryArena.h>
+
+/*
+ * Checks the lifetime of a MemoryArena: Objects allocated from an arena keep it
+ * alive after the arena itself and its scope are gone, a single surviving object
+ * pins the complete arena, and copies created by CopyOutOfArena() or outside of
+ * any arena scope do not reference the arena.
+ */
+
+static const size_t OBJECT_COUNT=200;
+static const size_t SLAB_SIZE=1024;   //!< Small slabs, so that the objects need several slabs
+
+static std::string GetName(const osmscout::Way& way,
+                           size_t nameIndex)
+{
+  if (!way.HasFeature(nameIndex)) {
+    return "";
+  }
+
+  return static_cast<osmscout::NameFeatureValue*>(way.GetFeatureValue(nameIndex))->GetName();
+}
+
+/**
+ * Create a way of the given type with the given name. Feature values and the
+ * way itself are allocated from the arena active for the current thread.
+ */
+static osmscout::WayRef CreateWay(const osmscout::TypeInfoRef& type,
+                                  size_t nameIndex,
+                                  const std::string& name)
+{
+  osmscout::WayRef             way=osmscout::AllocateShared<osmscout::Way>();
+  osmscout::FeatureValueBuffer buffer;
+  osmscout::NameFeatureValue   *value;
+
+  buffer.SetType(type);
+
+  value=static_cast<osmscout::NameFeatureValue*>(buffer.AllocateValue(nameIndex));
+  value->SetName(name);
+
+  way->SetFeatures(buffer);
+  way->nodes.push_back(osmscout::GeoCoord(51.0,7.0));
+  way->nodes.push_back(osmscout::GeoCoord(51.1,7.1));
+
+  return way;
+}
+
+int main(int /*argc*/, char* /*argv*/[])
+{
+  osmscout::TypeConfig  typeConfig;
+  osmscout::TypeInfoRef type=std::make_shared<osmscout::TypeInfo>();
+  size_t                nameIndex;
+  size_t                errors=0;
+
+  type->SetType("arena_test")
+      .CanBeWay(true)
+      .AddFeature(typeConfig.GetFeature(osmscout::NameFeature::NAME));
+
+  if (!type->GetFeature(osmscout::NameFeature::NAME,
+                        nameIndex)) {
+    std::cerr << "Cannot find name feature" << std::endl;
+    return 1;
+  }
+
+  osmscout::MemoryArenaRef             arena=std::make_shared<osmscout::MemoryArena>(SLAB_SIZE);
+  std::weak_ptr<osmscout::MemoryArena> arenaReference=arena;
+  std::vector<osmscout::WayRef>        ways;
+  osmscout::WayRef                     heapWay;
+
+  {
+    osmscout::MemoryArenaScope arenaScope(arena);
+
+    for (size_t i=0; i<OBJECT_COUNT; i++) {
+      ways.push_back(CreateWay(type,
+                               nameIndex,
+                               "Way "+std::to_string(i)));
+    }
+
+    {
+      osmscout::MemoryArenaScope heapScope((osmscout::MemoryArenaRef()));
+
+      heapWay=CreateWay(type,
+                        nameIndex,
+                        "Heap way");
+    }
+  }
+
+  if (arena->GetMemorySize()<=SLAB_SIZE) {
+    std::cerr << "Objects were not allocated from the arena" << std::endl;
+    errors++;
+  }
+
+  arena.reset();
+
+  if (arenaReference.expired()) {
+    std::cerr << "Arena was destroyed while objects allocated from it are alive" << std::endl;
+    return 1;
+  }
+
+  // A copy created outside of any arena scope does not reference the arena
+  osmscout::Way            plainCopy(*ways[0]);
+  // A copy created by CopyOutOfArena() does not reference the arena, even if another arena is active
+  osmscout::MemoryArenaRef otherArena=std::make_shared<osmscout::MemoryArena>(SLAB_SIZE);
+  osmscout::WayRef         copiedWay;
+
+  {
+    osmscout::MemoryArenaScope otherArenaScope(otherArena);
+
+    copiedWay=osmscout::CopyOutOfArena(ways[1]);
+  }
+
+  if (otherArena->GetMemorySize()!=0) {
+    std::cerr << "CopyOutOfArena() allocated from the active arena" << std::endl;
+    errors++;
+  }
+
+  osmscout::WayRef survivor=ways[OBJECT_COUNT/2];
+
+  ways.clear();
+
+  if (arenaReference.expired()) {
+    std::cerr << "Arena was destroyed while one object allocated from it is alive" << std::endl;
+    return 1;
+  }
+
+  if (GetName(*survivor,nameIndex)!="Way "+std::to_string(OBJECT_COUNT/2)) {
+    std::cerr << "Surviving way has wrong name '" << GetName(*survivor,nameIndex) << "'" << std::endl;
+    errors++;
+  }
+
+  survivor.reset();
+
+  if (!arenaReference.expired()) {
+    std::cerr << "Arena still alive after all objects allocated from it were released" << std::endl;
+    errors++;
+  }
+
+  if (GetName(*copiedWay,nameIndex)!="Way 1" ||
+      copiedWay->nodes.size()!=2 ||
+      copiedWay->GetType()!=type) {
+    std::cerr << "Way copied out of the arena differs" << std::endl;
+    errors++;
+  }
+
+  if (GetName(plainCopy,nameIndex)!="Way 0") {
+    std::cerr << "Copy of way differs" << std::endl;
+    errors++;
+  }
+
+  if (GetName(*heapWay,nameIndex)!="Heap way") {
+    std::cerr << "Way allocated from the heap differs" << std::endl;
+    errors++;
+  }
+
+  std::cout << OBJECT_COUNT << " object(s) allocated from an arena" << std::endl;
+
+  if (errors>0) {
+    std::cerr << errors << " error(s)" << std::endl;
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,332 @@
+/*
+  NumericIndex - a test program for libosmscout
+  Copyright (C) 2016  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <algorithm>
+#include <iostream>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <osmscout/NumericIndex.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/Number.h>
+
+/*
+ * Writes numeric indexes with different page sizes (and thus different numbers
+ * of levels) and compares the results of NumericIndex::GetOffsets() with calls of
+ * NumericIndex::GetOffset() for each id. Ids are queried sorted, unsorted, with
+ * duplicates, missing ids and ids at the boundaries of the pages of all levels,
+ * with and without all pages fitting into the page cache.
+ */
+
+static const char*         INDEX_FILENAME="NumericIndex.tmp";
+static const size_t        ID_COUNT=5000;
+static const size_t        QUERY_COUNT=2000;
+static const uint32_t      PAGE_SIZES[]={16,32,64,1024};
+static const unsigned long CACHE_SIZES[]={4,100000}; //!< Most pages evicted and all pages cached
+
+/**
+ * Write the entries as one level of index pages in the format of the numeric index
+ * generator of the import. The start id and file offset of each page are returned.
+ */
+static void WriteLevel(osmscout::FileWriter& writer,
+                       uint32_t pageSize,
+                       const std::vector<osmscout::Id>& ids,
+                       const std::vector<osmscout::FileOffset>& offsets,
+                       std::vector<osmscout::Id>& pageIds,
+                       std::vector<osmscout::FileOffset>& pageOffsets)
+{
+  size_t currentPageSize=0;
+
+  pageIds.clear();
+  pageOffsets.clear();
+
+  for (size_t i=0; i<ids.size(); i++) {
+    if (currentPageSize>0) {
+      char         b1[10];
+      char         b2[10];
+      unsigned int b1size=osmscout::EncodeNumber(ids[i]-ids[i-1],b1);
+      unsigned int b2size=osmscout::EncodeNumber(offsets[i]-offsets[i-1],b2);
+
+      if (currentPageSize+b1size+b2size>pageSize) {
+        writer.FlushCurrentBlockWithZeros(pageSize);
+
+        currentPageSize=0;
+      }
+      else {
+        writer.Write(b1,b1size);
+        writer.Write(b2,b2size);
+
+        currentPageSize+=b1size+b2size;
+      }
+    }
+
+    if (currentPageSize==0) {
+      pageIds.push_back(ids[i]);
+      pageOffsets.push_back(writer.GetPos());
+
+      writer.WriteNumber(ids[i]);
+      writer.WriteNumber(offsets[i]);
+
+      currentPageSize=writer.GetPos()%pageSize;
+    }
+  }
+
+  writer.FlushCurrentBlockWithZeros(pageSize);
+}
+
+/**
+ * Write the index and return the start ids of all pages of all levels and the
+ * number of levels.
+ */
+static bool WriteIndex(const std::string& filename,
+                       uint32_t pageSize,
+                       const std::vector<osmscout::Id>& ids,
+                       const std::vector<osmscout::FileOffset>& offsets,
+                       std::vector<osmscout::Id>& pageStartIds,
+                       size_t& levels)
+{
+  osmscout::FileWriter writer;
+
+  try {
+    std::vector<osmscout::Id>         levelIds(ids);
+    std::vector<osmscout::FileOffset> levelOffsets(offsets);
+    std::vector<osmscout::Id>         pageIds;
+    std::vector<osmscout::FileOffset> pageOffsets;
+    std::vector<uint32_t>             pageCounts;
+    osmscout::FileOffset              levelsOffset;
+    osmscout::FileOffset              rootPageOffset;
+    osmscout::FileOffset              pageCountsOffset;
+
+    writer.Open(filename);
+
+    writer.WriteNumber(pageSize);
+    writer.WriteNumber((uint32_t)ids.size());
+
+    levelsOffset=writer.GetPos();
+    writer.Write((uint32_t)0);
+
+    rootPageOffset=writer.GetPos();
+    writer.WriteFileOffset(0);
+
+    pageCountsOffset=writer.GetPos();
+    writer.WriteFileOffset(0);
+
+    writer.FlushCurrentBlockWithZeros(pageSize);
+
+    do {
+      WriteLevel(writer,
+                 pageSize,
+                 levelIds,
+                 levelOffsets,
+                 pageIds,
+                 pageOffsets);
+
+      pageCounts.push_back((uint32_t)pageIds.size());
+      pageStartIds.insert(pageStartIds.end(),
+                          pageIds.begin(),
+                          pageIds.end());
+
+      levelIds=pageIds;
+      levelOffsets=pageOffsets;
+    } while (pageIds.size()>1);
+
+    osmscout::FileOffset pageCountsPos=writer.GetPos();
+
+    writer.SetPos(levelsOffset);
+    writer.Write((uint32_t)pageCounts.size());
+
+    writer.SetPos(rootPageOffset);
+    writer.WriteFileOffset(pageOffsets.front());
+
+    writer.SetPos(pageCountsOffset);
+    writer.WriteFileOffset(pageCountsPos);
+
+    writer.SetPos(pageCountsPos);
+
+    for (auto count=pageCounts.rbegin();
+         count!=pageCounts.rend();
+         ++count) {
+      writer.WriteNumber(*count);
+    }
+
+    writer.Close();
+
+    levels=pageCounts.size();
+  }
+  catch (osmscout::IOException& e) {
+    std::cerr << e.GetDescription() << std::endl;
+    writer.CloseFailsafe();
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Compare GetOffsets() for the given ids with GetOffset() for each id
+ */
+static size_t CheckIds(const osmscout::NumericIndex<osmscout::Id>& index,
+                       const std::string& name,
+                       const std::vector<osmscout::Id>& ids)
+{
+  std::vector<osmscout::FileOffset> expected;
+  std::vector<osmscout::FileOffset> vectorOffsets;
+  std::vector<osmscout::FileOffset> listOffsets;
+
+  for (const auto id : ids) {
+    osmscout::FileOffset offset;
+
+    if (index.GetOffset(id,
+                        offset)) {
+      expected.push_back(offset);
+    }
+  }
+
+  if (!index.GetOffsets(ids,
+                        vectorOffsets) ||
+      !index.GetOffsets(std::list<osmscout::Id>(ids.begin(),ids.end()),
+                        listOffsets)) {
+    std::cerr << name << ": Error while resolving ids" << std::endl;
+    return 1;
+  }
+
+  if (vectorOffsets!=expected ||
+      listOffsets!=expected) {
+    std::cerr << name << ": " << vectorOffsets.size() << "/" << listOffsets.size() << " offset(s) differ from " << expected.size() << " offset(s) of single lookups" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
+
+int main(int /*argc*/, char* /*argv*/[])
+{
+  std::mt19937                            generator(4711);
+  std::uniform_int_distribution<uint64_t> idGapDistribution(1,3);
+  std::uniform_int_distribution<uint64_t> offsetGapDistribution(1,200);
+  std::vector<osmscout::Id>               ids;
+  std::vector<osmscout::FileOffset>       offsets;
+  size_t                                  errors=0;
+
+  // Id 0 cannot be stored, since the first entry of a page would end the page
+  osmscout::Id         id=1000;
+  osmscout::FileOffset offset=0;
+
+  for (size_t i=0; i<ID_COUNT; i++) {
+    id+=idGapDistribution(generator);
+    offset+=offsetGapDistribution(generator);
+
+    ids.push_back(id);
+    offsets.push_back(offset);
+  }
+
+  std::uniform_int_distribution<size_t>   indexDistribution(0,ids.size()-1);
+  std::uniform_int_distribution<uint64_t> queryDistribution(ids.front()-10,ids.back()+10);
+
+  for (uint32_t pageSize : PAGE_SIZES) {
+    std::vector<osmscout::Id> pageStartIds;
+    size_t                    levels;
+
+    if (!WriteIndex(INDEX_FILENAME,
+                    pageSize,
+                    ids,
+                    offsets,
+                    pageStartIds,
+                    levels)) {
+      return 1;
+    }
+
+    for (unsigned long cacheSize : CACHE_SIZES) {
+      osmscout::NumericIndex<osmscout::Id> index(INDEX_FILENAME,
+                                                 cacheSize);
+      std::string                          name="Page size "+std::to_string(pageSize)+", cache size "+std::to_string(cacheSize);
+
+      if (!index.Open(".",
+                      osmscout::FileScanner::FastRandom,
+                      true)) {
+        std::cerr << name << ": Cannot open index" << std::endl;
+        return 1;
+      }
+
+      // Sanity check of single lookups against the written data
+      for (size_t i=0; i<ids.size(); i++) {
+        osmscout::FileOffset foundOffset;
+
+        if (!index.GetOffset(ids[i],
+                             foundOffset) ||
+            foundOffset!=offsets[i]) {
+          std::cerr << name << ": Wrong offset for id " << ids[i] << std::endl;
+          errors++;
+          break;
+        }
+      }
+
+      std::vector<osmscout::Id> randomIds;
+      std::vector<osmscout::Id> duplicateIds;
+      std::vector<osmscout::Id> boundaryIds;
+
+      for (size_t i=0; i<QUERY_COUNT; i++) {
+        randomIds.push_back(queryDistribution(generator));
+        duplicateIds.push_back(ids[indexDistribution(generator)]);
+        duplicateIds.push_back(duplicateIds[generator()%duplicateIds.size()]);
+      }
+
+      for (const auto startId : pageStartIds) {
+        boundaryIds.push_back(startId-1);
+        boundaryIds.push_back(startId);
+        boundaryIds.push_back(startId+1);
+      }
+
+      std::shuffle(boundaryIds.begin(),
+                   boundaryIds.end(),
+                   generator);
+
+      std::vector<osmscout::Id> sortedBoundaryIds(boundaryIds);
+
+      std::sort(sortedBoundaryIds.begin(),
+                sortedBoundaryIds.end());
+
+      errors+=CheckIds(index,name+", all ids",ids);
+      errors+=CheckIds(index,name+", random ids",randomIds);
+      errors+=CheckIds(index,name+", duplicate ids",duplicateIds);
+      errors+=CheckIds(index,name+", page boundary ids",boundaryIds);
+      errors+=CheckIds(index,name+", sorted page boundary ids",sortedBoundaryIds);
+      errors+=CheckIds(index,name+", no ids",std::vector<osmscout::Id>());
+
+      index.Close();
+    }
+
+    std::cout << "Page size " << pageSize << ": " << levels << " level(s), " << pageStartIds.size() << " page(s)" << std::endl;
+  }
+
+  osmscout::RemoveFile(INDEX_FILENAME);
+
+  if (errors>0) {
+    std::cerr << errors << " error(s)" << std::endl;
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,297 @@
+/*
+  ObjectViews - a test program for libosmscout
+  Copyright (C) 2016  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <osmscout/AreaDataFile.h>
+#include <osmscout/NodeDataFile.h>
+#include <osmscout/ObjectView.h>
+#include <osmscout/TypeConfig.h>
+#include <osmscout/WayDataFile.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+
+/*
+ * Reads all nodes, ways and areas of the given database twice, once as
+ * Node, Way and Area and once using NodeView, WayView and AreaView, with and
+ * without memory mapping, and checks that the views return the same type,
+ * features, bounding box and coordinates and end at the same file position.
+ * Additionally DataFile::VisitByOffset() is checked against the fully read
+ * ways, while the visitor loads the visited way from the same data file.
+ */
+
+static const size_t VISIT_STEP=7; //!< Only visit every VISIT_STEP-th way using VisitByOffset()
+
+static bool Equals(const osmscout::CoordsView& view,
+                   const std::vector<osmscout::GeoCoord>& nodes)
+{
+  if (view.GetNodeCount()!=nodes.size()) {
+    return false;
+  }
+
+  std::vector<osmscout::GeoCoord> copy;
+  size_t                          index=0;
+
+  for (const auto& coord : view) {
+    if (coord!=nodes[index]) {
+      return false;
+    }
+
+    index++;
+  }
+
+  view.CopyTo(copy);
+
+  return index==nodes.size() &&
+         copy==nodes;
+}
+
+static bool Equals(const osmscout::GeoBox& a,
+                   const osmscout::GeoBox& b)
+{
+  return a.GetMinCoord()==b.GetMinCoord() &&
+         a.GetMaxCoord()==b.GetMaxCoord();
+}
+
+static bool Equals(const osmscout::NodeView& view,
+                   const osmscout::Node& node)
+{
+  return view.GetFileOffset()==node.GetFileOffset() &&
+         view.GetType()==node.GetType() &&
+         view.GetFeatureValueBuffer()==node.GetFeatureValueBuffer() &&
+         view.GetCoords()==node.GetCoords();
+}
+
+static bool Equals(const osmscout::WayView& view,
+                   const osmscout::Way& way)
+{
+  osmscout::GeoBox boundingBox;
+
+  way.GetBoundingBox(boundingBox);
+
+  return view.GetFileOffset()==way.GetFileOffset() &&
+         view.GetType()==way.GetType() &&
+         view.GetFeatureValueBuffer()==way.GetFeatureValueBuffer() &&
+         Equals(view.GetBoundingBox(),boundingBox) &&
+         Equals(view.GetCoords(),way.nodes);
+}
+
+static bool Equals(const osmscout::AreaView& view,
+                   const osmscout::Area& area)
+{
+  osmscout::GeoBox boundingBox;
+
+  area.GetBoundingBox(boundingBox);
+
+  if (view.GetFileOffset()!=area.GetFileOffset() ||
+      view.GetType()!=area.GetType() ||
+      !Equals(view.GetBoundingBox(),boundingBox) ||
+      view.GetRingCount()!=area.rings.size()) {
+    return false;
+  }
+
+  for (size_t r=0; r<area.rings.size(); r++) {
+    const osmscout::AreaView::RingView& ringView=view.GetRing(r);
+    const osmscout::Area::Ring&         ring=area.rings[r];
+
+    if (ringView.GetType()!=ring.GetType() ||
+        ringView.GetRing()!=ring.ring ||
+        !Equals(ringView.GetCoords(),ring.nodes)) {
+      return false;
+    }
+
+    if (ring.GetType()->GetAreaId()!=osmscout::typeIgnore &&
+        ringView.GetFeatureValueBuffer()!=ring.GetFeatureValueBuffer()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Read all objects of the given data file with a full reader (O) and a view (V)
+ * in parallel. Fully read objects are appended to the given vector.
+ */
+template<class O, class V>
+static size_t CheckDataFile(const osmscout::TypeConfig& typeConfig,
+                            const std::string& filename,
+                            bool memoryMapped,
+                            std::vector<O>& objects)
+{
+  osmscout::FileScanner objectScanner;
+  osmscout::FileScanner viewScanner;
+  size_t                errors=0;
+
+  try {
+    uint32_t dataCount;
+    V        view;
+
+    objectScanner.Open(filename,
+                       osmscout::FileScanner::Sequential,
+                       false);
+    viewScanner.Open(filename,
+                     osmscout::FileScanner::Sequential,
+                     memoryMapped);
+
+    objectScanner.Read(dataCount);
+    viewScanner.Read(dataCount);
+
+    for (uint32_t d=0; d<dataCount; d++) {
+      O object;
+
+      object.Read(typeConfig,
+                  objectScanner);
+
+      view.Read(typeConfig,
+                viewScanner);
+
+      if (viewScanner.GetPos()!=objectScanner.GetPos()) {
+        std::cerr << filename << ": View of object " << object.GetFileOffset() << " ends at " << viewScanner.GetPos() << " instead of " << objectScanner.GetPos() << std::endl;
+        return errors+1;
+      }
+
+      if (!Equals(view,object)) {
+        std::cerr << filename << ": View of object " << object.GetFileOffset() << " differs" << std::endl;
+        errors++;
+      }
+
+      objects.push_back(object);
+    }
+
+    objectScanner.Close();
+    viewScanner.Close();
+  }
+  catch (osmscout::IOException& e) {
+    std::cerr << e.GetDescription() << std::endl;
+    objectScanner.CloseFailsafe();
+    viewScanner.CloseFailsafe();
+    return errors+1;
+  }
+
+  std::cout << filename << (memoryMapped ? " (memory mapped): " : ": ") << objects.size() << " object(s) compared" << std::endl;
+
+  return errors;
+}
+
+static size_t CheckVisitByOffset(const osmscout::TypeConfigRef& typeConfig,
+                                 const std::string& directory,
+                                 const std::vector<osmscout::Way>& ways)
+{
+  osmscout::WayDataFile             dataFile;
+  std::vector<osmscout::FileOffset> offsets;
+  osmscout::WayView                 view;
+  size_t                            index=0;
+  size_t                            errors=0;
+
+  if (!dataFile.Open(typeConfig,
+                     directory,
+                     osmscout::FileScanner::LowMemRandom,
+                     true)) {
+    std::cerr << "Cannot open way data file" << std::endl;
+    return 1;
+  }
+
+  for (size_t i=0; i<ways.size(); i+=VISIT_STEP) {
+    offsets.push_back(ways[i].GetFileOffset());
+  }
+
+  if (!dataFile.VisitByOffset(offsets,
+                              view,
+                              [&dataFile,&ways,&index,&errors](const osmscout::WayView& view) {
+                                osmscout::WayRef way;
+
+                                if (!Equals(view,ways[index])) {
+                                  std::cerr << "Visited way " << ways[index].GetFileOffset() << " differs" << std::endl;
+                                  errors++;
+                                }
+
+                                // The visitor may access the data file itself
+                                if (!dataFile.GetByOffset(view.GetFileOffset(),
+                                                          way) ||
+                                    !Equals(view,*way)) {
+                                  std::cerr << "Way " << view.GetFileOffset() << " loaded while visiting differs" << std::endl;
+                                  errors++;
+                                }
+
+                                index+=VISIT_STEP;
+                              })) {
+    errors++;
+  }
+
+  dataFile.Close();
+
+  std::cout << offsets.size() << " way(s) visited by offset" << std::endl;
+
+  return errors;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc!=2) {
+    std::cerr << "ObjectViews <map directory>" << std::endl;
+    return 1;
+  }
+
+  osmscout::TypeConfigRef typeConfig=std::make_shared<osmscout::TypeConfig>();
+
+  if (!typeConfig->LoadFromDataFile(argv[1])) {
+    std::cerr << "Cannot load type configuration" << std::endl;
+    return 1;
+  }
+
+  size_t errors=0;
+
+  for (bool memoryMapped : {false,true}) {
+    std::vector<osmscout::Node> nodes;
+    std::vector<osmscout::Way>  ways;
+    std::vector<osmscout::Area> areas;
+
+    errors+=CheckDataFile<osmscout::Node,osmscout::NodeView>(*typeConfig,
+                                                             osmscout::AppendFileToDir(argv[1],osmscout::NodeDataFile::NODES_DAT),
+                                                             memoryMapped,
+                                                             nodes);
+    errors+=CheckDataFile<osmscout::Way,osmscout::WayView>(*typeConfig,
+                                                           osmscout::AppendFileToDir(argv[1],osmscout::WayDataFile::WAYS_DAT),
+                                                           memoryMapped,
+                                                           ways);
+    errors+=CheckDataFile<osmscout::Area,osmscout::AreaView>(*typeConfig,
+                                                             osmscout::AppendFileToDir(argv[1],osmscout::AreaDataFile::AREAS_DAT),
+                                                             memoryMapped,
+                                                             areas);
+
+    if (memoryMapped) {
+      errors+=CheckVisitByOffset(typeConfig,
+                                 argv[1],
+                                 ways);
+    }
+  }
+
+  if (errors>0) {
+    std::cerr << errors << " error(s)" << std::endl;
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
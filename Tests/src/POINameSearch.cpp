@@ -0,0 +1,483 @@
+/*
+  POINameSearch - a test program for libosmscout
+  Copyright (C) 2016  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <osmscout/POINameIndex.h>
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/Geometry.h>
+#include <osmscout/util/Number.h>
+
+#include <osmscout/system/Math.h>
+
+/*
+ * Writes a POI name index for generated POIs on both sides of the antimeridian
+ * and compares the results of POINameIndex::GetClosestEntries() with a brute
+ * force scan over all POIs.
+ */
+
+static const size_t   POI_COUNT=5000;
+static const size_t   QUERY_COUNT=300;
+static const uint32_t INDEX_LEVEL=14;        //!< Finest cell level, as used by the import
+static const size_t   MAX_CELLS=1 << 22;     //!< Maximum number of cells, as used by the import
+static const double   MIN_LAT=-18.0;
+static const double   MAX_LAT=-16.0;
+static const double   LON_EXTENT=1.0;        //!< POIs are at most this far from the antimeridian
+
+struct POI
+{
+  std::string             name;
+  osmscout::TypeInfoRef   type;
+  osmscout::ObjectFileRef object;
+  osmscout::GeoCoord      coord;
+  size_t                  cell;
+};
+
+/**
+ * Return the coordinate as stored in the index
+ */
+static osmscout::GeoCoord GetStoredCoord(const osmscout::GeoCoord& coord)
+{
+  unsigned char      buffer[osmscout::coordByteSize];
+  osmscout::GeoCoord storedCoord;
+
+  coord.EncodeToBuffer(buffer);
+  storedCoord.DecodeFromBuffer(buffer);
+
+  return storedCoord;
+}
+
+/**
+ * Write the index in the format of the POI name index generator of the import
+ */
+static bool WriteIndex(const std::string& filename,
+                       std::vector<POI>& pois)
+{
+  osmscout::GeoBox boundingBox(pois.front().coord,
+                               pois.front().coord);
+  uint32_t         level=INDEX_LEVEL;
+  uint32_t         cellXStart;
+  uint32_t         cellXEnd;
+  uint32_t         cellYStart;
+  uint32_t         cellYEnd;
+  size_t           cellXCount;
+  size_t           cellCount;
+
+  for (const auto& poi : pois) {
+    boundingBox.Include(osmscout::GeoBox(poi.coord,
+                                         poi.coord));
+  }
+
+  while (true) {
+    double cellWidth=360.0/pow(2.0,level);
+    double cellHeight=180.0/pow(2.0,level);
+
+    cellXStart=(uint32_t)floor((boundingBox.GetMinLon()+180.0)/cellWidth);
+    cellXEnd=(uint32_t)floor((boundingBox.GetMaxLon()+180.0)/cellWidth);
+    cellYStart=(uint32_t)floor((boundingBox.GetMinLat()+90.0)/cellHeight);
+    cellYEnd=(uint32_t)floor((boundingBox.GetMaxLat()+90.0)/cellHeight);
+    cellXCount=cellXEnd-cellXStart+1;
+    cellCount=cellXCount*(cellYEnd-cellYStart+1);
+
+    if (cellCount<=MAX_CELLS) {
+      for (auto& poi : pois) {
+        uint32_t x=(uint32_t)floor((poi.coord.GetLon()+180.0)/cellWidth);
+        uint32_t y=(uint32_t)floor((poi.coord.GetLat()+90.0)/cellHeight);
+
+        poi.cell=(y-cellYStart)*cellXCount+x-cellXStart;
+      }
+
+      break;
+    }
+
+    level--;
+  }
+
+  std::stable_sort(pois.begin(),
+                   pois.end(),
+                   [](const POI& a, const POI& b) {
+                     return a.cell<b.cell;
+                   });
+
+  std::vector<osmscout::FileOffset> cellOffsets(cellCount,0);
+  osmscout::FileWriter              writer;
+
+  try {
+    writer.Open(filename);
+
+    writer.WriteFileOffset(0);
+    writer.Write((uint8_t)0);
+
+    writer.WriteNumber(level);
+    writer.WriteNumber(cellXStart);
+    writer.WriteNumber(cellXEnd);
+    writer.WriteNumber(cellYStart);
+    writer.WriteNumber(cellYEnd);
+
+    for (size_t start=0; start<pois.size();) {
+      size_t end=start;
+
+      while (end<pois.size() &&
+             pois[end].cell==pois[start].cell) {
+        end++;
+      }
+
+      cellOffsets[pois[start].cell]=writer.GetPos();
+
+      writer.WriteNumber((uint32_t)(end-start));
+
+      for (size_t p=start; p<end; p++) {
+        writer.Write(pois[p].name);
+        writer.WriteNumber((uint32_t)pois[p].type->GetIndex());
+        writer.Write((uint8_t)pois[p].object.GetType());
+        writer.WriteNumber(pois[p].object.GetFileOffset());
+        writer.WriteCoord(pois[p].coord);
+      }
+
+      start=end;
+    }
+
+    osmscout::FileOffset tableOffset=writer.GetPos();
+    uint8_t              entryOffsetBytes=osmscout::BytesNeededToEncodeNumber(tableOffset);
+
+    for (const auto& offset : cellOffsets) {
+      writer.WriteFileOffset(offset,
+                             entryOffsetBytes);
+    }
+
+    writer.SetPos(0);
+    writer.WriteFileOffset(tableOffset);
+    writer.Write(entryOffsetBytes);
+
+    writer.Close();
+  }
+  catch (osmscout::IOException& e) {
+    std::cerr << e.GetDescription() << std::endl;
+    writer.CloseFailsafe();
+    return false;
+  }
+
+  std::cout << pois.size() << " POI(s) in " << cellCount << " cell(s) of level " << level << " written" << std::endl;
+
+  return true;
+}
+
+/**
+ * Convert the ASCII letters and the upper case umlauts used by CreateName() to lower case
+ */
+static std::string ToLower(const std::string& text)
+{
+  static const char* const umlauts[][2]={{"\xC3\x84","\xC3\xA4"},  // Ä
+                                         {"\xC3\x96","\xC3\xB6"},  // Ö
+                                         {"\xC3\x9C","\xC3\xBC"}}; // Ü
+  std::string lower(text);
+
+  std::transform(lower.begin(),lower.end(),lower.begin(),::tolower);
+
+  for (const auto& umlaut : umlauts) {
+    size_t pos;
+
+    while ((pos=lower.find(umlaut[0]))!=std::string::npos) {
+      lower.replace(pos,2,umlaut[1]);
+    }
+  }
+
+  return lower;
+}
+
+/**
+ * Returns true, if the pattern is a prefix of the name or of one of its words,
+ * ignoring the case of ASCII characters and umlauts
+ */
+static bool Matches(const std::string& name,
+                    const std::string& pattern)
+{
+  std::string lowerName=ToLower(name);
+  std::string lowerPattern=ToLower(pattern);
+
+  for (size_t start=0; start<lowerName.length() || start==0; start++) {
+    unsigned char previous=start>0 ? (unsigned char)lowerName[start-1] : 0;
+
+    // Only ASCII characters other than letters and digits separate words
+    if ((start==0 || (previous<0x80 && !isalnum(previous))) &&
+        lowerName.compare(start,lowerPattern.length(),lowerPattern)==0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * Return the POIs matching the given criteria sorted by distance, as returned by
+ * the index
+ */
+static std::vector<osmscout::POINameIndex::Entry> GetExpectedEntries(const std::vector<POI>& pois,
+                                                                     const osmscout::GeoCoord& center,
+                                                                     const osmscout::GeoBox* boundingBox,
+                                                                     double maxDistance,
+                                                                     const std::string& pattern,
+                                                                     const osmscout::TypeInfoSet& types,
+                                                                     size_t limit)
+{
+  std::vector<osmscout::POINameIndex::Entry> entries;
+
+  for (const auto& poi : pois) {
+    if ((!types.Empty() && !types.IsSet(poi.type)) ||
+        (boundingBox!=NULL && !boundingBox->Includes(poi.coord)) ||
+        !Matches(poi.name,pattern)) {
+      continue;
+    }
+
+    osmscout::POINameIndex::Entry entry;
+
+    entry.object=poi.object;
+    entry.type=poi.type;
+    entry.name=poi.name;
+    entry.coord=poi.coord;
+    entry.distance=osmscout::GetEllipsoidalDistance(center,
+                                                    poi.coord);
+
+    if (entry.distance<=maxDistance) {
+      entries.push_back(entry);
+    }
+  }
+
+  std::sort(entries.begin(),
+            entries.end(),
+            [](const osmscout::POINameIndex::Entry& a, const osmscout::POINameIndex::Entry& b) {
+              if (a.distance!=b.distance) {
+                return a.distance<b.distance;
+              }
+
+              return a.object<b.object;
+            });
+
+  if (limit>0 &&
+      entries.size()>limit) {
+    entries.resize(limit);
+  }
+
+  return entries;
+}
+
+static bool Compare(const std::string& query,
+                    const std::vector<osmscout::POINameIndex::Entry>& expected,
+                    const std::vector<osmscout::POINameIndex::Entry>& actual)
+{
+  bool equal=expected.size()==actual.size();
+
+  for (size_t i=0; equal && i<expected.size(); i++) {
+    equal=expected[i].object==actual[i].object &&
+          expected[i].type==actual[i].type &&
+          expected[i].name==actual[i].name &&
+          expected[i].distance==actual[i].distance;
+  }
+
+  if (!equal) {
+    std::cerr << query << ": " << actual.size() << " POI(s) returned, " << expected.size() << " expected";
+
+    if (!actual.empty() &&
+        !expected.empty()) {
+      std::cerr << ", first " << actual.front().name << " (" << actual.front().distance << " km) vs. ";
+      std::cerr << expected.front().name << " (" << expected.front().distance << " km)";
+    }
+
+    std::cerr << std::endl;
+  }
+
+  return equal;
+}
+
+static std::string CreateName(std::mt19937& generator)
+{
+  static const char* const words[]={"Cafe","Bar","Bank","Bakery","Museum","Market","Hotel","Hostel",
+                                    "Central","Coral","Reef","Bay","Beach","Palm","Sunset","Island",
+                                    "\xC3\x9C""bersee","B\xC3\xA4""ckerei","\xC3\x96""l"}; // Übersee, Bäckerei, Öl
+  std::string name;
+  size_t      wordCount=1+generator()%3;
+
+  for (size_t i=0; i<wordCount; i++) {
+    if (i>0) {
+      name.append(generator()%4==0 ? "-" : " ");
+    }
+
+    name.append(words[generator()%(sizeof(words)/sizeof(words[0]))]);
+  }
+
+  return name;
+}
+
+/**
+ * Return a random longitude at most the given extent away from the antimeridian
+ */
+static double CreateLon(std::mt19937& generator,
+                        double extent)
+{
+  double offset=std::uniform_real_distribution<double>(-extent,extent)(generator);
+
+  return offset<0.0 ? 180.0+offset : -180.0+offset;
+}
+
+int main(int /*argc*/, char* /*argv*/[])
+{
+  osmscout::TypeConfigRef            typeConfig=std::make_shared<osmscout::TypeConfig>();
+  std::vector<osmscout::TypeInfoRef> poiTypes;
+  std::mt19937                       generator(4711);
+  std::vector<POI>                   pois;
+  size_t                             errors=0;
+
+  for (const char* name : {"amenity_cafe","amenity_bank","tourism_hotel"}) {
+    osmscout::TypeInfoRef type=std::make_shared<osmscout::TypeInfo>();
+
+    type->SetType(name)
+         .CanBeNode(true)
+         .CanBeArea(true);
+
+    poiTypes.push_back(typeConfig->RegisterType(type));
+  }
+
+  std::uniform_real_distribution<double> latDistribution(MIN_LAT,MAX_LAT);
+
+  for (size_t i=0; i<POI_COUNT; i++) {
+    POI poi;
+
+    poi.name=i%50==0 ? "" : CreateName(generator);
+    poi.type=poiTypes[generator()%poiTypes.size()];
+    poi.object.Set(1000+i*10,
+                   i%2==0 ? osmscout::refNode : osmscout::refArea);
+    poi.coord=GetStoredCoord(osmscout::GeoCoord(latDistribution(generator),
+                                                CreateLon(generator,LON_EXTENT)));
+
+    pois.push_back(poi);
+  }
+
+  if (!WriteIndex(osmscout::POINameIndex::FILENAME_POI_NAME_IDX,
+                  pois)) {
+    return 1;
+  }
+
+  osmscout::POINameIndex index;
+
+  if (!index.Open(typeConfig,".")) {
+    std::cerr << "Cannot open POI name index" << std::endl;
+    return 1;
+  }
+
+  size_t crossingCount=0;
+
+  for (size_t q=0; q<QUERY_COUNT; q++) {
+    static const double distances[]={0.5,2.0,10.0,50.0,500.0};
+    static const size_t limits[]={0,1,10};
+
+    // Every third query is centered within 0.05 degree of the antimeridian
+    osmscout::GeoCoord    center(latDistribution(generator),
+                                 CreateLon(generator,q%3==0 ? 0.05 : LON_EXTENT));
+    double                maxDistance=distances[q%(sizeof(distances)/sizeof(distances[0]))];
+    size_t                limit=limits[q%(sizeof(limits)/sizeof(limits[0]))];
+    std::string           pattern;
+    osmscout::TypeInfoSet types(*typeConfig);
+
+    if (q%4!=0) {
+      std::string name=CreateName(generator);
+
+      pattern=name.substr(0,1+generator()%4);
+
+      if (q%5==0) {
+        std::transform(pattern.begin(),pattern.end(),pattern.begin(),::toupper);
+      }
+    }
+
+    if (q%7==0) {
+      // Lower case prefix of a word starting with an upper case umlaut
+      std::string word=q%2==0 ? "\xC3\x9C""bersee" : "\xC3\x96""l";
+
+      pattern=ToLower(word.substr(0,2+generator()%(word.length()-1)));
+    }
+
+    if (q%3==1) {
+      types.Set(poiTypes[generator()%poiTypes.size()]);
+    }
+
+    std::string queryName="Query "+std::to_string(q)+" at "+center.GetDisplayText()+" '"+pattern+"'";
+
+    // Search around a center, the search circle may cross the antimeridian
+    std::vector<osmscout::POINameIndex::Entry> expected=GetExpectedEntries(pois,center,NULL,maxDistance,pattern,types,limit);
+    std::vector<osmscout::POINameIndex::Entry> actual;
+
+    if (!index.GetClosestEntries(center,maxDistance,pattern,types,limit,actual)) {
+      std::cerr << queryName << ": Search failed" << std::endl;
+      return 1;
+    }
+
+    if (!Compare(queryName,expected,actual)) {
+      errors++;
+    }
+
+    for (const auto& entry : actual) {
+      if ((entry.coord.GetLon()<0.0)!=(center.GetLon()<0.0)) {
+        crossingCount++;
+      }
+    }
+
+    // Search within a bounding box on one side of the antimeridian
+    double           boxSize=maxDistance/200.0;
+    osmscout::GeoBox boundingBox(osmscout::GeoCoord(center.GetLat()-boxSize,std::max(center.GetLon()-boxSize,-180.0)),
+                                 osmscout::GeoCoord(center.GetLat()+boxSize,std::min(center.GetLon()+boxSize,180.0)));
+
+    expected=GetExpectedEntries(pois,boundingBox.GetCenter(),&boundingBox,std::numeric_limits<double>::max(),pattern,types,limit);
+
+    if (!index.GetClosestEntries(boundingBox.GetCenter(),boundingBox,std::numeric_limits<double>::max(),pattern,types,limit,actual)) {
+      std::cerr << queryName << ": Search in bounding box failed" << std::endl;
+      return 1;
+    }
+
+    if (!Compare(queryName+" in "+boundingBox.GetDisplayText(),expected,actual)) {
+      errors++;
+    }
+  }
+
+  index.Close();
+
+  osmscout::RemoveFile(osmscout::POINameIndex::FILENAME_POI_NAME_IDX);
+
+  std::cout << QUERY_COUNT << " queries compared, " << crossingCount << " result(s) across the antimeridian" << std::endl;
+
+  if (crossingCount==0) {
+    std::cerr << "No results across the antimeridian" << std::endl;
+    errors++;
+  }
+
+  if (errors>0) {
+    std::cerr << errors << " error(s)" << std::endl;
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
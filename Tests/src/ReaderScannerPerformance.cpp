@@ -17,30 +17,73 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <random>
+#include <string>
 
 #include <osmscout/Way.h>
+#include <osmscout/WayDataFile.h>
 
 #include <osmscout/util/FileScanner.h>
 #include <osmscout/util/StopClock.h>
 
 /**
-  Sequentially read the ways.dat file in the current directory first using
-  FileReader and then using FileScanner and compare execution time.
+  Sequentially read the ways.dat file in the current directory using FileScanner.
+
+  Then read a random subset of the ways by offset, first one by one in random order
+  and then via DataFile::GetByOffset(), which sorts and coalesces the offsets, and
+  compare the number of read system calls and execution time for different
+  coalesce gaps.
 
   Call this program repeately to avoid different timing because of OS file caching.
 */
 
-int main(int argc, char* argv[])
+static const size_t sampleRatio=10;
+
+/**
+ * Return the number of read system calls of the process so far as reported by
+ * the operating system or -1, if this information is not available
+ */
+static long GetReadCalls()
+{
+  std::ifstream io("/proc/self/io");
+  std::string   key;
+  long          value;
+
+  while (io >> key >> value) {
+    if (key=="syscr:") {
+      return value;
+    }
+  }
+
+  return -1;
+}
+
+static std::string GetReadCallsDifference(long start)
+{
+  long end=GetReadCalls();
+
+  if (start<0 ||
+      end<0) {
+    return "unknown number of";
+  }
+
+  return std::to_string(end-start);
+}
+
+int main(int /*argc*/, char* /*argv*/[])
 {
-  std::string           wayFilename="ways.dat";
+  std::string                       wayFilename="ways.dat";
 
-  osmscout::StopClock   scannerTimer;
+  osmscout::StopClock               scannerTimer;
 
-  osmscout::TypeConfig  typeConfig;
-  osmscout::FileScanner scanner;
+  osmscout::TypeConfigRef           typeConfig=std::make_shared<osmscout::TypeConfig>();
+  osmscout::FileScanner             scanner;
+  std::vector<osmscout::FileOffset> offsets;
 
-  if (!typeConfig.LoadFromDataFile(".")) {
+  if (!typeConfig->LoadFromDataFile(".")) {
     std::cerr << "Cannot open type configuration!" << std::endl;
     return 1;
   }
@@ -57,8 +100,10 @@ int main(int argc, char* argv[])
     for (size_t w=1; w<=wayCount; w++) {
       osmscout::Way way;
 
-      way.Read(typeConfig,
+      way.Read(*typeConfig,
                scanner);
+
+      offsets.push_back(way.GetFileOffset());
     }
 
     scanner.Close();
@@ -72,5 +117,97 @@ int main(int argc, char* argv[])
     return 1;
   }
 
+  if (offsets.empty()) {
+    return 0;
+  }
+
+  std::vector<osmscout::FileOffset> sample;
+  std::mt19937                      generator(0);
+
+  for (const auto& offset : offsets) {
+    if (generator()%sampleRatio==0) {
+      sample.push_back(offset);
+    }
+  }
+
+  std::shuffle(sample.begin(),sample.end(),generator);
+
+  std::cout << "Reading " << sample.size() << " random ways by offset..." << std::endl;
+
+  try {
+    scanner.Open(wayFilename,osmscout::FileScanner::LowMemRandom,false);
+
+    osmscout::StopClock singleTimer;
+    long                readCalls=GetReadCalls();
+
+    for (const auto& offset : sample) {
+      osmscout::Way way;
+
+      scanner.SetPos(offset);
+
+      way.Read(*typeConfig,
+               scanner);
+    }
+
+    singleTimer.Stop();
+
+    std::string reads=GetReadCallsDifference(readCalls);
+
+    scanner.Close();
+
+    std::cout << "Reading one by one: " << reads << " reads, took " << singleTimer << std::endl;
+  }
+  catch (osmscout::IOException& e) {
+    std::cerr << e.GetDescription() << std::endl;
+    return 1;
+  }
+
+  std::vector<osmscout::FileOffset> coalesceGaps={0,4096,65536};
+
+  for (const auto& coalesceGap : coalesceGaps) {
+    osmscout::WayDataFile         wayDataFile;
+    std::vector<osmscout::WayRef> ways;
+
+    wayDataFile.SetCoalesceGap(coalesceGap);
+
+    if (!wayDataFile.Open(typeConfig,
+                          ".",
+                          osmscout::FileScanner::LowMemRandom,
+                          false)) {
+      std::cerr << "Cannot open '" << wayFilename << "'!" << std::endl;
+      return 1;
+    }
+
+    osmscout::StopClock batchTimer;
+    long                readCalls=GetReadCalls();
+
+    if (!wayDataFile.GetByOffset(sample,
+                                 ways)) {
+      std::cerr << "Cannot read ways by offset!" << std::endl;
+      return 1;
+    }
+
+    batchTimer.Stop();
+
+    std::string reads=GetReadCallsDifference(readCalls);
+
+    wayDataFile.Close();
+
+    if (ways.size()!=sample.size()) {
+      std::cerr << "Read " << ways.size() << " ways instead of " << sample.size() << "!" << std::endl;
+      return 1;
+    }
+
+    for (size_t i=0; i<ways.size(); i++) {
+      if (ways[i]->GetFileOffset()!=sample[i]) {
+        std::cerr << "Way " << i << " has offset " << ways[i]->GetFileOffset() << " instead of " << sample[i] << "!" << std::endl;
+        return 1;
+      }
+    }
+
+    std::cout << "Reading coalesced (gap " << coalesceGap << "): ";
+    std::cout << reads << " reads, took " << batchTimer << std::endl;
+  }
+
   return 0;
 }
@@ -0,0 +1,655 @@
+/*
+  ReverseLookup - a test program for libosmscout
+  Copyright (C) 2016  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <iostream>
+#include <limits>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <osmscout/Database.h>
+#include <osmscout/LocationService.h>
+
+#include <osmscout/util/Geometry.h>
+#include <osmscout/util/String.h>
+
+/*
+ * Compares the reverse lookup of all nodes, ways and areas of the given database
+ * using the region lookup index (locationregion.idx) with the reverse lookup
+ * testing the areas of the admin regions, each with the admin regions loaded
+ * into memory and read from disk.
+ *
+ * For the admin regions loaded into memory and read from disk the traversal of
+ * the region tree, the resolving of the parent regions, the locations of each
+ * region and the location search for the names of all regions and locations
+ * are compared, too.
+ *
+ * Additionally the regions returned by the region lookup index for single
+ * coordinates are compared with the regions, whose outer rings contain the
+ * coordinate (nodes of the boundary count as inside) and whose parent regions
+ * contain it, too. Coordinates are a grid over the database, all nodes of the
+ * region areas (including the nodes of holes), coordinates east and west of
+ * each node on the same latitude and the center of all holes.
+ */
+
+static const size_t GRID_SIZE=200;      //!< Number of grid coordinates in each direction
+static const double NODE_OFFSET=0.00001; //!< Offset in degree of the coordinates east and west of boundary nodes
+static const size_t MAX_LOCATION_NAMES=5; //!< Maximum number of location names searched for in each region
+
+class RegionCollector : public osmscout::AdminRegionVisitor
+{
+public:
+  std::vector<osmscout::AdminRegion> regions;
+
+  Action Visit(const osmscout::AdminRegion& region)
+  {
+    regions.push_back(region);
+
+    return visitChildren;
+  }
+};
+
+/**
+ * Collects a key for each visited region, skipping the children of every
+ * second region, if requested
+ */
+class RegionKeyCollector : public osmscout::AdminRegionVisitor
+{
+private:
+  bool skip;
+
+public:
+  std::vector<std::string> keys;
+
+public:
+  explicit RegionKeyCollector(bool skip)
+  : skip(skip)
+  {
+    // no code
+  }
+
+  Action Visit(const osmscout::AdminRegion& region)
+  {
+    std::string key=osmscout::NumberToString(region.regionOffset)+" "+
+                    osmscout::NumberToString(region.dataOffset)+" "+
+                    osmscout::NumberToString(region.parentRegionOffset)+" "+
+                    region.name+" "+
+                    region.object.GetName()+" "+
+                    region.aliasName;
+
+    for (const auto& alias : region.aliases) {
+      key+=" "+alias.name+" "+osmscout::NumberToString(alias.objectOffset);
+    }
+
+    keys.push_back(key);
+
+    if (skip &&
+        keys.size()%2==0) {
+      return skipChildren;
+    }
+
+    return visitChildren;
+  }
+};
+
+class LocationCollector : public osmscout::LocationVisitor
+{
+public:
+  std::set<std::string> names;
+  std::set<std::string> keys;
+
+  bool Visit(const osmscout::AdminRegion& adminRegion,
+             const osmscout::POI& poi)
+  {
+    keys.insert("P "+osmscout::NumberToString(adminRegion.regionOffset)+" "+poi.object.GetName()+" "+poi.name);
+
+    return true;
+  }
+
+  bool Visit(const osmscout::AdminRegion& adminRegion,
+             const osmscout::Location& location)
+  {
+    names.insert(location.name);
+    keys.insert("L "+osmscout::NumberToString(adminRegion.regionOffset)+" "+osmscout::NumberToString(location.locationOffset)+" "+location.name);
+
+    return true;
+  }
+};
+
+/**
+ * A database opened with one combination of the location index options
+ */
+struct DatabaseVariant
+{
+  std::string                  name;
+  osmscout::DatabaseRef        database;
+  osmscout::LocationIndexRef   locationIndex;
+  osmscout::LocationServiceRef locationService;
+};
+
+/**
+ * An admin region together with the rings of its area
+ */
+struct RegionGeometry
+{
+  osmscout::AdminRegion                         region;
+  size_t                                        parentIndex; //!< Index of the parent region, or the maximum value
+  std::vector<std::vector<osmscout::GeoCoord> > outerRings;
+  std::vector<std::vector<osmscout::GeoCoord> > innerRings;
+};
+
+static bool OpenDatabase(const std::string& directory,
+                         bool regionLookup,
+                         bool regionsInMemory,
+                         DatabaseVariant& variant)
+{
+  osmscout::DatabaseParameter databaseParameter;
+
+  databaseParameter.SetLocationIndexRegionLookup(regionLookup);
+  databaseParameter.SetLocationIndexRegionsInMemory(regionsInMemory);
+
+  variant.name=std::string(regionLookup ? "region lookup index" : "region areas")+
+               (regionsInMemory ? ", regions in memory" : ", regions on disk");
+  variant.database=std::make_shared<osmscout::Database>(databaseParameter);
+
+  if (!variant.database->Open(directory)) {
+    std::cerr << "Cannot open database" << std::endl;
+    return false;
+  }
+
+  variant.locationIndex=variant.database->GetLocationIndex();
+
+  if (!variant.locationIndex) {
+    std::cerr << "Cannot load location index" << std::endl;
+    return false;
+  }
+
+  if (variant.locationIndex->HasRegionLookupIndex()!=regionLookup) {
+    std::cerr << "Region lookup index is " << (regionLookup ? "not available" : "used although disabled") << std::endl;
+    return false;
+  }
+
+  if (variant.locationIndex->HasRegionsInMemory()!=regionsInMemory) {
+    std::cerr << "Regions are " << (regionsInMemory ? "not loaded into memory" : "loaded into memory although disabled") << std::endl;
+    return false;
+  }
+
+  variant.locationService=std::make_shared<osmscout::LocationService>(variant.database);
+
+  return true;
+}
+
+/**
+ * Load all admin regions in the order of the region tree together with their
+ * areas
+ */
+static bool GetRegionGeometries(const osmscout::Database& database,
+                                std::vector<RegionGeometry>& geometries)
+{
+  RegionCollector                       collector;
+  std::map<osmscout::FileOffset,size_t> regionIndexes;
+
+  if (!database.GetLocationIndex()->VisitAdminRegions(collector)) {
+    std::cerr << "Cannot visit admin regions" << std::endl;
+    return false;
+  }
+
+  for (const auto& region : collector.regions) {
+    RegionGeometry    geometry;
+    osmscout::AreaRef area;
+
+    if (region.object.GetType()!=osmscout::refArea ||
+        !database.GetAreaByOffset(region.object.GetFileOffset(),
+                                  area)) {
+      std::cerr << "Cannot load area of region '" << region.name << "'" << std::endl;
+      return false;
+    }
+
+    auto parent=regionIndexes.find(region.parentRegionOffset);
+
+    geometry.region=region;
+    geometry.parentIndex=parent!=regionIndexes.end() ? parent->second : std::numeric_limits<size_t>::max();
+
+    for (const auto& ring : area->rings) {
+      if (ring.ring==osmscout::Area::outerRingId) {
+        geometry.outerRings.push_back(ring.nodes);
+      }
+      else if (ring.ring!=osmscout::Area::masterRingId) {
+        geometry.innerRings.push_back(ring.nodes);
+      }
+    }
+
+    regionIndexes[region.regionOffset]=geometries.size();
+    geometries.push_back(geometry);
+  }
+
+  return true;
+}
+
+/**
+ * Return the offsets of all regions, whose outer rings contain the given coordinate and
+ * whose parent regions contain it, too. Holes are not taken into account, as for the
+ * traversal of the region tree during reverse lookup.
+ */
+static std::set<osmscout::FileOffset> GetExpectedRegionOffsets(const std::vector<RegionGeometry>& geometries,
+                                                               const osmscout::GeoCoord& coord)
+{
+  std::set<osmscout::FileOffset> regionOffsets;
+  std::vector<bool>              contained(geometries.size(),false);
+
+  // Parents are visited before their children
+  for (size_t r=0; r<geometries.size(); r++) {
+    const RegionGeometry& geometry=geometries[r];
+
+    if (geometry.parentIndex!=std::numeric_limits<size_t>::max() &&
+        !contained[geometry.parentIndex]) {
+      continue;
+    }
+
+    for (const auto& ring : geometry.outerRings) {
+      if (osmscout::GetRelationOfPointToArea(coord,
+                                             ring)>=0) {
+        contained[r]=true;
+        regionOffsets.insert(geometry.region.regionOffset);
+        break;
+      }
+    }
+  }
+
+  return regionOffsets;
+}
+
+static std::vector<osmscout::GeoCoord> GetTestCoords(const osmscout::GeoBox& boundingBox,
+                                                     const std::vector<RegionGeometry>& geometries)
+{
+  std::vector<osmscout::GeoCoord> coords;
+
+  for (size_t y=0; y<=GRID_SIZE; y++) {
+    for (size_t x=0; x<=GRID_SIZE; x++) {
+      coords.push_back(osmscout::GeoCoord(boundingBox.GetMinLat()+boundingBox.GetHeight()*y/GRID_SIZE,
+                                          boundingBox.GetMinLon()+boundingBox.GetWidth()*x/GRID_SIZE));
+    }
+  }
+
+  for (const auto& geometry : geometries) {
+    for (const auto* rings : {&geometry.outerRings,&geometry.innerRings}) {
+      for (const auto& ring : *rings) {
+        for (const auto& node : ring) {
+          coords.push_back(node);
+          coords.push_back(osmscout::GeoCoord(node.GetLat(),
+                                              node.GetLon()-NODE_OFFSET));
+          coords.push_back(osmscout::GeoCoord(node.GetLat(),
+                                              node.GetLon()+NODE_OFFSET));
+        }
+      }
+    }
+
+    for (const auto& ring : geometry.innerRings) {
+      double lat=0.0;
+      double lon=0.0;
+
+      for (const auto& node : ring) {
+        lat+=node.GetLat();
+        lon+=node.GetLon();
+      }
+
+      if (!ring.empty()) {
+        coords.push_back(osmscout::GeoCoord(lat/ring.size(),
+                                            lon/ring.size()));
+      }
+    }
+  }
+
+  return coords;
+}
+
+/**
+ * Return all nodes, ways and areas of the database
+ */
+static bool GetObjects(const osmscout::Database& database,
+                       std::vector<osmscout::ObjectFileRef>& objects)
+{
+  osmscout::TypeConfigRef              typeConfig=database.GetTypeConfig();
+  osmscout::GeoBox                     boundingBox;
+  std::vector<osmscout::FileOffset>    offsets;
+  std::vector<osmscout::DataBlockSpan> spans;
+  std::vector<osmscout::AreaRef>       areas;
+  osmscout::TypeInfoSet                loadedTypes;
+
+  if (!database.GetBoundingBox(boundingBox) ||
+      !database.GetAreaNodeIndex()->GetOffsets(boundingBox,
+                                               osmscout::TypeInfoSet(typeConfig->GetNodeTypes()),
+                                               offsets,
+                                               loadedTypes)) {
+    return false;
+  }
+
+  for (const auto& offset : offsets) {
+    objects.push_back(osmscout::ObjectFileRef(offset,
+                                              osmscout::refNode));
+  }
+
+  offsets.clear();
+
+  if (!database.GetAreaWayIndex()->GetOffsets(boundingBox,
+                                              osmscout::TypeInfoSet(typeConfig->GetWayTypes()),
+                                              offsets,
+                                              loadedTypes)) {
+    return false;
+  }
+
+  for (const auto& offset : offsets) {
+    objects.push_back(osmscout::ObjectFileRef(offset,
+                                              osmscout::refWay));
+  }
+
+  if (!database.GetAreaAreaIndex()->GetAreasInArea(*typeConfig,
+                                                   boundingBox,
+                                                   std::numeric_limits<size_t>::max(),
+                                                   osmscout::TypeInfoSet(typeConfig->GetAreaTypes()),
+                                                   spans,
+                                                   loadedTypes) ||
+      !database.GetAreasByBlockSpans(spans,
+                                     areas)) {
+    return false;
+  }
+
+  for (const auto& area : areas) {
+    objects.push_back(osmscout::ObjectFileRef(area->GetFileOffset(),
+                                              osmscout::refArea));
+  }
+
+  return true;
+}
+
+static std::set<std::string> GetHierachieKeys(const osmscout::LocationIndex& locationIndex,
+                                              const osmscout::AdminRegion& region)
+{
+  std::map<osmscout::FileOffset,osmscout::AdminRegionRef> refs;
+  std::set<std::string>                                   keys;
+
+  if (!locationIndex.ResolveAdminRegionHierachie(std::make_shared<osmscout::AdminRegion>(region),
+                                                 refs)) {
+    keys.insert("error");
+  }
+
+  for (const auto& ref : refs) {
+    keys.insert(osmscout::NumberToString(ref.first)+" "+ref.second->name);
+  }
+
+  return keys;
+}
+
+static std::set<std::string> GetSearchKeys(const osmscout::LocationService& locationService,
+                                           const std::string& regionPattern,
+                                           const std::string& locationPattern)
+{
+  osmscout::LocationSearch        search;
+  osmscout::LocationSearch::Entry entry;
+  osmscout::LocationSearchResult  result;
+  std::set<std::string>           keys;
+
+  entry.adminRegionPattern=regionPattern;
+  entry.locationPattern=locationPattern;
+
+  search.searches.push_back(entry);
+  search.limit=100000;
+
+  if (!locationService.SearchForLocations(search,
+                                          result)) {
+    keys.insert("error");
+  }
+
+  for (const auto& resultEntry : result.results) {
+    std::string key;
+
+    key+=resultEntry.adminRegion ? osmscout::NumberToString(resultEntry.adminRegion->regionOffset) : std::string("-");
+    key+=" "+(resultEntry.location ? osmscout::NumberToString(resultEntry.location->locationOffset) : std::string("-"));
+    key+=" "+(resultEntry.poi ? resultEntry.poi->object.GetName() : std::string("-"));
+    key+=" "+(resultEntry.address ? osmscout::NumberToString(resultEntry.address->addressOffset) : std::string("-"));
+
+    keys.insert(key);
+  }
+
+  return keys;
+}
+
+/**
+ * Compare the region tree, the region hierachies, the locations of the regions and
+ * the location search of the given variant with the reference
+ */
+static size_t CompareRegions(const DatabaseVariant& reference,
+                             const DatabaseVariant& variant,
+                             const std::vector<RegionGeometry>& geometries)
+{
+  size_t errors=0;
+
+  for (bool skip : {false,true}) {
+    RegionKeyCollector expected(skip);
+    RegionKeyCollector actual(skip);
+
+    if (!reference.locationIndex->VisitAdminRegions(expected) ||
+        !variant.locationIndex->VisitAdminRegions(actual)) {
+      std::cerr << "Cannot visit admin regions" << std::endl;
+      return errors+1;
+    }
+
+    if (actual.keys!=expected.keys) {
+      std::cerr << variant.name << ": " << actual.keys.size() << " region(s) visited instead of " << expected.keys.size() << (skip ? " skipping children" : "") << std::endl;
+      errors++;
+    }
+  }
+
+  for (const auto& geometry : geometries) {
+    const osmscout::AdminRegion& region=geometry.region;
+
+    if (GetHierachieKeys(*variant.locationIndex,region)!=GetHierachieKeys(*reference.locationIndex,region)) {
+      std::cerr << variant.name << ": Hierachie of region '" << region.name << "' differs" << std::endl;
+      errors++;
+    }
+
+    for (bool recursive : {false,true}) {
+      LocationCollector expected;
+      LocationCollector actual;
+
+      if (!reference.locationIndex->VisitAdminRegionLocations(region,
+                                                              expected,
+                                                              recursive) ||
+          !variant.locationIndex->VisitAdminRegionLocations(region,
+                                                            actual,
+                                                            recursive)) {
+        std::cerr << "Cannot visit locations of region '" << region.name << "'" << std::endl;
+        return errors+1;
+      }
+
+      if (actual.keys!=expected.keys) {
+        std::cerr << variant.name << ": " << actual.keys.size() << " location(s) in region '" << region.name << "' instead of " << expected.keys.size() << (recursive ? " (recursive)" : "") << std::endl;
+        errors++;
+      }
+
+      if (!recursive) {
+        continue;
+      }
+
+      std::vector<std::string> locationPatterns(1,"");
+
+      for (const auto& name : expected.names) {
+        if (locationPatterns.size()>MAX_LOCATION_NAMES) {
+          break;
+        }
+
+        locationPatterns.push_back(name);
+      }
+
+      for (const auto& locationPattern : locationPatterns) {
+        if (GetSearchKeys(*variant.locationService,region.name,locationPattern)!=
+            GetSearchKeys(*reference.locationService,region.name,locationPattern)) {
+          std::cerr << variant.name << ": Search for '" << locationPattern << "' in '" << region.name << "' differs" << std::endl;
+          errors++;
+        }
+      }
+    }
+  }
+
+  return errors;
+}
+
+static std::set<std::string> GetResultKeys(const std::list<osmscout::LocationService::ReverseLookupResult>& results)
+{
+  std::set<std::string> keys;
+
+  for (const auto& result : results) {
+    std::string key=result.object.GetName();
+
+    key+=" "+(result.adminRegion ? osmscout::NumberToString(result.adminRegion->regionOffset) : std::string("-"));
+    key+=" "+(result.poi ? result.poi->name : std::string("-"));
+    key+=" "+(result.location ? osmscout::NumberToString(result.location->locationOffset) : std::string("-"));
+    key+=" "+(result.address ? osmscout::NumberToString(result.address->addressOffset) : std::string("-"));
+
+    keys.insert(key);
+  }
+
+  return keys;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc!=2) {
+    std::cerr << "ReverseLookup <map directory>" << std::endl;
+    return 1;
+  }
+
+  // The first variant is the reference
+  std::vector<DatabaseVariant> variants(4);
+
+  if (!OpenDatabase(argv[1],false,false,variants[0]) ||
+      !OpenDatabase(argv[1],false,true,variants[1]) ||
+      !OpenDatabase(argv[1],true,false,variants[2]) ||
+      !OpenDatabase(argv[1],true,true,variants[3])) {
+    return 1;
+  }
+
+  const DatabaseVariant&      reference=variants.front();
+  std::vector<RegionGeometry> geometries;
+  osmscout::GeoBox            boundingBox;
+  size_t                      errors=0;
+
+  if (!GetRegionGeometries(*reference.database,
+                           geometries) ||
+      !reference.database->GetBoundingBox(boundingBox)) {
+    return 1;
+  }
+
+  // Regions in memory and on disk
+
+  std::cout << "Comparing " << geometries.size() << " region(s) in memory and on disk..." << std::endl;
+
+  errors+=CompareRegions(reference,
+                         variants[1],
+                         geometries);
+
+  // Regions of single coordinates
+
+  std::vector<osmscout::GeoCoord> coords=GetTestCoords(boundingBox,
+                                                       geometries);
+
+  std::cout << "Comparing the regions of " << coords.size() << " coordinate(s)..." << std::endl;
+
+  for (const auto& coord : coords) {
+    std::set<osmscout::FileOffset> expected=GetExpectedRegionOffsets(geometries,
+                                                                     coord);
+
+    for (const auto& variant : variants) {
+      std::set<osmscout::FileOffset> actual;
+
+      if (!variant.locationIndex->HasRegionLookupIndex()) {
+        continue;
+      }
+
+      if (!variant.locationIndex->GetRegionOffsets(std::vector<osmscout::GeoCoord>(1,coord),
+                                                   actual)) {
+        std::cerr << "Cannot lookup regions of " << coord.GetDisplayText() << std::endl;
+        return 1;
+      }
+
+      if (actual!=expected) {
+        std::cerr << variant.name << ": Coordinate " << coord.GetDisplayText() << ": " << actual.size() << " region(s) instead of " << expected.size() << std::endl;
+        errors++;
+      }
+    }
+  }
+
+  // Reverse lookup of all objects
+
+  std::vector<osmscout::ObjectFileRef> objects;
+
+  if (!GetObjects(*reference.database,
+                  objects)) {
+    std::cerr << "Cannot load objects" << std::endl;
+    return 1;
+  }
+
+  std::cout << "Comparing the reverse lookup of " << objects.size() << " object(s)..." << std::endl;
+
+  size_t resultCount=0;
+
+  for (const auto& object : objects) {
+    std::list<osmscout::LocationService::ReverseLookupResult> expected;
+
+    if (!reference.locationService->ReverseLookupObject(object,
+                                                        expected)) {
+      std::cerr << "Cannot reverse lookup " << object.GetName() << std::endl;
+      return 1;
+    }
+
+    for (size_t v=1; v<variants.size(); v++) {
+      std::list<osmscout::LocationService::ReverseLookupResult> actual;
+
+      if (!variants[v].locationService->ReverseLookupObject(object,
+                                                            actual)) {
+        std::cerr << "Cannot reverse lookup " << object.GetName() << std::endl;
+        return 1;
+      }
+
+      if (GetResultKeys(actual)!=GetResultKeys(expected)) {
+        std::cerr << variants[v].name << ": Reverse lookup of " << object.GetName() << ": " << actual.size() << " result(s) instead of " << expected.size() << std::endl;
+        errors++;
+      }
+    }
+
+    resultCount+=expected.size();
+  }
+
+  std::cout << resultCount << " reverse lookup result(s)" << std::endl;
+
+  for (auto& variant : variants) {
+    variant.database->Close();
+  }
+
+  if (errors>0) {
+    std::cerr << errors << " error(s)" << std::endl;
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
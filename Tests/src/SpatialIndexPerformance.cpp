@@ -0,0 +1,207 @@
+/*
+  SpatialIndexPerformance - a test program for libosmscout
+  Copyright (C) 2016  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <limits>
+
+#include <osmscout/Database.h>
+
+#include <osmscout/util/StopClock.h>
+
+/**
+  Compare the query latency of the area*.idx index files with the optional
+  packed R-tree indexes (generated by calling Import with "--rtreeIndex true").
+
+  For a number of random query boxes within the bounding box of the database,
+  the offsets of all nodes, ways and areas in the box are requested from both index
+  families. The bytes read are counted by the indexes themselves, the area*.idx
+  indexes by their FileScanner (independent of memory mapping), the R-tree indexes
+  by the boxes, types and offsets they decode from the mapped file. So both
+  numbers are the amount of index data a query has to access. Data read from the
+  cache of AreaAreaIndex is not counted.
+*/
+
+static const size_t defaultQueryCount=1000;
+static const double defaultBoxSize=0.02;
+
+typedef std::function<bool(const osmscout::GeoBox&,size_t&)> Query;
+typedef std::function<uint64_t()>                            BytesRead;
+
+static bool MeasureQueries(const std::string& name,
+                           const std::vector<osmscout::GeoBox>& boxes,
+                           Query query,
+                           BytesRead bytesRead)
+{
+  size_t              resultCount=0;
+  uint64_t            bytes=bytesRead();
+  osmscout::StopClock timer;
+
+  for (const auto& box : boxes) {
+    if (!query(box,resultCount)) {
+      std::cerr << "Error while querying " << name << std::endl;
+      return false;
+    }
+  }
+
+  timer.Stop();
+
+  bytes=bytesRead()-bytes;
+
+  std::cout << name << ": " << resultCount << " object(s), ";
+  std::cout << timer.GetMilliseconds()/boxes.size() << " ms/query, ";
+  std::cout << bytes/boxes.size() << " bytes/query read" << std::endl;
+
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc<2 || argc>4) {
+    std::cerr << "SpatialIndexPerformance <map directory> [<query count> [<box size>]]" << std::endl;
+    return 1;
+  }
+
+  size_t queryCount=argc>2 ? (size_t)atol(argv[2]) : defaultQueryCount;
+  double boxSize=argc>3 ? atof(argv[3]) : defaultBoxSize;
+
+  if (queryCount==0 || boxSize<=0.0) {
+    std::cerr << "Illegal query count or box size" << std::endl;
+    return 1;
+  }
+
+  osmscout::DatabaseParameter parameter;
+  osmscout::DatabaseRef       database=std::make_shared<osmscout::Database>(parameter);
+
+  if (!database->Open(argv[1])) {
+    std::cerr << "Cannot open database" << std::endl;
+    return 1;
+  }
+
+  osmscout::TypeConfigRef typeConfig=database->GetTypeConfig();
+  osmscout::GeoBox        boundingBox;
+
+  if (!database->GetBoundingBox(boundingBox)) {
+    std::cerr << "Cannot read bounding box" << std::endl;
+    return 1;
+  }
+
+  osmscout::AreaNodeIndexRef    areaNodeIndex=database->GetAreaNodeIndex();
+  osmscout::AreaWayIndexRef     areaWayIndex=database->GetAreaWayIndex();
+  osmscout::AreaAreaIndexRef    areaAreaIndex=database->GetAreaAreaIndex();
+  osmscout::PackedRTreeIndexRef nodeRTreeIndex=database->GetNodeRTreeIndex();
+  osmscout::PackedRTreeIndexRef wayRTreeIndex=database->GetWayRTreeIndex();
+  osmscout::PackedRTreeIndexRef areaRTreeIndex=database->GetAreaRTreeIndex();
+
+  if (!areaNodeIndex ||
+      !areaWayIndex ||
+      !areaAreaIndex) {
+    std::cerr << "Cannot open area*.idx indexes" << std::endl;
+    return 1;
+  }
+
+  if (!nodeRTreeIndex ||
+      !wayRTreeIndex ||
+      !areaRTreeIndex) {
+    std::cerr << "Cannot open R-tree indexes, import with '--rtreeIndex true'" << std::endl;
+    return 1;
+  }
+
+  osmscout::TypeInfoSet nodeTypes(typeConfig->GetNodeTypes());
+  osmscout::TypeInfoSet wayTypes(typeConfig->GetWayTypes());
+  osmscout::TypeInfoSet areaTypes(typeConfig->GetAreaTypes());
+
+  std::vector<osmscout::GeoBox> boxes;
+
+  srand(0);
+
+  for (size_t i=0; i<queryCount; i++) {
+    double lat=boundingBox.GetMinLat()+(boundingBox.GetHeight()-boxSize)*rand()/RAND_MAX;
+    double lon=boundingBox.GetMinLon()+(boundingBox.GetWidth()-boxSize)*rand()/RAND_MAX;
+
+    boxes.push_back(osmscout::GeoBox(osmscout::GeoCoord(lat,lon),
+                                     osmscout::GeoCoord(lat+boxSize,lon+boxSize)));
+  }
+
+  std::cout << "Executing " << queryCount << " queries of size " << boxSize << "x" << boxSize << "..." << std::endl;
+
+  std::vector<osmscout::FileOffset>           offsets;
+  std::vector<osmscout::DataBlockSpan>        spans;
+  osmscout::TypeInfoSet                       loadedTypes;
+  osmscout::PackedRTreeIndex::QueryStatistics nodeStatistics;
+  osmscout::PackedRTreeIndex::QueryStatistics wayStatistics;
+  osmscout::PackedRTreeIndex::QueryStatistics areaStatistics;
+
+  bool result=
+    MeasureQueries("AreaNodeIndex   ",boxes,[&](const osmscout::GeoBox& box, size_t& count) {
+      offsets.clear();
+      bool success=areaNodeIndex->GetOffsets(box,nodeTypes,offsets,loadedTypes);
+      count+=offsets.size();
+      return success;
+    },[&]() {
+      return areaNodeIndex->GetBytesRead();
+    }) &&
+    MeasureQueries("Node R-tree     ",boxes,[&](const osmscout::GeoBox& box, size_t& count) {
+      offsets.clear();
+      bool success=nodeRTreeIndex->GetOffsets(box,nodeTypes,offsets,loadedTypes,&nodeStatistics);
+      count+=offsets.size();
+      return success;
+    },[&]() {
+      return nodeStatistics.bytesRead;
+    }) &&
+    MeasureQueries("AreaWayIndex    ",boxes,[&](const osmscout::GeoBox& box, size_t& count) {
+      offsets.clear();
+      bool success=areaWayIndex->GetOffsets(box,wayTypes,offsets,loadedTypes);
+      count+=offsets.size();
+      return success;
+    },[&]() {
+      return areaWayIndex->GetBytesRead();
+    }) &&
+    MeasureQueries("Way R-tree      ",boxes,[&](const osmscout::GeoBox& box, size_t& count) {
+      offsets.clear();
+      bool success=wayRTreeIndex->GetOffsets(box,wayTypes,offsets,loadedTypes,&wayStatistics);
+      count+=offsets.size();
+      return success;
+    },[&]() {
+      return wayStatistics.bytesRead;
+    }) &&
+    MeasureQueries("AreaAreaIndex   ",boxes,[&](const osmscout::GeoBox& box, size_t& count) {
+      spans.clear();
+      bool success=areaAreaIndex->GetAreasInArea(*typeConfig,box,std::numeric_limits<size_t>::max(),areaTypes,spans,loadedTypes);
+      for (const auto& span : spans) {
+        count+=span.count;
+      }
+      return success;
+    },[&]() {
+      return areaAreaIndex->GetBytesRead();
+    }) &&
+    MeasureQueries("Area R-tree     ",boxes,[&](const osmscout::GeoBox& box, size_t& count) {
+      offsets.clear();
+      bool success=areaRTreeIndex->GetOffsets(box,areaTypes,offsets,loadedTypes,&areaStatistics);
+      count+=offsets.size();
+      return success;
+    },[&]() {
+      return areaStatistics.bytesRead;
+    });
+
+  database->Close();
+
+  return result ? 0 : 1;
+}
@@ -0,0 +1,739 @@
+/*
+  TextSearch - a test program for libosmscout
+  Copyright (C) 2016  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <marisa.h>
+
+#include <osmscout/TextSearchIndex.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/String.h>
+
+/*
+ * Creates text indexes from generated texts and compares the results of
+ * TextSearchIndex::SearchRanked() and TextSearchIndex::Search() with a brute
+ * force scan over all texts.
+ */
+
+static const size_t TRIE_COUNT=4;            //!< Number of tries, indexes as in TextSearchIndex
+static const size_t RANDOM_TEXT_COUNT=10000; //!< Number of random texts for checking the results
+static const size_t NAME_COUNT=50000;        //!< Number of generated names for measuring the time of searches
+static const size_t TIMING_QUERY_COUNT=50;   //!< Number of queries for measuring the time of searches
+static const double MAX_QUERY_TIME=10.0;     //!< Expected maximum time of a search with limit in milliseconds, only reported
+static const size_t SEARCH_THREAD_COUNT=4;   //!< Number of threads searching concurrently
+static const size_t SEARCH_RUN_COUNT=5;      //!< Number of times each thread runs all queries
+
+static const char* const trieFiles[]={osmscout::TextSearchIndex::TEXT_POI_DAT,
+                                      osmscout::TextSearchIndex::TEXT_LOC_DAT,
+                                      osmscout::TextSearchIndex::TEXT_REGION_DAT,
+                                      osmscout::TextSearchIndex::TEXT_OTHER_DAT};
+
+// Indexes of the tries in the order of their importance, as used by SearchRanked()
+static const size_t trieOrder[]={2,1,0,3};
+
+/**
+ * The objects of all texts of one trie
+ */
+typedef std::map<std::string,std::set<osmscout::ObjectFileRef> > TrieTexts;
+
+/**
+ * Return the key for the given text and object as written by the import
+ */
+static std::string GetKey(const std::string& text,
+                          const osmscout::ObjectFileRef& object)
+{
+  std::string key(text);
+
+  key.push_back(static_cast<char>(object.GetType()));
+
+  for (size_t i=0; i<4; i++) {
+    key.push_back(static_cast<char>((object.GetFileOffset() >> ((3-i)*8)) & 0xff));
+  }
+
+  return key;
+}
+
+static bool WriteTrie(const std::string& filename,
+                      const TrieTexts& texts)
+{
+  marisa::Keyset        keyset;
+  std::set<std::string> characters;
+  std::string           offsetSizeKey;
+  std::string           charactersKey;
+
+  for (const auto& entry : texts) {
+    std::vector<std::string> textCharacters;
+
+    osmscout::SplitUTF8String(entry.first,
+                              textCharacters);
+
+    characters.insert(textCharacters.begin(),
+                      textCharacters.end());
+
+    for (const auto& object : entry.second) {
+      std::string key=GetKey(entry.first,
+                             object);
+
+      keyset.push_back(key.c_str(),
+                       key.length());
+    }
+  }
+
+  offsetSizeKey.push_back(4);
+  offsetSizeKey.append("4");
+
+  charactersKey.push_back(5);
+
+  for (const auto& character : characters) {
+    charactersKey.append(character);
+  }
+
+  keyset.push_back(offsetSizeKey.c_str(),
+                   offsetSizeKey.length());
+  keyset.push_back(charactersKey.c_str(),
+                   charactersKey.length());
+
+  try {
+    marisa::Trie trie;
+
+    trie.build(keyset);
+    trie.save(filename.c_str());
+  }
+  catch (const marisa::Exception& e) {
+    std::cerr << "Cannot write '" << filename << "': " << e.what() << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Return the minimum edit distance (optimal string alignment) between the query
+ * and any prefix of the text, counting UTF-8 characters
+ */
+static size_t GetPrefixDistance(const std::vector<std::string>& query,
+                                const std::string& text)
+{
+  std::vector<std::string>         textCharacters;
+  std::vector<std::vector<size_t>> d;
+
+  osmscout::SplitUTF8String(text,
+                            textCharacters);
+
+  d.resize(textCharacters.size()+1,
+           std::vector<size_t>(query.size()+1));
+
+  for (size_t j=0; j<=query.size(); j++) {
+    d[0][j]=j;
+  }
+
+  size_t minDistance=d[0][query.size()];
+
+  for (size_t i=1; i<=textCharacters.size(); i++) {
+    d[i][0]=i;
+
+    for (size_t j=1; j<=query.size(); j++) {
+      size_t cost=textCharacters[i-1]==query[j-1] ? 0 : 1;
+
+      d[i][j]=std::min(std::min(d[i-1][j]+1,
+                                d[i][j-1]+1),
+                       d[i-1][j-1]+cost);
+
+      if (i>1 &&
+          j>1 &&
+          textCharacters[i-1]==query[j-2] &&
+          textCharacters[i-2]==query[j-1]) {
+        d[i][j]=std::min(d[i][j],
+                         d[i-2][j-2]+1);
+      }
+    }
+
+    minDistance=std::min(minDistance,
+                         d[i][query.size()]);
+  }
+
+  return minDistance;
+}
+
+/**
+ * An expected result, the rank is the position of the trie in trieOrder
+ */
+struct ExpectedResult
+{
+  size_t                             distance;
+  size_t                             rank;
+  bool                               shared;  //!< The text is part of multiple tries
+  std::set<osmscout::ObjectFileRef> objects;
+};
+
+static std::map<std::string,ExpectedResult> GetExpectedResults(const std::vector<TrieTexts>& tries,
+                                                               const std::string& query,
+                                                               size_t maxDistance)
+{
+  std::vector<std::string>              queryCharacters;
+  std::map<std::string,ExpectedResult> results;
+
+  osmscout::SplitUTF8String(query,
+                            queryCharacters);
+
+  maxDistance=std::min(maxDistance,
+                       queryCharacters.size()-1);
+
+  for (size_t rank=0; rank<TRIE_COUNT; rank++) {
+    for (const auto& entry : tries[trieOrder[rank]]) {
+      size_t distance=GetPrefixDistance(queryCharacters,
+                                        entry.first);
+
+      if (distance>maxDistance) {
+        continue;
+      }
+
+      auto result=results.find(entry.first);
+
+      // Texts found in multiple tries are ranked by their best match
+      if (result==results.end()) {
+        result=results.insert(std::make_pair(entry.first,ExpectedResult())).first;
+
+        result->second.distance=distance;
+        result->second.rank=rank;
+        result->second.shared=false;
+      }
+      else {
+        if (distance<result->second.distance) {
+          result->second.distance=distance;
+          result->second.rank=rank;
+        }
+
+        result->second.shared=true;
+      }
+
+      result->second.objects.insert(entry.second.begin(),
+                                    entry.second.end());
+    }
+  }
+
+  return results;
+}
+
+/**
+ * Return the expected results with a distance of at most maxDistance
+ */
+static std::map<std::string,ExpectedResult> FilterExpectedResults(const std::map<std::string,ExpectedResult>& results,
+                                                                  size_t maxDistance)
+{
+  std::map<std::string,ExpectedResult> filteredResults;
+
+  for (const auto& entry : results) {
+    if (entry.second.distance<=maxDistance) {
+      filteredResults.insert(entry);
+    }
+  }
+
+  return filteredResults;
+}
+
+/**
+ * Check the results of one search. If the result is limited, all texts ranked before
+ * the rank of the last result must be returned.
+ */
+static bool CheckSearch(const osmscout::TextSearchIndex& index,
+                        const std::map<std::string,ExpectedResult>& expected,
+                        const std::string& query,
+                        size_t maxDistance,
+                        size_t limit)
+{
+  std::vector<osmscout::TextSearchIndex::RankedResult> results;
+  std::string                                          description="Query '"+query+"', distance "+std::to_string(maxDistance)+
+                                                                   ", limit "+std::to_string(limit);
+
+  if (!index.SearchRanked(query,true,true,true,true,maxDistance,limit,results)) {
+    std::cerr << description << ": Search failed" << std::endl;
+    return false;
+  }
+
+  if (results.size()!=std::min(limit,expected.size())) {
+    std::cerr << description << ": " << results.size() << " result(s) instead of " << std::min(limit,expected.size()) << std::endl;
+    return false;
+  }
+
+  std::set<std::string> returnedTexts;
+
+  for (size_t r=0; r<results.size(); r++) {
+    const auto& result=results[r];
+    auto        entry=expected.find(result.text);
+
+    if (entry==expected.end()) {
+      std::cerr << description << ": Unexpected result '" << result.text << "'" << std::endl;
+      return false;
+    }
+
+    if (result.distance!=entry->second.distance) {
+      std::cerr << description << ": Distance of '" << result.text << "' is " << result.distance << " instead of " << entry->second.distance << std::endl;
+      return false;
+    }
+
+    std::set<osmscout::ObjectFileRef> objects(result.objects.begin(),
+                                              result.objects.end());
+
+    // A limited search may return before the objects of other tries are visited
+    bool complete=!entry->second.shared || results.size()<limit;
+
+    if (objects.size()!=result.objects.size() ||
+        (complete && objects!=entry->second.objects) ||
+        !std::includes(entry->second.objects.begin(),entry->second.objects.end(),
+                       objects.begin(),objects.end())) {
+      std::cerr << description << ": Objects of '" << result.text << "' differ" << std::endl;
+      return false;
+    }
+
+    if (!returnedTexts.insert(result.text).second) {
+      std::cerr << description << ": Duplicate result '" << result.text << "'" << std::endl;
+      return false;
+    }
+
+    if (r>0) {
+      const auto& previous=expected.at(results[r-1].text);
+      const auto& current=entry->second;
+
+      if (previous.distance>current.distance ||
+          (previous.distance==current.distance && previous.rank>current.rank) ||
+          (previous.distance==current.distance && previous.rank==current.rank &&
+           results[r-1].text.length()>result.text.length())) {
+        std::cerr << description << ": '" << results[r-1].text << "' is ranked before '" << result.text << "'" << std::endl;
+        return false;
+      }
+    }
+  }
+
+  if (!results.empty()) {
+    const auto& last=expected.at(results.back().text);
+
+    for (const auto& entry : expected) {
+      if ((entry.second.distance<last.distance ||
+           (entry.second.distance==last.distance && entry.second.rank<last.rank)) &&
+          returnedTexts.find(entry.first)==returnedTexts.end()) {
+        std::cerr << description << ": Result '" << entry.first << "' is missing" << std::endl;
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Check, that the given text is returned with the given distance by a search
+ */
+static bool CheckMatch(const osmscout::TextSearchIndex& index,
+                       const std::string& query,
+                       size_t maxDistance,
+                       size_t limit,
+                       const std::string& text,
+                       size_t distance)
+{
+  std::vector<osmscout::TextSearchIndex::RankedResult> results;
+
+  if (!index.SearchRanked(query,true,true,true,true,maxDistance,limit,results)) {
+    std::cerr << "Query '" << query << "': Search failed" << std::endl;
+    return false;
+  }
+
+  for (const auto& result : results) {
+    if (result.text==text) {
+      if (result.distance!=distance) {
+        std::cerr << "Query '" << query << "': Distance of '" << text << "' is " << result.distance << " instead of " << distance << std::endl;
+        return false;
+      }
+
+      return true;
+    }
+  }
+
+  std::cerr << "Query '" << query << "': '" << text << "' not found" << std::endl;
+
+  return false;
+}
+
+/**
+ * Return the objects of all texts starting with the query
+ */
+static TrieTexts GetExpectedPrefixResults(const std::vector<TrieTexts>& tries,
+                                          const std::string& query)
+{
+  TrieTexts results;
+
+  for (const auto& trie : tries) {
+    for (auto entry=trie.lower_bound(query);
+         entry!=trie.end() && entry->first.compare(0,query.length(),query)==0;
+         ++entry) {
+      results[entry->first].insert(entry->second.begin(),
+                                   entry->second.end());
+    }
+  }
+
+  return results;
+}
+
+static TrieTexts GetTexts(const osmscout::TextSearchIndex::ResultsMap& results)
+{
+  TrieTexts texts;
+
+  for (const auto& entry : results) {
+    texts[entry.first].insert(entry.second.begin(),
+                              entry.second.end());
+  }
+
+  return texts;
+}
+
+static TrieTexts GetTexts(const osmscout::TextSearchIndex::ResultBuffer& results)
+{
+  TrieTexts texts;
+
+  for (size_t i=0; i<results.GetSize(); i++) {
+    texts[results.GetText(i)].insert(results.GetObject(i));
+  }
+
+  return texts;
+}
+
+/**
+ * Check the results of TextSearchIndex::Search() returning a ResultsMap against a
+ * brute force scan and then check, that concurrent searches, each thread reusing
+ * one ResultBuffer for all its searches, return the same results as the ResultsMap
+ * overload.
+ */
+static bool CheckConcurrentSearch(const osmscout::TextSearchIndex& index,
+                                  const std::vector<TrieTexts>& tries,
+                                  const std::vector<std::string>& queries)
+{
+  std::vector<TrieTexts> expectedResults;
+  size_t                 errors=0;
+
+  for (const auto& query : queries) {
+    osmscout::TextSearchIndex::ResultsMap results;
+
+    if (!index.Search(query,true,true,true,true,results)) {
+      std::cerr << "Query '" << query << "': Search failed" << std::endl;
+      return false;
+    }
+
+    expectedResults.push_back(GetTexts(results));
+
+    if (expectedResults.back()!=GetExpectedPrefixResults(tries,query)) {
+      std::cerr << "Query '" << query << "': Search returned wrong results" << std::endl;
+      errors++;
+    }
+  }
+
+  std::atomic<size_t>      concurrentErrors(0);
+  std::vector<std::thread> threads;
+
+  for (size_t t=0; t<SEARCH_THREAD_COUNT; t++) {
+    threads.push_back(std::thread([&index,&queries,&expectedResults,&concurrentErrors,t]() {
+      osmscout::TextSearchIndex::ResultBuffer results;
+
+      for (size_t run=0; run<SEARCH_RUN_COUNT; run++) {
+        // Each thread starts with a different query
+        for (size_t q=0; q<queries.size(); q++) {
+          size_t query=(q+run+t*queries.size()/SEARCH_THREAD_COUNT)%queries.size();
+
+          if (!index.Search(queries[query],true,true,true,true,results) ||
+              GetTexts(results)!=expectedResults[query]) {
+            concurrentErrors++;
+          }
+        }
+      }
+    }));
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  if (concurrentErrors>0) {
+    std::cerr << concurrentErrors << " concurrent search(es) returned wrong results" << std::endl;
+    errors++;
+  }
+
+  return errors==0;
+}
+
+static std::string CreateRandomText(std::mt19937& generator,
+                                    size_t length)
+{
+  static const char* const characters[]={"a","b","c","d","e","f","g","h","i","k","l","m",
+                                         "n","o","p","r","s","t","u","w"," ","ä","ö","ü","ß","é"};
+  std::string text;
+
+  for (size_t i=0; i<length; i++) {
+    text.append(characters[generator()%(sizeof(characters)/sizeof(characters[0]))]);
+  }
+
+  return text;
+}
+
+/**
+ * Create a name from syllables, so that the texts below a prefix are distributed
+ * like those of real names and not uniformly like random texts
+ */
+static std::string CreateName(std::mt19937& generator)
+{
+  static const char* const syllables[]={"Ab","ach","Alt","an","au","Bach","bau","Berg","bor","Brun","bruck","Buch",
+                                        "burg","dorf","Eich","eck","el","en","er","feld","Fisch","furt","gar","Gras",
+                                        "hau","heim","hof","hol","hörn","in","Kir","ke","Lan","lin","Lin","markt",
+                                        "Mühl","Neu","ost","platz","Ro","ring","sen","stein","Stra","ße","tal","ten",
+                                        "Ul","wald","Wei","weg","wie","zell"};
+  std::string name;
+  size_t      syllableCount=2+generator()%3;
+
+  for (size_t i=0; i<syllableCount; i++) {
+    if (i>0 && generator()%5==0) {
+      name.append(" ");
+    }
+
+    name.append(syllables[generator()%(sizeof(syllables)/sizeof(syllables[0]))]);
+  }
+
+  return name;
+}
+
+/**
+ * Return a query for the given name as typed by a user, a prefix of the name
+ * with one typo
+ */
+static std::string CreateQuery(std::mt19937& generator,
+                               const std::string& name)
+{
+  std::vector<std::string> characters;
+
+  osmscout::SplitUTF8String(name,
+                            characters);
+
+  characters.resize(std::min(characters.size(),
+                             (size_t)(4+generator()%5)));
+
+  size_t position=generator()%(characters.size()-1);
+
+  if (generator()%2==0) {
+    std::swap(characters[position],
+              characters[position+1]);
+  }
+  else {
+    characters[position]="x";
+  }
+
+  std::string query;
+
+  for (const auto& character : characters) {
+    query.append(character);
+  }
+
+  return query;
+}
+
+/**
+ * Add the text to a random trie, if it is not already part of a trie
+ */
+static void AddText(std::mt19937& generator,
+                    std::vector<TrieTexts>& tries,
+                    const std::string& text,
+                    const osmscout::ObjectFileRef& object)
+{
+  size_t trie=generator()%TRIE_COUNT;
+
+  for (const auto& trieTexts : tries) {
+    if (trieTexts.find(text)!=trieTexts.end()) {
+      return;
+    }
+  }
+
+  tries[trie][text].insert(object);
+}
+
+int main(int /*argc*/, char* /*argv*/[])
+{
+  std::vector<TrieTexts> tries(TRIE_COUNT);
+  std::mt19937           generator(4711);
+  uint32_t               nextOffset=1;
+
+  // Texts with known typos
+  const char* const poiTexts[]={"Hauptbahnhof","Haus","Haus am See","Hausarzt","Haushaltswaren","Kirche","Kirchweg","Krankenhaus"};
+  const char* const locationTexts[]={"Hauptstraße","Bahnhofstraße","Müllerstraße","Münchener Freiheit","Straße des 17. Juni"};
+  const char* const regionTexts[]={"München","Hamburg","Haus"};
+
+  for (const char* text : poiTexts) {
+    tries[0][text].insert(osmscout::ObjectFileRef(nextOffset++,osmscout::refNode));
+    tries[0][text].insert(osmscout::ObjectFileRef(nextOffset++,osmscout::refArea));
+  }
+
+  for (const char* text : locationTexts) {
+    tries[1][text].insert(osmscout::ObjectFileRef(nextOffset++,osmscout::refWay));
+  }
+
+  for (const char* text : regionTexts) {
+    tries[2][text].insert(osmscout::ObjectFileRef(nextOffset++,osmscout::refArea));
+  }
+
+  // Many completions of "Haus" to check, that the complete match is not lost by the limit
+  for (size_t i=0; i<1000; i++) {
+    tries[3]["Haus "+std::to_string(i)].insert(osmscout::ObjectFileRef(nextOffset++,osmscout::refNode));
+  }
+
+  for (size_t i=0; i<RANDOM_TEXT_COUNT; i++) {
+    std::string text=CreateRandomText(generator,3+generator()%12);
+
+    AddText(generator,
+            tries,
+            text,
+            osmscout::ObjectFileRef(nextOffset++,
+                                    i%2==0 ? osmscout::refNode : osmscout::refWay));
+  }
+
+  std::vector<std::string> names;
+
+  for (size_t i=0; i<NAME_COUNT; i++) {
+    names.push_back(CreateName(generator));
+
+    AddText(generator,
+            tries,
+            names.back(),
+            osmscout::ObjectFileRef(nextOffset++,
+                                    osmscout::refWay));
+  }
+
+  // Texts are unique over all tries, except "Haus", which is a region and a POI
+  for (size_t t=0; t<TRIE_COUNT; t++) {
+    if (!WriteTrie(trieFiles[t],tries[t])) {
+      return 1;
+    }
+  }
+
+  osmscout::TextSearchIndex index;
+  size_t                    errors=0;
+
+  if (!index.Load(".")) {
+    std::cerr << "Cannot load text index" << std::endl;
+    return 1;
+  }
+
+  // Distance 0, 1 and 2, transpositions and UTF-8 characters
+  if (!CheckMatch(index,"Hauptstr",0,100,"Hauptstraße",0) ||
+      !CheckMatch(index,"Hauptstraße",0,100,"Hauptstraße",0) ||
+      !CheckMatch(index,"Hautpstr",1,100,"Hauptstraße",1) ||
+      !CheckMatch(index,"Haptstr",1,100,"Hauptstraße",1) ||
+      !CheckMatch(index,"Hauxptstr",1,100,"Hauptstraße",1) ||
+      !CheckMatch(index,"Hxuptstr",1,100,"Hauptstraße",1) ||
+      !CheckMatch(index,"Hautpsrt",2,100,"Hauptstraße",2) ||
+      !CheckMatch(index,"Munchen",1,100,"Münchener Freiheit",1) ||
+      !CheckMatch(index,"Münhcen",1,100,"München",1) ||
+      !CheckMatch(index,"Strase des",1,100,"Straße des 17. Juni",1) ||
+      !CheckMatch(index,"Mülerstr",1,100,"Müllerstraße",1)) {
+    errors++;
+  }
+
+  // The complete match must be returned, even if there are many longer completions
+  if (!CheckMatch(index,"Haus",0,1,"Haus",0)) {
+    errors++;
+  }
+
+  std::vector<std::string> queries={"Hauptstr","Hautpstr","Haus","Hasu","Munchen","Münhcen","Strase","Kirhc","K","Ha"};
+
+  for (size_t i=0; i<20; i++) {
+    queries.push_back(CreateRandomText(generator,1+i%5));
+  }
+
+  for (size_t i=0; i<10; i++) {
+    queries.push_back(CreateQuery(generator,names[generator()%names.size()]));
+  }
+
+  for (const auto& query : queries) {
+    std::map<std::string,ExpectedResult> allExpected=GetExpectedResults(tries,query,2);
+
+    for (size_t maxDistance=0; maxDistance<=2; maxDistance++) {
+      std::map<std::string,ExpectedResult> expected=FilterExpectedResults(allExpected,maxDistance);
+
+      for (size_t limit : {(size_t)1,(size_t)5,(size_t)50,(size_t)1000000}) {
+        if (!CheckSearch(index,expected,query,maxDistance,limit)) {
+          errors++;
+        }
+      }
+    }
+  }
+
+  if (!CheckConcurrentSearch(index,tries,queries)) {
+    errors++;
+  }
+
+  // Searches with a limit should be fast, even if they match many texts
+  double maxTime=0.0;
+
+  for (size_t i=0; i<TIMING_QUERY_COUNT; i++) {
+    std::string query=CreateQuery(generator,names[generator()%names.size()]);
+    double      time=0.0;
+
+    // Best of five runs to reduce the effect of other processes
+    for (size_t run=0; run<5; run++) {
+      std::vector<osmscout::TextSearchIndex::RankedResult> results;
+      auto                                                 start=std::chrono::steady_clock::now();
+
+      index.SearchRanked(query,true,true,true,true,2,10,results);
+
+      double runTime=std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count();
+
+      time=run==0 ? runTime : std::min(time,runTime);
+    }
+
+    maxTime=std::max(maxTime,time);
+  }
+
+  std::cout << "Maximum time of a search with limit: " << maxTime << " ms" << std::endl;
+
+  // Timing depends on the build and the load of the machine, so it is only reported
+  if (maxTime>MAX_QUERY_TIME) {
+    std::cout << "Warning: Search with limit took longer than " << MAX_QUERY_TIME << " ms";
+#if !defined(__OPTIMIZE__)
+    std::cout << " (unoptimized build)";
+#endif
+    std::cout << std::endl;
+  }
+
+  for (const char* file : trieFiles) {
+    osmscout::RemoveFile(file);
+  }
+
+  if (errors>0) {
+    std::cerr << errors << " error(s)" << std::endl;
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
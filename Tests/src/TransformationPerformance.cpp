@@ -0,0 +1,551 @@
+/*
+  TransformationPerformance - a test program for libosmscout
+  Copyright (C) 2016  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <osmscout/util/CompactGeoCoords.h>
+#include <osmscout/util/Magnification.h>
+#include <osmscout/util/Projection.h>
+#include <osmscout/util/StopClock.h>
+#include <osmscout/util/Transformation.h>
+
+/**
+  Check performance of the transformation and simplification of large
+  polygons (like coastlines or administrative boundaries) using
+  * no optimization
+  * fast optimization (similar points and redundant points)
+  * quality optimization (Douglas-Peucker)
+  for coordinates given as std::vector<GeoCoord> and as CompactGeoCoords.
+
+  The result of each transformation is compared point by point with a
+  reference implementation of the original (recursive, array of structures)
+  simplification, for the large polygon and for many small random polygons.
+*/
+
+static const size_t POLYGON_SIZE       = 1000000;
+static const size_t ITERATIONS         = 10;
+static const size_t SMALL_POLYGONS     = 10000;
+static const size_t SMALL_POLYGON_SIZE = 50;
+
+typedef std::vector<osmscout::TransPolygon::TransPoint> TransPoints;
+
+static double ReferenceDistancePointToLineSegment(const osmscout::TransPolygon::TransPoint& p,
+                                                  const osmscout::TransPolygon::TransPoint& a,
+                                                  const osmscout::TransPolygon::TransPoint& b)
+{
+  double xdelta=b.x-a.x;
+  double ydelta=b.y-a.y;
+
+  if (xdelta==0 && ydelta==0) {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  double u=((p.x-a.x)*xdelta+(p.y-a.y)*ydelta)/(xdelta*xdelta+ydelta*ydelta);
+  double cx,cy;
+
+  if (u<0) {
+    cx=a.x;
+    cy=a.y;
+  }
+  else if (u>1) {
+    cx=b.x;
+    cy=b.y;
+  }
+  else {
+    cx=a.x+u*xdelta;
+    cy=a.y+u*ydelta;
+  }
+
+  double dx=cx-p.x;
+  double dy=cy-p.y;
+
+  return sqrt(dx*dx+dy*dy);
+}
+
+static double ReferenceDistanceSquaredToLine(const osmscout::TransPolygon::TransPoint& p,
+                                             const osmscout::TransPolygon::TransPoint& a,
+                                             const osmscout::TransPolygon::TransPoint& b)
+{
+  double xdelta=b.x-a.x;
+  double ydelta=b.y-a.y;
+  double inverseLength=1/(xdelta*xdelta+ydelta*ydelta);
+  double cx=p.x-a.x;
+  double cy=p.y-a.y;
+  double u=(cx*xdelta+cy*ydelta)*inverseLength;
+
+  u=std::min(1.0,std::max(0.0,u));
+
+  double dx=cx-u*xdelta;
+  double dy=cy-u*ydelta;
+
+  return dx*dx+dy*dy;
+}
+
+static void ReferenceDropSimilarPoints(TransPoints& points,
+                                       double tolerance)
+{
+  for (size_t i=0; i<points.size(); i++) {
+    if (points[i].draw) {
+      size_t j=i+1;
+
+      while (j<points.size()-1) {
+        if (points[j].draw) {
+          if (std::fabs(points[j].x-points[i].x)<=tolerance &&
+              std::fabs(points[j].y-points[i].y)<=tolerance) {
+            points[j].draw=false;
+          }
+          else {
+            break;
+          }
+        }
+
+        j++;
+      }
+    }
+  }
+}
+
+static void ReferenceDropRedundantPointsFast(TransPoints& points,
+                                             double tolerance)
+{
+  size_t length=points.size();
+  size_t prev=0;
+
+  while (prev<length) {
+    while (prev<length && !points[prev].draw) {
+      prev++;
+    }
+
+    size_t cur=prev+1;
+
+    while (cur<length && !points[cur].draw) {
+      cur++;
+    }
+
+    size_t next=cur+1;
+
+    while (next<length && !points[next].draw) {
+      next++;
+    }
+
+    if (prev>=length ||
+        cur>=length ||
+        next>=length) {
+      break;
+    }
+
+    if (ReferenceDistancePointToLineSegment(points[cur],points[prev],points[next])<=tolerance) {
+      points[cur].draw=false;
+      prev=next;
+    }
+    else {
+      prev++;
+    }
+  }
+}
+
+static void ReferenceSimplifyDouglasPeucker(TransPoints& points,
+                                            size_t beginIndex,
+                                            size_t endIndex,
+                                            size_t endValueIndex,
+                                            double toleranceSquared)
+{
+  double maxDistanceSquared=0;
+  size_t maxDistanceIndex=beginIndex;
+
+  for (size_t i=beginIndex+1; i<endIndex; ++i) {
+    if (points[i].draw) {
+      double distanceSquared=ReferenceDistanceSquaredToLine(points[i],
+                                                            points[beginIndex],
+                                                            points[endValueIndex]);
+
+      if (distanceSquared>maxDistanceSquared) {
+        maxDistanceSquared=distanceSquared;
+        maxDistanceIndex=i;
+      }
+    }
+  }
+
+  if (maxDistanceSquared<=toleranceSquared) {
+    for (size_t i=beginIndex+1; i<endIndex; ++i) {
+      points[i].draw=false;
+    }
+
+    return;
+  }
+
+  ReferenceSimplifyDouglasPeucker(points,beginIndex,maxDistanceIndex,maxDistanceIndex,toleranceSquared);
+  ReferenceSimplifyDouglasPeucker(points,maxDistanceIndex,endIndex,endValueIndex,toleranceSquared);
+}
+
+static void ReferenceDropRedundantPointsDouglasPeucker(TransPoints& points,
+                                                       double tolerance,
+                                                       bool isArea)
+{
+  size_t length=points.size();
+  size_t begin=0;
+
+  while (begin<length &&
+         !points[begin].draw) {
+    begin++;
+  }
+
+  if (begin>=length) {
+    return;
+  }
+
+  if (isArea) {
+    double maxDist=0.0;
+    size_t maxDistIndex=begin;
+
+    for (size_t i=begin; i<length; ++i) {
+      if (points[i].draw) {
+        double xdelta=points[i].x-points[begin].x;
+        double ydelta=points[i].y-points[begin].y;
+        double dist=sqrt(xdelta*xdelta+ydelta*ydelta);
+
+        if (dist>maxDist) {
+          maxDist=dist;
+          maxDistIndex=i;
+        }
+      }
+    }
+
+    if (maxDistIndex==begin) {
+      return;
+    }
+
+    ReferenceSimplifyDouglasPeucker(points,begin,maxDistIndex,maxDistIndex,tolerance*tolerance);
+    ReferenceSimplifyDouglasPeucker(points,maxDistIndex,length,begin,tolerance*tolerance);
+  }
+  else {
+    size_t end=length-1;
+
+    while (end>begin &&
+           !points[end].draw) {
+      end--;
+    }
+
+    if (end<=begin) {
+      return;
+    }
+
+    ReferenceSimplifyDouglasPeucker(points,begin,end,end,tolerance*tolerance);
+  }
+}
+
+/**
+ * Transform and simplify the coordinates like the original implementation
+ */
+static void ReferenceTransform(const osmscout::Projection& projection,
+                               osmscout::TransPolygon::OptimizeMethod optimize,
+                               bool isArea,
+                               const std::vector<osmscout::GeoCoord>& coords,
+                               double tolerance,
+                               TransPoints& points)
+{
+  std::vector<double> x(coords.size());
+  std::vector<double> y(coords.size());
+
+  points.resize(coords.size());
+
+  projection.GeoToPixel(coords,
+                        x.data(),
+                        y.data());
+
+  for (size_t i=0; i<coords.size(); i++) {
+    points[i].draw=true;
+    points[i].x=x[i];
+    points[i].y=y[i];
+  }
+
+  if (optimize==osmscout::TransPolygon::none) {
+    return;
+  }
+
+  if (!isArea ||
+      optimize==osmscout::TransPolygon::fast) {
+    ReferenceDropSimilarPoints(points,tolerance);
+  }
+
+  if (optimize==osmscout::TransPolygon::fast) {
+    ReferenceDropRedundantPointsFast(points,tolerance);
+  }
+  else {
+    ReferenceDropRedundantPointsDouglasPeucker(points,tolerance,isArea);
+  }
+}
+
+/**
+ * Compare the result of the transformation point by point with the reference
+ */
+static bool Compare(const std::string& name,
+                    const osmscout::TransPolygon& polygon,
+                    const TransPoints& reference)
+{
+  size_t length=0;
+  size_t start=reference.size();
+  size_t end=0;
+
+  for (size_t i=0; i<reference.size(); i++) {
+    const osmscout::TransPolygon::TransPoint& point=polygon.points[i];
+
+    if (point.draw!=reference[i].draw ||
+        point.x!=reference[i].x ||
+        point.y!=reference[i].y) {
+      std::cerr << name << ": Point " << i << " differs from the reference" << std::endl;
+      return false;
+    }
+
+    if (point.draw) {
+      length++;
+      start=std::min(start,i);
+      end=i;
+    }
+  }
+
+  if (polygon.GetLength()!=length ||
+      (length>0 && (polygon.GetStart()!=start || polygon.GetEnd()!=end))) {
+    std::cerr << name << ": Length, start or end differ from the reference" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Generates a closed, noisy ring around the given center, resembling a coastline
+ */
+static void GeneratePolygon(double lon,
+                            double lat,
+                            double radius,
+                            size_t size,
+                            std::vector<osmscout::GeoCoord>& coords)
+{
+  coords.clear();
+  coords.reserve(size);
+
+  srand(0);
+
+  for (size_t i=0; i<size; i++) {
+    double angle=2*M_PI*i/size;
+    double noise=radius*0.05*(rand()/(double)RAND_MAX-0.5);
+    double r=radius*(1+0.1*sin(angle*50))+noise;
+
+    coords.push_back(osmscout::GeoCoord(lat+r*sin(angle),
+                                        lon+r*cos(angle)));
+  }
+}
+
+static bool Benchmark(const std::string& name,
+                      const osmscout::Projection& projection,
+                      osmscout::TransPolygon::OptimizeMethod optimize,
+                      bool isArea,
+                      const std::vector<osmscout::GeoCoord>& coords)
+{
+  osmscout::TransPolygon polygon;
+  TransPoints            reference;
+  size_t                 length=0;
+  osmscout::StopClock    clock;
+
+  for (size_t i=0; i<ITERATIONS; i++) {
+    if (isArea) {
+      polygon.TransformArea(projection,
+                            optimize,
+                            coords,
+                            1.0);
+    }
+    else {
+      polygon.TransformWay(projection,
+                           optimize,
+                           coords,
+                           1.0);
+    }
+
+    length=polygon.GetLength();
+  }
+
+  clock.Stop();
+
+  std::cout << name << ": " << coords.size() << " => " << length << " points, ";
+  std::cout << clock.GetMilliseconds()/ITERATIONS << " ms per polygon" << std::endl;
+
+  ReferenceTransform(projection,optimize,isArea,coords,1.0,reference);
+
+  return Compare(name,polygon,reference);
+}
+
+static bool BenchmarkCompact(const std::string& name,
+                             const osmscout::Projection& projection,
+                             osmscout::TransPolygon::OptimizeMethod optimize,
+                             const osmscout::CompactGeoCoords& coords)
+{
+  osmscout::TransPolygon          polygon;
+  std::vector<osmscout::GeoCoord> expandedCoords;
+  TransPoints                     reference;
+  size_t                          length=0;
+  osmscout::StopClock    clock;
+
+  for (size_t i=0; i<ITERATIONS; i++) {
+    polygon.TransformArea(projection,
+                          optimize,
+                          coords,
+                          1.0);
+
+    length=polygon.GetLength();
+  }
+
+  clock.Stop();
+
+  std::cout << name << ": " << coords.GetSize() << " => " << length << " points, ";
+  std::cout << clock.GetMilliseconds()/ITERATIONS << " ms per polygon" << std::endl;
+
+  coords.Get(expandedCoords);
+  ReferenceTransform(projection,optimize,true,expandedCoords,1.0,reference);
+
+  return Compare(name,polygon,reference);
+}
+
+/**
+ * Compare the transformation of many small random polygons with the reference,
+ * including repeated points and collinear points, which result in equal distances
+ */
+static bool CheckSmallPolygons(const osmscout::Projection& projection)
+{
+  std::mt19937                           generator(4711);
+  std::uniform_real_distribution<double> offsetDistribution(-0.01,0.01);
+  osmscout::TransPolygon                 polygon;
+  TransPoints                            reference;
+  size_t                                 errors=0;
+
+  for (size_t p=0; p<SMALL_POLYGONS; p++) {
+    std::vector<osmscout::GeoCoord> coords;
+    size_t                          size=2+generator()%(SMALL_POLYGON_SIZE-1);
+
+    for (size_t i=0; i<size; i++) {
+      if (i>0 && generator()%4==0) {
+        coords.push_back(coords.back());
+      }
+      else if (i>1 && generator()%4==0) {
+        coords.push_back(osmscout::GeoCoord(2*coords[i-1].GetLat()-coords[i-2].GetLat(),
+                                            2*coords[i-1].GetLon()-coords[i-2].GetLon()));
+      }
+      else {
+        coords.push_back(osmscout::GeoCoord(51.0+offsetDistribution(generator),
+                                            7.0+offsetDistribution(generator)));
+      }
+    }
+
+    double                          tolerance=(p%4)*0.5;
+    osmscout::CompactGeoCoords      compactCoords;
+    std::vector<osmscout::GeoCoord> expandedCoords;
+
+    compactCoords.Set(coords);
+    compactCoords.Get(expandedCoords);
+
+    for (auto optimize : {osmscout::TransPolygon::none,osmscout::TransPolygon::fast,osmscout::TransPolygon::quality}) {
+      for (bool isArea : {true,false}) {
+        if (isArea) {
+          polygon.TransformArea(projection,optimize,coords,tolerance);
+        }
+        else {
+          polygon.TransformWay(projection,optimize,coords,tolerance);
+        }
+
+        ReferenceTransform(projection,optimize,isArea,coords,tolerance,reference);
+
+        if (!Compare("Polygon "+std::to_string(p)+(isArea ? " area" : " way")+" optimize "+std::to_string(optimize),
+                     polygon,
+                     reference)) {
+          errors++;
+        }
+
+        // Compact coordinates are compared with the reference for the rounded coordinates
+        if (isArea) {
+          polygon.TransformArea(projection,optimize,compactCoords,tolerance);
+        }
+        else {
+          polygon.TransformWay(projection,optimize,compactCoords,tolerance);
+        }
+
+        ReferenceTransform(projection,optimize,isArea,expandedCoords,tolerance,reference);
+
+        if (!Compare("Compact polygon "+std::to_string(p)+(isArea ? " area" : " way")+" optimize "+std::to_string(optimize),
+                     polygon,
+                     reference)) {
+          errors++;
+        }
+      }
+    }
+  }
+
+  std::cout << SMALL_POLYGONS << " small polygons compared with the reference" << std::endl;
+
+  return errors==0;
+}
+
+int main(int /*argc*/, char* /*argv*/[])
+{
+  osmscout::MercatorProjection    projection;
+  osmscout::Magnification         magnification;
+  std::vector<osmscout::GeoCoord> coords;
+  osmscout::CompactGeoCoords      compactCoords;
+
+  magnification.SetLevel(8);
+
+  projection.Set(7.0,
+                 51.0,
+                 magnification,
+                 96.0,
+                 1920,
+                 1080);
+
+  GeneratePolygon(7.0,51.0,2.0,POLYGON_SIZE,coords);
+  compactCoords.Set(coords);
+
+  std::cout << "Polygon with " << coords.size() << " points, " << ITERATIONS << " iterations each" << std::endl;
+  std::cout << "Memory: " << coords.capacity()*sizeof(osmscout::GeoCoord) << " bytes, ";
+  std::cout << compactCoords.GetMemorySize() << " bytes compact" << std::endl;
+
+  size_t errors=0;
+
+  errors+=Benchmark("Area none   ",projection,osmscout::TransPolygon::none,true,coords) ? 0 : 1;
+  errors+=Benchmark("Area fast   ",projection,osmscout::TransPolygon::fast,true,coords) ? 0 : 1;
+  errors+=Benchmark("Area quality",projection,osmscout::TransPolygon::quality,true,coords) ? 0 : 1;
+  errors+=Benchmark("Way none    ",projection,osmscout::TransPolygon::none,false,coords) ? 0 : 1;
+  errors+=Benchmark("Way fast    ",projection,osmscout::TransPolygon::fast,false,coords) ? 0 : 1;
+  errors+=Benchmark("Way quality ",projection,osmscout::TransPolygon::quality,false,coords) ? 0 : 1;
+  errors+=BenchmarkCompact("Compact area none   ",projection,osmscout::TransPolygon::none,compactCoords) ? 0 : 1;
+  errors+=BenchmarkCompact("Compact area quality",projection,osmscout::TransPolygon::quality,compactCoords) ? 0 : 1;
+  errors+=CheckSmallPolygons(projection) ? 0 : 1;
+
+  if (errors>0) {
+    std::cerr << errors << " transformation(s) differ from the reference" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "All transformations are identical to the reference" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -17,17 +17,24 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <thread>
 #include <vector>
 
+#include <osmscout/util/StopClock.h>
+#include <osmscout/util/ThreadPool.h>
 #include <osmscout/util/WorkQueue.h>
 
+static const size_t benchmarkTaskCount=200000;
+static const size_t benchmarkTaskSize=1000;
+
 class Worker
 {
 private:
-  std::thread              worker;
   osmscout::WorkQueue<int> queue;
+  std::thread              worker;
 
 private:
   int Work(int a, int b)
@@ -79,10 +86,303 @@ public:
   }
 };
 
-int main(int argc, char* argv[])
+/**
+ * Some CPU bound dummy work
+ */
+static int BenchmarkWork(size_t value)
+{
+  size_t result=value;
+
+  for (size_t i=0; i<benchmarkTaskSize; i++) {
+    result=result*31+i;
+  }
+
+  return (int)(result%1000);
+}
+
+/**
+ * Sum of the results of all benchmark tasks, calculated sequentially
+ */
+static size_t GetExpectedBenchmarkSum()
+{
+  size_t sum=0;
+
+  for (size_t i=0; i<benchmarkTaskCount; i++) {
+    sum+=BenchmarkWork(i);
+  }
+
+  return sum;
+}
+
+/**
+ * Throughput of a WorkQueue shared by one consumer thread per core
+ */
+static size_t BenchmarkWorkQueue(size_t workerCount)
+{
+  osmscout::WorkQueue<int>      queue;
+  std::vector<std::thread>      workers;
+  std::vector<std::future<int>> futures;
+  osmscout::StopClock           stopClock;
+
+  futures.reserve(benchmarkTaskCount);
+
+  for (size_t i=0; i<workerCount; i++) {
+    workers.push_back(std::thread([&queue]() {
+      std::packaged_task<int()> task;
+
+      while (queue.PopTask(task)) {
+        task();
+      }
+    }));
+  }
+
+  for (size_t i=0; i<benchmarkTaskCount; i++) {
+    std::packaged_task<int()> task(std::bind(BenchmarkWork,i));
+
+    futures.push_back(task.get_future());
+
+    queue.PushTask(task);
+  }
+
+  size_t sum=0;
+
+  for (auto& future : futures) {
+    sum+=future.get();
+  }
+
+  stopClock.Stop();
+
+  queue.Stop();
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  std::cout << "WorkQueue:  " << benchmarkTaskCount << " tasks, " << workerCount << " workers: " << stopClock.ResultString() << " (" << sum << ")" << std::endl;
+
+  return sum;
+}
+
+/**
+ * Throughput of the work stealing ThreadPool
+ */
+static size_t BenchmarkThreadPool(size_t workerCount)
+{
+  osmscout::ThreadPool          pool(workerCount);
+  std::vector<std::future<int>> futures;
+  osmscout::StopClock           stopClock;
+
+  futures.reserve(benchmarkTaskCount);
+
+  for (size_t i=0; i<benchmarkTaskCount; i++) {
+    futures.push_back(pool.Submit(std::bind(BenchmarkWork,i)));
+  }
+
+  size_t sum=0;
+
+  for (auto& future : futures) {
+    sum+=future.get();
+  }
+
+  stopClock.Stop();
+
+  std::cout << "ThreadPool: " << benchmarkTaskCount << " tasks, " << workerCount << " workers: " << stopClock.ResultString() << " (" << sum << ")" << std::endl;
+
+  return sum;
+}
+
+/**
+ * Cancellation of queued ThreadPool tasks via a Breaker. Every task must either
+ * be executed with the correct result or be cancelled.
+ */
+static bool TestThreadPoolBreaker()
+{
+  osmscout::ThreadPool          pool(1);
+  osmscout::BreakerRef          breaker=std::make_shared<osmscout::ThreadedBreaker>();
+  std::vector<std::future<int>> futures;
+  size_t                        executed=0;
+  size_t                        cancelled=0;
+  bool                          success=true;
+
+  for (size_t i=0; i<1000; i++) {
+    futures.push_back(pool.Submit(std::bind(BenchmarkWork,i),breaker));
+  }
+
+  breaker->Break();
+
+  for (size_t i=0; i<futures.size(); i++) {
+    try {
+      if (futures[i].get()!=BenchmarkWork(i)) {
+        success=false;
+      }
+
+      executed++;
+    }
+    catch (const std::future_error&) {
+      cancelled++;
+    }
+  }
+
+  std::cout << "ThreadPool breaker: " << executed << " tasks executed, " << cancelled << " tasks cancelled" << std::endl;
+
+  return success &&
+         executed+cancelled==futures.size();
+}
+
+/**
+ * Jobs pushed concurrently from several threads outside the pool and from jobs
+ * within the pool must all be executed exactly once with the correct result.
+ */
+static bool TestThreadPoolConcurrentPush(size_t workerCount)
+{
+  static const size_t producerCount=4;
+  static const size_t jobsPerProducer=20000;
+
+  bool success=true;
+
+  for (size_t round=0; round<10; round++) {
+    osmscout::ThreadPool     pool(workerCount);
+    std::atomic<size_t>      executed(0);
+    std::vector<std::thread> producers;
+    std::vector<std::vector<std::future<size_t>>> futures(producerCount);
+
+    for (size_t p=0; p<producerCount; p++) {
+      producers.push_back(std::thread([&pool,&executed,&futures,p]() {
+        futures[p].reserve(jobsPerProducer);
+
+        for (size_t i=0; i<jobsPerProducer; i++) {
+          size_t value=p*jobsPerProducer+i;
+
+          futures[p].push_back(pool.Submit([&pool,&executed,value]() {
+            executed++;
+
+            // Every 100th job pushes a nested job from within the pool
+            if (value%100==0) {
+              pool.Push([&executed]() {
+                executed++;
+              });
+            }
+
+            return value*2;
+          }));
+        }
+      }));
+    }
+
+    for (auto& producer : producers) {
+      producer.join();
+    }
+
+    for (size_t p=0; p<producerCount; p++) {
+      for (size_t i=0; i<jobsPerProducer; i++) {
+        if (futures[p][i].get()!=(p*jobsPerProducer+i)*2) {
+          success=false;
+        }
+      }
+    }
+
+    pool.Stop();
+
+    if (executed!=producerCount*jobsPerProducer+producerCount*jobsPerProducer/100) {
+      std::cerr << "Round " << round << ": " << executed << " jobs executed" << std::endl;
+      success=false;
+    }
+  }
+
+  std::cout << "ThreadPool concurrent push: " << (success ? "OK" : "FAILED") << std::endl;
+
+  return success;
+}
+
+/**
+ * Queued jobs are still executed after Stop(), jobs pushed after Stop() are rejected
+ */
+static bool TestThreadPoolPushAfterStop()
+{
+  osmscout::ThreadPool          pool(2);
+  std::vector<std::future<int>> futures;
+  bool                          success=true;
+
+  for (size_t i=0; i<1000; i++) {
+    futures.push_back(pool.Submit(std::bind(BenchmarkWork,i)));
+  }
+
+  pool.Stop();
+
+  for (size_t i=0; i<futures.size(); i++) {
+    if (futures[i].wait_for(std::chrono::seconds(0))!=std::future_status::ready ||
+        futures[i].get()!=BenchmarkWork(i)) {
+      success=false;
+    }
+  }
+
+  if (pool.Push([]() {})) {
+    success=false;
+  }
+
+  std::future<int> rejected=pool.Submit(std::bind(BenchmarkWork,0));
+
+  if (rejected.wait_for(std::chrono::seconds(0))!=std::future_status::ready) {
+    success=false;
+  }
+  else {
+    try {
+      rejected.get();
+      success=false;
+    }
+    catch (const std::future_error&) {
+      // expected
+    }
+  }
+
+  std::cout << "ThreadPool push after stop: " << (success ? "OK" : "FAILED") << std::endl;
+
+  return success;
+}
+
+/**
+ * Stopping and destroying the pool from within one of its jobs must not dead lock
+ */
+static bool TestThreadPoolStopFromWorker()
+{
+  bool success=true;
+
+  {
+    osmscout::ThreadPool pool(2);
+    std::future<void>    stopped=pool.Submit([&pool]() {
+      pool.Stop();
+    });
+
+    if (stopped.wait_for(std::chrono::seconds(10))!=std::future_status::ready) {
+      std::cerr << "Stop() from a worker did not return" << std::endl;
+      return false;
+    }
+  }
+
+  std::shared_ptr<osmscout::ThreadPool> pool=std::make_shared<osmscout::ThreadPool>(2);
+  std::promise<void>                    destroyed;
+  std::future<void>                     destroyedFuture=destroyed.get_future();
+
+  pool->Push([&pool,&destroyed]() {
+    pool.reset();
+    destroyed.set_value();
+  });
+
+  if (destroyedFuture.wait_for(std::chrono::seconds(10))!=std::future_status::ready) {
+    std::cerr << "Destruction from a worker did not return" << std::endl;
+    success=false;
+  }
+
+  std::cout << "ThreadPool stop from worker: " << (success ? "OK" : "FAILED") << std::endl;
+
+  return success;
+}
+
+int main(int /*argc*/, char* /*argv*/[])
 {
   Worker                        worker;
   std::vector<std::future<int>> futures;
+  size_t                        errors=0;
 
   std::cout << std::this_thread::get_id() << ": Pushing work..." << std::endl;
   for (size_t i=1; i<=100; i++) {
@@ -92,18 +392,60 @@ int main(int argc, char* argv[])
 
   std::cout << "Waiting for futures..." << std::endl;
 
-  for (auto& future : futures) {
+  for (size_t i=1; i<=futures.size(); i++) {
+    std::future<int>& future=futures[i-1];
+
     future.wait();
 
-    std::cout << "Result: " << future.get() << std::endl;
+    int result=future.get();
+
+    std::cout << "Result: " << result << std::endl;
+
+    if (result!=(int)(i+i*2)) {
+      std::cerr << "Wrong result for task #" << i << std::endl;
+      errors++;
+    }
   }
 
   std::cout << "Signaling worker stop..." << std::endl;
   worker.Stop();
 
-  std::cout << "Waiting for 1 seconds..." << std::endl;
+  size_t workerCount=std::max(2u,std::thread::hardware_concurrency());
+
+  std::cout << "Running throughput benchmark..." << std::endl;
 
-  std::this_thread::sleep_for (std::chrono::seconds(1));
+  size_t expectedSum=GetExpectedBenchmarkSum();
+
+  if (BenchmarkWorkQueue(workerCount)!=expectedSum) {
+    std::cerr << "WorkQueue returned wrong results" << std::endl;
+    errors++;
+  }
+
+  if (BenchmarkThreadPool(workerCount)!=expectedSum) {
+    std::cerr << "ThreadPool returned wrong results" << std::endl;
+    errors++;
+  }
+
+  if (!TestThreadPoolBreaker()) {
+    errors++;
+  }
+
+  if (!TestThreadPoolConcurrentPush(workerCount)) {
+    errors++;
+  }
+
+  if (!TestThreadPoolPushAfterStop()) {
+    errors++;
+  }
+
+  if (!TestThreadPoolStopFromWorker()) {
+    errors++;
+  }
+
+  if (errors>0) {
+    std::cerr << errors << " error(s)" << std::endl;
+    return 1;
+  }
 
   std::cout << "Bye" << std::endl;
 
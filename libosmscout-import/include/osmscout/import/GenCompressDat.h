@@ -0,0 +1,49 @@
+#ifndef OSMSCOUT_IMPORT_GENCOMPRESSDAT_H
+#define OSMSCOUT_IMPORT_GENCOMPRESSDAT_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2016  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/Import.h>
+
+namespace osmscout {
+
+  /**
+   * Replaces the node, way, area and route data files by block compressed
+   * copies, if enabled by ImportParameter::SetCompressDataFiles(). Must run after all
+   * other modules, since it rewrites files other modules read.
+   */
+  class CompressDataGenerator : public ImportModule
+  {
+  private:
+    bool CompressDataFile(const ImportParameter& parameter,
+                          Progress& progress,
+                          const std::string& filename);
+
+  public:
+    void GetDescription(const ImportParameter& parameter,
+                        ImportModuleDescription& description) const;
+
+    bool Import(const TypeConfigRef& typeConfig,
+                const ImportParameter& parameter,
+                Progress& progress);
+  };
+}
+
+#endif
@@ -28,8 +28,11 @@
 #include <osmscout/Area.h>
 #include <osmscout/Way.h>
 
+#include <osmscout/LocationIndex.h>
 #include <osmscout/ObjectRef.h>
 
+#include <osmscout/util/GeoBox.h>
+
 #include <osmscout/import/Import.h>
 
 namespace osmscout {
@@ -53,8 +56,9 @@ namespace osmscout {
      */
     struct RegionPOI
     {
-      ObjectFileRef object; //!< Object
-      std::string   name;   //!< Name of the POI
+      ObjectFileRef object;     //!< Object
+      std::string   name;       //!< Name of the POI
+      FileOffset    dataOffset; //!< Offset of the POI entry in the index file
 
       bool operator<(const RegionPOI& other) const
       {
@@ -75,6 +79,7 @@ namespace osmscout {
 
     struct RegionLocation
     {
+      FileOffset               dataOffset;    //!< Offset of the location entry in the index file
       FileOffset               addressOffset; //!< Offset of place where the address list offset is stored
       std::list<ObjectFileRef> objects;       //!< Objects that represent this location
       std::list<RegionAddress> addresses;     //!< Addresses at this location
@@ -158,6 +163,41 @@ namespace osmscout {
                                  const GeoCoord& coord) const;
     };
 
+    /**
+     * A region, whose boundary crosses a cell of the region lookup index
+     */
+    struct RegionLookupCandidate
+    {
+      FileOffset                          regionOffset; //!< Offset of the region in the index file
+      bool                                centerInside; //!< The center of the cell is within the region area
+      std::vector<std::vector<GeoCoord> > runs;         //!< Consecutive boundary segments touching the cell
+    };
+
+    /**
+     * A cell of the region lookup index
+     */
+    struct RegionLookupCell
+    {
+      std::vector<FileOffset>            regionOffsets; //!< Regions completely containing the cell
+      std::vector<RegionLookupCandidate> candidates;    //!< Regions, whose boundary crosses the cell
+    };
+
+    /**
+     * Grid of cells over the bounding box of all regions
+     */
+    struct RegionLookupGrid
+    {
+      uint32_t                      level;
+      uint32_t                      cellXStart;
+      uint32_t                      cellXEnd;
+      uint32_t                      cellYStart;
+      uint32_t                      cellYEnd;
+      uint32_t                      cellXCount;
+      double                        cellWidth;
+      double                        cellHeight;
+      std::vector<RegionLookupCell> cells;
+    };
+
     /**
      * Reference to an area
      */
@@ -387,6 +427,27 @@ namespace osmscout {
     void WriteAddressData(FileWriter& writer,
                           Region& root);
 
+    void CollectTokenEntries(const Region& region,
+                             std::unordered_map<std::string,std::vector<LocationIndex::TokenEntry> >& tokenEntries);
+
+    void WriteTokenIndex(const std::string& filename,
+                         const Region& rootRegion,
+                         Progress& progress);
+
+    void GetRegionBoundingBox(const Region& region,
+                              GeoBox& boundingBox);
+
+    void IndexRegionLookupArea(RegionLookupGrid& grid,
+                               FileOffset regionOffset,
+                               const std::vector<GeoCoord>& nodes);
+
+    void IndexRegionLookupCells(RegionLookupGrid& grid,
+                                const Region& region);
+
+    void WriteRegionLookupIndex(const std::string& filename,
+                                const Region& rootRegion,
+                                Progress& progress);
+
   public:
     void GetDescription(const ImportParameter& parameter,
                         ImportModuleDescription& description) const;
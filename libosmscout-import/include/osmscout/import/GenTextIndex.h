@@ -57,6 +57,8 @@ namespace osmscout
                               Progress &progress,
                               const TypeConfig &typeConfig);
 
+    std::string GetKeysetCharacters(const marisa::Keyset& keyset) const;
+
     bool BuildKeyStr(const std::string &text,
                      const FileOffset offset,
                      const RefType reftype,
@@ -142,6 +142,14 @@ namespace osmscout {
     bool                         assumeLand;               //<! During sea/land detection,we either trust coastlines only or make some
                                                            //<! assumptions which tiles are sea and which are land.
 
+    bool                         rtreeIndex;               //<! Generate the optional R-tree indexes for nodes, ways and areas
+    size_t                       rtreeNodeSize;            //<! Maximum number of children of a R-tree node
+
+    bool                         poiNameIndex;             //<! Generate the optional index of POIs and their names by location
+
+    bool                         compressDataFiles;        //<! Store node, way, area and route data files block compressed
+    size_t                       compressionBlockSize;     //<! Uncompressed size of a block of compressed data files
+
   public:
     ImportParameter();
 
@@ -202,6 +210,14 @@ namespace osmscout {
 
     bool GetAssumeLand() const;
 
+    bool GetRTreeIndex() const;
+    size_t GetRTreeNodeSize() const;
+
+    bool GetPOINameIndex() const;
+
+    bool GetCompressDataFiles() const;
+    size_t GetCompressionBlockSize() const;
+
     void SetMapfiles(const std::list<std::string>& mapfile);
     void SetTypefile(const std::string& typefile);
     void SetDestinationDirectory(const std::string& destinationDirectory);
@@ -261,6 +277,14 @@ namespace osmscout {
     void SetRouteNodeBlockSize(size_t blockSize);
 
     void SetAssumeLand(bool assumeLand);
+
+    void SetRTreeIndex(bool rtreeIndex);
+    void SetRTreeNodeSize(size_t rtreeNodeSize);
+
+    void SetPOINameIndex(bool poiNameIndex);
+
+    void SetCompressDataFiles(bool compressDataFiles);
+    void SetCompressionBlockSize(size_t compressionBlockSize);
   };
 
   class OSMSCOUT_IMPORT_API ImportModuleDescription
@@ -0,0 +1,134 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2016  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/GenCompressDat.h>
+
+#include <limits>
+
+#include <osmscout/AreaDataFile.h>
+#include <osmscout/NodeDataFile.h>
+#include <osmscout/WayDataFile.h>
+
+#include <osmscout/util/BlockCompression.h>
+#include <osmscout/util/File.h>
+#include <osmscout/util/String.h>
+
+namespace osmscout {
+
+  void CompressDataGenerator::GetDescription(const ImportParameter& parameter,
+                                             ImportModuleDescription& description) const
+  {
+    description.SetName("CompressDataGenerator");
+    description.SetDescription("Block compress data files");
+
+    description.AddRequiredFile(NodeDataFile::NODES_DAT);
+    description.AddRequiredFile(WayDataFile::WAYS_DAT);
+    description.AddRequiredFile(AreaDataFile::AREAS_DAT);
+
+    for (const auto& router : parameter.GetRouter()) {
+      description.AddRequiredFile(router.GetDataFilename());
+    }
+  }
+
+  bool CompressDataGenerator::CompressDataFile(const ImportParameter& parameter,
+                                               Progress& progress,
+                                               const std::string& filename)
+  {
+    std::string dataFilename=AppendFileToDir(parameter.GetDestinationDirectory(),
+                                             filename);
+    std::string tmpFilename=dataFilename+".tmp";
+
+    progress.SetAction("Compressing '"+filename+"'");
+
+    if (IsBlockCompressedFile(dataFilename)) {
+      progress.Info("File is already compressed");
+      return true;
+    }
+
+    FileOffset uncompressedSize=GetFileSize(dataFilename);
+
+    if (!CompressFile(dataFilename,
+                      tmpFilename,
+                      (uint32_t)parameter.GetCompressionBlockSize())) {
+      progress.Error("Cannot compress file '"+dataFilename+"'");
+      return false;
+    }
+
+    FileOffset compressedSize=GetFileSize(tmpFilename);
+
+    if (!RemoveFile(dataFilename)) {
+      progress.Error("Cannot delete file '"+dataFilename+"'");
+      return false;
+    }
+
+    if (!RenameFile(tmpFilename,
+                    dataFilename)) {
+      progress.Error("Cannot rename file '"+tmpFilename+"' to '"+dataFilename+"'");
+      return false;
+    }
+
+    progress.Info("Compressed "+NumberToString(uncompressedSize)+" to "+NumberToString(compressedSize)+" byte(s)");
+
+    return true;
+  }
+
+  bool CompressDataGenerator::Import(const TypeConfigRef& /*typeConfig*/,
+                                     const ImportParameter& parameter,
+                                     Progress& progress)
+  {
+    if (!parameter.GetCompressDataFiles()) {
+      progress.Info("Compression of data files is disabled");
+      return true;
+    }
+
+    if (!HasBlockCompressionSupport()) {
+      progress.Error("Compression of data files is not supported");
+      return false;
+    }
+
+    if (parameter.GetCompressionBlockSize()==0 ||
+        parameter.GetCompressionBlockSize()>std::numeric_limits<uint32_t>::max()) {
+      progress.Error("Compression block size must be in the range [1.."+
+                     NumberToString(std::numeric_limits<uint32_t>::max())+"]");
+      return false;
+    }
+
+    if (!CompressDataFile(parameter,
+                          progress,
+                          NodeDataFile::NODES_DAT) ||
+        !CompressDataFile(parameter,
+                          progress,
+                          WayDataFile::WAYS_DAT) ||
+        !CompressDataFile(parameter,
+                          progress,
+                          AreaDataFile::AREAS_DAT)) {
+      return false;
+    }
+
+    for (const auto& router : parameter.GetRouter()) {
+      if (!CompressDataFile(parameter,
+                            progress,
+                            router.GetDataFilename())) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+}
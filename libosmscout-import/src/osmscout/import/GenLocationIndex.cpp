@@ -19,6 +19,7 @@
 
 #include <osmscout/import/GenLocationIndex.h>
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <limits>
@@ -44,6 +45,7 @@
 #include <osmscout/util/FileWriter.h>
 #include <osmscout/util/GeoBox.h>
 #include <osmscout/util/Geometry.h>
+#include <osmscout/util/Number.h>
 #include <osmscout/util/String.h>
 
 #include <osmscout/import/SortWayDat.h>
@@ -53,6 +55,8 @@
 namespace osmscout {
 
   static const size_t REGION_INDEX_LEVEL=16;
+  static const size_t REGION_LOOKUP_INDEX_LEVEL=16;    //!< Finest cell level of the region lookup index
+  static const size_t REGION_LOOKUP_MAX_CELLS=1 << 20; //!< Maximum number of cells of the region lookup index
 
   LocationIndexGenerator::RegionRef LocationIndexGenerator::RegionIndex::GetRegionForNode(RegionRef& rootRegion,
                                                                                           const GeoCoord& coord) const
@@ -1721,7 +1725,9 @@ namespace osmscout {
 
     ObjectFileRefStreamWriter objectFileRefWriter(writer);
 
-    for (const auto& poi : region.pois) {
+    for (auto& poi : region.pois) {
+      poi.dataOffset=writer.GetPos();
+
       writer.Write(poi.name);
 
       objectFileRefWriter.Write(poi.object);
@@ -1731,6 +1737,8 @@ namespace osmscout {
     for (auto& location : region.locations) {
       location.second.objects.sort(ObjectFileRefByFileOffsetComparator());
 
+      location.second.dataOffset=writer.GetPos();
+
       writer.Write(location.first);
       writer.WriteNumber((uint32_t)location.second.objects.size()); // Number of objects
 
@@ -1807,6 +1815,448 @@ namespace osmscout {
     }
   }
 
+  void LocationIndexGenerator::CollectTokenEntries(const Region& region,
+                                                   std::unordered_map<std::string,std::vector<LocationIndex::TokenEntry> >& tokenEntries)
+  {
+    std::vector<std::string>  tokens;
+    LocationIndex::TokenEntry entry;
+
+    entry.type=LocationIndex::tokenRegion;
+    entry.offset=region.indexOffset;
+    entry.regionOffset=region.indexOffset;
+
+    LocationIndex::GetNameTokens(region.name,
+                                 tokens);
+
+    for (const auto& token : tokens) {
+      tokenEntries[token].push_back(entry);
+    }
+
+    for (const auto& alias : region.aliases) {
+      LocationIndex::GetNameTokens(alias.name,
+                                   tokens);
+
+      for (const auto& token : tokens) {
+        tokenEntries[token].push_back(entry);
+      }
+    }
+
+    for (const auto& poi : region.pois) {
+      LocationIndex::TokenEntry poiEntry;
+
+      poiEntry.type=LocationIndex::tokenPOI;
+      poiEntry.offset=poi.dataOffset;
+      poiEntry.regionOffset=region.indexOffset;
+      poiEntry.object=poi.object;
+
+      LocationIndex::GetNameTokens(poi.name,
+                                   tokens);
+
+      for (const auto& token : tokens) {
+        tokenEntries[token].push_back(poiEntry);
+      }
+    }
+
+    for (const auto& location : region.locations) {
+      LocationIndex::TokenEntry locationEntry;
+
+      locationEntry.type=LocationIndex::tokenLocation;
+      locationEntry.offset=location.second.dataOffset;
+      locationEntry.regionOffset=region.indexOffset;
+
+      LocationIndex::GetNameTokens(location.first,
+                                   tokens);
+
+      for (const auto& token : tokens) {
+        tokenEntries[token].push_back(locationEntry);
+      }
+    }
+
+    for (const auto& childRegion : region.regions) {
+      CollectTokenEntries(*childRegion,
+                          tokenEntries);
+    }
+  }
+
+  /**
+   * Write the token index for the already written location index. For each
+   * normalized token of a region, alias, POI or location name the list of entries
+   * is stored, the sorted token directory is placed at the end of the file.
+   */
+  void LocationIndexGenerator::WriteTokenIndex(const std::string& filename,
+                                               const Region& rootRegion,
+                                               Progress& progress)
+  {
+    std::unordered_map<std::string,std::vector<LocationIndex::TokenEntry> > tokenEntries;
+    std::vector<std::string>                                               tokens;
+    std::vector<FileOffset>                                                tokenEntryOffsets;
+    FileWriter                                                             writer;
+
+    for (const auto& childRegion : rootRegion.regions) {
+      CollectTokenEntries(*childRegion,
+                          tokenEntries);
+    }
+
+    tokens.reserve(tokenEntries.size());
+
+    for (const auto& entry : tokenEntries) {
+      tokens.push_back(entry.first);
+    }
+
+    std::sort(tokens.begin(),
+              tokens.end());
+
+    writer.Open(filename);
+
+    writer.WriteFileOffset(0);
+
+    tokenEntryOffsets.reserve(tokens.size());
+
+    for (const auto& token : tokens) {
+      std::vector<LocationIndex::TokenEntry>& entries=tokenEntries[token];
+
+      std::sort(entries.begin(),
+                entries.end());
+      entries.erase(std::unique(entries.begin(),
+                                entries.end()),
+                    entries.end());
+
+      tokenEntryOffsets.push_back(writer.GetPos());
+
+      writer.WriteNumber((uint32_t)entries.size());
+
+      for (const auto& entry : entries) {
+        writer.Write((uint8_t)entry.type);
+        writer.WriteNumber(entry.offset);
+        writer.WriteNumber(entry.regionOffset);
+
+        if (entry.type==LocationIndex::tokenPOI) {
+          writer.Write(entry.object);
+        }
+      }
+    }
+
+    FileOffset directoryOffset=writer.GetPos();
+
+    writer.WriteNumber((uint32_t)tokens.size());
+
+    for (size_t i=0; i<tokens.size(); i++) {
+      writer.Write(tokens[i]);
+      writer.WriteNumber(tokenEntryOffsets[i]);
+    }
+
+    writer.SetPos(0);
+    writer.WriteFileOffset(directoryOffset);
+
+    writer.Close();
+
+    progress.Info(NumberToString(tokens.size())+" token(s) written");
+  }
+
+  void LocationIndexGenerator::GetRegionBoundingBox(const Region& region,
+                                                    GeoBox& boundingBox)
+  {
+    if (!region.areas.empty()) {
+      GeoBox regionBox(GeoCoord(region.minlat,
+                                region.minlon),
+                       GeoCoord(region.maxlat,
+                                region.maxlon));
+
+      if (boundingBox.IsValid()) {
+        boundingBox.Include(regionBox);
+      }
+      else {
+        boundingBox=regionBox;
+      }
+    }
+
+    for (const auto& childRegion : region.regions) {
+      GetRegionBoundingBox(*childRegion,
+                           boundingBox);
+    }
+  }
+
+  /**
+   * Sort the given outer ring of a region into the cells of the region lookup grid.
+   * Cells crossed by the boundary get the region as candidate together with the
+   * crossing boundary segments, cells completely within the ring are labeled with
+   * the region.
+   */
+  void LocationIndexGenerator::IndexRegionLookupArea(RegionLookupGrid& grid,
+                                                     FileOffset regionOffset,
+                                                     const std::vector<GeoCoord>& nodes)
+  {
+    if (nodes.size()<3) {
+      return;
+    }
+
+    double minLat=nodes[0].GetLat();
+    double maxLat=nodes[0].GetLat();
+    double minLon=nodes[0].GetLon();
+    double maxLon=nodes[0].GetLon();
+
+    for (const auto& node : nodes) {
+      minLat=std::min(minLat,node.GetLat());
+      maxLat=std::max(maxLat,node.GetLat());
+      minLon=std::min(minLon,node.GetLon());
+      maxLon=std::max(maxLon,node.GetLon());
+    }
+
+    uint32_t cellXStart=std::max(grid.cellXStart,(uint32_t)floor((minLon+180.0)/grid.cellWidth));
+    uint32_t cellXEnd=std::min(grid.cellXEnd,(uint32_t)floor((maxLon+180.0)/grid.cellWidth));
+    uint32_t cellYStart=std::max(grid.cellYStart,(uint32_t)floor((minLat+90.0)/grid.cellHeight));
+    uint32_t cellYEnd=std::min(grid.cellYEnd,(uint32_t)floor((maxLat+90.0)/grid.cellHeight));
+
+    // Longitudes, where the boundary crosses the horizontal line through the cell centers of a row
+    std::vector<std::vector<double> >      crossings(cellYEnd-cellYStart+1);
+    // Index of all boundary segments touching a cell
+    std::map<size_t,std::vector<size_t> > cellSegments;
+
+    for (size_t i=0; i<nodes.size(); i++) {
+      const GeoCoord& a=nodes[i];
+      const GeoCoord& b=nodes[(i+1)%nodes.size()];
+      uint32_t        segmentYStart=std::max(cellYStart,(uint32_t)floor((std::min(a.GetLat(),b.GetLat())+90.0)/grid.cellHeight));
+      uint32_t        segmentYEnd=std::min(cellYEnd,(uint32_t)floor((std::max(a.GetLat(),b.GetLat())+90.0)/grid.cellHeight));
+
+      for (uint32_t y=segmentYStart; y<=segmentYEnd; y++) {
+        double rowMinLat=y*grid.cellHeight-90.0;
+        double rowMaxLat=(y+1)*grid.cellHeight-90.0;
+        double centerLat=(y+0.5)*grid.cellHeight-90.0;
+
+        // Same crossing rule as IsCoordInArea()
+        if ((a.GetLat()<=centerLat && centerLat<b.GetLat()) ||
+            (b.GetLat()<=centerLat && centerLat<a.GetLat())) {
+          crossings[y-cellYStart].push_back((b.GetLon()-a.GetLon())*(centerLat-a.GetLat())/(b.GetLat()-a.GetLat())+a.GetLon());
+        }
+
+        // Longitude range of the part of the segment within the row
+        double segmentMinLon;
+        double segmentMaxLon;
+
+        if (a.GetLat()==b.GetLat()) {
+          segmentMinLon=std::min(a.GetLon(),b.GetLon());
+          segmentMaxLon=std::max(a.GetLon(),b.GetLon());
+        }
+        else {
+          double startLat=std::max(rowMinLat,std::min(a.GetLat(),b.GetLat()));
+          double endLat=std::min(rowMaxLat,std::max(a.GetLat(),b.GetLat()));
+          double startLon=a.GetLon()+(b.GetLon()-a.GetLon())*(startLat-a.GetLat())/(b.GetLat()-a.GetLat());
+          double endLon=a.GetLon()+(b.GetLon()-a.GetLon())*(endLat-a.GetLat())/(b.GetLat()-a.GetLat());
+
+          segmentMinLon=std::max(std::min(startLon,endLon),std::min(a.GetLon(),b.GetLon()));
+          segmentMaxLon=std::min(std::max(startLon,endLon),std::max(a.GetLon(),b.GetLon()));
+        }
+
+        uint32_t segmentXStart=std::max(cellXStart,(uint32_t)floor((segmentMinLon+180.0)/grid.cellWidth));
+        uint32_t segmentXEnd=std::min(cellXEnd,(uint32_t)floor((segmentMaxLon+180.0)/grid.cellWidth));
+
+        for (uint32_t x=segmentXStart; x<=segmentXEnd; x++) {
+          std::vector<size_t>& segments=cellSegments[(y-grid.cellYStart)*grid.cellXCount+x-grid.cellXStart];
+
+          if (segments.empty() ||
+              segments.back()!=i) {
+            segments.push_back(i);
+          }
+        }
+      }
+    }
+
+    for (uint32_t y=cellYStart; y<=cellYEnd; y++) {
+      std::vector<double>& rowCrossings=crossings[y-cellYStart];
+      size_t               crossing=0;
+
+      std::sort(rowCrossings.begin(),
+                rowCrossings.end());
+
+      for (uint32_t x=cellXStart; x<=cellXEnd; x++) {
+        double centerLon=(x+0.5)*grid.cellWidth-180.0;
+        size_t cellIndex=(y-grid.cellYStart)*grid.cellXCount+x-grid.cellXStart;
+
+        while (crossing<rowCrossings.size() &&
+               rowCrossings[crossing]<=centerLon) {
+          crossing++;
+        }
+
+        // Inside, if there is an odd number of crossings east of the center
+        bool                                                   centerInside=(rowCrossings.size()-crossing)%2!=0;
+        std::map<size_t,std::vector<size_t> >::const_iterator segments=cellSegments.find(cellIndex);
+        RegionLookupCell&                                      cell=grid.cells[cellIndex];
+
+        if (segments==cellSegments.end()) {
+          if (centerInside) {
+            cell.regionOffsets.push_back(regionOffset);
+          }
+
+          continue;
+        }
+
+        RegionLookupCandidate candidate;
+
+        candidate.regionOffset=regionOffset;
+        candidate.centerInside=centerInside;
+
+        // Join consecutive segments to runs of nodes
+        for (size_t s=0; s<segments->second.size(); s++) {
+          size_t segment=segments->second[s];
+
+          if (s==0 ||
+              segments->second[s-1]+1!=segment) {
+            candidate.runs.push_back(std::vector<GeoCoord>());
+            candidate.runs.back().push_back(nodes[segment]);
+          }
+
+          candidate.runs.back().push_back(nodes[(segment+1)%nodes.size()]);
+        }
+
+        cell.candidates.push_back(candidate);
+      }
+    }
+  }
+
+  void LocationIndexGenerator::IndexRegionLookupCells(RegionLookupGrid& grid,
+                                                      const Region& region)
+  {
+    for (const auto& area : region.areas) {
+      IndexRegionLookupArea(grid,
+                            region.indexOffset,
+                            area);
+    }
+
+    for (const auto& childRegion : region.regions) {
+      IndexRegionLookupCells(grid,
+                             *childRegion);
+    }
+  }
+
+  /**
+   * Write the region lookup index for the already written location index. The index
+   * is a grid over the bounding box of all regions. Each cell holds the regions
+   * completely containing the cell and the regions, whose boundary crosses the cell,
+   * together with the crossing boundary segments and the information, if the center
+   * of the cell is within the region. This way a coordinate can be resolved to its
+   * regions by one cell lookup and a few segment intersection tests.
+   */
+  void LocationIndexGenerator::WriteRegionLookupIndex(const std::string& filename,
+                                                      const Region& rootRegion,
+                                                      Progress& progress)
+  {
+    RegionLookupGrid grid;
+    GeoBox           boundingBox;
+    FileWriter       writer;
+
+    GetRegionBoundingBox(rootRegion,
+                         boundingBox);
+
+    if (!boundingBox.IsValid()) {
+      boundingBox.Set(GeoCoord(0.0,0.0),
+                      GeoCoord(0.0,0.0));
+    }
+
+    // Use the finest level, that does not exceed the maximum number of cells
+    grid.level=REGION_LOOKUP_INDEX_LEVEL;
+
+    while (true) {
+      grid.cellWidth=360.0/pow(2.0,grid.level);
+      grid.cellHeight=180.0/pow(2.0,grid.level);
+      grid.cellXStart=(uint32_t)floor((boundingBox.GetMinLon()+180.0)/grid.cellWidth);
+      grid.cellXEnd=(uint32_t)floor((boundingBox.GetMaxLon()+180.0)/grid.cellWidth);
+      grid.cellYStart=(uint32_t)floor((boundingBox.GetMinLat()+90.0)/grid.cellHeight);
+      grid.cellYEnd=(uint32_t)floor((boundingBox.GetMaxLat()+90.0)/grid.cellHeight);
+      grid.cellXCount=grid.cellXEnd-grid.cellXStart+1;
+
+      if (grid.level==0 ||
+          (size_t)grid.cellXCount*(grid.cellYEnd-grid.cellYStart+1)<=REGION_LOOKUP_MAX_CELLS) {
+        break;
+      }
+
+      grid.level--;
+    }
+
+    grid.cells.resize((size_t)grid.cellXCount*(grid.cellYEnd-grid.cellYStart+1));
+
+    for (const auto& childRegion : rootRegion.regions) {
+      IndexRegionLookupCells(grid,
+                             *childRegion);
+    }
+
+    std::map<std::vector<FileOffset>,FileOffset> labelEntryOffsets;
+    std::vector<FileOffset>                      cellEntryOffsets;
+    size_t                                       boundaryCellCount=0;
+
+    cellEntryOffsets.reserve(grid.cells.size());
+
+    writer.Open(filename);
+
+    writer.WriteFileOffset(0); // Offset of the cell table
+    writer.Write((uint8_t)0);  // Bytes per cell table entry
+
+    writer.WriteNumber(grid.level);
+    writer.WriteNumber(grid.cellXStart);
+    writer.WriteNumber(grid.cellXEnd);
+    writer.WriteNumber(grid.cellYStart);
+    writer.WriteNumber(grid.cellYEnd);
+
+    for (auto& cell : grid.cells) {
+      std::sort(cell.regionOffsets.begin(),
+                cell.regionOffsets.end());
+      cell.regionOffsets.erase(std::unique(cell.regionOffsets.begin(),
+                                           cell.regionOffsets.end()),
+                               cell.regionOffsets.end());
+
+      // Cells without boundaries share their entry with all cells of the same regions
+      if (cell.candidates.empty()) {
+        auto entry=labelEntryOffsets.find(cell.regionOffsets);
+
+        if (entry!=labelEntryOffsets.end()) {
+          cellEntryOffsets.push_back(entry->second);
+          continue;
+        }
+
+        labelEntryOffsets[cell.regionOffsets]=writer.GetPos();
+      }
+      else {
+        boundaryCellCount++;
+      }
+
+      cellEntryOffsets.push_back(writer.GetPos());
+
+      writer.WriteNumber((uint32_t)cell.regionOffsets.size());
+
+      for (const auto& regionOffset : cell.regionOffsets) {
+        writer.WriteNumber(regionOffset);
+      }
+
+      writer.WriteNumber((uint32_t)cell.candidates.size());
+
+      for (const auto& candidate : cell.candidates) {
+        writer.WriteNumber(candidate.regionOffset);
+        writer.Write(candidate.centerInside);
+        writer.WriteNumber((uint32_t)candidate.runs.size());
+
+        for (const auto& run : candidate.runs) {
+          writer.Write(run);
+        }
+      }
+    }
+
+    FileOffset tableOffset=writer.GetPos();
+    uint8_t    entryOffsetBytes=BytesNeededToEncodeNumber(tableOffset);
+
+    for (const auto& offset : cellEntryOffsets) {
+      writer.WriteFileOffset(offset,
+                             entryOffsetBytes);
+    }
+
+    writer.SetPos(0);
+    writer.WriteFileOffset(tableOffset);
+    writer.Write(entryOffsetBytes);
+
+    writer.Close();
+
+    progress.Info(NumberToString(grid.cells.size())+" cell(s) of level "+NumberToString(grid.level)+", "+
+                  NumberToString(boundaryCellCount)+" boundary cell(s) written");
+  }
+
   void LocationIndexGenerator::GetDescription(const ImportParameter& /*parameter*/,
                                               ImportModuleDescription& description) const
   {
@@ -1822,6 +2272,8 @@ namespace osmscout {
     description.AddRequiredFile(AreaAreaIndexGenerator::AREAADDRESS_DAT);
 
     description.AddProvidedFile(LocationIndex::FILENAME_LOCATION_IDX);
+    description.AddProvidedFile(LocationIndex::FILENAME_LOCATION_TOKEN_IDX);
+    description.AddProvidedFile(LocationIndex::FILENAME_LOCATION_REGION_IDX);
   }
 
   bool LocationIndexGenerator::Import(const TypeConfigRef& typeConfig,
@@ -2057,6 +2509,20 @@ namespace osmscout {
                        *rootRegion);
 
       writer.Close();
+
+      progress.SetAction(std::string("Write '")+LocationIndex::FILENAME_LOCATION_TOKEN_IDX+"'");
+
+      WriteTokenIndex(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                      LocationIndex::FILENAME_LOCATION_TOKEN_IDX),
+                      *rootRegion,
+                      progress);
+
+      progress.SetAction(std::string("Write '")+LocationIndex::FILENAME_LOCATION_REGION_IDX+"'");
+
+      WriteRegionLookupIndex(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                             LocationIndex::FILENAME_LOCATION_REGION_IDX),
+                             *rootRegion,
+                             progress);
     }
     catch (IOException& e) {
       progress.Error(e.GetDescription())                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                              ;
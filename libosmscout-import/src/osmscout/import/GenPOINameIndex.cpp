@@ -0,0 +1,327 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2016  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/GenPOINameIndex.h>
+
+#include <algorithm>
+
+#include <osmscout/AreaDataFile.h>
+#include <osmscout/NodeDataFile.h>
+#include <osmscout/ObjectView.h>
+#include <osmscout/POINameIndex.h>
+#include <osmscout/TypeFeatures.h>
+#include <osmscout/WayDataFile.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/Number.h>
+#include <osmscout/util/String.h>
+
+#include <osmscout/system/Math.h>
+
+namespace osmscout {
+
+  static const uint32_t POI_NAME_INDEX_LEVEL=14;          //!< Finest cell level of the POI name index
+  static const size_t   POI_NAME_INDEX_MAX_CELLS=1 << 22; //!< Maximum number of cells of the POI name index
+
+  /**
+   * A POI together with the cell it belongs to
+   */
+  struct POINameEntry
+  {
+    size_t      cell;
+    std::string name;
+    uint32_t    typeIndex;
+    RefType     refType;
+    FileOffset  offset;
+    GeoCoord    coord;
+
+    inline bool operator<(const POINameEntry& other) const
+    {
+      if (cell!=other.cell) {
+        return cell<other.cell;
+      }
+
+      return offset<other.offset;
+    }
+  };
+
+  static GeoCoord GetObjectCoord(const NodeView& node)
+  {
+    return node.GetCoords();
+  }
+
+  static GeoCoord GetObjectCoord(const WayView& way)
+  {
+    return way.GetBoundingBox().GetCenter();
+  }
+
+  static GeoCoord GetObjectCoord(const AreaView& area)
+  {
+    return area.GetBoundingBox().GetCenter();
+  }
+
+  /**
+   * Read the name, type, reference and coordinate of all POIs in the given data file.
+   *
+   * @throws IOException
+   */
+  template<class V>
+  static void ReadEntries(const TypeConfig& typeConfig,
+                          const std::string& filename,
+                          RefType refType,
+                          Progress& progress,
+                          std::vector<POINameEntry>& entries)
+  {
+    NameFeatureValueReader nameReader(typeConfig);
+    FileScanner            scanner;
+    uint32_t               dataCount;
+    V                      view;
+
+    scanner.Open(filename,
+                 FileScanner::Sequential,
+                 true);
+
+    scanner.Read(dataCount);
+
+    for (uint32_t d=1; d<=dataCount; d++) {
+      progress.SetProgress(d,dataCount);
+
+      view.Read(typeConfig,
+                scanner);
+
+      TypeInfoRef type=view.GetType();
+
+      if (type->GetIgnore() ||
+          !type->GetIndexAsPOI()) {
+        continue;
+      }
+
+      NameFeatureValue *nameValue=nameReader.GetValue(view.GetFeatureValueBuffer());
+      POINameEntry     entry;
+
+      if (nameValue!=NULL) {
+        entry.name=nameValue->GetName();
+      }
+
+      entry.cell=0;
+      entry.typeIndex=(uint32_t)type->GetIndex();
+      entry.refType=refType;
+      entry.offset=view.GetFileOffset();
+      entry.coord=GetObjectCoord(view);
+
+      entries.push_back(entry);
+    }
+
+    scanner.Close();
+  }
+
+  /**
+   * Write the index. The header holds the offset of the cell table and the grid
+   * dimensions, followed by the POIs of all non-empty cells and the table holding
+   * the offset of the data of each cell (0 for empty cells).
+   *
+   * @throws IOException
+   */
+  static void WriteIndex(const std::string& filename,
+                         std::vector<POINameEntry>& entries,
+                         Progress& progress)
+  {
+    GeoBox     boundingBox;
+    uint32_t   level=POI_NAME_INDEX_LEVEL;
+    uint32_t   cellXStart;
+    uint32_t   cellXEnd;
+    uint32_t   cellYStart;
+    uint32_t   cellYEnd;
+    size_t     cellXCount;
+    size_t     cellCount;
+    FileWriter writer;
+
+    if (entries.empty()) {
+      boundingBox.Set(GeoCoord(0.0,0.0),
+                      GeoCoord(0.0,0.0));
+    }
+    else {
+      boundingBox.Set(entries.front().coord,
+                      entries.front().coord);
+
+      for (const auto& entry : entries) {
+        boundingBox.Include(GeoBox(entry.coord,
+                                   entry.coord));
+      }
+    }
+
+    // Use the finest level, that does not exceed the maximum number of cells
+    while (true) {
+      double cellWidth=360.0/pow(2.0,level);
+      double cellHeight=180.0/pow(2.0,level);
+
+      cellXStart=(uint32_t)floor((boundingBox.GetMinLon()+180.0)/cellWidth);
+      cellXEnd=(uint32_t)floor((boundingBox.GetMaxLon()+180.0)/cellWidth);
+      cellYStart=(uint32_t)floor((boundingBox.GetMinLat()+90.0)/cellHeight);
+      cellYEnd=(uint32_t)floor((boundingBox.GetMaxLat()+90.0)/cellHeight);
+      cellXCount=cellXEnd-cellXStart+1;
+      cellCount=cellXCount*(cellYEnd-cellYStart+1);
+
+      if (level==0 ||
+          cellCount<=POI_NAME_INDEX_MAX_CELLS) {
+        for (auto& entry : entries) {
+          uint32_t x=(uint32_t)floor((entry.coord.GetLon()+180.0)/cellWidth);
+          uint32_t y=(uint32_t)floor((entry.coord.GetLat()+90.0)/cellHeight);
+
+          entry.cell=(y-cellYStart)*cellXCount+x-cellXStart;
+        }
+
+        break;
+      }
+
+      level--;
+    }
+
+    std::sort(entries.begin(),
+              entries.end());
+
+    std::vector<FileOffset> cellEntryOffsets(cellCount,0);
+    size_t                  usedCellCount=0;
+
+    writer.Open(filename);
+
+    writer.WriteFileOffset(0); // Offset of the cell table
+    writer.Write((uint8_t)0);  // Bytes per cell table entry
+
+    writer.WriteNumber(level);
+    writer.WriteNumber(cellXStart);
+    writer.WriteNumber(cellXEnd);
+    writer.WriteNumber(cellYStart);
+    writer.WriteNumber(cellYEnd);
+
+    auto cellStart=entries.begin();
+
+    while (cellStart!=entries.end()) {
+      auto cellEnd=cellStart;
+
+      while (cellEnd!=entries.end() &&
+             cellEnd->cell==cellStart->cell) {
+        ++cellEnd;
+      }
+
+      cellEntryOffsets[cellStart->cell]=writer.GetPos();
+      usedCellCount++;
+
+      writer.WriteNumber((uint32_t)(cellEnd-cellStart));
+
+      for (auto entry=cellStart; entry!=cellEnd; ++entry) {
+        writer.Write(entry->name);
+        writer.WriteNumber(entry->typeIndex);
+        writer.Write((uint8_t)entry->refType);
+        writer.WriteNumber(entry->offset);
+        writer.WriteCoord(entry->coord);
+      }
+
+      cellStart=cellEnd;
+    }
+
+    FileOffset tableOffset=writer.GetPos();
+    uint8_t    entryOffsetBytes=BytesNeededToEncodeNumber(tableOffset);
+
+    for (const auto& offset : cellEntryOffsets) {
+      writer.WriteFileOffset(offset,
+                             entryOffsetBytes);
+    }
+
+    writer.SetPos(0);
+    writer.WriteFileOffset(tableOffset);
+    writer.Write(entryOffsetBytes);
+
+    writer.Close();
+
+    progress.Info(NumberToString(entries.size())+" POI(s) in "+NumberToString(usedCellCount)+" of "+
+                  NumberToString(cellCount)+" cell(s) of level "+NumberToString(level)+" written");
+  }
+
+  void POINameIndexGenerator::GetDescription(const ImportParameter& parameter,
+                                             ImportModuleDescription& description) const
+  {
+    description.SetName("POINameIndexGenerator");
+    description.SetDescription("Generate index of POIs and their names by location");
+
+    description.AddRequiredFile(NodeDataFile::NODES_DAT);
+    description.AddRequiredFile(WayDataFile::WAYS_DAT);
+    description.AddRequiredFile(AreaDataFile::AREAS_DAT);
+
+    if (parameter.GetPOINameIndex()) {
+      description.AddProvidedFile(POINameIndex::FILENAME_POI_NAME_IDX);
+    }
+  }
+
+  bool POINameIndexGenerator::Import(const TypeConfigRef& typeConfig,
+                                     const ImportParameter& parameter,
+                                     Progress& progress)
+  {
+    if (!parameter.GetPOINameIndex()) {
+      progress.Info("Generation of POI name index is disabled");
+      return true;
+    }
+
+    std::vector<POINameEntry> entries;
+
+    try {
+      progress.SetAction("Scanning nodes");
+
+      ReadEntries<NodeView>(*typeConfig,
+                            AppendFileToDir(parameter.GetDestinationDirectory(),
+                                            NodeDataFile::NODES_DAT),
+                            refNode,
+                            progress,
+                            entries);
+
+      progress.SetAction("Scanning ways");
+
+      ReadEntries<WayView>(*typeConfig,
+                           AppendFileToDir(parameter.GetDestinationDirectory(),
+                                           WayDataFile::WAYS_DAT),
+                           refWay,
+                           progress,
+                           entries);
+
+      progress.SetAction("Scanning areas");
+
+      ReadEntries<AreaView>(*typeConfig,
+                            AppendFileToDir(parameter.GetDestinationDirectory(),
+                                            AreaDataFile::AREAS_DAT),
+                            refArea,
+                            progress,
+                            entries);
+
+      progress.SetAction("Generating '"+std::string(POINameIndex::FILENAME_POI_NAME_IDX)+"'");
+
+      WriteIndex(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                 POINameIndex::FILENAME_POI_NAME_IDX),
+                 entries,
+                 progress);
+    }
+    catch (IOException& e) {
+      progress.Error(e.GetDescription());
+      return false;
+    }
+
+    return true;
+  }
+}
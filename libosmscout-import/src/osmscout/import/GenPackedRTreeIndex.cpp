@@ -0,0 +1,306 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2016  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/GenPackedRTreeIndex.h>
+
+#include <algorithm>
+
+#include <osmscout/AreaDataFile.h>
+#include <osmscout/NodeDataFile.h>
+#include <osmscout/ObjectView.h>
+#include <osmscout/PackedRTreeIndex.h>
+#include <osmscout/WayDataFile.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/String.h>
+
+namespace osmscout {
+
+  /**
+   * Leaf entry of the tree together with its sort key
+   */
+  struct RTreeEntry
+  {
+    uint64_t              hilbertValue;
+    PackedRTreeIndex::Box box;
+    FileOffset            offset;
+    uint16_t              typeIndex;
+
+    inline bool operator<(const RTreeEntry& other) const
+    {
+      return hilbertValue<other.hilbertValue;
+    }
+  };
+
+  static const uint32_t hilbertOrder=16;
+
+  /**
+   * Return the distance of the given cell along a Hilbert curve filling
+   * a grid of 2^hilbertOrder x 2^hilbertOrder cells.
+   */
+  static uint64_t GetHilbertValue(uint32_t x,
+                                  uint32_t y)
+  {
+    uint32_t n=1u << hilbertOrder;
+    uint64_t value=0;
+
+    for (uint32_t s=n/2; s>0; s/=2) {
+      uint32_t rx=(x & s)>0 ? 1 : 0;
+      uint32_t ry=(y & s)>0 ? 1 : 0;
+
+      value+=(uint64_t)s*s*((3*rx)^ry);
+
+      if (ry==0) {
+        if (rx==1) {
+          x=n-1-x;
+          y=n-1-y;
+        }
+
+        std::swap(x,y);
+      }
+    }
+
+    return value;
+  }
+
+  static GeoBox GetObjectBoundingBox(const NodeView& node)
+  {
+    return GeoBox(node.GetCoords(),
+                  node.GetCoords());
+  }
+
+  static GeoBox GetObjectBoundingBox(const WayView& way)
+  {
+    return way.GetBoundingBox();
+  }
+
+  static GeoBox GetObjectBoundingBox(const AreaView& area)
+  {
+    return area.GetBoundingBox();
+  }
+
+  /**
+   * Read the type, bounding box and offset of all objects in the given data file.
+   *
+   * @throws IOException
+   */
+  template<class V>
+  static void ReadEntries(const TypeConfig& typeConfig,
+                          const std::string& filename,
+                          Progress& progress,
+                          std::vector<RTreeEntry>& entries)
+  {
+    FileScanner scanner;
+    uint32_t    dataCount;
+    V           view;
+    uint32_t    shift=27-hilbertOrder; // Fixed point coordinates use 27 bit
+
+    scanner.Open(filename,
+                 FileScanner::Sequential,
+                 true);
+
+    scanner.Read(dataCount);
+
+    entries.reserve(dataCount);
+
+    for (uint32_t d=1; d<=dataCount; d++) {
+      progress.SetProgress(d,dataCount);
+
+      view.Read(typeConfig,
+                scanner);
+
+      RTreeEntry entry;
+
+      entry.box=PackedRTreeIndex::Box::FromGeoBox(GetObjectBoundingBox(view));
+      entry.offset=view.GetFileOffset();
+      entry.typeIndex=(uint16_t)view.GetType()->GetIndex();
+
+      uint64_t latCenter=((uint64_t)entry.box.minLat+entry.box.maxLat)/2;
+      uint64_t lonCenter=((uint64_t)entry.box.minLon+entry.box.maxLon)/2;
+
+      entry.hilbertValue=GetHilbertValue((uint32_t)(lonCenter >> shift),
+                                         (uint32_t)(latCenter >> shift));
+
+      entries.push_back(entry);
+    }
+
+    scanner.Close();
+  }
+
+  /**
+   * Sort the given entries in Hilbert order, build the levels of the tree and
+   * write the tree in the format expected by PackedRTreeIndex.
+   *
+   * @throws IOException
+   */
+  static void WriteIndex(const std::string& filename,
+                         size_t nodeSize,
+                         std::vector<RTreeEntry>& entries)
+  {
+    std::vector<PackedRTreeIndex::Box> boxes;
+    std::vector<uint64_t>              levelEnds;
+    FileWriter                         writer;
+
+    std::sort(entries.begin(),
+              entries.end());
+
+    boxes.reserve(entries.size()+entries.size()/(nodeSize-1)+1);
+
+    for (const auto& entry : entries) {
+      boxes.push_back(entry.box);
+    }
+
+    if (!entries.empty()) {
+      levelEnds.push_back(boxes.size());
+    }
+
+    size_t levelStart=0;
+
+    while (!levelEnds.empty() &&
+           levelEnds.back()-levelStart>1) {
+      size_t levelEnd=(size_t)levelEnds.back();
+
+      for (size_t child=levelStart; child<levelEnd; child+=nodeSize) {
+        PackedRTreeIndex::Box box=boxes[child];
+
+        for (size_t i=child+1; i<std::min(child+nodeSize,levelEnd); i++) {
+          box.minLat=std::min(box.minLat,boxes[i].minLat);
+          box.minLon=std::min(box.minLon,boxes[i].minLon);
+          box.maxLat=std::max(box.maxLat,boxes[i].maxLat);
+          box.maxLon=std::max(box.maxLon,boxes[i].maxLon);
+        }
+
+        boxes.push_back(box);
+      }
+
+      levelStart=levelEnd;
+      levelEnds.push_back(boxes.size());
+    }
+
+    writer.Open(filename);
+
+    writer.Write((uint32_t)nodeSize);
+    writer.Write((uint32_t)levelEnds.size());
+    writer.Write((uint64_t)entries.size());
+
+    for (const auto& levelEnd : levelEnds) {
+      writer.Write(levelEnd);
+    }
+
+    for (const auto& box : boxes) {
+      writer.Write(box.minLat);
+      writer.Write(box.minLon);
+      writer.Write(box.maxLat);
+      writer.Write(box.maxLon);
+    }
+
+    for (const auto& entry : entries) {
+      writer.Write((uint64_t)entry.offset);
+    }
+
+    for (const auto& entry : entries) {
+      writer.Write(entry.typeIndex);
+    }
+
+    writer.Close();
+  }
+
+  template<class V>
+  static bool GenerateIndex(const TypeConfig& typeConfig,
+                            const ImportParameter& parameter,
+                            Progress& progress,
+                            const std::string& dataFilename,
+                            const std::string& indexFilename)
+  {
+    std::vector<RTreeEntry> entries;
+
+    progress.SetAction("Generating '"+indexFilename+"'");
+
+    try {
+      ReadEntries<V>(typeConfig,
+                     AppendFileToDir(parameter.GetDestinationDirectory(),
+                                     dataFilename),
+                     progress,
+                     entries);
+
+      WriteIndex(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                 indexFilename),
+                 parameter.GetRTreeNodeSize(),
+                 entries);
+    }
+    catch (IOException& e) {
+      progress.Error(e.GetDescription());
+      return false;
+    }
+
+    progress.Info(NumberToString(entries.size())+" object(s) indexed");
+
+    return true;
+  }
+
+  void PackedRTreeIndexGenerator::GetDescription(const ImportParameter& parameter,
+                                                 ImportModuleDescription& description) const
+  {
+    description.SetName("PackedRTreeIndexGenerator");
+    description.SetDescription("Generate R-tree indexes of nodes, ways and areas");
+
+    description.AddRequiredFile(NodeDataFile::NODES_DAT);
+    description.AddRequiredFile(WayDataFile::WAYS_DAT);
+    description.AddRequiredFile(AreaDataFile::AREAS_DAT);
+
+    if (parameter.GetRTreeIndex()) {
+      description.AddProvidedFile(PackedRTreeIndex::NODE_RTREE_IDX);
+      description.AddProvidedFile(PackedRTreeIndex::WAY_RTREE_IDX);
+      description.AddProvidedFile(PackedRTreeIndex::AREA_RTREE_IDX);
+    }
+  }
+
+  bool PackedRTreeIndexGenerator::Import(const TypeConfigRef& typeConfig,
+                                         const ImportParameter& parameter,
+                                         Progress& progress)
+  {
+    if (!parameter.GetRTreeIndex()) {
+      progress.Info("Generation of R-tree indexes is disabled");
+      return true;
+    }
+
+    if (parameter.GetRTreeNodeSize()<2) {
+      progress.Error("R-tree node size must be at least 2");
+      return false;
+    }
+
+    return GenerateIndex<NodeView>(*typeConfig,
+                                   parameter,
+                                   progress,
+                                   NodeDataFile::NODES_DAT,
+                                   PackedRTreeIndex::NODE_RTREE_IDX) &&
+           GenerateIndex<WayView>(*typeConfig,
+                                  parameter,
+                                  progress,
+                                  WayDataFile::WAYS_DAT,
+                                  PackedRTreeIndex::WAY_RTREE_IDX) &&
+           GenerateIndex<AreaView>(*typeConfig,
+                                   parameter,
+                                   progress,
+                                   AreaDataFile::AREAS_DAT,
+                                   PackedRTreeIndex::AREA_RTREE_IDX);
+  }
+}
@@ -17,6 +17,8 @@
  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
  */
 
+#include <set>
+
 #include <osmscout/ObjectRef.h>
 
 #include <osmscout/Node.h>
@@ -123,9 +125,19 @@ namespace osmscout
                                         TextSearchIndex::TEXT_OTHER_DAT));
 
     for(size_t i=0; i < keysets.size(); i++) {
-      // add sz_offset to the keyset
+      // Create a string holding all characters used
+      // by the texts of the trie, so that fuzzy searches
+      // know the possible children of a trie node
+      // 0x05: ENQ
+      std::string charactersStr;
+      charactersStr.push_back(5);
+      charactersStr+=GetKeysetCharacters(*keysets[i]);
+
+      // add sz_offset and the characters to the keyset
       keysets[i]->push_back(offsetSizeBytesStr.c_str(),
                             offsetSizeBytesStr.length());
+      keysets[i]->push_back(charactersStr.c_str(),
+                            charactersStr.length());
 
       marisa::Trie trie;
       try {
@@ -521,6 +533,40 @@ namespace osmscout
     return true;
   }
 
+  /**
+   * Return the concatenation of all distinct (UTF-8) characters
+   * used by the texts of the given keyset.
+   */
+  std::string TextIndexGenerator::GetKeysetCharacters(const marisa::Keyset& keyset) const
+  {
+    std::set<std::string>    characters;
+    std::vector<std::string> textCharacters;
+
+    for(size_t i=0; i < keyset.size(); i++) {
+      const marisa::Key& key=keyset[i];
+
+      // Each key ends with the ref type and the file offset
+      if(key.length() < (size_t)offsetSizeBytes+2) {
+        continue;
+      }
+
+      SplitUTF8String(std::string(key.ptr(),
+                                  key.length()-offsetSizeBytes-1),
+                      textCharacters);
+
+      characters.insert(textCharacters.begin(),
+                        textCharacters.end());
+    }
+
+    std::string result;
+
+    for(const auto& character : characters) {
+      result+=character;
+    }
+
+    return result;
+  }
+
   bool TextIndexGenerator::BuildKeyStr(const std::string &text,
                                        const FileOffset offset,
                                        const RefType reftype,
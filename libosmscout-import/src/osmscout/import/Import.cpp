@@ -73,6 +73,12 @@
 #include <osmscout/import/GenTextIndex.h>
 #endif
 
+#include <osmscout/import/GenPackedRTreeIndex.h>
+
+#include <osmscout/import/GenPOINameIndex.h>
+
+#include <osmscout/import/GenCompressDat.h>
+
 #include <osmscout/util/MemoryMonitor.h>
 #include <osmscout/util/Progress.h>
 #include <osmscout/util/StopClock.h>
@@ -81,9 +87,9 @@ namespace osmscout {
 
   static const size_t defaultStartStep=1;
 #if defined(OSMSCOUT_IMPORT_HAVE_LIB_MARISA)
-  static const size_t defaultEndStep=23;
+  static const size_t defaultEndStep=26;
 #else
-  static const size_t defaultEndStep=22;
+  static const size_t defaultEndStep=25;
 #endif
 
   ImportParameter::Router::Router(uint8_t vehicleMask,
@@ -130,7 +136,12 @@ namespace osmscout {
      optimizationCellSizeMax(255),
      optimizationWayMethod(TransPolygon::quality),
      routeNodeBlockSize(500000),
-     assumeLand(true)
+     assumeLand(true),
+     rtreeIndex(false),
+     rtreeNodeSize(16),
+     poiNameIndex(false),
+     compressDataFiles(false),
+     compressionBlockSize(65536)
   {
     // no code
   }
@@ -330,6 +341,31 @@ namespace osmscout {
     return assumeLand;
   }
 
+  bool ImportParameter::GetRTreeIndex() const
+  {
+    return rtreeIndex;
+  }
+
+  size_t ImportParameter::GetRTreeNodeSize() const
+  {
+    return rtreeNodeSize;
+  }
+
+  bool ImportParameter::GetPOINameIndex() const
+  {
+    return poiNameIndex;
+  }
+
+  bool ImportParameter::GetCompressDataFiles() const
+  {
+    return compressDataFiles;
+  }
+
+  size_t ImportParameter::GetCompressionBlockSize() const
+  {
+    return compressionBlockSize;
+  }
+
   void ImportParameter::SetMapfiles(const std::list<std::string>& mapfiles)
   {
     this->mapfiles=mapfiles;
@@ -535,6 +571,31 @@ namespace osmscout {
     this->assumeLand=assumeLand;
   }
 
+  void ImportParameter::SetRTreeIndex(bool rtreeIndex)
+  {
+    this->rtreeIndex=rtreeIndex;
+  }
+
+  void ImportParameter::SetRTreeNodeSize(size_t rtreeNodeSize)
+  {
+    this->rtreeNodeSize=rtreeNodeSize;
+  }
+
+  void ImportParameter::SetPOINameIndex(bool poiNameIndex)
+  {
+    this->poiNameIndex=poiNameIndex;
+  }
+
+  void ImportParameter::SetCompressDataFiles(bool compressDataFiles)
+  {
+    this->compressDataFiles=compressDataFiles;
+  }
+
+  void ImportParameter::SetCompressionBlockSize(size_t compressionBlockSize)
+  {
+    this->compressionBlockSize=compressionBlockSize;
+  }
+
   void ImportModuleDescription::SetName(const std::string& name)
   {
     this->name=name;
@@ -714,6 +775,15 @@ namespace osmscout {
     /* 23 */
     modules.push_back(std::make_shared<TextIndexGenerator>());
 #endif
+
+    /* 24 */
+    modules.push_back(std::make_shared<PackedRTreeIndexGenerator>());
+
+    /* 25 */
+    modules.push_back(std::make_shared<POINameIndexGenerator>());
+
+    /* 26 */
+    modules.push_back(std::make_shared<CompressDataGenerator>());
   }
 
   void Importer::DumpTypeConfigData(const TypeConfig& typeConfig,
@@ -255,6 +255,8 @@ namespace osmscout {
      */
     //@{
     TransBuffer                  transBuffer;       //!< Static (avoid reallocation) buffer of transformed coordinates
+    std::vector<GeoCoord>        decodedNodes;      //!< Static (avoid reallocation) buffer for lazily decoded nodes
+    std::vector<Id>              decodedIds;        //!< Static (avoid reallocation) buffer for lazily decoded ids
     //@}
 
     /**
@@ -322,6 +324,12 @@ namespace osmscout {
       Private draw algorithm implementation routines.
      */
     //@{
+    void TransformAreaRing(const Projection& projection,
+                           const MapParameter& parameter,
+                           const Area::Ring& ring,
+                           double errorTolerancePixel,
+                           PolyData& data);
+
     void PrepareAreas(const StyleConfig& styleConfig,
                       const Projection& projection,
                       const MapParameter& parameter,
@@ -330,10 +338,7 @@ namespace osmscout {
     void PrepareWaySegment(const StyleConfig& styleConfig,
                            const Projection& projection,
                            const MapParameter& parameter,
-                           const ObjectFileRef& ref,
-                           const FeatureValueBuffer& buffer,
-                           const std::vector<GeoCoord>& nodes,
-                           const std::vector<Id>& ids);
+                           const Way& way);
 
     void PrepareWays(const StyleConfig& styleConfig,
                      const Projection& projection,
@@ -408,10 +413,18 @@ namespace osmscout {
                        const std::vector<GeoCoord>& nodes,
                        double pixelOffset) const;
 
+    bool IsVisibleArea(const Projection& projection,
+                       const GeoBox& boundingBox,
+                       double pixelOffset) const;
+
     bool IsVisibleWay(const Projection& projection,
                       const std::vector<GeoCoord>& nodes,
                       double pixelOffset) const;
 
+    bool IsVisibleWay(const Projection& projection,
+                      const GeoBox& boundingBox,
+                      double pixelOffset) const;
+
     void Transform(const Projection& projection,
                    const MapParameter& parameter,
                    double lon,
@@ -20,6 +20,7 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <atomic>
 #include <list>
 #include <memory>
 #include <thread>
@@ -35,8 +36,9 @@
 
 #include <osmscout/util/Breaker.h>
 #include <osmscout/util/GeoBox.h>
+#include <osmscout/util/MemoryArena.h>
 #include <osmscout/util/StopClock.h>
-#include <osmscout/util/WorkQueue.h>
+#include <osmscout/util/ThreadPool.h>
 
 #include <osmscout/TiledDataCache.h>
 
@@ -110,20 +112,10 @@ namespace osmscout {
     mutable TiledDataCache       cache;                //!< Data cache
     TypeDefinitionRef            typeDefinition;       //<! Last used and cached TypeDefinition
 
-    mutable WorkQueue<bool>      nodeWorkerQueue;
-    std::thread                  nodeWorkerThread;
-
-    mutable WorkQueue<bool>      wayWorkerQueue;
-    std::thread                  wayWorkerThread;
-
-    mutable WorkQueue<bool>      wayLowZoomWorkerQueue;
-    std::thread                  wayLowZoomWorkerThread;
-
-    mutable WorkQueue<bool>      areaWorkerQueue;
-    std::thread                  areaWorkerThread;
-
-    mutable WorkQueue<bool>      areaLowZoomWorkerQueue;
-    std::thread                  areaLowZoomWorkerThread;
+    mutable ThreadPool           workerPool;           //!< Thread pool for data loading tasks of all tiles and object kinds
+    std::atomic<bool>            compactGeometry;      //!< Store loaded geometry in compact form
+    std::atomic<bool>            lazyGeometry;         //!< Load ways and areas without decoding their geometry
+    std::atomic<bool>            arenaAllocation;      //!< Allocate loaded objects from a per load MemoryArena
 
     CallbackId                   nextCallbackId;
     std::map<CallbackId,TileStateCallback> tileStateCallbacks;
@@ -135,6 +127,8 @@ namespace osmscout {
                                         const StyleConfig& styleConfig,
                                         const Magnification& magnification) const;
 
+    MemoryArenaRef CreateLoadArena() const;
+
     bool GetNodes(const AreaSearchParameter& parameter,
                   const TypeInfoSet& nodeTypes,
                   const GeoBox& boundingBox,
@@ -163,12 +157,6 @@ namespace osmscout {
                  const GeoBox& boundingBox,
                  const TileRef& tile) const;
 
-    void NodeWorkerLoop();
-    void WayWorkerLoop();
-    void WayLowZoomWorkerLoop();
-    void AreaWorkerLoop();
-    void AreaLowZoomWorkerLoop();
-
     std::future<bool> PushNodeTask(const AreaSearchParameter& parameter,
                                    const TypeInfoSet& nodeTypes,
                                    const GeoBox& boundingBox,
@@ -209,6 +197,13 @@ namespace osmscout {
     virtual ~MapService();
 
     void SetCacheSize(size_t cacheSize);
+    void SetCacheMemorySize(size_t cacheMemorySize);
+
+    TiledDataCache::Statistics GetCacheStatistics() const;
+
+    void SetCompactGeometry(bool compactGeometry);
+    void SetLazyGeometry(bool lazyGeometry);
+    void SetArenaAllocation(bool arenaAllocation);
 
     void FlushTileCache();
 
@@ -20,9 +20,10 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
-#include <map>
+#include <list>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include <osmscout/private/MapImportExport.h>
@@ -105,6 +106,26 @@ namespace osmscout {
     bool operator<(const TileId& other) const;
   };
 
+  /**
+   * \ingroup tiledcache
+   *
+   * Hash function for TileId, allowing TileIds as keys in unordered containers.
+   */
+  struct OSMSCOUT_MAP_API TileIdHasher
+  {
+    size_t operator()(const TileId& id) const;
+  };
+
+  /**
+   * \ingroup tiledcache
+   *
+   * Estimated number of bytes allocated by the given object. Used for accounting the
+   * memory consumption of tiles in the TiledDataCache.
+   */
+  extern OSMSCOUT_MAP_API size_t EstimateMemorySize(const Node& node);
+  extern OSMSCOUT_MAP_API size_t EstimateMemorySize(const Way& way);
+  extern OSMSCOUT_MAP_API size_t EstimateMemorySize(const Area& area);
+
   /**
    * \ingroup tiledcache
    *
@@ -118,18 +139,34 @@ namespace osmscout {
 
     TypeInfoSet        prefillTypes;
     std::vector<O>     prefillData;
+    size_t             prefillMemorySize;
 
     TypeInfoSet        types;
     std::vector<O>     data;
+    size_t             memorySize;
 
     bool               complete;
 
+  private:
+    static size_t EstimateMemorySize(const std::vector<O>& data)
+    {
+      size_t size=data.capacity()*sizeof(O);
+
+      for (const auto& object : data) {
+        size+=osmscout::EstimateMemorySize(*object);
+      }
+
+      return size;
+    }
+
   public:
     /**
      * Create an empty and unassigned TileData
      */
     TileData()
-    : complete(false)
+    : prefillMemorySize(0),
+      memorySize(0),
+      complete(false)
     {
       // no code
     }
@@ -144,6 +181,8 @@ namespace osmscout {
 
       this->prefillData=data;
       this->prefillTypes=types;
+
+      prefillMemorySize=EstimateMemorySize(this->prefillData);
     }
 
     /**
@@ -156,6 +195,8 @@ namespace osmscout {
 
       this->data=data;
       this->types=types;
+
+      memorySize=EstimateMemorySize(this->data);
     }
 
     void SetComplete()
@@ -175,6 +216,19 @@ namespace osmscout {
       return complete;
     }
 
+    /**
+     * Return the estimated number of bytes allocated for the prefill data and
+     * the data of the tile.
+     *
+     * Note that objects shared between tiles are accounted for in each tile.
+     */
+    size_t GetMemorySize() const
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+
+      return prefillMemorySize+memorySize;
+    }
+
     /**
      * Return the list of types of the prefill data stored in the tile.
      *
@@ -219,7 +273,7 @@ namespace osmscout {
     {
       std::lock_guard<std::mutex> guard(mutex);
 
-      return prefillData.size();
+      return data.size();
     }
 
     void CopyData(std::function<void(const O&)> function) const
@@ -376,7 +430,19 @@ namespace osmscout {
     }
 
     /**
-     * Return 'true' if no data at all has been assigned
+     * Return the estimated number of bytes allocated for the data of the tile
+     */
+    inline size_t GetMemorySize() const
+    {
+      return nodeData.GetMemorySize()+
+             wayData.GetMemorySize()+
+             areaData.GetMemorySize()+
+             optimizedWayData.GetMemorySize()+
+             optimizedAreaData.GetMemorySize();
+    }
+
+    /**
+     * Return 'true' if all data has been assigned
      */
     inline bool IsComplete() const
     {
@@ -411,15 +477,34 @@ namespace osmscout {
    * \ingroup tiledcache
    *
    * Data cache using tile based cache pages. The cache holds a number of of tiles. The
-   * maximum number of tiles hold can be configured. Tiles however will only be freed
-   * if a cleanup is explicitely triggered. So temporary overbooking can happen. This should
-   * assure that prefilling of tiles is possible even with a very low limit.
+   * maximum number of tiles and the maximum (estimated) memory size of the tiles hold can
+   * be configured. Tiles however will only be freed if a cleanup is explicitely triggered.
+   * So temporary overbooking can happen. This should assure that prefilling of tiles is
+   * possible even with a very low limit.
    *
-   * The cache will free least recently used tiles first,
+   * The cache will free least recently used tiles first. Tiles still referenced
+   * outside the cache are never freed.
    *
+   * All public methods are thread safe, so the cache can be shared between multiple
+   * loading and rendering threads.
    */
   class OSMSCOUT_MAP_API TiledDataCache
   {
+  public:
+    /**
+     * Statistics about the cache usage
+     */
+    struct OSMSCOUT_MAP_API Statistics
+    {
+      size_t tileCount;  //!< Number of tiles currently in the cache
+      size_t memorySize; //!< Estimated memory size of all tiles currently in the cache
+      size_t hits;       //!< Number of tile requests that returned an already cached tile
+      size_t misses;     //!< Number of tile requests that did not find a cached tile
+      size_t evictions;  //!< Number of tiles removed from the cache
+
+      Statistics();
+    };
+
   private:
     /**
      * Internaly used cache entry
@@ -427,11 +512,10 @@ namespace osmscout {
     struct OSMSCOUT_MAP_API CacheEntry
     {
       TileId  id;
-      //TileWeakRef tile;
       TileRef tile;
 
       CacheEntry(const TileId& id,
-                 const TileRef /*TileWeakRef*/& tile)
+                 const TileRef& tile)
               : id(id),
                 tile(tile)
       {
@@ -446,14 +530,25 @@ namespace osmscout {
     typedef Cache::iterator  CacheRef;
 
     //! An index from TileIds to cache entries
-    typedef std::map<TileId,CacheRef> CacheIndex;
+    typedef std::unordered_map<TileId,CacheRef,TileIdHasher> CacheIndex;
 
   private:
-    size_t             cacheSize;
+    mutable std::mutex mutex;           //!< Mutex protecting the cache state
+    size_t             cacheSize;       //!< Maximum number of tiles
+    size_t             cacheMemorySize; //!< Maximum estimated memory size in bytes, 0 for no limit
 
     mutable CacheIndex tileIndex;
     mutable Cache      tileCache;
 
+    mutable size_t     hits;
+    mutable size_t     misses;
+    size_t             evictions;
+
+  private:
+    TileRef GetTileInternal(const TileId& id) const;
+
+    void CleanupCacheInternal();
+
     void ResolveNodesFromParent(Tile& tile,
                                 const Tile& parentTile,
                                 const GeoBox& boundingBox,
@@ -478,9 +573,11 @@ namespace osmscout {
                                 const TypeInfoSet& areaTypes);
 
   public:
-    TiledDataCache(size_t cacheSize);
+    TiledDataCache(size_t cacheSize,
+                   size_t cacheMemorySize=0);
 
     void SetSize(size_t cacheSize);
+    void SetMemorySize(size_t cacheMemorySize);
 
     void CleanupCache();
 
@@ -497,6 +594,8 @@ namespace osmscout {
                               const TypeInfoSet& areaTypes,
                               const TypeInfoSet& optimizedWayTypes,
                               const TypeInfoSet& optimizedAreaTypes);
+
+    Statistics GetStatistics() const;
   };
 
   /**
@@ -166,7 +166,7 @@ namespace osmscout {
       DataStatistic& entry=statistics[way->GetType()];
 
       entry.wayCount++;
-      entry.coordCount+=way->nodes.size();
+      entry.coordCount+=way->GetNodeCount();
 
       PathShieldStyleRef shieldStyle;
       PathTextStyleRef   pathTextStyle;
@@ -191,7 +191,7 @@ namespace osmscout {
       DataStatistic& entry=statistics[way->GetType()];
 
       entry.wayCount++;
-      entry.coordCount+=way->nodes.size();
+      entry.coordCount+=way->GetNodeCount();
 
       PathShieldStyleRef shieldStyle;
       PathTextStyleRef   pathTextStyle;
@@ -218,7 +218,7 @@ namespace osmscout {
       entry.areaCount++;
 
       for (const auto& ring : area->rings) {
-        entry.coordCount+=ring.nodes.size();
+        entry.coordCount+=ring.GetNodeCount();
 
         if (ring.ring==Area::masterRingId) {
           IconStyleRef iconStyle;
@@ -247,7 +247,7 @@ namespace osmscout {
       entry.areaCount++;
 
       for (const auto& ring : area->rings) {
-        entry.coordCount+=ring.nodes.size();
+        entry.coordCount+=ring.GetNodeCount();
 
         if (ring.ring==Area::masterRingId) {
           IconStyleRef iconStyle;
@@ -300,18 +300,24 @@ namespace osmscout {
       return false;
     }
 
-    // Bounding box
-    double lonMin=nodes[0].GetLon();
-    double lonMax=lonMin;
-    double latMin=nodes[0].GetLat();
-    double latMax=latMin;
+    GeoBox boundingBox;
 
-    for (size_t i=1; i<nodes.size(); i++) {
-      lonMin=std::min(lonMin,nodes[i].GetLon());
-      lonMax=std::max(lonMax,nodes[i].GetLon());
-      latMin=std::min(latMin,nodes[i].GetLat());
-      latMax=std::max(latMax,nodes[i].GetLat());
-    }
+    osmscout::GetBoundingBox(nodes,
+                             boundingBox);
+
+    return IsVisibleArea(projection,
+                         boundingBox,
+                         pixelOffset);
+  }
+
+  bool MapPainter::IsVisibleArea(const Projection& projection,
+                                 const GeoBox& boundingBox,
+                                 double pixelOffset) const
+  {
+    double lonMin=boundingBox.GetMinLon();
+    double lonMax=boundingBox.GetMaxLon();
+    double latMin=boundingBox.GetMinLat();
+    double latMax=boundingBox.GetMaxLat();
 
     double x1;
     double x2;
@@ -358,18 +364,24 @@ namespace osmscout {
       return false;
     }
 
-    // Bounding box
-    double lonMin=nodes[0].GetLon();
-    double lonMax=lonMin;
-    double latMin=nodes[0].GetLat();
-    double latMax=latMin;
+    GeoBox boundingBox;
 
-    for (size_t i=1; i<nodes.size(); i++) {
-      lonMin=std::min(lonMin,nodes[i].GetLon());
-      lonMax=std::max(lonMax,nodes[i].GetLon());
-      latMin=std::min(latMin,nodes[i].GetLat());
-      latMax=std::max(latMax,nodes[i].GetLat());
-    }
+    osmscout::GetBoundingBox(nodes,
+                             boundingBox);
+
+    return IsVisibleWay(projection,
+                        boundingBox,
+                        pixelOffset);
+  }
+
+  bool MapPainter::IsVisibleWay(const Projection& projection,
+                                const GeoBox& boundingBox,
+                                double pixelOffset) const
+  {
+    double lonMin=boundingBox.GetMinLon();
+    double lonMax=boundingBox.GetMaxLon();
+    double latMin=boundingBox.GetMinLat();
+    double latMax=boundingBox.GetMaxLat();
 
     double x1;
     double x2;
@@ -1482,6 +1494,38 @@ namespace osmscout {
     }
   }
 
+  void MapPainter::TransformAreaRing(const Projection& projection,
+                                     const MapParameter& parameter,
+                                     const Area::Ring& ring,
+                                     double errorTolerancePixel,
+                                     PolyData& data)
+  {
+    if (ring.HasEncodedGeometry()) {
+      ring.DecodeGeometry(decodedNodes,
+                          decodedIds);
+
+      transBuffer.TransformArea(projection,
+                                parameter.GetOptimizeAreaNodes(),
+                                decodedNodes,
+                                data.transStart,data.transEnd,
+                                errorTolerancePixel);
+    }
+    else if (ring.HasCompactNodes()) {
+      transBuffer.TransformArea(projection,
+                                parameter.GetOptimizeAreaNodes(),
+                                ring.compactNodes,
+                                data.transStart,data.transEnd,
+                                errorTolerancePixel);
+    }
+    else {
+      transBuffer.TransformArea(projection,
+                                parameter.GetOptimizeAreaNodes(),
+                                ring.nodes,
+                                data.transStart,data.transEnd,
+                                errorTolerancePixel);
+    }
+  }
+
   void MapPainter::PrepareAreas(const StyleConfig& styleConfig,
                                 const Projection& projection,
                                 const MapParameter& parameter,
@@ -1495,19 +1539,7 @@ namespace osmscout {
     for (const auto& area : data.areas) {
       std::vector<PolyData> data(area->rings.size());
 
-      for (size_t i=0; i<area->rings.size(); i++) {
-        // The master ring does not have any nodes, skipping...
-        if (area->rings[i].ring==Area::masterRingId) {
-          continue;
-        }
-
-        transBuffer.TransformArea(projection,
-                                  parameter.GetOptimizeAreaNodes(),
-                                  area->rings[i].nodes,
-                                  data[i].transStart,data[i].transEnd,
-                                  errorTolerancePixel);
-      }
-
+      // Rings are only transformed if they are visible (or clip a visible ring)
       size_t ringId=Area::outerRingId;
       bool foundRing=true;
 
@@ -1542,12 +1574,54 @@ namespace osmscout {
 
             foundRing=true;
 
+            if (ring.GetNodeCount()==0) {
+              continue;
+            }
+
+            GeoBox ringBoundingBox;
+
+            if (ring.HasEncodedGeometry()) {
+              // Cull using the bounding box of the area stored in the data
+              // before paying for the decoding of the geometry
+              area->GetBoundingBox(ringBoundingBox);
+
+              if (!IsVisibleArea(projection,
+                                 ringBoundingBox,
+                                 fillStyle->GetBorderWidth()/2)) {
+                continue;
+              }
+
+              ring.DecodeGeometry(decodedNodes,
+                                  decodedIds);
+
+              osmscout::GetBoundingBox(decodedNodes,
+                                       ringBoundingBox);
+            }
+            else {
+              ring.GetBoundingBox(ringBoundingBox);
+            }
+
             if (!IsVisibleArea(projection,
-                               ring.nodes,
+                               ringBoundingBox,
                                fillStyle->GetBorderWidth()/2)) {
               continue;
             }
 
+            if (ring.HasEncodedGeometry()) {
+              transBuffer.TransformArea(projection,
+                                        parameter.GetOptimizeAreaNodes(),
+                                        decodedNodes,
+                                        data[i].transStart,data[i].transEnd,
+                                        errorTolerancePixel);
+            }
+            else {
+              TransformAreaRing(projection,
+                                parameter,
+                                ring,
+                                errorTolerancePixel,
+                                data[i]);
+            }
+
             AreaData a;
 
             // Collect possible clippings. We only take into account inner rings of the next level
@@ -1560,6 +1634,12 @@ namespace osmscout {
             while (j<area->rings.size() &&
                    area->rings[j].ring==ringId+1 &&
                    area->rings[j].GetType()->GetIgnore()) {
+              TransformAreaRing(projection,
+                                parameter,
+                                area->rings[j],
+                                errorTolerancePixel,
+                                data[j]);
+
               a.clippings.push_back(data[j]);
 
               j++;
@@ -1572,7 +1652,7 @@ namespace osmscout {
             a.transStart=data[i].transStart;
             a.transEnd=data[i].transEnd;
 
-            ring.GetBoundingBox(a.boundingBox);
+            a.boundingBox=ringBoundingBox;
 
             areaData.push_back(a);
 
@@ -1590,19 +1670,25 @@ namespace osmscout {
   void MapPainter::PrepareWaySegment(const StyleConfig& styleConfig,
                                      const Projection& projection,
                                      const MapParameter& parameter,
-                                     const ObjectFileRef& ref,
-                                     const FeatureValueBuffer& buffer,
-                                     const std::vector<GeoCoord>& nodes,
-                                     const std::vector<Id>& ids)
+                                     const Way& way)
   {
+    const ObjectFileRef       ref(way.GetFileOffset(),refWay);
+    const FeatureValueBuffer& buffer=way.GetFeatureValueBuffer();
+    const std::vector<Id>*    ids=&way.ids;
+
     styleConfig.GetWayLineStyles(buffer,
                                  projection,
                                  lineStyles);
 
-    if (lineStyles.empty()) {
+    if (lineStyles.empty() ||
+        way.GetNodeCount()==0) {
       return;
     }
 
+    GeoBox boundingBox;
+
+    way.GetBoundingBox(boundingBox);
+
     bool   transformed=false;
     size_t transStart=0; // Make the compiler happy
     size_t transEnd=0;   // Make the compiler happy
@@ -1649,18 +1735,41 @@ namespace osmscout {
       data.lineWidth=lineWidth;
 
       if (!IsVisibleWay(projection,
-                        nodes,
+                        boundingBox,
                         lineWidth/2)) {
         continue;
       }
 
       if (!transformed) {
-        transBuffer.TransformWay(projection,
-                                 parameter.GetOptimizeWayNodes(),
-                                 nodes,
-                                 transStart,
-                                 transEnd,
-                                 errorTolerancePixel);
+        if (way.HasEncodedGeometry()) {
+          way.DecodeGeometry(decodedNodes,
+                             decodedIds);
+
+          ids=&decodedIds;
+
+          transBuffer.TransformWay(projection,
+                                   parameter.GetOptimizeWayNodes(),
+                                   decodedNodes,
+                                   transStart,
+                                   transEnd,
+                                   errorTolerancePixel);
+        }
+        else if (way.HasCompactNodes()) {
+          transBuffer.TransformWay(projection,
+                                   parameter.GetOptimizeWayNodes(),
+                                   way.compactNodes,
+                                   transStart,
+                                   transEnd,
+                                   errorTolerancePixel);
+        }
+        else {
+          transBuffer.TransformWay(projection,
+                                   parameter.GetOptimizeWayNodes(),
+                                   way.nodes,
+                                   transStart,
+                                   transEnd,
+                                   errorTolerancePixel);
+        }
 
         WayPathData pathData;
 
@@ -1678,8 +1787,8 @@ namespace osmscout {
       data.buffer=&buffer;
       data.lineStyle=lineStyle;
       data.wayPriority=styleConfig.GetWayPrio(buffer.GetType());
-      data.startIsClosed=ids.empty() || ids[0]==0;
-      data.endIsClosed=ids.empty() || ids[ids.size()-1]==0;
+      data.startIsClosed=ids->empty() || ids->front()==0;
+      data.endIsClosed=ids->empty() || ids->back()==0;
 
       LayerFeatureValue *layerValue=layerReader.GetValue(buffer);
 
@@ -1715,20 +1824,14 @@ namespace osmscout {
       PrepareWaySegment(styleConfig,
                         projection,
                         parameter,
-                        ObjectFileRef(way->GetFileOffset(),refWay),
-                        way->GetFeatureValueBuffer(),
-                        way->nodes,
-                        way->ids);
+                        *way);
     }
 
     for (const auto& way : data.poiWays) {
       PrepareWaySegment(styleConfig,
                         projection,
                         parameter,
-                        ObjectFileRef(way->GetFileOffset(),refWay),
-                        way->GetFeatureValueBuffer(),
-                        way->nodes,
-                        way->ids);
+                        *way);
     }
 
     wayData.sort();
@@ -86,11 +86,12 @@ namespace osmscout {
   MapService::MapService(const DatabaseRef& database)
    : database(database),
      cache(25),
-     nodeWorkerThread(&MapService::NodeWorkerLoop,this),
-     wayWorkerThread(&MapService::WayWorkerLoop,this),
-     wayLowZoomWorkerThread(&MapService::WayLowZoomWorkerLoop,this),
-     areaWorkerThread(&MapService::AreaWorkerLoop,this),
-     areaLowZoomWorkerThread(&MapService::AreaLowZoomWorkerLoop,this),
+     // Loading is mostly I/O bound, so we use at least one thread per object kind,
+     // but scale with the number of available cores
+     workerPool(std::max(5u,std::thread::hardware_concurrency())),
+     compactGeometry(false),
+     lazyGeometry(false),
+     arenaAllocation(false),
      nextCallbackId(0)
   {
     // no code
@@ -98,33 +99,98 @@ namespace osmscout {
 
   MapService::~MapService()
   {
-    nodeWorkerQueue.Stop();
-    wayWorkerQueue.Stop();
-    wayLowZoomWorkerQueue.Stop();
-    areaWorkerQueue.Stop();
-    areaLowZoomWorkerQueue.Stop();
-
-    nodeWorkerThread.join();
-    wayWorkerThread.join();
-    wayLowZoomWorkerThread.join();
-    areaWorkerThread.join();
-    areaLowZoomWorkerThread.join();
+    workerPool.Stop();
   }
 
   /**
-   * Set the size of the tile data cache
+   * Set the size of the tile data cache (maximum number of tiles)
    */
   void MapService::SetCacheSize(size_t cacheSize)
   {
-    std::lock_guard<std::mutex> lock(stateMutex);
-
     cache.SetSize(cacheSize);
   }
 
-  void MapService::FlushTileCache()
+  /**
+   * Set the maximum (estimated) memory size of the tile data cache in bytes.
+   * Least recently used tiles are evicted if the limit is exceeded. A value
+   * of 0 disables the limit.
+   */
+  void MapService::SetCacheMemorySize(size_t cacheMemorySize)
   {
-    std::lock_guard<std::mutex> lock(stateMutex);
+    cache.SetMemorySize(cacheMemorySize);
+  }
+
+  /**
+   * Return statistics (size, hits, misses, evictions) of the tile data cache
+   */
+  TiledDataCache::Statistics MapService::GetCacheStatistics() const
+  {
+    return cache.GetStatistics();
+  }
+
+  /**
+   * If enabled, the coordinates of loaded ways and areas are stored in the compact
+   * fixed point representation (see Way::CompactNodes() and Area::CompactNodes()),
+   * halving the memory required for geometry in the tile data cache.
+   *
+   * MapPainter handles compacted objects transparently. Other code using the returned
+   * MapData must check HasCompactNodes() before accessing the nodes of an object.
+   * Only affects data loaded after the call.
+   */
+  void MapService::SetCompactGeometry(bool compactGeometry)
+  {
+    this->compactGeometry=compactGeometry;
+  }
 
+  /**
+   * If enabled, ways and areas are loaded without decoding their geometry (see
+   * Way::ReadLazy() and Area::ReadLazy()). MapPainter culls objects using the
+   * stored bounding box and only decodes the geometry of objects actually drawn.
+   *
+   * MapPainter handles lazily loaded objects transparently. Other code using the
+   * returned MapData must check HasEncodedGeometry() and decode the geometry into
+   * its own buffers (see Way::DecodeGeometry()) before accessing the nodes of an
+   * object, since the cached objects are shared. Only affects data loaded after the
+   * call.
+   */
+  void MapService::SetLazyGeometry(bool lazyGeometry)
+  {
+    this->lazyGeometry=lazyGeometry;
+  }
+
+  /**
+   * If enabled, the feature buffers and object instances loaded for one tile and
+   * object kind are carved from a per load MemoryArena instead of being allocated
+   * individually. The arena is freed as a whole after the last object loaded into
+   * it has been released (normally if the tile gets evicted from the cache).
+   *
+   * Note that every object keeps its complete arena alive. Objects, that are kept
+   * by the application after the MapData they were returned with has been dropped,
+   * should be copied using CopyOutOfArena(), else they pin the memory of all objects
+   * of the same kind loaded for their tile.
+   *
+   * Only affects data loaded after the call.
+   */
+  void MapService::SetArenaAllocation(bool arenaAllocation)
+  {
+    this->arenaAllocation=arenaAllocation;
+  }
+
+  /**
+   * Return a new arena for loading data, if arena allocation is enabled,
+   * else an empty reference.
+   */
+  MemoryArenaRef MapService::CreateLoadArena() const
+  {
+    if (arenaAllocation) {
+      return std::make_shared<MemoryArena>();
+    }
+
+    return MemoryArenaRef();
+  }
+
+  void MapService::FlushTileCache()
+  {
     cache.CleanupCache();
   }
 
@@ -221,14 +287,9 @@ namespace osmscout {
       }
 
       if (!offsets.empty()) {
-        // Sort offsets before loading to optimize disk access
-        std::sort(offsets.begin(),offsets.end());
-
-        if (parameter.IsAborted()) {
-          return false;
-        }
-
+        // Offsets are returned sorted by the index, so loading accesses the disk sequentially
         std::vector<NodeRef> nodes;
+        MemoryArenaScope     arenaScope(CreateLoadArena());
 
         if (!database->GetNodesByOffset(offsets,
                                         nodes)) {
@@ -285,6 +346,7 @@ namespace osmscout {
 
     if (!requestedAreaTypes.Empty()) {
       std::vector<AreaRef> areas;
+      MemoryArenaScope     arenaScope(CreateLoadArena());
 
       if (!optimizeAreasLowZoom->GetAreas(boundingBox,
                                           magnification,
@@ -299,6 +361,12 @@ namespace osmscout {
         return false;
       }
 
+      if (compactGeometry) {
+        for (auto& area : areas) {
+          area->CompactNodes();
+        }
+      }
+
       tile->GetOptimizedAreaData().SetData(loadedAreaTypes,std::move(areas));
     }
 
@@ -363,9 +431,11 @@ namespace osmscout {
         }
 
         std::vector<AreaRef> areas;
+        MemoryArenaScope     arenaScope(CreateLoadArena());
 
         if (!database->GetAreasByBlockSpans(spans,
-                                            areas)) {
+                                            areas,
+                                            lazyGeometry)) {
           log.Error() << "Error reading areas in area!";
           return false;
         }
@@ -374,6 +444,12 @@ namespace osmscout {
           return false;
         }
 
+        if (compactGeometry) {
+          for (auto& area : areas) {
+            area->CompactNodes();
+          }
+        }
+
         tile->GetAreaData().SetData(loadedAreaTypes,std::move(areas));
       }
     }
@@ -419,6 +495,7 @@ namespace osmscout {
 
     if (!requestedWayTypes.Empty()) {
       std::vector<WayRef> ways;
+      MemoryArenaScope    arenaScope(CreateLoadArena());
 
       if (!optimizeWaysLowZoom->GetWays(boundingBox,
                                         magnification,
@@ -433,6 +510,12 @@ namespace osmscout {
         return false;
       }
 
+      if (compactGeometry) {
+        for (auto& way : ways) {
+          way->CompactNodes();
+        }
+      }
+
       tile->GetOptimizedWayData().SetData(loadedWayTypes,std::move(ways));
     }
 
@@ -485,17 +568,13 @@ namespace osmscout {
       }
 
       if (!offsets.empty()) {
-        // Sort offsets before loading to optimize disk access
-        std::sort(offsets.begin(),offsets.end());
-
-        if (parameter.IsAborted()) {
-          return false;
-        }
-
+        // Offsets are returned sorted by the index, so loading accesses the disk sequentially
         std::vector<WayRef> ways;
+        MemoryArenaScope    arenaScope(CreateLoadArena());
 
         if (!database->GetWaysByOffset(offsets,
-                                       ways)) {
+                                       ways,
+                                       lazyGeometry)) {
           log.Error() << "Error reading ways in area!";
           return false;
         }
@@ -504,6 +583,12 @@ namespace osmscout {
           return false;
         }
 
+        if (compactGeometry) {
+          for (auto& way : ways) {
+            way->CompactNodes();
+          }
+        }
+
         tile->GetWayData().SetData(loadedWayTypes,std::move(ways));
       }
     }
@@ -515,63 +600,12 @@ namespace osmscout {
     return !parameter.IsAborted();
   }
 
-  void MapService::NodeWorkerLoop()
-  {
-    std::packaged_task<bool()> task;
-
-    while (nodeWorkerQueue.PopTask(task)) {
-      task();
-    }
-  }
-
-  void MapService::WayWorkerLoop()
-  {
-    std::packaged_task<bool()> task;
-
-    while (wayWorkerQueue.PopTask(task)) {
-      task();
-    }
-  }
-
-  void MapService::WayLowZoomWorkerLoop()
-  {
-    std::packaged_task<bool()> task;
-
-    while (wayLowZoomWorkerQueue.PopTask(task)) {
-      task();
-    }
-  }
-
-  void MapService::AreaWorkerLoop()
-  {
-    std::packaged_task<bool()> task;
-
-    while (areaWorkerQueue.PopTask(task)) {
-      task();
-    }
-  }
-
-  void MapService::AreaLowZoomWorkerLoop()
-  {
-    std::packaged_task<bool()> task;
-
-    while (areaLowZoomWorkerQueue.PopTask(task)) {
-      task();
-    }
-  }
-
   std::future<bool> MapService::PushNodeTask(const AreaSearchParameter& parameter,
                                              const TypeInfoSet& nodeTypes,
                                              const GeoBox& boundingBox,
                                              const TileRef& tile) const
   {
-    std::packaged_task<bool()> task(std::bind(&MapService::GetNodes,this,parameter,nodeTypes,boundingBox,tile));
-
-    std::future<bool> future=task.get_future();
-
-    nodeWorkerQueue.PushTask(task);
-
-    return future;
+    return workerPool.Submit(std::bind(&MapService::GetNodes,this,parameter,nodeTypes,boundingBox,tile));
   }
 
   std::future<bool> MapService::PushAreaLowZoomTask(const AreaSearchParameter& parameter,
@@ -580,13 +614,7 @@ namespace osmscout {
                                                     const GeoBox& boundingBox,
                                                     const TileRef& tile) const
   {
-    std::packaged_task<bool()> task(std::bind(&MapService::GetAreasLowZoom,this,parameter,areaTypes,magnification,boundingBox,tile));
-
-    std::future<bool> future=task.get_future();
-
-    areaLowZoomWorkerQueue.PushTask(task);
-
-    return future;
+    return workerPool.Submit(std::bind(&MapService::GetAreasLowZoom,this,parameter,areaTypes,magnification,boundingBox,tile));
   }
 
   std::future<bool> MapService::PushAreaTask(const AreaSearchParameter& parameter,
@@ -595,13 +623,7 @@ namespace osmscout {
                                              const GeoBox& boundingBox,
                                              const TileRef& tile) const
   {
-    std::packaged_task<bool()> task(std::bind(&MapService::GetAreas,this,parameter,areaTypes,magnification,boundingBox,tile));
-
-    std::future<bool> future=task.get_future();
-
-    areaWorkerQueue.PushTask(task);
-
-    return future;
+    return workerPool.Submit(std::bind(&MapService::GetAreas,this,parameter,areaTypes,magnification,boundingBox,tile));
   }
 
   std::future<bool> MapService::PushWayLowZoomTask(const AreaSearchParameter& parameter,
@@ -610,14 +632,8 @@ namespace osmscout {
                                                    const GeoBox& boundingBox,
                                                    const TileRef& tile) const
   {
-    std::packaged_task<bool()> task(std::bind(&MapService::GetWaysLowZoom,this,parameter,
-                                              wayTypes,magnification,boundingBox,tile));
-
-    std::future<bool> future=task.get_future();
-
-    wayLowZoomWorkerQueue.PushTask(task);
-
-    return future;
+    return workerPool.Submit(std::bind(&MapService::GetWaysLowZoom,this,parameter,
+                                       wayTypes,magnification,boundingBox,tile));
   }
 
   std::future<bool> MapService::PushWayTask(const AreaSearchParameter& parameter,
@@ -625,14 +641,8 @@ namespace osmscout {
                                             const GeoBox& boundingBox,
                                             const TileRef& tile) const
   {
-    std::packaged_task<bool()> task(std::bind(&MapService::GetWays,this,parameter,
-                                              wayTypes,boundingBox,tile));
-
-    std::future<bool> future=task.get_future();
-
-    wayWorkerQueue.PushTask(task);
-
-    return future;
+    return workerPool.Submit(std::bind(&MapService::GetWays,this,parameter,
+                                       wayTypes,boundingBox,tile));
   }
 
   void MapService::NotifyTileStateCallbacks(const TileRef& tile) const
@@ -868,6 +878,9 @@ namespace osmscout {
 
   /**
    * Convert the data hold by the given tiles to the given MapData class instance.
+   *
+   * If arena allocation is enabled, the returned objects share the arenas of
+   * their tiles (see SetArenaAllocation()).
    */
   void MapService::ConvertTilesToMapData(std::list<TileRef>& tiles,
                                          MapData& data) const
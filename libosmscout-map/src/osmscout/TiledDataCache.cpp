@@ -106,6 +106,58 @@ namespace osmscout {
     return x<other.x;
   }
 
+  size_t TileIdHasher::operator()(const TileId& id) const
+  {
+    size_t hash=id.GetLevel();
+
+    hash=hash*31+id.GetX();
+    hash=hash*31+id.GetY();
+
+    return hash;
+  }
+
+  static size_t EstimateMemorySize(const FeatureValueBuffer& buffer)
+  {
+    TypeInfoRef type=buffer.GetType();
+
+    if (!type) {
+      return 0;
+    }
+
+    return type->GetFeatureMaskBytes()+type->GetFeatureValueBufferSize();
+  }
+
+  size_t EstimateMemorySize(const Node& node)
+  {
+    return sizeof(Node)+
+           EstimateMemorySize(node.GetFeatureValueBuffer());
+  }
+
+  size_t EstimateMemorySize(const Way& way)
+  {
+    return sizeof(Way)+
+           EstimateMemorySize(way.GetFeatureValueBuffer())+
+           way.ids.capacity()*sizeof(Id)+
+           way.nodes.capacity()*sizeof(GeoCoord)+
+           way.compactNodes.GetMemorySize()+
+           way.GetEncodedGeometryMemorySize();
+  }
+
+  size_t EstimateMemorySize(const Area& area)
+  {
+    size_t size=sizeof(Area)+area.rings.capacity()*sizeof(Area::Ring);
+
+    for (const auto& ring : area.rings) {
+      size+=EstimateMemorySize(ring.GetFeatureValueBuffer())+
+            ring.ids.capacity()*sizeof(Id)+
+            ring.nodes.capacity()*sizeof(GeoCoord)+
+            ring.compactNodes.GetMemorySize()+
+            ring.encodedGeometry.capacity();
+    }
+
+    return size;
+  }
+
   /**
    * Create a new tile with the given id.
    */
@@ -120,11 +172,27 @@ namespace osmscout {
     // no code
   }
 
+  TiledDataCache::Statistics::Statistics()
+  : tileCount(0),
+    memorySize(0),
+    hits(0),
+    misses(0),
+    evictions(0)
+  {
+    // no code
+  }
+
   /**
-   * Create a new tile cache with the given cache size
+   * Create a new tile cache with the given cache size (number of tiles) and the
+   * given maximum memory size in bytes (0 means no memory limit).
    */
-  TiledDataCache::TiledDataCache(size_t cacheSize)
-  : cacheSize(cacheSize)
+  TiledDataCache::TiledDataCache(size_t cacheSize,
+                                 size_t cacheMemorySize)
+  : cacheSize(cacheSize),
+    cacheMemorySize(cacheMemorySize),
+    hits(0),
+    misses(0),
+    evictions(0)
   {
     // no code
   }
@@ -134,37 +202,74 @@ namespace osmscout {
    */
   void TiledDataCache::SetSize(size_t cacheSize)
   {
+    std::lock_guard<std::mutex> guard(mutex);
+
     bool cleanupCache=cacheSize<this->cacheSize;
 
     this->cacheSize=cacheSize;
 
     if (cleanupCache) {
-      CleanupCache();
+      CleanupCacheInternal();
+    }
+  }
+
+  /**
+   * Change the maximum (estimated) memory size of the cache in bytes. A value
+   * of 0 disables the memory limit. Cache will be cleaned immediately.
+   */
+  void TiledDataCache::SetMemorySize(size_t cacheMemorySize)
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    bool cleanupCache=cacheMemorySize!=0 &&
+                      (this->cacheMemorySize==0 || cacheMemorySize<this->cacheMemorySize);
+
+    this->cacheMemorySize=cacheMemorySize;
+
+    if (cleanupCache) {
+      CleanupCacheInternal();
     }
   }
 
   /**
    * Cleanup the cache. Free least recently used tiles until the given maximum cache
-   * size is reached again.
+   * size and the maximum memory size is reached again.
    */
   void TiledDataCache::CleanupCache()
   {
-    if (tileCache.size()>cacheSize) {
-      auto currentEntry=tileCache.rbegin();
-
-      while (currentEntry!=tileCache.rend() &&
-              tileCache.size()>cacheSize) {
-        //if (currentEntry->tile.expired()) {
-        if (currentEntry->tile.use_count()==1) {
-          //std::cout << "Dropping tile " << (std::string)currentEntry->id << " from cache " << cache.size() << "/" << cacheSize << std::endl;
-          tileIndex.erase(currentEntry->id);
-
-          ++currentEntry;
-          currentEntry=std::reverse_iterator<Cache::iterator>(tileCache.erase(currentEntry.base()));
-        }
-        else {
-          ++currentEntry;
+    std::lock_guard<std::mutex> guard(mutex);
+
+    CleanupCacheInternal();
+  }
+
+  void TiledDataCache::CleanupCacheInternal()
+  {
+    size_t memorySize=0;
+
+    if (cacheMemorySize>0) {
+      for (const auto& entry : tileCache) {
+        memorySize+=entry.tile->GetMemorySize();
+      }
+    }
+
+    auto currentEntry=tileCache.rbegin();
+
+    while (currentEntry!=tileCache.rend() &&
+           (tileCache.size()>cacheSize ||
+            (cacheMemorySize>0 && memorySize>cacheMemorySize))) {
+      if (currentEntry->tile.use_count()==1) {
+        if (cacheMemorySize>0) {
+          memorySize-=currentEntry->tile->GetMemorySize();
         }
+
+        tileIndex.erase(currentEntry->id);
+        evictions++;
+
+        ++currentEntry;
+        currentEntry=std::reverse_iterator<Cache::iterator>(tileCache.erase(currentEntry.base()));
+      }
+      else {
+        ++currentEntry;
       }
     }
   }
@@ -172,28 +277,29 @@ namespace osmscout {
   /**
    * Return the cache tiles with the given id. If the tiles is not cache,
    * an empty reference will be returned.
+   *
+   * The lookup is not counted as hit or miss, since it only probes the cache
+   * (for example for prefilling tiles from their parent or child tiles).
    */
   TileRef TiledDataCache::GetCachedTile(const TileId& id) const
   {
-    std::map<TileId,CacheRef>::iterator existingEntry=tileIndex.find(id);
+    std::lock_guard<std::mutex> guard(mutex);
+
+    auto existingEntry=tileIndex.find(id);
 
     if (existingEntry!=tileIndex.end()) {
       tileCache.splice(tileCache.begin(),tileCache,existingEntry->second);
       existingEntry->second=tileCache.begin();
 
-      return existingEntry->second->tile;//.lock();
+      return existingEntry->second->tile;
     }
 
     return NULL;
   }
 
-  /**
-   * Return the tile with the given id. If the tile is not currently cached
-   * return an empty and unassigned tile and move it to the front of the cache.
-   */
-  TileRef TiledDataCache::GetTile(const TileId& id) const
+  TileRef TiledDataCache::GetTileInternal(const TileId& id) const
   {
-    std::map<TileId,CacheRef>::iterator existingEntry=tileIndex.find(id);
+    auto existingEntry=tileIndex.find(id);
 
     if (existingEntry==tileIndex.end()) {
       TileRef tile(new Tile(id));
@@ -202,18 +308,31 @@ namespace osmscout {
       CacheEntry cacheEntry(id,tile);
 
       tileCache.push_front(cacheEntry);
-      tileIndex[id]=tileCache.begin();
+      tileIndex.insert(std::make_pair(id,tileCache.begin()));
+      misses++;
 
       return tile;
     }
     else {
       tileCache.splice(tileCache.begin(),tileCache,existingEntry->second);
       existingEntry->second=tileCache.begin();
+      hits++;
 
       return existingEntry->second->tile;
     }
   }
 
+  /**
+   * Return the tile with the given id. If the tile is not currently cached
+   * return an empty and unassigned tile and move it to the front of the cache.
+   */
+  TileRef TiledDataCache::GetTile(const TileId& id) const
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    return GetTileInternal(id);
+  }
+
   /**
    * Return all tile necessary for covering the given boundingbox using the given magnification.
    */
@@ -235,9 +354,11 @@ namespace osmscout {
 
     //std::cout << "Tile bounding box: " << cx1 << "," << cy1 << " - "  << cx2 << "," << cy2 << std::endl;
 
+    std::lock_guard<std::mutex> guard(mutex);
+
     for (size_t y=cy1; y<=cy2; y++) {
       for (size_t x=cx1; x<=cx2; x++) {
-        tiles.push_back(GetTile(TileId(magnification,x,y)));
+        tiles.push_back(GetTileInternal(TileId(magnification,x,y)));
       }
     }
   }
@@ -446,4 +567,26 @@ namespace osmscout {
       std::cout << "Prefilling from children..." << std::endl;
     }*/
   }
+
+  /**
+   * Return statistics about the current cache state and the cache usage
+   * since creation of the cache.
+   */
+  TiledDataCache::Statistics TiledDataCache::GetStatistics() const
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    Statistics statistics;
+
+    statistics.tileCount=tileCache.size();
+    statistics.hits=hits;
+    statistics.misses=misses;
+    statistics.evictions=evictions;
+
+    for (const auto& entry : tileCache) {
+      statistics.memorySize+=entry.tile->GetMemorySize();
+    }
+
+    return statistics;
+  }
 }
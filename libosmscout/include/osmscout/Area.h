@@ -27,6 +27,7 @@
 #include <osmscout/TypeConfig.h>
 
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/CompactGeoCoords.h>
 #include <osmscout/util/FileWriter.h>
 #include <osmscout/util/GeoBox.h>
 #include <osmscout/util/Progress.h>
@@ -50,6 +51,8 @@ namespace osmscout {
       uint8_t               ring;               //!< The ring hierarchy number (0...n)
       std::vector<Id>       ids;                //!< The array of ids for a coordinate
       std::vector<GeoCoord> nodes;              //!< The array of coordinates
+      CompactGeoCoords      compactNodes;       //!< Compact storage of nodes, only filled after Area::CompactNodes()
+      std::vector<char>     encodedGeometry;    //!< Not yet decoded nodes and ids, only filled by Area::ReadLazy()
 
     public:
       inline Ring()
@@ -93,6 +96,38 @@ namespace osmscout {
         return featureValueBuffer;
       }
 
+      /**
+       * Returns true, if the coordinates are stored in compactNodes instead of nodes
+       */
+      inline bool HasCompactNodes() const
+      {
+        return !compactNodes.IsEmpty();
+      }
+
+      /**
+       * Returns true, if the area was read using Area::ReadLazy() and nodes and ids
+       * have not yet been decoded using DecodeGeometry()
+       */
+      inline bool HasEncodedGeometry() const
+      {
+        return !encodedGeometry.empty();
+      }
+
+      inline size_t GetNodeCount() const
+      {
+        if (HasEncodedGeometry()) {
+          return GetEncodedCoordCount(encodedGeometry.data());
+        }
+
+        return HasCompactNodes() ? compactNodes.GetSize() : nodes.size();
+      }
+
+      bool HasIds(size_t nodeCount) const;
+
+      void DecodeGeometry();
+      void DecodeGeometry(std::vector<GeoCoord>& nodes,
+                          std::vector<Id>& ids) const;
+
       bool GetCenter(GeoCoord& center) const;
 
       void GetBoundingBox(GeoBox& boundingBox) const;
@@ -110,6 +145,7 @@ namespace osmscout {
 
   private:
     FileOffset        fileOffset;
+    GeoBox            boundingBox; //!< Bounding box as stored in the record, only used while HasEncodedGeometry()
 
   public:
     std::vector<Ring> rings;
@@ -144,16 +180,37 @@ namespace osmscout {
       return rings.size()==1;
     }
 
+    /**
+     * Returns true, if the area was read using ReadLazy() and the geometry
+     * of its rings has not yet been decoded
+     */
+    inline bool HasEncodedGeometry() const
+    {
+      return !rings.empty() && rings.front().HasEncodedGeometry();
+    }
+
     bool GetCenter(GeoCoord& center) const;
 
     void GetBoundingBox(GeoBox& boundingBox) const;
 
+    void CompactNodes();
+    void ExpandNodes();
+
+    void DecodeGeometry();
+
     /**
      * Read the area as written by Write().
      */
     void Read(const TypeConfig& typeConfig,
               FileScanner& scanner);
 
+    /**
+     * Read the area as written by Write(), but only copy the still encoded
+     * geometry of the rings.
+     */
+    void ReadLazy(const TypeConfig& typeConfig,
+                  FileScanner& scanner);
+
     /**
      * Read the area as written by WriteImport().
      */
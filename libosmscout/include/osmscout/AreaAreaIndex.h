@@ -136,6 +136,8 @@ namespace osmscout {
       return scanner.IsOpen();
     }
 
+    FileOffset GetBytesRead() const;
+
     bool GetAreasInArea(const TypeConfig& typeConfig,
                         const GeoBox& boundingBox,
                         size_t maxLevel,
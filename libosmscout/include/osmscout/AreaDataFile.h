@@ -36,6 +36,12 @@ namespace osmscout {
     static const char* AREAS_DAT;
     static const char* AREAS_IDMAP;
 
+  protected:
+    void ReadObject(const TypeConfig& typeConfig,
+                    FileScanner& scanner,
+                    bool lazyGeometry,
+                    Area& data) const;
+
   public:
     AreaDataFile();
   };
@@ -96,6 +96,8 @@ namespace osmscout {
       return scanner.IsOpen();
     }
 
+    FileOffset GetBytesRead() const;
+
     bool GetOffsets(const GeoBox& boundingBox,
                     const TypeInfoSet& requestedTypes,
                     std::vector<FileOffset>& offsets,
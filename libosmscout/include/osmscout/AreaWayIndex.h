@@ -84,7 +84,7 @@ namespace osmscout {
   private:
     bool GetOffsets(const TypeData& typeData,
                     const GeoBox& boundingBox,
-                    std::unordered_set<FileOffset>& offsets) const;
+                    std::vector<FileOffset>& offsets) const;
 
   public:
     AreaWayIndex();
@@ -99,6 +99,8 @@ namespace osmscout {
       return scanner.IsOpen();
     }
 
+    FileOffset GetBytesRead() const;
+
     bool GetOffsets(const GeoBox& boundingBox,
                     const TypeInfoSet& types,
                     std::vector<FileOffset>& offsets,
@@ -20,6 +20,8 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <algorithm>
+#include <future>
 #include <memory>
 #include <mutex>
 #include <set>
@@ -31,6 +33,8 @@
 #include <osmscout/util/Cache.h>
 #include <osmscout/util/FileScanner.h>
 #include <osmscout/util/Logger.h>
+#include <osmscout/util/MemoryArena.h>
+#include <osmscout/util/ThreadPool.h>
 
 namespace osmscout {
 
@@ -73,6 +77,8 @@ namespace osmscout {
   public:
     typedef std::shared_ptr<N> ValueType;
 
+    static const FileOffset MAX_RANGE_SIZE=1024*1024; //!< Maximum size of a range read at once by GetByOffset()
+
   private:
     std::string         datafile;        //!< Basename part of the data file name
     std::string         datafilename;    //!< complete filename for data file
@@ -83,18 +89,33 @@ namespace osmscout {
 
     mutable std::mutex  accessMutex;     //!< Mutex to secure multi-thread access
 
+    FileOffset          coalesceGap;     //!< Maximum distance between two offsets read as part of one sequential range
+    bool                prefetchSpans;   //!< Prefetch the data of DataBlockSpans before reading them
+
+    mutable FileOffset  readBytes;       //!< Number of bytes of objects read by offset or DataBlockSpans, used to estimate prefetch sizes
+    mutable FileOffset  readObjects;     //!< Number of objects read by offset or DataBlockSpans, used to estimate prefetch sizes
+
   protected:
     TypeConfigRef       typeConfig;
 
+  protected:
+    virtual void ReadObject(const TypeConfig& typeConfig,
+                            FileScanner& scanner,
+                            bool lazyGeometry,
+                            N& data) const;
+
   private:
     bool ReadData(const TypeConfig& typeConfig,
                   FileScanner& scanner,
+                  bool lazyGeometry,
                   N& data) const;
     bool ReadData(const TypeConfig& typeConfig,
                   FileScanner& scanner,
                   FileOffset offset,
                   N& data) const;
 
+    FileOffset GetPrefetchObjectSize() const;
+
   public:
     DataFile(const std::string& datafile);
 
@@ -107,8 +128,12 @@ namespace osmscout {
     virtual bool IsOpen() const;
     virtual bool Close();
 
+    void SetCoalesceGap(FileOffset coalesceGap);
+    void SetPrefetchSpans(bool prefetchSpans);
+
     bool GetByOffset(const std::vector<FileOffset>& offsets,
-                     std::vector<ValueType>& data) const;
+                     std::vector<ValueType>& data,
+                     bool lazyGeometry=false) const;
     bool GetByOffset(const std::list<FileOffset>& offsets,
                      std::vector<ValueType>& data) const;
     bool GetByOffset(const std::set<FileOffset>& offsets,
@@ -123,14 +148,33 @@ namespace osmscout {
     bool GetByBlockSpan(const DataBlockSpan& span,
                         std::vector<ValueType>& data) const;
     bool GetByBlockSpans(const std::vector<DataBlockSpan>& spans,
-                         std::vector<ValueType>& data) const;
+                         std::vector<ValueType>& data,
+                         bool lazyGeometry=false) const;
+    std::future<bool> GetByBlockSpansAsync(ThreadPool& threadPool,
+                                           const std::vector<DataBlockSpan>& spans,
+                                           std::vector<ValueType>& data) const;
+
+    void Prefetch(const std::vector<DataBlockSpan>& spans) const;
+
+    template<class V, class F>
+    bool VisitByOffset(const std::vector<FileOffset>& offsets,
+                       V& view,
+                       F visitor) const;
+    template<class V, class F>
+    bool VisitByBlockSpans(const std::vector<DataBlockSpan>& spans,
+                           V& view,
+                           F visitor) const;
   };
 
   template <class N>
   DataFile<N>::DataFile(const std::string& datafile)
   : datafile(datafile),
     modeData(FileScanner::LowMemRandom),
-    memoryMapedData(false)
+    memoryMapedData(false),
+    coalesceGap(4096),
+    prefetchSpans(false),
+    readBytes(0),
+    readObjects(0)
   {
     // no code
   }
@@ -143,6 +187,24 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Read one data value from the current position of the stream. Derived classes
+   * for objects supporting lazy decoding of their geometry (ways and areas) overwrite
+   * this method to read the object lazily, if requested. The default implementation
+   * ignores lazyGeometry.
+   *
+   * @throws IOException
+   */
+  template <class N>
+  void DataFile<N>::ReadObject(const TypeConfig& typeConfig,
+                               FileScanner& scanner,
+                               bool /*lazyGeometry*/,
+                               N& data) const
+  {
+    data.Read(typeConfig,
+              scanner);
+  }
+
   /**
    * Read one data value from the given file offset.
    *
@@ -159,8 +221,10 @@ namespace osmscout {
     try {
       scanner.SetPos(offset);
 
-      data.Read(typeConfig,
-                scanner);
+      ReadObject(typeConfig,
+                 scanner,
+                 false,
+                 data);
     }
     catch (IOException& e) {
       log.Error() << e.GetDescription();
@@ -178,11 +242,14 @@ namespace osmscout {
   template <class N>
   bool DataFile<N>::ReadData(const TypeConfig& typeConfig,
                              FileScanner& scanner,
+                             bool lazyGeometry,
                              N& data) const
   {
     try {
-      data.Read(typeConfig,
-                scanner);
+      ReadObject(typeConfig,
+                 scanner,
+                 lazyGeometry,
+                 data);
     }
     catch (IOException& e) {
       log.Error() << e.GetDescription();
@@ -258,30 +325,134 @@ namespace osmscout {
   }
 
   /**
-   * Read data values from the given file offsets.
+   * Set the maximum distance in bytes between the offsets of two objects, for which
+   * both are treated as part of one sequential range by GetByOffset(). A value of 0
+   * disables coalescing.
+   *
+   * Method is not thread-safe.
+   */
+  template <class N>
+  void DataFile<N>::SetCoalesceGap(FileOffset coalesceGap)
+  {
+    this->coalesceGap=coalesceGap;
+  }
+
+  /**
+   * Enable or disable prefetching of the data of all spans before reading them in
+   * GetByBlockSpans(), see Prefetch(). Prefetching costs additional system calls
+   * and only pays off, if the data is not in the file system cache, so it is
+   * disabled by default.
+   *
+   * Method is not thread-safe.
+   */
+  template <class N>
+  void DataFile<N>::SetPrefetchSpans(bool prefetchSpans)
+  {
+    this->prefetchSpans=prefetchSpans;
+  }
+
+  /**
+   * Read data values from the given file offsets. The values are returned in the
+   * order of the offsets.
+   *
+   * The offsets are read in ascending order. Offsets with a distance of at most the
+   * coalesce gap (see SetCoalesceGap()) to the previous offset are grouped into one
+   * range of at most MAX_RANGE_SIZE bytes. Ranges holding more than one object are
+   * read into memory with one read operation (see FileScanner::ReadRange()) and the
+   * objects are decoded from there, instead of reading the file for each object.
+   *
+   * If lazyGeometry is true, ways and areas are read using Way::ReadLazy() and
+   * Area::ReadLazy(), so the caller must decode their geometry before accessing
+   * nodes or ids. It has no effect for other objects.
    *
    * Method is thread-safe.
    */
   template <class N>
   bool DataFile<N>::GetByOffset(const std::vector<FileOffset>& offsets,
-                                std::vector<ValueType>& data) const
+                                std::vector<ValueType>& data,
+                                bool lazyGeometry) const
   {
-    data.reserve(data.size()+offsets.size());
+    if (offsets.empty()) {
+      return true;
+    }
 
-    for (const auto& offset : offsets) {
-      ValueType value=std::make_shared<N>();
+    std::vector<size_t> order(offsets.size());
 
-      if (!ReadData(*typeConfig,
-                    scanner,
-                    offset,
-                    *value)) {
-        log.Error() << "Error while reading data from offset " << offset << " of file " << datafilename << "!";
-        return false;
-      }
+    for (size_t i=0; i<order.size(); i++) {
+      order[i]=i;
+    }
 
-      data.push_back(value);
+    if (!std::is_sorted(offsets.begin(),offsets.end())) {
+      std::stable_sort(order.begin(),
+                       order.end(),
+                       [&offsets](size_t a, size_t b) {
+                         return offsets[a]<offsets[b];
+                       });
     }
 
+    std::vector<ValueType>      values(offsets.size());
+    std::lock_guard<std::mutex> lock(accessMutex);
+
+    try {
+      FileOffset objectSize=GetPrefetchObjectSize();
+      size_t     runStart=0;
+
+      while (runStart<order.size()) {
+        size_t runEnd=runStart+1;
+
+        FileOffset startOffset=offsets[order[runStart]];
+
+        while (runEnd<order.size() &&
+               offsets[order[runEnd]]-offsets[order[runEnd-1]]<=coalesceGap &&
+               offsets[order[runEnd]]-startOffset+objectSize<=MAX_RANGE_SIZE) {
+          runEnd++;
+        }
+
+        if (runEnd-runStart>1) {
+          scanner.ReadRange(startOffset,
+                            offsets[order[runEnd-1]]-startOffset+objectSize);
+        }
+        else {
+          scanner.SetPos(startOffset);
+        }
+
+        for (size_t i=runStart; i<runEnd; i++) {
+          FileOffset offset=offsets[order[i]];
+
+          // Skip the gap to the next object (or go back, if the same offset is requested twice)
+          if (scanner.GetPos()!=offset) {
+            scanner.SetPos(offset);
+          }
+
+          ValueType value=AllocateShared<N>();
+
+          if (!ReadData(*typeConfig,
+                        scanner,
+                        lazyGeometry,
+                        *value)) {
+            log.Error() << "Error while reading data from offset " << offset << " of file " << datafilename << "!";
+            return false;
+          }
+
+          values[order[i]]=value;
+
+          readBytes+=scanner.GetPos()-offset;
+          readObjects++;
+        }
+
+        runStart=runEnd;
+      }
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      return false;
+    }
+
+    data.reserve(data.size()+values.size());
+    data.insert(data.end(),
+                values.begin(),
+                values.end());
+
     return true;
   }
 
@@ -294,24 +465,11 @@ namespace osmscout {
   bool DataFile<N>::GetByOffset(const std::list<FileOffset>& offsets,
                                 std::vector<ValueType>& data) const
   {
-    data.reserve(data.size()+offsets.size());
-
-    for (const auto& offset : offsets) {
-      ValueType value=std::make_shared<N>();
+    std::vector<FileOffset> offsetVector(offsets.begin(),
+                                         offsets.end());
 
-      if (!ReadData(*typeConfig,
-                    scanner,
-                    offset,
-                    *value)) {
-        log.Error() << "Error while reading data from offset " << offset << " of file " << datafilename << "!";
-        // TODO: Remove broken entry from cache
-        return false;
-      }
-
-      data.push_back(value);
-    }
-
-    return true;
+    return GetByOffset(offsetVector,
+                       data);
   }
 
   /**
@@ -323,24 +481,11 @@ namespace osmscout {
   bool DataFile<N>::GetByOffset(const std::set<FileOffset>& offsets,
                                 std::vector<ValueType>& data) const
   {
-    data.reserve(data.size()+offsets.size());
-
-    for (const auto& offset : offsets) {
-      ValueType value=std::make_shared<N>();
+    std::vector<FileOffset> offsetVector(offsets.begin(),
+                                         offsets.end());
 
-      if (!ReadData(*typeConfig,
-                    scanner,
-                    offset,
-                    *value)) {
-        log.Error() << "Error while reading data from offset " << offset << " of file " << datafilename << "!";
-        // TODO: Remove broken entry from cache
-        return false;
-      }
-
-      data.push_back(value);
-    }
-
-    return true;
+    return GetByOffset(offsetVector,
+                       data);
   }
 
   /**
@@ -374,7 +519,7 @@ namespace osmscout {
   bool DataFile<N>::GetByOffset(const FileOffset& offset,
                                 ValueType& entry) const
   {
-    ValueType value=std::make_shared<N>();
+    ValueType value=AllocateShared<N>();
 
     if (!ReadData(*typeConfig,
                   scanner,
@@ -411,10 +556,11 @@ namespace osmscout {
       area.reserve(area.size()+span.count);
 
       for (uint32_t i=1; i<=span.count; i++) {
-        ValueType value=std::make_shared<N>();
+        ValueType value=AllocateShared<N>();
 
         if (!ReadData(*typeConfig,
                       scanner,
+                      false,
                       *value)) {
           log.Error() << "Error while reading data #" << i << " starting from offset " << span.startOffset << " of file " << datafilename << "!";
           return false;
@@ -423,6 +569,9 @@ namespace osmscout {
         area.push_back(value);
       }
 
+      readBytes+=scanner.GetPos()-span.startOffset;
+      readObjects+=span.count;
+
       return true;
     }
     catch (IOException& e) {
@@ -434,11 +583,16 @@ namespace osmscout {
   /**
    * Read data values from the given DataBlockSpans.
    *
+   * If lazyGeometry is true, ways and areas are read using Way::ReadLazy() and
+   * Area::ReadLazy(), see GetByOffset(). If enabled (see SetPrefetchSpans()), the
+   * data of all spans is prefetched first.
+   *
    * Method is thread-safe.
    */
   template <class N>
   bool DataFile<N>::GetByBlockSpans(const std::vector<DataBlockSpan>& spans,
-                                    std::vector<ValueType>& data) const
+                                    std::vector<ValueType>& data,
+                                    bool lazyGeometry) const
   {
     uint32_t overallCount=0;
 
@@ -448,6 +602,10 @@ namespace osmscout {
 
     data.reserve(data.size()+overallCount);
 
+    if (prefetchSpans) {
+      Prefetch(spans);
+    }
+
     try {
       for (const auto& span : spans) {
         if (span.count==0) {
@@ -459,10 +617,11 @@ namespace osmscout {
         scanner.SetPos(span.startOffset);
 
         for (uint32_t i=1; i<=span.count; i++) {
-          ValueType value=std::make_shared<N>();
+          ValueType value=AllocateShared<N>();
 
           if (!ReadData(*typeConfig,
                         scanner,
+                        lazyGeometry,
                         *value)) {
             log.Error() << "Error while reading data #" << i << " starting from offset " << span.startOffset <<
             " of file " << datafilename << "!";
@@ -471,6 +630,206 @@ namespace osmscout {
 
           data.push_back(value);
         }
+
+        readBytes+=scanner.GetPos()-span.startOffset;
+        readObjects+=span.count;
+      }
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Read data values from the given DataBlockSpans as a job of the given thread pool.
+   * The returned future signals the result of GetByBlockSpans(). The data vector must
+   * not be accessed until the future is ready. If a MemoryArena is active for the
+   * calling thread, it is used for the loaded objects, so it must not be used by the
+   * calling thread until the future is ready, either.
+   *
+   * Method is thread-safe.
+   */
+  template <class N>
+  std::future<bool> DataFile<N>::GetByBlockSpansAsync(ThreadPool& threadPool,
+                                                      const std::vector<DataBlockSpan>& spans,
+                                                      std::vector<ValueType>& data) const
+  {
+    MemoryArena    *currentArena=MemoryArena::GetCurrentArena();
+    MemoryArenaRef arena;
+
+    if (currentArena!=NULL) {
+      arena=currentArena->shared_from_this();
+    }
+
+    return threadPool.Submit([this,spans,arena,&data]() {
+      MemoryArenaScope arenaScope(arena);
+
+      return GetByBlockSpans(spans,
+                             data);
+    });
+  }
+
+  /**
+   * Return the estimated size of one object in the file, based on the data
+   * read so far.
+   */
+  template <class N>
+  FileOffset DataFile<N>::GetPrefetchObjectSize() const
+  {
+    if (readObjects==0) {
+      return 256;
+    }
+
+    return std::max(readBytes/readObjects,(FileOffset)1);
+  }
+
+  /**
+   * Hint the operating system to read the data of the given DataBlockSpans in the
+   * background, so that disk access overlaps with decoding of already loaded data.
+   * Since spans only hold the number of objects, the size of the data is estimated
+   * from the average size of the objects read so far. The range of a span never
+   * exceeds the start of the following span. Adjacent ranges are merged.
+   *
+   * Method is thread-safe.
+   */
+  template <class N>
+  void DataFile<N>::Prefetch(const std::vector<DataBlockSpan>& spans) const
+  {
+    std::vector<DataBlockSpan> sortedSpans;
+
+    sortedSpans.reserve(spans.size());
+
+    for (const auto& span : spans) {
+      if (span.count>0) {
+        sortedSpans.push_back(span);
+      }
+    }
+
+    if (sortedSpans.empty()) {
+      return;
+    }
+
+    if (!std::is_sorted(sortedSpans.begin(),sortedSpans.end())) {
+      std::sort(sortedSpans.begin(),sortedSpans.end());
+    }
+
+    std::lock_guard<std::mutex> lock(accessMutex);
+
+    if (!scanner.IsOpen()) {
+      return;
+    }
+
+    FileOffset objectSize=GetPrefetchObjectSize();
+    FileOffset rangeStart=sortedSpans.front().startOffset;
+    FileOffset rangeEnd=rangeStart;
+
+    for (size_t i=0; i<sortedSpans.size(); i++) {
+      const DataBlockSpan& span=sortedSpans[i];
+      FileOffset           end=span.startOffset+span.count*objectSize;
+
+      if (i+1<sortedSpans.size() &&
+          sortedSpans[i+1].startOffset>span.startOffset) {
+        end=std::min(end,sortedSpans[i+1].startOffset);
+      }
+
+      if (span.startOffset>rangeEnd) {
+        scanner.Prefetch(rangeStart,
+                         rangeEnd-rangeStart);
+
+        rangeStart=span.startOffset;
+      }
+
+      rangeEnd=std::max(rangeEnd,end);
+    }
+
+    scanner.Prefetch(rangeStart,
+                     rangeEnd-rangeStart);
+  }
+
+  /**
+   * Read the objects at the given file offsets one after the other into the given
+   * view (NodeView, WayView or AreaView, see ObjectView.h) and call the visitor
+   * with the view after each object. No object instances are created. If the file
+   * is memory mapped, the geometry of the view is not copied.
+   *
+   * The view passed to the visitor is only valid during the call. The data file
+   * is not locked while the visitor is called, so the visitor may load further
+   * objects from the same data file. The data file must not be closed before
+   * the method returns.
+   *
+   * Method is thread-safe.
+   */
+  template <class N>
+  template <class V, class F>
+  bool DataFile<N>::VisitByOffset(const std::vector<FileOffset>& offsets,
+                                  V& view,
+                                  F visitor) const
+  {
+    try {
+      for (const auto& offset : offsets) {
+        {
+          std::lock_guard<std::mutex> lock(accessMutex);
+
+          scanner.SetPos(offset);
+
+          view.Read(*typeConfig,
+                    scanner);
+
+          readBytes+=scanner.GetPos()-offset;
+          readObjects++;
+        }
+
+        visitor(view);
+      }
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Read the objects in the given DataBlockSpans one after the other into the given
+   * view and call the visitor with the view after each object. As for
+   * VisitByOffset() the data file is not locked while the visitor is called.
+   *
+   * Method is thread-safe.
+   */
+  template <class N>
+  template <class V, class F>
+  bool DataFile<N>::VisitByBlockSpans(const std::vector<DataBlockSpan>& spans,
+                                      V& view,
+                                      F visitor) const
+  {
+    try {
+      for (const auto& span : spans) {
+        FileOffset offset=span.startOffset;
+
+        for (uint32_t i=1; i<=span.count; i++) {
+          {
+            std::lock_guard<std::mutex> lock(accessMutex);
+
+            // The visitor may have moved the scanner
+            if (scanner.GetPos()!=offset) {
+              scanner.SetPos(offset);
+            }
+
+            view.Read(*typeConfig,
+                      scanner);
+
+            readBytes+=scanner.GetPos()-offset;
+            readObjects++;
+
+            offset=scanner.GetPos();
+          }
+
+          visitor(view);
+        }
       }
     }
     catch (IOException& e) {
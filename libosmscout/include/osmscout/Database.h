@@ -43,6 +43,8 @@
 #include <osmscout/AreaAreaIndex.h>
 #include <osmscout/AreaNodeIndex.h>
 #include <osmscout/AreaWayIndex.h>
+#include <osmscout/PackedRTreeIndex.h>
+#include <osmscout/POINameIndex.h>
 
 // Location index
 #include <osmscout/LocationIndex.h>
@@ -71,23 +73,66 @@ namespace osmscout {
 
     The following attributes are currently available:
     * cache sizes.
+    * loading of the admin regions of the location index into memory.
+    * usage of the region lookup index of the location index.
+    * usage of the optional R-tree indexes.
     */
   class OSMSCOUT_API DatabaseParameter
   {
   private:
     unsigned long areaAreaIndexCacheSize;
     unsigned long areaNodeIndexCacheSize;
+    bool          locationIndexRegionsInMemory;
+    bool          locationIndexRegionLookup;
+    bool          rTreeIndexes;
 
   public:
     DatabaseParameter();
 
     void SetAreaAreaIndexCacheSize(unsigned long areaAreaIndexCacheSize);
     void SetAreaNodeIndexCacheSize(unsigned long areaNodeIndexCacheSize);
+    void SetLocationIndexRegionsInMemory(bool locationIndexRegionsInMemory);
+    void SetLocationIndexRegionLookup(bool locationIndexRegionLookup);
+    void SetRTreeIndexes(bool rTreeIndexes);
 
     unsigned long GetAreaAreaIndexCacheSize() const;
     unsigned long GetAreaNodeIndexCacheSize() const;
+    bool GetLocationIndexRegionsInMemory() const;
+    bool GetLocationIndexRegionLookup() const;
+    bool GetRTreeIndexes() const;
   };
 
+  /**
+   * \ingroup Database
+   *
+   * An object together with its distance to the coordinate of a nearest
+   * neighbour query (see Database::GetClosestNodes() and friends).
+   */
+  template<class R>
+  struct ClosestObject
+  {
+    R        object;   //!< The object
+    double   distance; //!< Distance of the object geometry in km, 0.0 if the coordinate is inside an area
+    GeoCoord coord;    //!< Closest coordinate of the object geometry
+  };
+
+  typedef ClosestObject<NodeRef> ClosestNode;
+  typedef ClosestObject<WayRef>  ClosestWay;
+  typedef ClosestObject<AreaRef> ClosestArea;
+
+  /**
+   * \ingroup Database
+   *
+   * Return the distance (in km) of the given area to the reference coordinate
+   * of the given distance calculation, as used by Database::GetClosestAreas():
+   * the distance to the nearest ring of the area or 0.0, if the coordinate is
+   * inside the area (but not within one of its holes). closest is set to the
+   * closest coordinate of the area geometry.
+   */
+  extern OSMSCOUT_API double GetAreaDistance(const EquirectangularDistance& distance,
+                                             const Area& area,
+                                             GeoCoord& closest);
+
   /**
    * \ingroup Database
    *
@@ -129,6 +174,18 @@ namespace osmscout {
     mutable AreaAreaIndexRef        areaAreaIndex;        //!< Index of ways by containing area
     mutable std::mutex              areaAreaIndexMutex;   //!< Mutex to make lazy initialisation of area area index thread-safe
 
+    mutable PackedRTreeIndexRef     nodeRTreeIndex;       //!< Optional R-tree index of nodes
+    mutable std::mutex              nodeRTreeIndexMutex;  //!< Mutex to make lazy initialisation of node R-tree index thread-safe
+
+    mutable PackedRTreeIndexRef     wayRTreeIndex;        //!< Optional R-tree index of ways
+    mutable std::mutex              wayRTreeIndexMutex;   //!< Mutex to make lazy initialisation of way R-tree index thread-safe
+
+    mutable PackedRTreeIndexRef     areaRTreeIndex;       //!< Optional R-tree index of areas
+    mutable std::mutex              areaRTreeIndexMutex;  //!< Mutex to make lazy initialisation of area R-tree index thread-safe
+
+    mutable POINameIndexRef         poiNameIndex;         //!< Index of POIs and their names by location
+    mutable std::mutex              poiNameIndexMutex;    //!< Mutex to make lazy initialisation of POI name index thread-safe
+
     mutable LocationIndexRef        locationIndex;        //!< Location-based index
     mutable std::mutex              locationIndexMutex;   //!< Mutex to make lazy initialisation of location index thread-safe
 
@@ -141,6 +198,9 @@ namespace osmscout {
     mutable OptimizeWaysLowZoomRef  optimizeWaysLowZoom;  //!< Optimized data for low zoom situations
     mutable std::mutex              optimizeWaysMutex;    //!< Mutex to make lazy initialisation of optimized ways index thread-safe
 
+  private:
+    PackedRTreeIndexRef OpenRTreeIndex(const std::string& filename) const;
+
   public:
     Database(const DatabaseParameter& parameter);
     virtual ~Database();
@@ -160,6 +220,12 @@ namespace osmscout {
     AreaAreaIndexRef GetAreaAreaIndex() const;
     AreaWayIndexRef GetAreaWayIndex() const;
 
+    PackedRTreeIndexRef GetNodeRTreeIndex() const;
+    PackedRTreeIndexRef GetWayRTreeIndex() const;
+    PackedRTreeIndexRef GetAreaRTreeIndex() const;
+
+    POINameIndexRef GetPOINameIndex() const;
+
     LocationIndexRef GetLocationIndex() const;
 
     WaterIndexRef GetWaterIndex() const;
@@ -193,13 +259,15 @@ namespace osmscout {
     bool GetAreasByBlockSpan(const DataBlockSpan& span,
                              std::vector<AreaRef>& area) const;
     bool GetAreasByBlockSpans(const std::vector<DataBlockSpan>& spans,
-                              std::vector<AreaRef>& areas) const;
+                              std::vector<AreaRef>& areas,
+                              bool lazyGeometry=false) const;
 
 
     bool GetWayByOffset(const FileOffset& offset,
                         WayRef& way) const;
     bool GetWaysByOffset(const std::vector<FileOffset>& offsets,
-                         std::vector<WayRef>& ways) const;
+                         std::vector<WayRef>& ways,
+                         bool lazyGeometry=false) const;
     bool GetWaysByOffset(const std::set<FileOffset>& offsets,
                          std::vector<WayRef>& ways) const;
     bool GetWaysByOffset(const std::list<FileOffset>& offsets,
@@ -207,6 +275,22 @@ namespace osmscout {
     bool GetWaysByOffset(const std::set<FileOffset>& offsets,
                          std::unordered_map<FileOffset,WayRef>& dataMap) const;
 
+    bool GetClosestNodes(const GeoCoord& coord,
+                         const TypeInfoSet& types,
+                         size_t count,
+                         double maxDistance,
+                         std::vector<ClosestNode>& nodes) const;
+    bool GetClosestWays(const GeoCoord& coord,
+                        const TypeInfoSet& types,
+                        size_t count,
+                        double maxDistance,
+                        std::vector<ClosestWay>& ways) const;
+    bool GetClosestAreas(const GeoCoord& coord,
+                         const TypeInfoSet& types,
+                         size_t count,
+                         double maxDistance,
+                         std::vector<ClosestArea>& areas) const;
+
     void DumpStatistics();
   };
 
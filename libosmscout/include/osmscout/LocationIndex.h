@@ -22,8 +22,11 @@
 
 #include <list>
 #include <memory>
+#include <mutex>
 #include <set>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <osmscout/Location.h>
 #include <osmscout/TypeConfig.h>
@@ -41,11 +44,83 @@ namespace osmscout {
    * Currently every type that has option 'INDEX' set in the map.ost file is indexed as
    * location. Areas are currently build by scanning administrative boundaries and the
    * various sized city typed locations and areas.
+   *
+   * If the optional token index (generated together with the location index) is
+   * available, name based searches can be restricted to the regions, locations and POIs
+   * that contain all tokens of the search pattern instead of visiting the complete
+   * region tree.
+   *
+   * Optionally the admin region hierarchy can be loaded into memory on Load(). Region
+   * traversal and resolving of parent regions then do not need any disk access, only
+   * POIs, locations and addresses are read from the index file. Opened index files are
+   * kept memory mapped and reused by later calls.
+   *
+   * The optional region lookup index is a grid over all admin regions. Each cell holds
+   * the regions completely containing the cell and the boundary segments of all regions
+   * crossing the cell, so the regions of a coordinate can be resolved without loading
+   * the region areas.
    */
   class OSMSCOUT_API LocationIndex
   {
   public:
     static const char* const FILENAME_LOCATION_IDX;
+    static const char* const FILENAME_LOCATION_TOKEN_IDX;
+    static const char* const FILENAME_LOCATION_REGION_IDX;
+
+    static const size_t SHORT_TOKEN_LENGTH=3;          //!< Pattern tokens with less characters are "short"
+    static const size_t MAX_SHORT_TOKEN_ENTRIES=10000; //!< Maximum number of posting entries read for a short token
+
+    /**
+     * Kind of object referenced by a TokenEntry
+     */
+    enum TokenEntryType
+    {
+      tokenRegion   = 0, //!< An admin region, the name or one of its aliases contain the token
+      tokenPOI      = 1, //!< A POI
+      tokenLocation = 2  //!< A location
+    };
+
+    /**
+     * Entry of the posting list of a token in the token index
+     */
+    struct OSMSCOUT_API TokenEntry
+    {
+      TokenEntryType type;         //!< Kind of the entry
+      FileOffset     offset;       //!< Offset of the entry in the location index
+      FileOffset     regionOffset; //!< Offset of the region the entry belongs to (the region itself for regions)
+      ObjectFileRef  object;       //!< The object of a POI, unset for other entries
+
+      inline bool operator<(const TokenEntry& other) const
+      {
+        if (type!=other.type) {
+          return type<other.type;
+        }
+
+        return offset<other.offset;
+      }
+
+      inline bool operator==(const TokenEntry& other) const
+      {
+        return type==other.type &&
+               offset==other.offset;
+      }
+    };
+
+  private:
+    /**
+     * Header of the region lookup index
+     */
+    struct RegionLookupGrid
+    {
+      FileOffset tableOffset;      //!< Offset of the cell table
+      uint8_t    entryOffsetBytes; //!< Number of bytes of a cell table entry
+      uint32_t   cellXStart;
+      uint32_t   cellXEnd;
+      uint32_t   cellYStart;
+      uint32_t   cellYEnd;
+      double     cellWidth;
+      double     cellHeight;
+    };
 
   private:
     std::string                     path;
@@ -55,14 +130,54 @@ namespace osmscout {
     std::unordered_set<std::string> regionIgnoreTokens;
     std::unordered_set<std::string> locationIgnoreTokens;
     FileOffset                      indexOffset;
+    std::vector<std::string>        tokens;                  //!< Sorted tokens of the token index
+    std::vector<FileOffset>         tokenEntryOffsets;       //!< Offset of the posting list for each token
+    bool                            regionsInMemory;         //!< The admin regions have been loaded into memory
+    std::vector<AdminRegion>        regions;                 //!< All admin regions in depth first order
+    std::vector<uint32_t>           regionSubtreeEnds;       //!< Index of the first region after the subtree of each region
+    std::unordered_map<FileOffset,uint32_t> regionIndexes;   //!< Index of each region by its offset
+
+    mutable std::mutex                                scannerMutex;  //!< Mutex to secure the scanner pools
+    mutable std::vector<std::unique_ptr<FileScanner>> indexScanners; //!< Unused scanners for the location index
+    mutable std::vector<std::unique_ptr<FileScanner>> tokenScanners; //!< Unused scanners for the token index
+
+    bool                                              hasRegionLookupIndex; //!< The region lookup index is available
+    RegionLookupGrid                                  regionLookupGrid;     //!< Header of the region lookup index
+    mutable std::vector<std::unique_ptr<FileScanner>> regionScanners;       //!< Unused scanners for the region lookup index
 
   private:
+    std::unique_ptr<FileScanner> AcquireScanner(std::vector<std::unique_ptr<FileScanner>>& pool,
+                                                const std::string& filename) const;
+    void ReleaseScanner(std::vector<std::unique_ptr<FileScanner>>& pool,
+                        std::unique_ptr<FileScanner>& scanner) const;
+    static void CloseScanners(std::vector<std::unique_ptr<FileScanner>>& pool);
+
+    bool LoadTokenIndex();
+    bool LoadRegionLookupIndex();
+
+    void LoadRegionTree(FileScanner& scanner);
+    bool LoadRegions();
+
+    bool GetTokenEntries(FileScanner& scanner,
+                         const std::string& prefix,
+                         size_t maxEntries,
+                         std::vector<TokenEntry>& entries,
+                         bool& complete) const;
+
+    bool GetTokenEntries(const std::string& pattern,
+                         std::vector<TokenEntry>& entries,
+                         bool& selective) const;
+
     void Read(FileScanner& scanner,
               ObjectFileRef& object) const;
 
     bool LoadAdminRegion(FileScanner& scanner,
                          AdminRegion& region) const;
 
+    bool LoadAdminRegion(FileScanner& scanner,
+                         FileOffset offset,
+                         AdminRegion& region) const;
+
     AdminRegionVisitor::Action VisitRegionEntries(FileScanner& scanner,
                                                   AdminRegionVisitor& visitor) const;
 
@@ -71,6 +186,15 @@ namespace osmscout {
                                     bool recursive,
                                     bool& stopped) const;
 
+    bool GetRegionOffsets(FileScanner& scanner,
+                          const GeoCoord& coord,
+                          std::vector<FileOffset>& regionOffsets,
+                          std::vector<GeoCoord>& run) const;
+
+    void LoadLocation(FileScanner& scanner,
+                      FileOffset regionOffset,
+                      Location& location) const;
+
     bool LoadRegionDataEntry(FileScanner& scanner,
                              const AdminRegion& region,
                              LocationVisitor& visitor,
@@ -86,11 +210,43 @@ namespace osmscout {
     LocationIndex();
     virtual ~LocationIndex();
 
-    bool Load(const std::string& path);
+    bool Load(const std::string& path,
+              bool loadRegions=false,
+              bool loadRegionLookup=true);
+
+    /**
+     * Returns true, if the admin regions have been loaded into memory
+     */
+    inline bool HasRegionsInMemory() const
+    {
+      return regionsInMemory;
+    }
 
     bool IsRegionIgnoreToken(const std::string& token) const;
     bool IsLocationIgnoreToken(const std::string& token) const;
 
+    static void GetNameTokens(const std::string& name,
+                              std::vector<std::string>& tokens);
+
+    /**
+     * Returns true, if the optional token index is available
+     */
+    inline bool HasTokenIndex() const
+    {
+      return !tokens.empty();
+    }
+
+    /**
+     * Returns true, if the optional region lookup index is available
+     */
+    inline bool HasRegionLookupIndex() const
+    {
+      return hasRegionLookupIndex;
+    }
+
+    bool GetRegionOffsets(const std::vector<GeoCoord>& coords,
+                          std::set<FileOffset>& regionOffsets) const;
+
     /**
      * Visit all admin regions
      */
@@ -110,6 +266,13 @@ namespace osmscout {
                                 const Location& location,
                                 AddressVisitor& visitor) const;
 
+    bool VisitMatchingAdminRegions(const std::string& pattern,
+                                   AdminRegionVisitor& visitor) const;
+
+    bool VisitMatchingAdminRegionLocations(const AdminRegion& region,
+                                           const std::string& pattern,
+                                           LocationVisitor& visitor) const;
+
     bool ResolveAdminRegionHierachie(const AdminRegionRef& region,
                                      std::map<FileOffset,AdminRegionRef>& refs) const;
 
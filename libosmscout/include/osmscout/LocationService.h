@@ -22,10 +22,14 @@
 
 #include <list>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include <osmscout/Database.h>
 #include <osmscout/Location.h>
 
+#include <osmscout/util/ThreadPool.h>
+
 namespace osmscout {
 
   /**
@@ -149,8 +153,9 @@ namespace osmscout {
     };
 
   public:
-    std::list<Entry> searches; //!< List of search entries, the queries are OR'ed
-    size_t           limit;    //!< The maximum number of results over all sub searches requested
+    std::list<Entry> searches;      //!< List of search entries, the queries are OR'ed
+    size_t           limit;         //!< The maximum number of results over all sub searches requested
+    bool             useTokenIndex; //!< Use the token index (if available), patterns then only match at the start of name tokens
 
     LocationSearch();
   };
@@ -235,9 +240,6 @@ namespace osmscout {
        void Match(const std::string& name,
                   bool& match,
                   bool& candidate) const;
-
-     private:
-       void TolowerUmlaut(std::string& s) const;
      };
 
     class AdminRegionMatchVisitor : public AdminRegionVisitor, public VisitorMatcher
@@ -357,7 +359,9 @@ namespace osmscout {
     };
 
   private:
-    DatabaseRef database;
+    DatabaseRef                 database;
+    std::mutex                  workerPoolMutex; //!< Mutex to secure the creation of the worker pool
+    std::unique_ptr<ThreadPool> workerPool;      //!< Thread pool for DescribeLocations(), created on first use
 
   private:
     bool HandleAdminRegion(const LocationSearch& search,
@@ -382,8 +386,14 @@ namespace osmscout {
                                           const AddressMatchVisitor::AddressResult& addressResult,
                                           LocationSearchResult& result) const;
 
-    bool DescribeLocationByAddress(const GeoCoord& location,
-                                   LocationDescription& description);
+    bool GetAddressTypes(TypeInfoSet& addressTypes) const;
+
+    bool DescribeLocationsByAddress(const std::vector<GeoCoord>& locations,
+                                    const std::vector<size_t>& cluster,
+                                    const TypeInfoSet& addressTypes,
+                                    std::vector<LocationDescription>& descriptions) const;
+
+    ThreadPool& GetWorkerPool();
 
   public:
     LocationService(const DatabaseRef& database);
@@ -413,6 +423,10 @@ namespace osmscout {
 
     bool DescribeLocation(const GeoCoord& location,
                           LocationDescription& description);
+
+    bool DescribeLocations(const std::vector<GeoCoord>& locations,
+                           std::vector<LocationDescription>& descriptions,
+                           bool parallel=true);
   };
 
   //! \ingroup Service
@@ -20,6 +20,7 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <algorithm>
 #include <mutex>
 #include <vector>
 
@@ -44,21 +45,23 @@ namespace osmscout {
   {
   private:
     /**
-      an individual index entry.
+      Number of entries, below which the page search switches from binary search
+      to a linear scan.
       */
-    struct Entry
-    {
-      N          startId;
-      FileOffset fileOffset;
-    };
+    static const size_t searchBlockSize=16;
 
+    /**
+      An index page. The start ids and file offsets of the entries are stored
+      in separate arrays, so that searching only touches the densely packed ids.
+      */
     struct Page
     {
-      std::vector<Entry> entries;
+      std::vector<N>          startIds;    //!< Start id of each entry, sorted ascending
+      std::vector<FileOffset> fileOffsets; //!< File offset of each entry
 
       inline bool IndexIsValid(size_t index) const
       {
-        return index<entries.size();
+        return index<startIds.size();
       }
     };
 
@@ -73,7 +76,7 @@ namespace osmscout {
     {
       size_t GetSize(const PageRef& value) const
       {
-        return sizeof(value)+sizeof(Page)+sizeof(Entry)*value->entries.size();
+        return sizeof(value)+sizeof(Page)+(sizeof(N)+sizeof(FileOffset))*value->startIds.size();
       }
     };
 
@@ -101,6 +104,7 @@ namespace osmscout {
   private:
     size_t GetPageIndex(const Page& page, N id) const;
     void ReadPage(FileOffset offset, PageRef& page) const;
+    void GetPage(size_t level, N startId, FileOffset offset, PageRef& pageRef) const;
     void InitializeCache();
 
   public:
@@ -146,38 +150,41 @@ namespace osmscout {
   }
 
   /**
-    Binary search for index page for given id
+    Search for the index of the entry with the largest start id less than or equal
+    to the given id. Returns the number of entries, if there is no such entry.
+
+    The range is first narrowed down to a block of searchBlockSize entries by a
+    binary search without data dependent branches. The block is then scanned
+    completely by counting the matching entries, which the compiler can vectorize.
     */
   template <class N>
   inline size_t NumericIndex<N>::GetPageIndex(const Page& page, N id) const
   {
-    size_t size=page.entries.size();
-
-    if (size>0) {
-      size_t left=0;
-      size_t right=size-1;
-      size_t mid;
-
-      while (left<=right) {
-        mid=(left+right)/2;
-        if (page.entries[mid].startId<=id &&
-            (mid+1>=size || page.entries[mid+1].startId>id)) {
-          return mid;
-        }
-        else if (page.entries[mid].startId<id) {
-          left=mid+1;
-        }
-        else {
-          if (mid==0) {
-            return size;
-          }
+    size_t size=page.startIds.size();
 
-          right=mid-1;
-        }
-      }
+    if (size==0 ||
+        page.startIds[0]>id) {
+      return size;
+    }
+
+    const N* base=page.startIds.data();
+    size_t   count=size;
+
+    // Invariant: base[0]<=id
+    while (count>searchBlockSize) {
+      size_t half=count/2;
+
+      base=(base[half]<=id) ? base+half : base;
+      count-=half;
+    }
+
+    size_t matches=0;
+
+    for (size_t i=0; i<count; i++) {
+      matches+=(base[i]<=id) ? 1 : 0;
     }
 
-    return size;
+    return (base-page.startIds.data())+matches-1;
   }
 
   template <class N>
@@ -187,11 +194,10 @@ namespace osmscout {
       page=std::make_shared<Page>();
     }
     else {
-      page->entries.clear();
+      page->startIds.clear();
+      page->fileOffsets.clear();
     }
 
-    page->entries.reserve(pageSize);
-
     scanner.SetPos(offset);
 
     scanner.Read(buffer,
@@ -206,7 +212,6 @@ namespace osmscout {
       unsigned int bytes;
       N            curId;
       FileOffset   curFileOffset;
-      Entry        entry;
 
       bytes=DecodeNumber(&buffer[currentPos],
                          curId);
@@ -221,10 +226,8 @@ namespace osmscout {
       prevId+=curId;
       prefFileOffset+=curFileOffset;
 
-      entry.startId=prevId;
-      entry.fileOffset=prefFileOffset;
-
-      page->entries.push_back(entry);
+      page->startIds.push_back(prevId);
+      page->fileOffsets.push_back(prefFileOffset);
     }
   }
 
@@ -341,6 +344,47 @@ namespace osmscout {
     return scanner.IsOpen();
   }
 
+  /**
+   * Return the page with the given start id and file offset of the given level
+   * below the root page, loading it if it is not cached.
+   *
+   * This method is not thread-safe.
+   */
+  template <class N>
+  void NumericIndex<N>::GetPage(size_t level,
+                                N startId,
+                                FileOffset offset,
+                                PageRef& pageRef) const
+  {
+    if (level<=simpleCacheMaxLevel) {
+      auto cacheRef=simplePageCache[level].find(startId);
+
+      if (cacheRef==simplePageCache[level].end()) {
+        pageRef=NULL; // Make sure, that we allocate a new page and not reuse an old one
+
+        ReadPage(offset,pageRef);
+
+        simplePageCache[level].insert(std::make_pair(startId,pageRef));
+      }
+      else {
+        pageRef=cacheRef->second;
+      }
+    }
+    else {
+      typename PageCache::CacheRef cacheRef;
+
+      if (!pageCaches[level].GetEntry(startId,cacheRef)) {
+        typename PageCache::CacheEntry cacheEntry(startId);
+
+        cacheRef=pageCaches[level].SetEntry(cacheEntry);
+
+        ReadPage(offset,cacheRef->value);
+      }
+
+      pageRef=cacheRef->value;
+    }
+  }
+
   /**
    * Return the file offset in the data file for the given object id.
    *
@@ -357,43 +401,18 @@ namespace osmscout {
       PageRef                     pageRef;
 
       if (!root->IndexIsValid(r)) {
-        //std::cerr << "Id " << id << " not found in root index, " << root->entries.front().startId << "-" << root->entries.back().startId << std::endl;
+        //std::cerr << "Id " << id << " not found in root index, " << root->startIds.front() << "-" << root->startIds.back() << std::endl;
         return false;
       }
 
-      const Entry& rootEntry=root->entries[r];
-
-      offset=rootEntry.fileOffset;
+      offset=root->fileOffsets[r];
 
-      N startId=rootEntry.startId;
+      N startId=root->startIds[r];
       for (size_t level=0; level+2<=levels; level++) {
-        if (level<=simpleCacheMaxLevel) {
-          auto cacheRef=simplePageCache[level].find(startId);
-
-          if (cacheRef==simplePageCache[level].end()) {
-            pageRef=NULL; // Make sure, that we allocate a new page and not reuse an old one
-
-            ReadPage(offset,pageRef);
-
-            simplePageCache[level].insert(std::make_pair(startId,pageRef));
-          }
-          else {
-            pageRef=cacheRef->second;
-          }
-        }
-        else {
-          typename PageCache::CacheRef cacheRef;
-
-          if (!pageCaches[level].GetEntry(startId,cacheRef)) {
-            typename PageCache::CacheEntry cacheEntry(startId);
-
-            cacheRef=pageCaches[level].SetEntry(cacheEntry);
-
-            ReadPage(offset,cacheRef->value);
-          }
-
-          pageRef=cacheRef->value;
-        }
+        GetPage(level,
+                startId,
+                offset,
+                pageRef);
 
         Page& page=*pageRef;
 
@@ -404,10 +423,8 @@ namespace osmscout {
           return false;
         }
 
-        const Entry& entry=page.entries[i];
-
-        startId=entry.startId;
-        offset=entry.fileOffset;
+        startId=page.startIds[i];
+        offset=page.fileOffsets[i];
       }
 
       /*
@@ -424,7 +441,14 @@ namespace osmscout {
   }
 
   /**
-   * Return the file offsets in the data file for the given object ids.
+   * Return the file offsets in the data file for the given object ids. Offsets are
+   * returned in the order of the ids, ids not found are skipped. As for GetOffset(),
+   * an error while reading an index page only skips the affected ids.
+   *
+   * The ids are resolved in ascending order while keeping the path of pages from
+   * the root to the current leaf page. For each id the tree is only descended
+   * from the deepest page of the path still covering the id, so ids sharing a
+   * leaf page are resolved by a search in that page only.
    *
    * This method is thread-safe.
    */
@@ -433,14 +457,95 @@ namespace osmscout {
                                    std::vector<FileOffset>& offsets) const
   {
     offsets.clear();
-    offsets.reserve(ids.size());
 
-    for (const auto& id : ids) {
-      FileOffset offset;
+    if (ids.empty()) {
+      return true;
+    }
+
+    std::vector<size_t> order(ids.size());
+
+    for (size_t i=0; i<order.size(); i++) {
+      order[i]=i;
+    }
+
+    if (!std::is_sorted(ids.begin(),ids.end())) {
+      std::sort(order.begin(),
+                order.end(),
+                [&ids](size_t a, size_t b) {
+                  return ids[a]<ids[b];
+                });
+    }
+
+    std::vector<FileOffset> result(ids.size());
+    std::vector<bool>       found(ids.size(),false);
 
-      if (GetOffset(id,
-                    offset)) {
-        offsets.push_back(offset);
+    std::lock_guard<std::mutex> lock(accessMutex);
+    size_t                      leafDepth=std::max(levels,(uint32_t)1);
+    std::vector<PageRef>        path(leafDepth);            // path[0] is the root page, path[leafDepth-1] the leaf page
+    std::vector<N>              upperIds(leafDepth);        // Exclusive upper bound of the ids covered by each page of the path
+    std::vector<bool>           hasUpperId(leafDepth,false);
+    size_t                      depth=1;                    // Number of pages in path
+
+    path[0]=root;
+
+    for (const auto& idx : order) {
+      N id=ids[idx];
+
+      // Go up, until we find a page covering the id
+      while (depth>1 &&
+             hasUpperId[depth-1] &&
+             id>=upperIds[depth-1]) {
+        depth--;
+      }
+
+      try {
+        while (true) {
+          const Page& page=*path[depth-1];
+          size_t      i=GetPageIndex(page,id);
+
+          if (!page.IndexIsValid(i)) {
+            break;
+          }
+
+          if (depth==leafDepth) {
+            if (page.startIds[i]==id) {
+              result[idx]=page.fileOffsets[i];
+              found[idx]=true;
+            }
+
+            break;
+          }
+
+          if (i+1<page.startIds.size()) {
+            upperIds[depth]=page.startIds[i+1];
+            hasUpperId[depth]=true;
+          }
+          else {
+            upperIds[depth]=upperIds[depth-1];
+            hasUpperId[depth]=hasUpperId[depth-1];
+          }
+
+          GetPage(depth-1,
+                  page.startIds[i],
+                  page.fileOffsets[i],
+                  path[depth]);
+
+          depth++;
+        }
+      }
+      catch (IOException& e) {
+        log.Error() << e.GetDescription();
+
+        // The path is incomplete, start the next id at the root page again
+        depth=1;
+      }
+    }
+
+    offsets.reserve(ids.size());
+
+    for (size_t i=0; i<ids.size(); i++) {
+      if (found[i]) {
+        offsets.push_back(result[i]);
       }
     }
 
@@ -456,19 +561,11 @@ namespace osmscout {
   bool NumericIndex<N>::GetOffsets(const std::list<N>& ids,
                                    std::vector<FileOffset>& offsets) const
   {
-    offsets.clear();
-    offsets.reserve(ids.size());
+    std::vector<N> idVector(ids.begin(),
+                            ids.end());
 
-    for (const auto& id : ids) {
-      FileOffset offset;
-
-      if (GetOffset(id,
-                    offset)) {
-        offsets.push_back(offset);
-      }
-    }
-
-    return true;
+    return GetOffsets(idVector,
+                      offsets);
   }
 
   /**
@@ -480,19 +577,11 @@ namespace osmscout {
   bool NumericIndex<N>::GetOffsets(const std::set<N>& ids,
                                    std::vector<FileOffset>& offsets) const
   {
-    offsets.clear();
-    offsets.reserve(ids.size());
-
-    for (const auto& id : ids) {
-      FileOffset offset;
-
-      if (GetOffset(id,
-                    offset)) {
-        offsets.push_back(offset);
-      }
-    }
+    std::vector<N> idVector(ids.begin(),
+                            ids.end());
 
-    return true;
+    return GetOffsets(idVector,
+                      offsets);
   }
 
   template <class N>
@@ -502,7 +591,7 @@ namespace osmscout {
     size_t pages=0;
 
     pages+=1;
-    memory+=root->entries.size()*sizeof(Entry);
+    memory+=root->startIds.size()*(sizeof(N)+sizeof(FileOffset));
 
 
     for (size_t i=0; i<pageCaches.size(); i++) {
@@ -0,0 +1,314 @@
+#ifndef OSMSCOUT_OBJECTVIEW_H
+#define OSMSCOUT_OBJECTVIEW_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2016 Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <vector>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/Area.h>
+#include <osmscout/GeoCoord.h>
+#include <osmscout/TypeConfig.h>
+#include <osmscout/Types.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/GeoBox.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Geometry
+   *
+   * Read-only view of an encoded coordinate array (see FileScanner::ReadCoordsInPlace()).
+   * The iterator decodes the coordinates one by one from the encoded bytes, so
+   * iterating does not allocate any memory.
+   */
+  class OSMSCOUT_API CoordsView
+  {
+  public:
+    class OSMSCOUT_API Iterator
+    {
+    private:
+      const uint8_t* delta;     //!< Next delta to apply
+      size_t         deltaSize; //!< Size of one latitude or longitude delta in bytes
+      size_t         index;     //!< Index of the current coordinate
+      size_t         nodeCount; //!< Number of coordinates
+      uint32_t       latValue;  //!< Fixed point latitude of the current coordinate
+      uint32_t       lonValue;  //!< Fixed point longitude of the current coordinate
+
+    public:
+      Iterator(const uint8_t* data,
+               size_t deltaSize,
+               size_t index,
+               size_t nodeCount);
+
+      inline GeoCoord operator*() const
+      {
+        return GeoCoord(latValue/latConversionFactor-90.0,
+                        lonValue/lonConversionFactor-180.0);
+      }
+
+      Iterator& operator++();
+
+      inline bool operator==(const Iterator& other) const
+      {
+        return index==other.index;
+      }
+
+      inline bool operator!=(const Iterator& other) const
+      {
+        return index!=other.index;
+      }
+    };
+
+  private:
+    const uint8_t* data;         //!< The first coordinate, followed by the deltas
+    size_t         nodeCount;    //!< Number of coordinates
+    size_t         coordBitSize; //!< Size of one (latitude,longitude) delta in bits
+
+  public:
+    CoordsView();
+    explicit CoordsView(const char* buffer);
+
+    inline bool IsEmpty() const
+    {
+      return nodeCount==0;
+    }
+
+    inline size_t GetNodeCount() const
+    {
+      return nodeCount;
+    }
+
+    inline Iterator begin() const
+    {
+      return Iterator(data,
+                      coordBitSize/16,
+                      0,
+                      nodeCount);
+    }
+
+    inline Iterator end() const
+    {
+      return Iterator(data,
+                      coordBitSize/16,
+                      nodeCount,
+                      nodeCount);
+    }
+
+    void CopyTo(std::vector<GeoCoord>& nodes) const;
+  };
+
+  /**
+   * \ingroup Database
+   *
+   * Cursor like read-only view of a node in a data file. In contrast to Node
+   * a view can be reused for reading the next object without reallocation.
+   */
+  class OSMSCOUT_API NodeView
+  {
+  private:
+    FileOffset         fileOffset;
+    FeatureValueBuffer featureValueBuffer;
+    GeoCoord           coords;
+
+  public:
+    NodeView();
+
+    inline FileOffset GetFileOffset() const
+    {
+      return fileOffset;
+    }
+
+    inline TypeInfoRef GetType() const
+    {
+      return featureValueBuffer.GetType();
+    }
+
+    inline const FeatureValueBuffer& GetFeatureValueBuffer() const
+    {
+      return featureValueBuffer;
+    }
+
+    inline const GeoCoord& GetCoords() const
+    {
+      return coords;
+    }
+
+    void Read(const TypeConfig& typeConfig,
+              FileScanner& scanner);
+  };
+
+  /**
+   * \ingroup Database
+   *
+   * Cursor like read-only view of a way in a data file. The geometry is not
+   * decoded but exposed as CoordsView. If the file is memory mapped, the
+   * CoordsView points directly into the mapped memory and stays valid as
+   * long as the file is open; else it is only valid until the next Read().
+   *
+   * Ids of the nodes are skipped (but still have to be read, because their
+   * size is not stored).
+   */
+  class OSMSCOUT_API WayView
+  {
+  private:
+    FileOffset         fileOffset;
+    FeatureValueBuffer featureValueBuffer;
+    GeoBox             boundingBox;
+    CoordsView         coords;
+    std::vector<char>  coordsBuffer; //!< Copy of the encoded coordinates, if the file is not memory mapped
+    std::vector<char>  idsBuffer;    //!< Skipped encoded node ids, reused between calls to Read()
+
+  public:
+    WayView();
+
+    inline FileOffset GetFileOffset() const
+    {
+      return fileOffset;
+    }
+
+    inline TypeInfoRef GetType() const
+    {
+      return featureValueBuffer.GetType();
+    }
+
+    inline const FeatureValueBuffer& GetFeatureValueBuffer() const
+    {
+      return featureValueBuffer;
+    }
+
+    inline const GeoBox& GetBoundingBox() const
+    {
+      return boundingBox;
+    }
+
+    inline const CoordsView& GetCoords() const
+    {
+      return coords;
+    }
+
+    void Read(const TypeConfig& typeConfig,
+              FileScanner& scanner);
+  };
+
+  /**
+   * \ingroup Database
+   *
+   * Cursor like read-only view of an area in a data file. Rings are exposed like
+   * in Area, the geometry of each ring as CoordsView with the same validity rules
+   * as for WayView.
+   *
+   * Ids of the nodes are skipped.
+   */
+  class OSMSCOUT_API AreaView
+  {
+  public:
+    class OSMSCOUT_API RingView
+    {
+    private:
+      FeatureValueBuffer featureValueBuffer;
+      uint8_t            ring;
+      CoordsView         coords;
+      std::vector<char>  coordsBuffer; //!< Copy of the encoded coordinates, if the file is not memory mapped
+
+      friend class AreaView;
+
+    public:
+      RingView();
+
+      inline TypeInfoRef GetType() const
+      {
+        return featureValueBuffer.GetType();
+      }
+
+      inline const FeatureValueBuffer& GetFeatureValueBuffer() const
+      {
+        return featureValueBuffer;
+      }
+
+      inline uint8_t GetRing() const
+      {
+        return ring;
+      }
+
+      inline bool IsMasterRing() const
+      {
+        return ring==Area::masterRingId;
+      }
+
+      inline bool IsOuterRing() const
+      {
+        return ring==Area::outerRingId;
+      }
+
+      inline const CoordsView& GetCoords() const
+      {
+        return coords;
+      }
+    };
+
+  private:
+    FileOffset            fileOffset;
+    GeoBox                boundingBox;
+    std::vector<RingView> rings;     //!< Ring views, reused between calls to Read()
+    size_t                ringCount; //!< Number of valid entries in rings
+    std::vector<char>     idsBuffer; //!< Skipped encoded node ids, reused between calls to Read()
+
+  public:
+    AreaView();
+
+    inline FileOffset GetFileOffset() const
+    {
+      return fileOffset;
+    }
+
+    inline TypeInfoRef GetType() const
+    {
+      return rings.front().GetType();
+    }
+
+    inline const FeatureValueBuffer& GetFeatureValueBuffer() const
+    {
+      return rings.front().GetFeatureValueBuffer();
+    }
+
+    inline const GeoBox& GetBoundingBox() const
+    {
+      return boundingBox;
+    }
+
+    inline size_t GetRingCount() const
+    {
+      return ringCount;
+    }
+
+    inline const RingView& GetRing(size_t index) const
+    {
+      return rings[index];
+    }
+
+    void Read(const TypeConfig& typeConfig,
+              FileScanner& scanner);
+  };
+}
+
+#endif
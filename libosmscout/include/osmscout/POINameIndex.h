@@ -0,0 +1,140 @@
+#ifndef OSMSCOUT_POINAMEINDEX_H
+#define OSMSCOUT_POINAMEINDEX_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2016  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <osmscout/GeoCoord.h>
+#include <osmscout/ObjectRef.h>
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/GeoBox.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Database
+   *
+   * Index of all POIs (nodes, ways and areas of types with the 'POI' option set in
+   * the map.ost file) by grid cell. Each cell holds the name, the type, the
+   * reference and a representative coordinate of all POIs within the cell.
+   *
+   * The index allows searching for POIs of given types with a name matching a given
+   * pattern near a given coordinate or within a given bounding box, reading only the
+   * cells in the neighbourhood of the search center instead of loading all objects
+   * of the requested types and filtering them by name afterwards.
+   */
+  class OSMSCOUT_API POINameIndex
+  {
+  public:
+    static const char* const FILENAME_POI_NAME_IDX;
+
+    /**
+     * A POI returned by a search
+     */
+    struct OSMSCOUT_API Entry
+    {
+      ObjectFileRef object;   //!< Reference to the object
+      TypeInfoRef   type;     //!< Type of the object
+      std::string   name;     //!< Name of the object, empty if it has no name
+      GeoCoord      coord;    //!< Coordinate of a node, center of the bounding box for ways and areas
+      double        distance; //!< Distance in km to the search center
+    };
+
+  private:
+    TypeConfigRef       typeConfig;
+    std::string         datafilename;     //!< Full path and name of the data file
+    mutable FileScanner scanner;          //!< Scanner instance for reading this file
+
+    FileOffset          tableOffset;      //!< Offset of the cell table
+    uint8_t             entryOffsetBytes; //!< Number of bytes of a cell table entry
+    uint32_t            cellXStart;
+    uint32_t            cellXEnd;
+    uint32_t            cellYStart;
+    uint32_t            cellYEnd;
+    double              cellWidth;
+    double              cellHeight;
+
+    mutable std::mutex  lookupMutex;
+
+  private:
+    void ReadCell(uint32_t x,
+                  uint32_t y,
+                  const GeoCoord& center,
+                  const GeoBox& boundingBox,
+                  double maxDistance,
+                  const std::string& pattern,
+                  const TypeInfoSet& types,
+                  size_t limit,
+                  std::vector<Entry>& entries) const;
+
+    void VisitCells(const GeoCoord& center,
+                    const GeoBox& boundingBox,
+                    double maxDistance,
+                    const std::string& pattern,
+                    const TypeInfoSet& types,
+                    size_t limit,
+                    std::vector<Entry>& entries) const;
+
+    bool GetClosestEntries(const GeoCoord& center,
+                           const std::vector<GeoBox>& boundingBoxes,
+                           double maxDistance,
+                           const std::string& pattern,
+                           const TypeInfoSet& types,
+                           size_t limit,
+                           std::vector<Entry>& entries) const;
+
+  public:
+    POINameIndex();
+
+    void Close();
+    bool Open(const TypeConfigRef& typeConfig,
+              const std::string& path);
+
+    inline bool IsOpen() const
+    {
+      return scanner.IsOpen();
+    }
+
+    bool GetClosestEntries(const GeoCoord& center,
+                           const GeoBox& boundingBox,
+                           double maxDistance,
+                           const std::string& pattern,
+                           const TypeInfoSet& types,
+                           size_t limit,
+                           std::vector<Entry>& entries) const;
+
+    bool GetClosestEntries(const GeoCoord& center,
+                           double maxDistance,
+                           const std::string& pattern,
+                           const TypeInfoSet& types,
+                           size_t limit,
+                           std::vector<Entry>& entries) const;
+  };
+
+  typedef std::shared_ptr<POINameIndex> POINameIndexRef;
+}
+
+#endif
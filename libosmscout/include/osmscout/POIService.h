@@ -21,6 +21,7 @@
 */
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <osmscout/Database.h>
@@ -36,6 +37,7 @@ namespace osmscout {
    *
    * Currently this includes the following functionality:
    * - Locating POIs of given types in a given area
+   * - Searching the POIs of given types closest to a given location by name
    */
   class OSMSCOUT_API POIService
   {
@@ -65,6 +67,19 @@ namespace osmscout {
                        std::vector<WayRef>& ways,
                        const TypeInfoSet& areaTypes,
                        std::vector<AreaRef>& areas) const;
+
+    bool SearchPOIsByName(const GeoCoord& center,
+                          double maxDistance,
+                          const std::string& pattern,
+                          const TypeInfoSet& types,
+                          size_t limit,
+                          std::vector<POINameIndex::Entry>& pois) const;
+
+    bool SearchPOIsByName(const GeoBox& boundingBox,
+                          const std::string& pattern,
+                          const TypeInfoSet& types,
+                          size_t limit,
+                          std::vector<POINameIndex::Entry>& pois) const;
   };
 
   //! \ingroup Service
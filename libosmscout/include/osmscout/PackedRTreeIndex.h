@@ -0,0 +1,185 @@
+#ifndef OSMSCOUT_PACKEDRTREEINDEX_H
+#define OSMSCOUT_PACKEDRTREEINDEX_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2016  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/GeoBox.h>
+#include <osmscout/util/Geometry.h>
+
+namespace osmscout {
+
+  /**
+    \ingroup Database
+    PackedRTreeIndex is an optional, static R-tree over all objects of one kind
+    (nodes, ways or areas) and an alternative to the area*.idx index files.
+
+    The tree is bulk loaded by the importer: Objects are sorted by the Hilbert value
+    of the center of their bounding box and packed into leaf nodes of fixed size, the
+    parent levels are build by grouping the nodes of the level below. Each leaf entry
+    holds the bounding box, the type and the file offset of an object.
+
+    All values are stored with fixed width, so the file can be used memory mapped
+    without any decoding step:
+
+    - uint32_t node size, uint32_t level count, uint64_t item count
+    - uint64_t end index of each level (level 0 holds the items, the last level the root)
+    - the boxes of all levels, four uint32_t each (minLat, minLon, maxLat, maxLon in
+      the fixed point representation of GeoCoord)
+    - the file offset of each item as uint64_t
+    - the type index of each item as uint16_t
+
+    After opening the index is immutable, queries do not lock and can be executed
+    in parallel.
+    */
+  class OSMSCOUT_API PackedRTreeIndex
+  {
+  public:
+    static const char* NODE_RTREE_IDX;
+    static const char* WAY_RTREE_IDX;
+    static const char* AREA_RTREE_IDX;
+
+    /**
+     * Bounding box in the fixed point representation used by the index
+     */
+    struct OSMSCOUT_API Box
+    {
+      uint32_t minLat;
+      uint32_t minLon;
+      uint32_t maxLat;
+      uint32_t maxLon;
+
+      static Box FromGeoBox(const GeoBox& boundingBox);
+
+      inline bool Intersects(const Box& other) const
+      {
+        return !(maxLat<other.minLat ||
+                 minLat>other.maxLat ||
+                 maxLon<other.minLon ||
+                 minLon>other.maxLon);
+      }
+    };
+
+    /**
+     * Visitor for VisitNearest()
+     */
+    class OSMSCOUT_API NearestVisitor
+    {
+    public:
+      virtual ~NearestVisitor();
+
+      /**
+       * Called for each object in the order of increasing distance of its bounding
+       * box to the search coordinate. The distance is a lower bound of the distance
+       * of the object itself. Return false to stop the search.
+       */
+      virtual bool Visit(FileOffset offset,
+                         double boxDistance) = 0;
+    };
+
+    /**
+     * Optional statistics of a single query, passed by the caller to measure the
+     * amount of index data a query touches. Like FileScanner::GetBytesRead() for
+     * memory mapped files, reading the same data again counts again.
+     */
+    struct OSMSCOUT_API QueryStatistics
+    {
+      uint64_t bytesRead; //!< Number of bytes of the index read by the query
+
+      QueryStatistics()
+      : bytesRead(0)
+      {
+        // no code
+      }
+    };
+
+    static const size_t headerSize=16;   //!< Size of the fixed part of the header
+    static const size_t boxSize=16;      //!< Size of one box
+    static const size_t offsetSize=8;    //!< Size of the file offset of an item
+    static const size_t typeSize=2;      //!< Size of the type index of an item
+
+  private:
+    TypeConfigRef           typeConfig;   //!< Type configuration
+    std::string             datafilename; //!< Full path and name of the data file
+    FileScanner             scanner;      //!< Scanner for the (memory mapped) file
+    std::vector<char>       content;      //!< Content of the file, if it cannot be memory mapped
+
+    const unsigned char     *data;        //!< Pointer to the file content
+    uint32_t                nodeSize;     //!< Maximum number of children of a node
+    uint64_t                itemCount;    //!< Number of items
+    std::vector<uint64_t>   levelEnds;    //!< End index of each level in the box array
+    const unsigned char     *boxes;       //!< Start of the boxes
+    const unsigned char     *fileOffsets; //!< Start of the item file offsets
+    const unsigned char     *typeIndexes; //!< Start of the item type indexes
+
+  private:
+    Box GetBox(uint64_t index) const;
+    GeoBox GetGeoBox(uint64_t index) const;
+
+  public:
+    PackedRTreeIndex();
+    virtual ~PackedRTreeIndex();
+
+    void Close();
+    bool Open(const TypeConfigRef& typeConfig,
+              const std::string& path,
+              const std::string& filename);
+
+    inline bool IsOpen() const
+    {
+      return data!=NULL;
+    }
+
+    inline std::string GetFilename() const
+    {
+      return datafilename;
+    }
+
+    /**
+     * Return the number of indexed objects
+     */
+    inline uint64_t GetItemCount() const
+    {
+      return itemCount;
+    }
+
+    bool GetOffsets(const GeoBox& boundingBox,
+                    const TypeInfoSet& types,
+                    std::vector<FileOffset>& offsets,
+                    TypeInfoSet& loadedTypes,
+                    QueryStatistics* statistics=NULL) const;
+
+    bool VisitNearest(const EquirectangularDistance& distance,
+                      const TypeInfoSet& types,
+                      double maxDistance,
+                      NearestVisitor& visitor,
+                      QueryStatistics* statistics=NULL) const;
+  };
+
+  typedef std::shared_ptr<PackedRTreeIndex> PackedRTreeIndexRef;
+}
+
+#endif
@@ -202,6 +202,17 @@ namespace osmscout {
 
     bool HasNodeWithId(const std::vector<Id>& ids) const;
 
+    bool GetRoutableObjectsInBox(const GeoBox& boundingBox,
+                                 const TypeInfoSet& wayRoutableTypes,
+                                 const TypeInfoSet& areaRoutableTypes,
+                                 std::vector<AreaRef>& areas,
+                                 std::vector<WayRef>& ways) const;
+    double GetClosestRoutableNode(const EquirectangularDistance& distance,
+                                  const std::vector<AreaRef>& areas,
+                                  const std::vector<WayRef>& ways,
+                                  ObjectFileRef& object,
+                                  size_t& nodeIndex) const;
+
     bool LoadObjectVariantData(const std::string& filename,
                                std::vector<ObjectVariantData>& objectVariantData) const;
 
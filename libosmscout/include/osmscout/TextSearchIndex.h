@@ -20,7 +20,9 @@
  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
  */
 
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include <osmscout/ObjectRef.h>
 
@@ -34,6 +36,11 @@ namespace osmscout
    \ingroup Database
    A class that allows prefix-based searching
    of text data indexed during import
+
+   The tries are memory mapped and not changed after
+   Load(), each search uses its own marisa agents. A
+   loaded index can thus be searched from multiple
+   threads in parallel.
    */
   class OSMSCOUT_API TextSearchIndex
   {
@@ -46,12 +53,12 @@ namespace osmscout
   private:
     struct TrieInfo
     {
-      marisa::Trie *trie;
-      std::string  file;
-      bool         isAvail;
+      std::unique_ptr<marisa::Trie> trie;
+      std::string                   file;
+      bool                          isAvail;
+      std::vector<std::string>      characters; //!< All characters used by the texts of the trie
 
       TrieInfo() :
-        trie(NULL),
         isAvail(false)
       {
         // no code
@@ -61,6 +68,85 @@ namespace osmscout
   public:
     typedef std::unordered_map<std::string,std::vector<ObjectFileRef> > ResultsMap;
 
+    /**
+     * Reusable buffer for the results of Search(). The texts of all
+     * results are stored in one character buffer, results with the same
+     * text as the previous result share its text. Clear() keeps the
+     * allocated memory, so a buffer reused for multiple searches does
+     * not allocate memory per result.
+     */
+    class OSMSCOUT_API ResultBuffer
+    {
+    private:
+      struct Entry
+      {
+        size_t        textOffset; //!< Offset of the text in the character buffer
+        size_t        textLength; //!< Length of the text
+        ObjectFileRef object;     //!< The object
+      };
+
+    private:
+      std::string        texts;   //!< The texts of all results
+      std::vector<Entry> entries; //!< The results
+
+    public:
+      void Clear();
+
+      void Append(const char* text,
+                  size_t textLength,
+                  const ObjectFileRef& object);
+
+      inline size_t GetSize() const
+      {
+        return entries.size();
+      }
+
+      inline bool IsEmpty() const
+      {
+        return entries.empty();
+      }
+
+      inline const char* GetTextData(size_t index) const
+      {
+        return texts.data()+entries[index].textOffset;
+      }
+
+      inline size_t GetTextLength(size_t index) const
+      {
+        return entries[index].textLength;
+      }
+
+      inline std::string GetText(size_t index) const
+      {
+        return texts.substr(entries[index].textOffset,
+                            entries[index].textLength);
+      }
+
+      /**
+       * Returns true, if the results share their text
+       */
+      inline bool HasSameText(size_t a,
+                              size_t b) const
+      {
+        return entries[a].textOffset==entries[b].textOffset;
+      }
+
+      inline const ObjectFileRef& GetObject(size_t index) const
+      {
+        return entries[index].object;
+      }
+    };
+
+    /**
+     * A result of SearchRanked()
+     */
+    struct OSMSCOUT_API RankedResult
+    {
+      std::string                text;     //!< The matching text
+      size_t                     distance; //!< Edit distance between the query and the closest prefix of the text
+      std::vector<ObjectFileRef> objects;  //!< The objects with the given text
+    };
+
     TextSearchIndex();
 
     ~TextSearchIndex();
@@ -74,10 +160,26 @@ namespace osmscout
                 bool searchOther,
                 ResultsMap& results) const;
 
+    bool Search(const std::string& query,
+                bool searchPOIs,
+                bool searchLocations,
+                bool searchRegions,
+                bool searchOther,
+                ResultBuffer& results) const;
+
+    bool SearchRanked(const std::string& query,
+                      bool searchPOIs,
+                      bool searchLocations,
+                      bool searchRegions,
+                      bool searchOther,
+                      size_t maxDistance,
+                      size_t limit,
+                      std::vector<RankedResult>& results) const;
+
   private:
-    void splitSearchResult(const std::string& result,
-                           std::string& text,
-                           ObjectFileRef& ref) const;
+    size_t decodeSearchResult(const char* result,
+                              size_t resultLength,
+                              ObjectFileRef& ref) const;
 
 
     uint8_t               offsetSizeBytes;  //! size in bytes of FileOffsets stored in the tries
@@ -38,6 +38,7 @@
 
 #include <osmscout/util/FileScanner.h>
 #include <osmscout/util/FileWriter.h>
+#include <osmscout/util/MemoryArena.h>
 #include <osmscout/util/Progress.h>
 
 #include <osmscout/system/Assert.h>
@@ -935,9 +936,10 @@ namespace osmscout {
   class OSMSCOUT_API FeatureValueBuffer
   {
   private:
-    TypeInfoRef type;
-    uint8_t     *featureBits;
-    char        *featureValueBuffer;
+    TypeInfoRef    type;
+    uint8_t        *featureBits;        //!< Bit mask of set features, stored behind the values in featureValueBuffer
+    char           *featureValueBuffer; //!< Combined buffer for values and bit mask
+    MemoryArenaRef arena;               //!< Arena featureValueBuffer was allocated from, else empty. Keeps all slabs of the arena alive!
 
   private:
     void DeleteData();
@@ -999,7 +1001,7 @@ namespace osmscout {
     bool operator!=(const FeatureValueBuffer& other) const;
   };
 
-  static const uint32_t FILE_FORMAT_VERSION = 3;
+  static const uint32_t FILE_FORMAT_VERSION = 4;
 
   /**
    * \ingroup type
@@ -27,6 +27,7 @@
 #include <osmscout/TypeConfig.h>
 
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/CompactGeoCoords.h>
 #include <osmscout/util/FileWriter.h>
 #include <osmscout/util/GeoBox.h>
 #include <osmscout/util/Geometry.h>
@@ -40,13 +41,16 @@ namespace osmscout {
     FeatureValueBuffer    featureValueBuffer; //!< List of features
 
     FileOffset            fileOffset;
-
+    GeoBox                boundingBox;        //!< Bounding box as stored in the record, only used while HasEncodedGeometry()
+    std::vector<char>     encodedGeometry;    //!< Not yet decoded nodes and ids, only filled by ReadLazy()
 
   public:
     std::vector<Id>       ids;
     std::vector<GeoCoord> nodes;
+    CompactGeoCoords      compactNodes; //!< Compact storage of nodes, only filled after CompactNodes()
 
   private:
+    bool HasIds() const;
     void ReadIds(FileScanner& scanner);
     void WriteIds(FileWriter& writer) const;
 
@@ -102,10 +106,52 @@ namespace osmscout {
       return (ids[0]!=0 && ids[0]==ids[ids.size()-1]);
     }
 
+    /**
+     * Returns true, if the coordinates are stored in compactNodes instead of nodes
+     */
+    inline bool HasCompactNodes() const
+    {
+      return !compactNodes.IsEmpty();
+    }
+
+    /**
+     * Returns true, if the way was read using ReadLazy() and nodes and ids
+     * have not yet been decoded using DecodeGeometry()
+     */
+    inline bool HasEncodedGeometry() const
+    {
+      return !encodedGeometry.empty();
+    }
+
+    /**
+     * Returns the memory used by the not yet decoded geometry
+     */
+    inline size_t GetEncodedGeometryMemorySize() const
+    {
+      return encodedGeometry.capacity();
+    }
+
+    inline size_t GetNodeCount() const
+    {
+      if (HasEncodedGeometry()) {
+        return GetEncodedCoordCount(encodedGeometry.data());
+      }
+
+      return HasCompactNodes() ? compactNodes.GetSize() : nodes.size();
+    }
+
     inline void GetBoundingBox(GeoBox& boundingBox) const
     {
-      osmscout::GetBoundingBox(nodes,
-                               boundingBox);
+      if (HasEncodedGeometry()) {
+        boundingBox=this->boundingBox;
+      }
+      else if (HasCompactNodes()) {
+        compactNodes.GetBoundingBox(boundingBox);
+      }
+      else {
+        osmscout::GetBoundingBox(nodes,
+                                 boundingBox);
+      }
     }
 
     bool GetCenter(GeoCoord& center) const;
@@ -129,8 +175,17 @@ namespace osmscout {
 
     void SetLayerToMax();
 
+    void CompactNodes();
+    void ExpandNodes();
+
+    void DecodeGeometry();
+    void DecodeGeometry(std::vector<GeoCoord>& nodes,
+                        std::vector<Id>& ids) const;
+
     void Read(const TypeConfig& typeConfig,
               FileScanner& scanner);
+    void ReadLazy(const TypeConfig& typeConfig,
+                  FileScanner& scanner);
     void ReadOptimized(const TypeConfig& typeConfig,
                        FileScanner& scanner);
 
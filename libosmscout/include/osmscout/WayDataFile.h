@@ -36,6 +36,12 @@ namespace osmscout {
     static const char* WAYS_DAT;
     static const char* WAYS_IDMAP;
 
+  protected:
+    void ReadObject(const TypeConfig& typeConfig,
+                    FileScanner& scanner,
+                    bool lazyGeometry,
+                    Way& data) const;
+
   public:
     WayDataFile();
   };
@@ -0,0 +1,98 @@
+#ifndef OSMSCOUT_UTIL_BLOCKCOMPRESSION_H
+#define OSMSCOUT_UTIL_BLOCKCOMPRESSION_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2016 Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/Types.h>
+
+#include <osmscout/util/Cache.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup File
+   *
+   * Reader for block compressed files as written by CompressFile().
+   *
+   * A block compressed file consists of a header, the individually compressed
+   * blocks of fixed (uncompressed) size and a table holding the file offset of
+   * each block. Thus any position of the uncompressed data can be read by just
+   * decompressing the block containing it. Recently used blocks are held in a
+   * small cache.
+   *
+   * The reader is used by FileScanner to transparently read block compressed files.
+   * It is not thread-safe.
+   */
+  class OSMSCOUT_API BlockCompressedFileReader
+  {
+  private:
+    typedef Cache<size_t,std::vector<char>> BlockCache;
+
+  private:
+    std::string              filename;     //!< Filename
+    std::FILE                *file;        //!< The file handle, owned by the caller
+    uint32_t                 blockSize;    //!< Uncompressed size of a block
+    FileOffset               size;         //!< Uncompressed size of the file
+    std::vector<FileOffset>  blockOffsets; //!< File offset of each block plus the end offset of the last block
+    std::vector<char>        readBuffer;   //!< Buffer for the compressed data of a block
+    BlockCache               blockCache;   //!< Cache of decompressed blocks
+    size_t                   currentIndex; //!< Index of the most recently accessed block
+    BlockCache::CacheRef     currentBlock; //!< Most recently accessed block, valid if currentIndex<blockOffsets.size()
+
+  private:
+    void LoadBlock(size_t index);
+
+  public:
+    explicit BlockCompressedFileReader(size_t cacheSize=16);
+
+    void Open(const std::string& filename,
+              std::FILE* file);
+
+    size_t Read(FileOffset pos,
+                char* buffer,
+                size_t bytes);
+
+    /**
+     * Return the size of the uncompressed data
+     */
+    inline FileOffset GetSize() const
+    {
+      return size;
+    }
+
+    static bool IsBlockCompressed(std::FILE* file);
+  };
+
+  extern OSMSCOUT_API bool IsBlockCompressedFile(const std::string& filename);
+
+  extern OSMSCOUT_API bool HasBlockCompressionSupport();
+
+  extern OSMSCOUT_API bool CompressFile(const std::string& sourceFilename,
+                                        const std::string& targetFilename,
+                                        uint32_t blockSize);
+}
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef OSMSCOUT_UTIL_COMPACTGEOCOORDS_H
+#define OSMSCOUT_UTIL_COMPACTGEOCOORDS_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2016  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <vector>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/system/Types.h>
+
+#include <osmscout/GeoCoord.h>
+
+#include <osmscout/util/GeoBox.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Geometry
+   *
+   * Converts count fixed point coordinates (interleaved lat and lon values
+   * as stored in the data files) to GeoCoords.
+   */
+  extern OSMSCOUT_API void ConvertFixedPointCoords(const uint32_t* values,
+                                                   size_t count,
+                                                   GeoCoord* coords);
+
+  /**
+   * \ingroup Geometry
+   *
+   * Compact storage for an array of coordinates. Every coordinate is stored as
+   * two 32 bit fixed point values using the resolution of the data files, so it
+   * only needs half the memory of a std::vector<GeoCoord> without loosing
+   * any precision for coordinates loaded from the database.
+   *
+   * Coordinates are converted back to GeoCoord on access, either one by one
+   * or in bulk via Get().
+   */
+  class OSMSCOUT_API CompactGeoCoords
+  {
+  private:
+    std::vector<uint32_t> values; //!< Interleaved lat and lon fixed point values
+
+  public:
+    CompactGeoCoords();
+
+    void Set(const std::vector<GeoCoord>& coords);
+
+    void Get(std::vector<GeoCoord>& coords) const;
+
+    GeoCoord Get(size_t index) const;
+
+    /**
+     * Return the latitude of the coordinate with the given index without
+     * converting the whole coordinate
+     */
+    inline double GetLat(size_t index) const
+    {
+      return values[index*2]/latConversionFactor-90.0;
+    }
+
+    /**
+     * Return the longitude of the coordinate with the given index without
+     * converting the whole coordinate
+     */
+    inline double GetLon(size_t index) const
+    {
+      return values[index*2+1]/lonConversionFactor-180.0;
+    }
+
+    void GetBoundingBox(GeoBox& boundingBox) const;
+
+    void Clear();
+
+    inline size_t GetSize() const
+    {
+      return values.size()/2;
+    }
+
+    inline bool IsEmpty() const
+    {
+      return values.empty();
+    }
+
+    /**
+     * Return the memory allocated for the coordinates in bytes
+     */
+    inline size_t GetMemorySize() const
+    {
+      return values.capacity()*sizeof(uint32_t);
+    }
+  };
+}
+
+#endif
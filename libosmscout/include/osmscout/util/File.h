@@ -44,6 +44,13 @@ namespace osmscout {
    */
   extern OSMSCOUT_API FileOffset GetFileSize(const std::string& filename);
 
+  /**
+   * \ingroup File
+   *
+   * Return true, if the given file exists and can be opened for reading
+   */
+  extern OSMSCOUT_API bool ExistsInFilesystem(const std::string& filename);
+
   /**
    * \ingroup File
    *
@@ -43,6 +43,8 @@
 
 namespace osmscout {
 
+  class BlockCompressedFileReader;
+
   /**
     \ingroup File
 
@@ -79,6 +81,16 @@ namespace osmscout {
     // For std::vector<GeoCoord> loading
     uint8_t              *byteBuffer;    //!< Temporary buffer for loading of std::vector<GeoCoord>
     size_t               byteBufferSize; //!< Size of the temporary byte buffer
+    std::vector<uint32_t> coordBuffer;   //!< Temporary buffer for the decoded fixed point coordinate values
+
+    // For block compressed files
+    BlockCompressedFileReader *compressedFile; //!< Reader for the uncompressed data, if the file is block compressed
+
+    std::vector<char>    rangeData;      //!< Data of the range read by ReadRange(), empty if there is none
+    FileOffset           rangeStart;     //!< File offset of the first byte of rangeData
+
+    FileOffset           bytesRead;      //!< Number of bytes read, see GetBytesRead()
+    FileOffset           readStart;      //!< Offset of the last position set in the memory mapped file
 
     // For Windows mmap usage
 #if defined(__WIN32__) || defined(WIN32)
@@ -88,6 +100,8 @@ namespace osmscout {
   private:
     void AssureByteBufferSize(size_t size);
     void FreeBuffer();
+    size_t ReadFromFile(void* buffer, size_t bytes);
+    size_t ReadCoordsHeader(uint8_t header[]);
 
   public:
     FileScanner();
@@ -113,10 +127,35 @@ namespace osmscout {
 
     std::string GetFilename() const;
 
+    /**
+     * Return the size of the file content, for block compressed
+     * files the size of the uncompressed data.
+     */
+    inline FileOffset GetSize() const
+    {
+      return size;
+    }
+
+    /**
+     * Return the memory the file is mapped to or NULL, if the file is not
+     * memory mapped. The memory stays valid until the file is closed.
+     */
+    inline const char* GetMappedData() const
+    {
+      return buffer;
+    }
+
     void GotoBegin();
     void SetPos(FileOffset pos);
     FileOffset GetPos() const;
 
+    FileOffset GetBytesRead() const;
+
+    void Prefetch(FileOffset pos,
+                  FileOffset bytes);
+    void ReadRange(FileOffset pos,
+                   FileOffset bytes);
+
     void Read(char* buffer, size_t bytes);
 
     void Read(std::string& value);
@@ -156,6 +195,10 @@ namespace osmscout {
                               bool& isSet);
 
     void Read(std::vector<GeoCoord>& nodes);
+    void ReadCoordsEncoded(std::vector<char>& data);
+    void ReadIdsEncoded(size_t nodeCount,
+                        std::vector<char>& data);
+    const char* ReadCoordsInPlace(std::vector<char>& data);
 
     void ReadBox(GeoBox& box);
 
@@ -180,6 +223,15 @@ namespace osmscout {
     void Read(ObjectFileRef& ref);
   };
 
+  extern OSMSCOUT_API size_t DecodeCoordsHeader(const uint8_t* header,
+                                                size_t& nodeCount,
+                                                size_t& coordBitSize);
+  extern OSMSCOUT_API size_t GetEncodedCoordCount(const char* buffer);
+  extern OSMSCOUT_API size_t DecodeCoords(const char* buffer,
+                                          std::vector<GeoCoord>& nodes);
+  extern OSMSCOUT_API size_t DecodeIds(const char* buffer,
+                                       size_t nodeCount,
+                                       std::vector<Id>& ids);
 }
 
 #endif
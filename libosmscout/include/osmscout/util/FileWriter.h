@@ -33,6 +33,7 @@
 #include <osmscout/Types.h>
 
 #include <osmscout/util/Exception.h>
+#include <osmscout/util/GeoBox.h>
 
 namespace osmscout {
 
@@ -114,6 +115,8 @@ namespace osmscout {
 
     void Write(const std::vector<GeoCoord>& nodes);
 
+    void WriteBox(const GeoBox& box);
+
     void WriteTypeId(TypeId id, uint8_t maxBytes);
 
     void Flush();
@@ -786,6 +786,60 @@ namespace osmscout {
    */
   extern OSMSCOUT_API double NormalizeRelativeAngel(double angle);
 
+  /**
+   * \ingroup Geometry
+   * Calculates distances (in km) of coordinates, line segments and bounding boxes
+   * to a fixed reference coordinate by projecting them onto a plane through the reference
+   * coordinate (equirectangular projection).
+   *
+   * The distances are a good approximation for the vicinity of the reference coordinate.
+   * Since the projection maps bounding boxes to rectangles, the distance to a bounding
+   * box is a lower bound of the distance to everything inside it, which makes the
+   * distances suitable for nearest neighbour searches.
+   */
+  class OSMSCOUT_API EquirectangularDistance
+  {
+  private:
+    GeoCoord reference;   //!< The reference coordinate
+    double   lonFactor;   //!< Length of a degree longitude relative to a degree latitude
+
+  private:
+    inline double GetDistance(double latDelta,
+                              double lonDelta) const
+    {
+      double x=lonDelta*lonFactor;
+
+      return sqrt(latDelta*latDelta+x*x)*kmPerDegree;
+    }
+
+  public:
+    static const double kmPerDegree;
+
+  public:
+    explicit EquirectangularDistance(const GeoCoord& reference);
+
+    inline const GeoCoord& GetReference() const
+    {
+      return reference;
+    }
+
+    /**
+     * Return the distance of the given coordinate
+     */
+    inline double GetDistance(const GeoCoord& coord) const
+    {
+      return GetDistance(coord.GetLat()-reference.GetLat(),
+                         coord.GetLon()-reference.GetLon());
+    }
+
+    double GetDistance(const GeoCoord& a,
+                       const GeoCoord& b,
+                       GeoCoord& closest) const;
+    double GetDistance(const GeoBox& boundingBox) const;
+
+    GeoBox GetBoundingBox(double distance) const;
+  };
+
   struct OSMSCOUT_API ScanCell
   {
     int x;
@@ -0,0 +1,199 @@
+#ifndef OSMSCOUT_UTIL_MEMORYARENA_H
+#define OSMSCOUT_UTIL_MEMORYARENA_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2016 Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <osmscout/private/CoreImportExport.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Util
+   *
+   * A simple bump allocator, that carves allocations from a small number of
+   * large slabs. Memory is not freed individually, all slabs are freed at once
+   * if the arena gets destroyed.
+   *
+   * An arena is activated for the current thread using a MemoryArenaScope.
+   * While active, FeatureValueBuffer data and objects created via AllocateShared()
+   * are allocated from the arena. Each of them holds a reference to the arena, so
+   * the arena lives as long as data allocated from it.
+   *
+   * Since memory is only freed as a whole, a single surviving object pins all
+   * slabs of its arena. Arenas should therefore only be used for objects with a
+   * common lifetime (like all objects loaded for one tile). Objects, that escape
+   * this lifetime, should be copied out of the arena using CopyOutOfArena().
+   *
+   * The arena itself is not thread-safe, it must only be active in one thread
+   * at a time.
+   */
+  class OSMSCOUT_API MemoryArena : public std::enable_shared_from_this<MemoryArena>
+  {
+  private:
+    size_t             slabSize;      //!< Size of a standard slab
+    std::vector<char*> slabs;         //!< All allocated slabs
+    char*              current;       //!< Start of the free space in the current slab
+    size_t             available;     //!< Free bytes in the current slab
+    size_t             memorySize;    //!< Overall size of all slabs
+
+  private:
+    MemoryArena(const MemoryArena& other);
+    MemoryArena& operator=(const MemoryArena& other);
+
+    char* AllocateSlab(size_t size);
+
+  public:
+    explicit MemoryArena(size_t slabSize=65536);
+    virtual ~MemoryArena();
+
+    void* Allocate(size_t size);
+
+    inline size_t GetMemorySize() const
+    {
+      return memorySize;
+    }
+
+    static MemoryArena* GetCurrentArena();
+  };
+
+  typedef std::shared_ptr<MemoryArena> MemoryArenaRef;
+
+  /**
+   * \ingroup Util
+   *
+   * Activates the given arena for the current thread for the lifetime of the
+   * scope object. Passing an empty reference deactivates arena allocation
+   * for the scope. Scopes can be nested.
+   */
+  class OSMSCOUT_API MemoryArenaScope
+  {
+  private:
+    MemoryArena* previousArena;
+
+  private:
+    MemoryArenaScope(const MemoryArenaScope& other);
+    MemoryArenaScope& operator=(const MemoryArenaScope& other);
+
+  public:
+    explicit MemoryArenaScope(const MemoryArenaRef& arena);
+    ~MemoryArenaScope();
+  };
+
+  /**
+   * \ingroup Util
+   *
+   * STL compatible allocator returning memory from a MemoryArena. Deallocation
+   * is a no-op, the allocator keeps the arena alive instead.
+   */
+  template<class T>
+  class ArenaAllocator
+  {
+  public:
+    typedef T value_type;
+
+  private:
+    MemoryArenaRef arena;
+
+    template<class U>
+    friend class ArenaAllocator;
+
+  public:
+    explicit ArenaAllocator(const MemoryArenaRef& arena)
+    : arena(arena)
+    {
+      // no code
+    }
+
+    template<class U>
+    ArenaAllocator(const ArenaAllocator<U>& other)
+    : arena(other.arena)
+    {
+      // no code
+    }
+
+    T* allocate(size_t n)
+    {
+      return static_cast<T*>(arena->Allocate(n*sizeof(T)));
+    }
+
+    void deallocate(T* /*p*/,
+                    size_t /*n*/)
+    {
+      // no code
+    }
+
+    template<class U>
+    bool operator==(const ArenaAllocator<U>& other) const
+    {
+      return arena==other.arena;
+    }
+
+    template<class U>
+    bool operator!=(const ArenaAllocator<U>& other) const
+    {
+      return arena!=other.arena;
+    }
+  };
+
+  /**
+   * \ingroup Util
+   *
+   * Create a new default constructed instance of T. If an arena is active for the current
+   * thread, the object (and its reference count) is allocated from the arena, else
+   * std::make_shared() is used.
+   */
+  template<class T>
+  std::shared_ptr<T> AllocateShared()
+  {
+    MemoryArena* arena=MemoryArena::GetCurrentArena();
+
+    if (arena!=NULL) {
+      return std::allocate_shared<T>(ArenaAllocator<T>(arena->shared_from_this()));
+    }
+
+    return std::make_shared<T>();
+  }
+
+  /**
+   * \ingroup Util
+   *
+   * Return a copy of the given object (of type Node, Way or Area) allocated from the
+   * heap, independent of any arena active for the current thread. In contrast to
+   * the original, the copy does not keep the arena of the original alive, so the
+   * memory held by the copy is limited to the object itself.
+   */
+  template<class T>
+  std::shared_ptr<T> CopyOutOfArena(const std::shared_ptr<T>& object)
+  {
+    if (!object) {
+      return object;
+    }
+
+    MemoryArenaScope heapScope((MemoryArenaRef()));
+
+    return std::make_shared<T>(*object);
+  }
+}
+
+#endif
@@ -20,10 +20,13 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <vector>
+
 #include <osmscout/private/CoreImportExport.h>
 
 #include <osmscout/GeoCoord.h>
 
+#include <osmscout/util/CompactGeoCoords.h>
 #include <osmscout/util/GeoBox.h>
 #include <osmscout/util/Magnification.h>
 
@@ -299,6 +302,25 @@ namespace osmscout {
     virtual void GeoToPixel(const GeoCoord& coord,
                             double& x, double& y) const = 0;
 
+    /**
+     * Converts all given geo coordinates to pixel coordinates. The resulting
+     * coordinates are written to the arrays x and y, which must be able to
+     * hold (at least) coords.size() values.
+     *
+     * The default implementation calls GeoToPixel() for each coordinate,
+     * projections should override it with an optimized version.
+     */
+    virtual void GeoToPixel(const std::vector<GeoCoord>& coords,
+                            double* x, double* y) const;
+
+    /**
+     * Converts all given compact geo coordinates to pixel coordinates without
+     * converting them to GeoCoords first. Like for std::vector<GeoCoord>, x
+     * and y must be able to hold (at least) coords.GetSize() values.
+     */
+    virtual void GeoToPixel(const CompactGeoCoords& coords,
+                            double* x, double* y) const;
+
   protected:
     virtual void GeoToPixel(const BatchTransformer& transformData) const = 0;
 
@@ -380,6 +402,12 @@ namespace osmscout {
     void GeoToPixel(const GeoCoord& coord,
                     double& x, double& y) const;
 
+    void GeoToPixel(const std::vector<GeoCoord>& coords,
+                    double* x, double* y) const;
+
+    void GeoToPixel(const CompactGeoCoords& coords,
+                    double* x, double* y) const;
+
     bool Move(double horizPixel,
               double vertPixel);
 
@@ -405,6 +433,12 @@ namespace osmscout {
 
   protected:
      void GeoToPixel(const BatchTransformer& transformData) const;
+
+  private:
+    template<class C>
+    void TransformCoords(const C& coords,
+                         size_t count,
+                         double* x, double* y) const;
   };
 
   /**
@@ -479,9 +513,21 @@ namespace osmscout {
     void GeoToPixel(const GeoCoord& coord,
                     double& x, double& y) const;
 
+    void GeoToPixel(const std::vector<GeoCoord>& coords,
+                    double* x, double* y) const;
+
+    void GeoToPixel(const CompactGeoCoords& coords,
+                    double* x, double* y) const;
+
   protected:
 
      void GeoToPixel(const BatchTransformer& transformData) const;
+
+  private:
+    template<class C>
+    void TransformCoords(const C& coords,
+                         size_t count,
+                         double* x, double* y) const;
   };
 }
 
@@ -0,0 +1,99 @@
+#ifndef OSMSCOUT_UTIL_RADIXSORT_H
+#define OSMSCOUT_UTIL_RADIXSORT_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2016  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Util
+   *
+   * Sort the given unsigned integer values in ascending order using a least
+   * significant digit radix sort with 8 bit digits. Digits that are equal for
+   * all values (for example the high bytes of file offsets) are skipped.
+   * Small vectors are sorted using std::sort.
+   */
+  template<class T>
+  void RadixSort(std::vector<T>& values)
+  {
+    static_assert(std::is_unsigned<T>::value,"RadixSort requires unsigned values");
+
+    const size_t digitCount=sizeof(T);
+
+    if (values.size()<64) {
+      std::sort(values.begin(),values.end());
+      return;
+    }
+
+    std::vector<size_t> counts(digitCount*256,0);
+
+    for (const auto& value : values) {
+      for (size_t digit=0; digit<digitCount; digit++) {
+        counts[digit*256+((value >> (digit*8)) & 0xff)]++;
+      }
+    }
+
+    std::vector<T> buffer(values.size());
+
+    for (size_t digit=0; digit<digitCount; digit++) {
+      size_t* digitCounts=&counts[digit*256];
+
+      if (digitCounts[(values.front() >> (digit*8)) & 0xff]==values.size()) {
+        // All values have the same digit
+        continue;
+      }
+
+      size_t position=0;
+
+      for (size_t i=0; i<256; i++) {
+        size_t count=digitCounts[i];
+
+        digitCounts[i]=position;
+        position+=count;
+      }
+
+      for (const auto& value : values) {
+        buffer[digitCounts[(value >> (digit*8)) & 0xff]++]=value;
+      }
+
+      values.swap(buffer);
+    }
+  }
+
+  /**
+   * \ingroup Util
+   *
+   * Sort the given unsigned integer values in ascending order and remove duplicates.
+   */
+  template<class T>
+  void RadixSortUnique(std::vector<T>& values)
+  {
+    RadixSort(values);
+
+    values.erase(std::unique(values.begin(),values.end()),
+                 values.end());
+  }
+}
+
+#endif
@@ -23,6 +23,7 @@
 #include <limits>
 #include <list>
 #include <string>
+#include <vector>
 
 #include <osmscout/CoreFeatures.h>
 
@@ -392,6 +393,23 @@ namespace osmscout {
    */
   extern OSMSCOUT_API std::string ByteSizeToString(double size);
 
+  /**
+   * \ingroup Util
+   * Split the given UTF-8 encoded string into its characters. Each character
+   * is returned as a string holding the byte sequence of the character.
+   */
+  extern OSMSCOUT_API void SplitUTF8String(const std::string& text,
+                                           std::vector<std::string>& characters);
+
+  /**
+   * \ingroup Util
+   * Convert the given UTF-8 encoded string to lower case. Only the letters of
+   * ASCII and the upper case letters of the Latin-1 supplement (U+00C0 to U+00DE,
+   * which includes the german umlauts) are converted, all other characters are
+   * returned unchanged. The byte length of the string does not change.
+   */
+  extern OSMSCOUT_API std::string UTF8StringToLower(const std::string& text);
+
 #if defined(OSMSCOUT_HAVE_STD_WSTRING)
   /**
    * \ingroup Util
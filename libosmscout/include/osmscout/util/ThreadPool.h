@@ -0,0 +1,162 @@
+#ifndef OSMSCOUT_UTIL_THREADPOOL_H
+#define OSMSCOUT_UTIL_THREADPOOL_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2016 Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/util/Breaker.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Util
+   *
+   * A general purpose, work stealing thread pool.
+   *
+   * Each worker thread has its own job queue. Jobs submitted from outside
+   * the pool are distributed round robin over the worker queues, jobs submitted
+   * from a worker of the pool are pushed to the queue of this worker. Workers
+   * process their own queue in LIFO order (for better cache locality) and steal
+   * jobs from the front of the queues of other workers if their own queue is
+   * empty.
+   *
+   * Jobs still queued if the pool gets stopped are processed before the worker
+   * threads terminate. Jobs pushed after the pool has been stopped are rejected.
+   *
+   * The pool may be stopped or destroyed from within one of its jobs. The worker
+   * executing the job is then detached instead of joined and terminates after
+   * the remaining jobs have been processed.
+   */
+  class OSMSCOUT_API ThreadPool
+  {
+  public:
+    typedef std::function<void()> Job;
+
+  private:
+    struct WorkerQueue
+    {
+      std::mutex      mutex;
+      std::deque<Job> jobs;
+    };
+
+    typedef std::shared_ptr<WorkerQueue> WorkerQueueRef;
+
+    /**
+     * State shared between the pool and its workers. Workers hold a reference,
+     * so the state outlives the pool if a worker gets detached.
+     */
+    struct State
+    {
+      std::vector<WorkerQueueRef> queues;      //!< One job queue per worker
+      std::atomic<size_t>         nextQueue;   //!< Next queue for jobs pushed from outside the pool
+
+      std::mutex                  mutex;       //!< Mutex protecting pendingJobs and running
+      std::condition_variable     condition;   //!< Signals new jobs or stop to idle workers
+      size_t                      pendingJobs; //!< Number of queued (not yet started) jobs
+      bool                        running;
+
+      State();
+    };
+
+    typedef std::shared_ptr<State> StateRef;
+
+  private:
+    StateRef                 state;   //!< State shared with the workers
+    std::vector<std::thread> workers; //!< The worker threads
+
+  private:
+    size_t GetCurrentWorkerIndex() const;
+    static bool PopJob(State& state,
+                       size_t workerIndex,
+                       Job& job);
+    static void WorkerLoop(StateRef state,
+                           size_t workerIndex);
+
+  public:
+    explicit ThreadPool(size_t workerCount=0);
+    virtual ~ThreadPool();
+
+    size_t GetWorkerCount() const;
+
+    bool Push(const Job& job);
+
+    /**
+     * Submit the given function for execution in the pool. The result (or the exception
+     * thrown) is returned via the returned future. If the pool is already stopped, the
+     * function is dropped and the returned future signals a std::future_error
+     * (broken_promise).
+     */
+    template<class F>
+    auto Submit(F function) -> std::future<decltype(function())>
+    {
+      typedef decltype(function()) R;
+
+      auto task=std::make_shared<std::packaged_task<R()>>(std::move(function));
+      std::future<R> future=task->get_future();
+
+      Push([task]() {
+        (*task)();
+      });
+
+      return future;
+    }
+
+    /**
+     * Submit the given function for execution in the pool. If the given breaker
+     * is aborted before the function gets executed or if the pool is already stopped,
+     * the function is dropped and the returned future signals a std::future_error
+     * (broken_promise).
+     */
+    template<class F>
+    auto Submit(F function,
+                const BreakerRef& breaker) -> std::future<decltype(function())>
+    {
+      typedef decltype(function()) R;
+
+      auto task=std::make_shared<std::packaged_task<R()>>(std::move(function));
+      std::future<R> future=task->get_future();
+
+      Push([task,breaker]() {
+        if (!breaker || !breaker->IsAborted()) {
+          (*task)();
+        }
+      });
+
+      return future;
+    }
+
+    void Stop();
+  };
+
+  typedef std::shared_ptr<ThreadPool> ThreadPoolRef;
+}
+
+#endif
@@ -31,6 +31,7 @@
 #include <osmscout/GeoCoord.h>
 #include <osmscout/Pixel.h>
 
+#include <osmscout/util/CompactGeoCoords.h>
 #include <osmscout/util/Geometry.h>
 #include <osmscout/util/Projection.h>
 
@@ -45,10 +46,27 @@ namespace osmscout {
   class OSMSCOUT_API TransPolygon
   {
   private:
-    size_t  pointsSize;
-    size_t  length;
-    size_t  start;
-    size_t  end;
+    /**
+     * A pending sub line of the iterative Douglas-Peucker simplification.
+     */
+    struct SimplifySegment
+    {
+      size_t begin;    //!< Index of the start point of the line
+      size_t end;      //!< End index (exclusive) of the points checked against the line
+      size_t endValue; //!< Index of the end point of the line
+    };
+
+  private:
+    size_t                       pointsSize;
+    size_t                       length;
+    size_t                       start;
+    size_t                       end;
+    std::vector<double>          pixelX;         //!< x coordinates of all transformed points (structure of arrays)
+    std::vector<double>          pixelY;         //!< y coordinates of all transformed points (structure of arrays)
+    std::vector<size_t>          simplifyIndex;  //!< Index into points of the densely packed drawable points
+    std::vector<double>          simplifyX;      //!< Densely packed x coordinates of the drawable points
+    std::vector<double>          simplifyY;      //!< Densely packed y coordinates of the drawable points
+    std::vector<SimplifySegment> simplifyStack;  //!< Reusable stack of pending Douglas-Peucker segments
 
   public:
     enum OptimizeMethod
@@ -69,11 +87,24 @@ namespace osmscout {
     TransPoint* points;
 
   private:
+    void AllocatePoints(size_t count);
+    void InitializePoints(size_t count);
     void TransformGeoToPixel(const Projection& projection,
                              const std::vector<GeoCoord>& nodes);
+    void TransformGeoToPixel(const Projection& projection,
+                             const CompactGeoCoords& nodes);
     void DropSimilarPoints(double optimizeErrorTolerance);
     void DropRedundantPointsFast(double optimizeErrorTolerance);
+    void SimplifyPolyLineDouglasPeucker(size_t beginIndex,
+                                        size_t endIndex,
+                                        size_t endValueIndex,
+                                        double optimizeErrorToleranceSquared);
     void DropRedundantPointsDouglasPeucker(double optimizeErrorTolerance, bool isArea);
+    void UpdateDrawRange();
+    void OptimizeArea(OptimizeMethod optimize,
+                      double optimizeErrorTolerance);
+    void OptimizeWay(OptimizeMethod optimize,
+                     double optimizeErrorTolerance);
 
   public:
     TransPolygon();
@@ -104,11 +135,21 @@ namespace osmscout {
                        const std::vector<GeoCoord>& nodes,
                        double optimizeErrorTolerance);
 
+    void TransformArea(const Projection& projection,
+                       OptimizeMethod optimize,
+                       const CompactGeoCoords& nodes,
+                       double optimizeErrorTolerance);
+
     void TransformWay(const Projection& projection,
                       OptimizeMethod optimize,
                       const std::vector<GeoCoord>& nodes,
                       double optimizeErrorTolerance);
 
+    void TransformWay(const Projection& projection,
+                      OptimizeMethod optimize,
+                      const CompactGeoCoords& nodes,
+                      double optimizeErrorTolerance);
+
     bool GetBoundingBox(double& xmin, double& ymin,
                         double& xmax, double& ymax) const;
 
@@ -321,6 +362,10 @@ namespace osmscout {
     TransPolygon transPolygon;
     CoordBuffer *buffer;
 
+  private:
+    void CopyTransformedPoints(size_t& start,
+                               size_t& end);
+
   public:
     TransBuffer(CoordBuffer* buffer);
     virtual ~TransBuffer();
@@ -332,11 +377,21 @@ namespace osmscout {
                        const std::vector<GeoCoord>& nodes,
                        size_t& start, size_t &end,
                        double optimizeErrorTolerance);
+    void TransformArea(const Projection& projection,
+                       TransPolygon::OptimizeMethod optimize,
+                       const CompactGeoCoords& nodes,
+                       size_t& start, size_t &end,
+                       double optimizeErrorTolerance);
     bool TransformWay(const Projection& projection,
                       TransPolygon::OptimizeMethod optimize,
                       const std::vector<GeoCoord>& nodes,
                       size_t& start, size_t &end,
                       double optimizeErrorTolerance);
+    bool TransformWay(const Projection& projection,
+                      TransPolygon::OptimizeMethod optimize,
+                      const CompactGeoCoords& nodes,
+                      size_t& start, size_t &end,
+                      double optimizeErrorTolerance);
   };
 }
 
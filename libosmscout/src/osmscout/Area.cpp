@@ -22,14 +22,87 @@
 #include <algorithm>
 #include <limits>
 
+#include <osmscout/util/Geometry.h>
+#include <osmscout/util/Number.h>
 #include <osmscout/util/String.h>
 
 #include <osmscout/system/Math.h>
 
 namespace osmscout {
 
+  bool Area::Ring::HasIds(size_t nodeCount) const
+  {
+    return nodeCount>0 &&
+           GetType()->GetAreaId()!=typeIgnore &&
+           GetType()->CanRoute();
+  }
+
+  /**
+   * Decode the nodes and ids of a ring read by Area::ReadLazy(). Does nothing,
+   * if the geometry is already decoded.
+   */
+  void Area::Ring::DecodeGeometry()
+  {
+    if (!HasEncodedGeometry()) {
+      return;
+    }
+
+    DecodeGeometry(nodes,
+                   ids);
+
+    encodedGeometry.clear();
+    encodedGeometry.shrink_to_fit();
+  }
+
+  /**
+   * Decode the nodes and ids of a ring read by Area::ReadLazy() into the given
+   * buffers, without changing the ring itself. This allows to access the
+   * geometry of an area shared between multiple threads.
+   */
+  void Area::Ring::DecodeGeometry(std::vector<GeoCoord>& nodes,
+                                  std::vector<Id>& ids) const
+  {
+    if (!HasEncodedGeometry()) {
+      nodes=this->nodes;
+      ids=this->ids;
+
+      return;
+    }
+
+    size_t bytes=DecodeCoords(encodedGeometry.data(),
+                              nodes);
+
+    if (HasIds(nodes.size())) {
+      DecodeIds(encodedGeometry.data()+bytes,
+                nodes.size(),
+                ids);
+    }
+    else {
+      ids.clear();
+    }
+  }
+
+  /**
+   * Return the center of the bounding box of the ring.
+   *
+   * The geometry of a ring of an area read by Area::ReadLazy() must be decoded
+   * before (see Area::GetCenter() for the center of the stored bounding box).
+   */
   bool Area::Ring::GetCenter(GeoCoord& center) const
   {
+    assert(!HasEncodedGeometry());
+
+    if (HasCompactNodes()) {
+      GeoBox boundingBox;
+
+      compactNodes.GetBoundingBox(boundingBox);
+
+      center.Set(boundingBox.GetMinLat()+(boundingBox.GetMaxLat()-boundingBox.GetMinLat())/2,
+                 boundingBox.GetMinLon()+(boundingBox.GetMaxLon()-boundingBox.GetMinLon())/2);
+
+      return true;
+    }
+
     double minLat=0.0;
     double minLon=0.0;
     double maxLat=0.0;
@@ -64,8 +137,23 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Return the bounding box of the ring.
+   *
+   * The geometry of a ring of an area read by Area::ReadLazy() must be decoded
+   * before, either in place or into buffers of the caller (see
+   * DecodeGeometry()), instead of decoding it again for each call.
+   */
   void Area::Ring::GetBoundingBox(GeoBox& boundingBox) const
   {
+    assert(!HasEncodedGeometry());
+
+    if (HasCompactNodes()) {
+      compactNodes.GetBoundingBox(boundingBox);
+
+      return;
+    }
+
     assert(!nodes.empty());
 
     double minLon=nodes[0].GetLon();
@@ -88,6 +176,13 @@ namespace osmscout {
   {
     assert(!rings.empty());
 
+    if (HasEncodedGeometry()) {
+      center.Set(boundingBox.GetMinLat()+(boundingBox.GetMaxLat()-boundingBox.GetMinLat())/2,
+                 boundingBox.GetMinLon()+(boundingBox.GetMaxLon()-boundingBox.GetMinLon())/2);
+
+      return true;
+    }
+
     double minLat=0.0;
     double minLon=0.0;
     double maxLat=0.0;
@@ -96,7 +191,27 @@ namespace osmscout {
     bool start=true;
 
     for (const auto& ring : rings) {
-      if (ring.ring==Area::outerRingId) {
+      if (ring.ring==Area::outerRingId && ring.HasCompactNodes()) {
+        GeoBox ringBoundingBox;
+
+        ring.compactNodes.GetBoundingBox(ringBoundingBox);
+
+        if (start) {
+          minLat=ringBoundingBox.GetMinLat();
+          maxLat=ringBoundingBox.GetMaxLat();
+          minLon=ringBoundingBox.GetMinLon();
+          maxLon=ringBoundingBox.GetMaxLon();
+
+          start=false;
+        }
+        else {
+          minLat=std::min(minLat,ringBoundingBox.GetMinLat());
+          minLon=std::min(minLon,ringBoundingBox.GetMinLon());
+          maxLat=std::max(maxLat,ringBoundingBox.GetMaxLat());
+          maxLon=std::max(maxLon,ringBoundingBox.GetMaxLon());
+        }
+      }
+      else if (ring.ring==Area::outerRingId) {
         for (size_t j=0; j<ring.nodes.size(); j++) {
           if (start) {
             minLat=ring.nodes[j].GetLat();
@@ -130,6 +245,12 @@ namespace osmscout {
 
   void Area::GetBoundingBox(GeoBox& boundingBox) const
   {
+    if (HasEncodedGeometry()) {
+      boundingBox=this->boundingBox;
+
+      return;
+    }
+
     boundingBox.Invalidate();
 
     for (const auto& role : rings) {
@@ -148,6 +269,54 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Move the coordinates of all rings from nodes to the compact, fixed point
+   * representation in compactNodes, halving the memory required for the coordinates.
+   *
+   * Code that directly accesses the nodes of a ring must either check
+   * HasCompactNodes() or call ExpandNodes() before. Compacted areas cannot be written.
+   */
+  void Area::CompactNodes()
+  {
+    DecodeGeometry();
+
+    for (auto& ring : rings) {
+      if (ring.nodes.empty()) {
+        continue;
+      }
+
+      ring.compactNodes.Set(ring.nodes);
+
+      ring.nodes.clear();
+      ring.nodes.shrink_to_fit();
+    }
+  }
+
+  /**
+   * Restore the coordinates of all rings in nodes from compactNodes.
+   */
+  void Area::ExpandNodes()
+  {
+    for (auto& ring : rings) {
+      if (!ring.HasCompactNodes()) {
+        continue;
+      }
+
+      ring.compactNodes.Get(ring.nodes);
+      ring.compactNodes.Clear();
+    }
+  }
+
+  /**
+   * Decode the geometry of all rings of an area read by ReadLazy().
+   */
+  void Area::DecodeGeometry()
+  {
+    for (auto& ring : rings) {
+      ring.DecodeGeometry();
+    }
+  }
+
   void Area::ReadIds(FileScanner& scanner,
                      uint32_t nodesCount,
                      std::vector<Id>& ids)
@@ -216,6 +385,8 @@ namespace osmscout {
       ringCount++;
     }
 
+    scanner.ReadBox(boundingBox);
+
     rings.resize(ringCount);
 
     rings[0].featureValueBuffer=std::move(featureValueBuffer);
@@ -261,6 +432,85 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Reads data from the given Filescanner like Read(), but only copies the
+   * still encoded nodes and ids of all rings instead of decoding them.
+   * Types, features and the bounding box of the area are available directly,
+   * the geometry must be decoded using DecodeGeometry() before accessing nodes or
+   * ids of a ring.
+   *
+   * @throws IOException
+   */
+  void Area::ReadLazy(const TypeConfig& typeConfig,
+                      FileScanner& scanner)
+  {
+    TypeId             ringType;
+    bool               multipleRings;
+    uint32_t           ringCount=1;
+    FeatureValueBuffer featureValueBuffer;
+
+    fileOffset=scanner.GetPos();
+
+    scanner.ReadTypeId(ringType,
+                       typeConfig.GetAreaTypeIdBytes());
+
+    TypeInfoRef type=typeConfig.GetAreaTypeInfo(ringType);
+
+    featureValueBuffer.SetType(type);
+
+    featureValueBuffer.Read(scanner,
+                            multipleRings);
+
+    if (multipleRings) {
+      scanner.ReadNumber(ringCount);
+
+      ringCount++;
+    }
+
+    scanner.ReadBox(boundingBox);
+
+    rings.resize(ringCount);
+
+    rings[0].featureValueBuffer=std::move(featureValueBuffer);
+
+    if (ringCount>1) {
+      rings[0].ring=masterRingId;
+    }
+    else {
+      rings[0].ring=outerRingId;
+    }
+
+    for (size_t i=0; i<ringCount; i++) {
+      if (i>0) {
+        scanner.ReadTypeId(ringType,
+                           typeConfig.GetAreaTypeIdBytes());
+
+        type=typeConfig.GetAreaTypeInfo(ringType);
+
+        rings[i].SetType(type);
+
+        if (rings[i].GetType()->GetAreaId()!=typeIgnore) {
+          rings[i].featureValueBuffer.Read(scanner);
+        }
+
+        scanner.Read(rings[i].ring);
+      }
+
+      rings[i].nodes.clear();
+      rings[i].ids.clear();
+      rings[i].encodedGeometry.clear();
+
+      scanner.ReadCoordsEncoded(rings[i].encodedGeometry);
+
+      size_t nodeCount=GetEncodedCoordCount(rings[i].encodedGeometry.data());
+
+      if (rings[i].HasIds(nodeCount)) {
+        scanner.ReadIdsEncoded(nodeCount,
+                               rings[i].encodedGeometry);
+      }
+    }
+  }
+
   /**
    * Reads data from the given FileScanner. All data available will be read.
    *
@@ -456,6 +706,11 @@ namespace osmscout {
   {
     std::vector<Ring>::const_iterator ring=rings.begin();
     bool                              multipleRings=rings.size()>1;
+    GeoBox                            boundingBox;
+
+    GetBoundingBox(boundingBox);
+
+    assert(boundingBox.IsValid());
 
     // Outer ring
 
@@ -469,6 +724,8 @@ namespace osmscout {
       writer.WriteNumber((uint32_t)(rings.size()-1));
     }
 
+    writer.WriteBox(boundingBox);
+
     writer.Write(ring->nodes);
 
     if (!ring->nodes.empty() &&
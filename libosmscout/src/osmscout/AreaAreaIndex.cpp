@@ -243,6 +243,17 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Return the number of bytes read from the index file since it was opened,
+   * see FileScanner::GetBytesRead().
+   */
+  FileOffset AreaAreaIndex::GetBytesRead() const
+  {
+    std::lock_guard<std::mutex> guard(lookupMutex);
+
+    return scanner.GetBytesRead();
+  }
+
   /**
    * Returns references in form of DataBlockSpans to all areas within the
    * given area,
@@ -29,5 +29,25 @@ namespace osmscout {
   {
     // no code
   }
+
+  /**
+   * Read the area lazily (see Area::ReadLazy()), if lazyGeometry is true.
+   *
+   * @throws IOException
+   */
+  void AreaDataFile::ReadObject(const TypeConfig& typeConfig,
+                                FileScanner& scanner,
+                                bool lazyGeometry,
+                                Area& data) const
+  {
+    if (lazyGeometry) {
+      data.ReadLazy(typeConfig,
+                    scanner);
+    }
+    else {
+      data.Read(typeConfig,
+                scanner);
+    }
+  }
 }
 
@@ -24,6 +24,7 @@
 #include <osmscout/util/File.h>
 #include <osmscout/util/Geometry.h>
 #include <osmscout/util/Logger.h>
+#include <osmscout/util/RadixSort.h>
 #include <osmscout/util/StopClock.h>
 
 #include <osmscout/system/Math.h>
@@ -130,6 +131,12 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Append the offsets of all nodes of the given type in the given area to the
+   * offsets vector.
+   *
+   * Method is not thread-safe.
+   */
   bool AreaNodeIndex::GetOffsets(const TypeData& typeData,
                                  const GeoBox& boundingBox,
                                  std::vector<FileOffset>& offsets) const
@@ -163,10 +170,9 @@ namespace osmscout {
 
     // For each row
     for (size_t y=minyc; y<=maxyc; y++) {
-      std::lock_guard<std::mutex> guard(lookupMutex);
-      FileOffset                  initialCellDataOffset=0;
-      size_t                      cellDataOffsetCount=0;
-      FileOffset                  cellIndexOffset=typeData.GetCellOffset(minxc,y);
+      FileOffset initialCellDataOffset=0;
+      size_t     cellDataOffsetCount=0;
+      FileOffset cellIndexOffset=typeData.GetCellOffset(minxc,y);
 
       scanner.SetPos(cellIndexOffset);
 
@@ -224,22 +230,49 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Return the number of bytes read from the index file since it was opened,
+   * see FileScanner::GetBytesRead().
+   */
+  FileOffset AreaNodeIndex::GetBytesRead() const
+  {
+    std::lock_guard<std::mutex> guard(lookupMutex);
+
+    return scanner.GetBytesRead();
+  }
+
+  /**
+   * Append the offsets of all nodes of the given types in the given area to the
+   * offsets vector. The appended offsets are sorted in ascending order and do
+   * not contain duplicates, so the nodes can be read sequentially from the data file.
+   *
+   * Method is thread-safe.
+   */
   bool AreaNodeIndex::GetOffsets(const GeoBox& boundingBox,
                                  const TypeInfoSet& requestedTypes,
                                  std::vector<FileOffset>& offsets,
                                  TypeInfoSet& loadedTypes) const
   {
-    StopClock time;
+    StopClock               time;
+    std::vector<FileOffset> nodeOffsets;
 
     loadedTypes.Clear();
 
-    offsets.reserve(std::min((size_t)10000,offsets.capacity()));
+    nodeOffsets.reserve(10000);
 
     try {
+      std::lock_guard<std::mutex> guard(lookupMutex);
+
       for (TypeInfoRef type : requestedTypes) {
+        // The index only holds entries up to the last type with data
+        if (type->GetNodeId()>=nodeTypeData.size()) {
+          loadedTypes.Set(type);
+          continue;
+        }
+
         if (!GetOffsets(nodeTypeData[type->GetNodeId()],
                         boundingBox,
-                        offsets)) {
+                        nodeOffsets)) {
           return false;
         }
 
@@ -251,6 +284,10 @@ namespace osmscout {
       return false;
     }
 
+    RadixSortUnique(nodeOffsets);
+
+    offsets.insert(offsets.end(),nodeOffsets.begin(),nodeOffsets.end());
+
     time.Stop();
 
     if (time.GetMilliseconds()>100) {
@@ -24,6 +24,7 @@
 #include <osmscout/util/File.h>
 #include <osmscout/util/Geometry.h>
 #include <osmscout/util/Logger.h>
+#include <osmscout/util/RadixSort.h>
 #include <osmscout/util/StopClock.h>
 
 #include <osmscout/system/Math.h>
@@ -143,9 +144,15 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Append the offsets of all ways of the given type in the given area to the
+   * offsets vector. Offsets may be contained multiple times.
+   *
+   * Method is not thread-safe.
+   */
   bool AreaWayIndex::GetOffsets(const TypeData& typeData,
                                 const GeoBox& boundingBox,
-                                std::unordered_set<FileOffset>& offsets) const
+                                std::vector<FileOffset>& offsets) const
   {
     if (typeData.bitmapOffset==0) {
       // No data for this type available
@@ -176,10 +183,9 @@ namespace osmscout {
 
     // For each row
     for (size_t y=minyc; y<=maxyc; y++) {
-      std::lock_guard<std::mutex> guard(lookupMutex);
-      FileOffset                  initialCellDataOffset=0;
-      size_t                      cellDataOffsetCount=0;
-      FileOffset                  bitmapCellOffset=typeData.GetCellOffset(minxc,y);
+      FileOffset initialCellDataOffset=0;
+      size_t     cellDataOffsetCount=0;
+      FileOffset bitmapCellOffset=typeData.GetCellOffset(minxc,y);
 
       scanner.SetPos(bitmapCellOffset);
 
@@ -229,7 +235,7 @@ namespace osmscout {
 
           objectOffset+=lastOffset;
 
-          offsets.insert(objectOffset);
+          offsets.push_back(objectOffset);
 
           lastOffset=objectOffset;
         }
@@ -239,24 +245,43 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Return the number of bytes read from the index file since it was opened,
+   * see FileScanner::GetBytesRead().
+   */
+  FileOffset AreaWayIndex::GetBytesRead() const
+  {
+    std::lock_guard<std::mutex> guard(lookupMutex);
+
+    return scanner.GetBytesRead();
+  }
+
+  /**
+   * Append the offsets of all ways of the given types in the given area to the
+   * offsets vector. The appended offsets are sorted in ascending order and do
+   * not contain duplicates, so the ways can be read sequentially from the data file.
+   *
+   * Method is thread-safe.
+   */
   bool AreaWayIndex::GetOffsets(const GeoBox& boundingBox,
                                 const TypeInfoSet& types,
                                 std::vector<FileOffset>& offsets,
                                 TypeInfoSet& loadedTypes) const
   {
-    StopClock time;
+    StopClock               time;
+    std::vector<FileOffset> wayOffsets;
 
-    offsets.reserve(std::min((size_t)10000,offsets.capacity()));
+    wayOffsets.reserve(10000);
     loadedTypes.Clear();
 
-    std::unordered_set<FileOffset> uniqueOffsets;
-
     try {
+      std::lock_guard<std::mutex> guard(lookupMutex);
+
       for (const auto& data : wayTypeData) {
         if (types.IsSet(data.type)) {
           if (!GetOffsets(data,
                           boundingBox,
-                          uniqueOffsets)) {
+                          wayOffsets)) {
             return false;
           }
 
@@ -269,7 +294,9 @@ namespace osmscout {
       return false;
     }
 
-    offsets.insert(offsets.end(),uniqueOffsets.begin(),uniqueOffsets.end());
+    RadixSortUnique(wayOffsets);
+
+    offsets.insert(offsets.end(),wayOffsets.begin(),wayOffsets.end());
 
     //std::cout << "Found " << wayWayOffsets.size() << "+" << relationWayOffsets.size()<< " offsets in 'areaway.idx'" << std::endl;
 
@@ -20,6 +20,8 @@
 #include <osmscout/Database.h>
 
 #include <algorithm>
+#include <functional>
+#include <limits>
 
 #if _OPENMP
 #include <omp.h>
@@ -28,6 +30,7 @@
 #include <osmscout/system/Assert.h>
 #include <osmscout/system/Math.h>
 
+#include <osmscout/util/File.h>
 #include <osmscout/util/Geometry.h>
 #include <osmscout/util/Logger.h>
 #include <osmscout/util/StopClock.h>
@@ -36,7 +39,10 @@ namespace osmscout {
 
   DatabaseParameter::DatabaseParameter()
   : areaAreaIndexCacheSize(5000),
-    areaNodeIndexCacheSize(1000)
+    areaNodeIndexCacheSize(1000),
+    locationIndexRegionsInMemory(false),
+    locationIndexRegionLookup(true),
+    rTreeIndexes(true)
   {
     // no code
   }
@@ -51,6 +57,36 @@ namespace osmscout {
     this->areaNodeIndexCacheSize=areaNodeIndexCacheSize;
   }
 
+  /**
+   * If set to true, the admin regions of the location index are loaded into
+   * memory when the location index is opened, else they are read from disk
+   * on each location search. Default is false.
+   */
+  void DatabaseParameter::SetLocationIndexRegionsInMemory(bool locationIndexRegionsInMemory)
+  {
+    this->locationIndexRegionsInMemory=locationIndexRegionsInMemory;
+  }
+
+  /**
+   * If set to false, the optional region lookup index of the location index is
+   * not used and reverse lookups test the areas of the admin regions instead.
+   * Default is true.
+   */
+  void DatabaseParameter::SetLocationIndexRegionLookup(bool locationIndexRegionLookup)
+  {
+    this->locationIndexRegionLookup=locationIndexRegionLookup;
+  }
+
+  /**
+   * If set to false, the optional R-tree indexes are not used, even if they
+   * exist, and nearest neighbour queries and address lookups fall back to the
+   * area indexes. Default is true.
+   */
+  void DatabaseParameter::SetRTreeIndexes(bool rTreeIndexes)
+  {
+    this->rTreeIndexes=rTreeIndexes;
+  }
+
   unsigned long DatabaseParameter::GetAreaAreaIndexCacheSize() const
   {
     return areaAreaIndexCacheSize;
@@ -61,6 +97,21 @@ namespace osmscout {
     return areaNodeIndexCacheSize;
   }
 
+  bool DatabaseParameter::GetLocationIndexRegionsInMemory() const
+  {
+    return locationIndexRegionsInMemory;
+  }
+
+  bool DatabaseParameter::GetLocationIndexRegionLookup() const
+  {
+    return locationIndexRegionLookup;
+  }
+
+  bool DatabaseParameter::GetRTreeIndexes() const
+  {
+    return rTreeIndexes;
+  }
+
   Database::Database(const DatabaseParameter& parameter)
    : parameter(parameter),
      isOpen(false)
@@ -154,6 +205,26 @@ namespace osmscout {
       areaWayIndex=NULL;
     }
 
+    if (nodeRTreeIndex) {
+      nodeRTreeIndex->Close();
+      nodeRTreeIndex=NULL;
+    }
+
+    if (wayRTreeIndex) {
+      wayRTreeIndex->Close();
+      wayRTreeIndex=NULL;
+    }
+
+    if (areaRTreeIndex) {
+      areaRTreeIndex->Close();
+      areaRTreeIndex=NULL;
+    }
+
+    if (poiNameIndex) {
+      poiNameIndex->Close();
+      poiNameIndex=NULL;
+    }
+
     if (locationIndex) {
       locationIndex=NULL;
     }
@@ -364,6 +435,126 @@ namespace osmscout {
     return areaWayIndex;
   }
 
+  /**
+   * Open the given optional R-tree index file. Returns NULL without
+   * complaining if the file was not generated during import.
+   */
+  PackedRTreeIndexRef Database::OpenRTreeIndex(const std::string& filename) const
+  {
+    if (!parameter.GetRTreeIndexes()) {
+      log.Debug() << "Optional index '" << filename << "' is disabled";
+      return NULL;
+    }
+
+    if (!ExistsInFilesystem(AppendFileToDir(path,
+                                            filename))) {
+      log.Debug() << "Optional index '" << filename << "' does not exist";
+      return NULL;
+    }
+
+    PackedRTreeIndexRef index=std::make_shared<PackedRTreeIndex>();
+
+    StopClock timer;
+
+    if (!index->Open(typeConfig,
+                     path,
+                     filename)) {
+      log.Error() << "Cannot load R-tree index '" << filename << "'!";
+
+      return NULL;
+    }
+
+    timer.Stop();
+
+    log.Debug() << "Opening PackedRTreeIndex '" << filename << "': " << timer.ResultString();
+
+    return index;
+  }
+
+  PackedRTreeIndexRef Database::GetNodeRTreeIndex() const
+  {
+    std::lock_guard<std::mutex> guard(nodeRTreeIndexMutex);
+
+    if (!IsOpen()) {
+      return NULL;
+    }
+
+    if (!nodeRTreeIndex) {
+      nodeRTreeIndex=OpenRTreeIndex(PackedRTreeIndex::NODE_RTREE_IDX);
+    }
+
+    return nodeRTreeIndex;
+  }
+
+  PackedRTreeIndexRef Database::GetWayRTreeIndex() const
+  {
+    std::lock_guard<std::mutex> guard(wayRTreeIndexMutex);
+
+    if (!IsOpen()) {
+      return NULL;
+    }
+
+    if (!wayRTreeIndex) {
+      wayRTreeIndex=OpenRTreeIndex(PackedRTreeIndex::WAY_RTREE_IDX);
+    }
+
+    return wayRTreeIndex;
+  }
+
+  PackedRTreeIndexRef Database::GetAreaRTreeIndex() const
+  {
+    std::lock_guard<std::mutex> guard(areaRTreeIndexMutex);
+
+    if (!IsOpen()) {
+      return NULL;
+    }
+
+    if (!areaRTreeIndex) {
+      areaRTreeIndex=OpenRTreeIndex(PackedRTreeIndex::AREA_RTREE_IDX);
+    }
+
+    return areaRTreeIndex;
+  }
+
+  /**
+   * Return the index of POIs and their names by location. Returns NULL, if the
+   * index is not available.
+   */
+  POINameIndexRef Database::GetPOINameIndex() const
+  {
+    std::lock_guard<std::mutex> guard(poiNameIndexMutex);
+
+    if (!IsOpen()) {
+      return NULL;
+    }
+
+    if (!poiNameIndex) {
+      if (!ExistsInFilesystem(AppendFileToDir(path,
+                                              POINameIndex::FILENAME_POI_NAME_IDX))) {
+        log.Debug() << "Index '" << POINameIndex::FILENAME_POI_NAME_IDX << "' does not exist";
+        return NULL;
+      }
+
+      poiNameIndex=std::make_shared<POINameIndex>();
+
+      StopClock timer;
+
+      if (!poiNameIndex->Open(typeConfig,
+                              path)) {
+        log.Error() << "Cannot load POI name index!";
+        poiNameIndex=NULL;
+
+        return NULL;
+      }
+
+      timer.Stop();
+
+      log.Debug() << "Opening POINameIndex: " << timer.ResultString();
+    }
+
+    return poiNameIndex;
+  }
+
   LocationIndexRef Database::GetLocationIndex() const
   {
     std::lock_guard<std::mutex> guard(locationIndexMutex);
@@ -377,7 +568,9 @@ namespace osmscout {
 
       StopClock timer;
 
-      if (!locationIndex->Load(path)) {
+      if (!locationIndex->Load(path,
+                               parameter.GetLocationIndexRegionsInMemory(),
+                               parameter.GetLocationIndexRegionLookup())) {
         log.Error() << "Cannot load location index!";
         locationIndex=NULL;
 
@@ -710,8 +903,14 @@ namespace osmscout {
     return areaDataFile->GetByBlockSpan(span,area);
   }
 
+  /**
+   * Read the areas of the given spans. If lazyGeometry is true, the geometry of the
+   * areas is not decoded (see Area::ReadLazy()) and the caller must decode it before
+   * accessing nodes or ids of the rings.
+   */
   bool Database::GetAreasByBlockSpans(const std::vector<DataBlockSpan>& spans,
-                            std::vector<AreaRef>& areas) const
+                                      std::vector<AreaRef>& areas,
+                                      bool lazyGeometry) const
   {
     AreaDataFileRef areaDataFile=GetAreaDataFile();
 
@@ -719,7 +918,9 @@ namespace osmscout {
       return false;
     }
 
-    return areaDataFile->GetByBlockSpans(spans,areas);
+    return areaDataFile->GetByBlockSpans(spans,
+                                         areas,
+                                         lazyGeometry);
   }
 
   bool Database::GetWayByOffset(const FileOffset& offset,
@@ -742,8 +943,14 @@ namespace osmscout {
     return result;
   }
 
+  /**
+   * Read the ways at the given offsets. If lazyGeometry is true, the geometry of the
+   * ways is not decoded (see Way::ReadLazy()) and the caller must decode it before
+   * accessing nodes or ids.
+   */
   bool Database::GetWaysByOffset(const std::vector<FileOffset>& offsets,
-                                 std::vector<WayRef>& ways) const
+                                 std::vector<WayRef>& ways,
+                                 bool lazyGeometry) const
   {
     WayDataFileRef wayDataFile=GetWayDataFile();
 
@@ -753,7 +960,9 @@ namespace osmscout {
 
     StopClock time;
 
-    bool result=wayDataFile->GetByOffset(offsets,ways);
+    bool result=wayDataFile->GetByOffset(offsets,
+                                         ways,
+                                         lazyGeometry);
 
     if (time.GetMilliseconds()>100) {
       log.Warn() << "Retrieving ways by offset took " << time.ResultString();
@@ -822,6 +1031,586 @@ namespace osmscout {
     return result;
   }
 
+  static double GetObjectDistance(const EquirectangularDistance& distance,
+                                  const Node& node,
+                                  GeoCoord& closest)
+  {
+    closest=node.GetCoords();
+
+    return distance.GetDistance(closest);
+  }
+
+  /**
+   * Returns the distance to the given polyline. For an empty polyline
+   * the maximum double value and the reference coordinate are returned.
+   */
+  static double GetPolylineDistance(const EquirectangularDistance& distance,
+                                    const std::vector<GeoCoord>& nodes,
+                                    bool closed,
+                                    GeoCoord& closest)
+  {
+    double minDistance=std::numeric_limits<double>::max();
+
+    closest=distance.GetReference();
+
+    if (nodes.size()==1) {
+      closest=nodes.front();
+
+      return distance.GetDistance(closest);
+    }
+
+    for (size_t i=1; i<=nodes.size(); i++) {
+      if (i==nodes.size() && !closed) {
+        break;
+      }
+
+      GeoCoord segmentClosest;
+      double   segmentDistance=distance.GetDistance(nodes[i-1],
+                                                    nodes[i%nodes.size()],
+                                                    segmentClosest);
+
+      if (segmentDistance<minDistance) {
+        minDistance=segmentDistance;
+        closest=segmentClosest;
+      }
+    }
+
+    return minDistance;
+  }
+
+  /**
+   * Return the coordinates of the given way. Lazily read and compacted ways are
+   * decoded into the given buffer, since the way itself may be shared.
+   */
+  static const std::vector<GeoCoord>& GetNodes(const Way& way,
+                                               std::vector<GeoCoord>& buffer)
+  {
+    if (way.HasEncodedGeometry()) {
+      std::vector<Id> ids;
+
+      way.DecodeGeometry(buffer,
+                         ids);
+
+      return buffer;
+    }
+
+    if (way.HasCompactNodes()) {
+      way.compactNodes.Get(buffer);
+
+      return buffer;
+    }
+
+    return way.nodes;
+  }
+
+  /**
+   * Return the coordinates of the given area ring, see GetNodes(const Way&,...)
+   */
+  static const std::vector<GeoCoord>& GetNodes(const Area::Ring& ring,
+                                               std::vector<GeoCoord>& buffer)
+  {
+    if (ring.HasEncodedGeometry()) {
+      std::vector<Id> ids;
+
+      ring.DecodeGeometry(buffer,
+                          ids);
+
+      return buffer;
+    }
+
+    if (ring.HasCompactNodes()) {
+      ring.compactNodes.Get(buffer);
+
+      return buffer;
+    }
+
+    return ring.nodes;
+  }
+
+  static double GetObjectDistance(const EquirectangularDistance& distance,
+                                  const Way& way,
+                                  GeoCoord& closest)
+  {
+    std::vector<GeoCoord> buffer;
+
+    return GetPolylineDistance(distance,
+                               GetNodes(way,
+                                        buffer),
+                               false,
+                               closest);
+  }
+
+  /**
+   * The distance of an area is the distance to its nearest ring or 0.0, if
+   * the coordinate is inside the area (but not within one of its holes).
+   */
+  double GetAreaDistance(const EquirectangularDistance& distance,
+                         const Area& area,
+                         GeoCoord& closest)
+  {
+    double                minDistance=std::numeric_limits<double>::max();
+    size_t                containingRings=0;
+    std::vector<GeoCoord> buffer;
+
+    closest=distance.GetReference();
+
+    for (const auto& ring : area.rings) {
+      const std::vector<GeoCoord>& nodes=GetNodes(ring,
+                                                  buffer);
+
+      if (nodes.empty()) {
+        continue;
+      }
+
+      GeoCoord ringClosest;
+      double   ringDistance=GetPolylineDistance(distance,
+                                                nodes,
+                                                true,
+                                                ringClosest);
+
+      if (ringDistance<minDistance) {
+        minDistance=ringDistance;
+        closest=ringClosest;
+      }
+
+      if (ring.ring!=Area::masterRingId &&
+          IsCoordInArea(distance.GetReference(),
+                        nodes)) {
+        containingRings++;
+      }
+    }
+
+    if (containingRings%2==1) {
+      closest=distance.GetReference();
+
+      return 0.0;
+    }
+
+    return minDistance;
+  }
+
+  static double GetObjectDistance(const EquirectangularDistance& distance,
+                                  const Area& area,
+                                  GeoCoord& closest)
+  {
+    return GetAreaDistance(distance,
+                           area,
+                           closest);
+  }
+
+  /**
+   * Objects are ordered by distance, objects with the same distance by their
+   * file offset, so that the result does not depend on the order of visiting
+   */
+  template<class R>
+  static bool IsCloser(const ClosestObject<R>& a,
+                       const ClosestObject<R>& b)
+  {
+    if (a.distance!=b.distance) {
+      return a.distance<b.distance;
+    }
+
+    return a.object->GetFileOffset()<b.object->GetFileOffset();
+  }
+
+  /**
+   * Insert the given object into the result list sorted by distance and
+   * drop all entries beyond the requested count
+   */
+  template<class R>
+  static void AddClosestObject(const EquirectangularDistance& distance,
+                               const R& object,
+                               size_t count,
+                               std::vector<ClosestObject<R>>& objects)
+  {
+    ClosestObject<R> entry;
+
+    entry.object=object;
+    entry.distance=GetObjectDistance(distance,
+                                     *object,
+                                     entry.coord);
+
+    // Objects without geometry cannot be ranked
+    if (entry.distance==std::numeric_limits<double>::max()) {
+      return;
+    }
+
+    if (objects.size()>=count &&
+        !IsCloser(entry,
+                  objects.back())) {
+      return;
+    }
+
+    auto position=std::upper_bound(objects.begin(),
+                                   objects.end(),
+                                   entry,
+                                   IsCloser<R>);
+
+    objects.insert(position,
+                   entry);
+
+    if (objects.size()>count) {
+      objects.pop_back();
+    }
+  }
+
+  /**
+   * Visitor of PackedRTreeIndex::VisitNearest() that loads the visited objects and
+   * collects the nearest ones
+   */
+  template<class N>
+  class ClosestObjectCollector : public PackedRTreeIndex::NearestVisitor
+  {
+  private:
+    const DataFile<N>                                  &dataFile;
+    const EquirectangularDistance&                     distance;
+    size_t                                             count;
+    double                                             maxDistance;
+    std::vector<ClosestObject<std::shared_ptr<N>>>&    objects;
+    bool                                               error;
+
+  public:
+    ClosestObjectCollector(const DataFile<N>& dataFile,
+                           const EquirectangularDistance& distance,
+                           size_t count,
+                           double maxDistance,
+                           std::vector<ClosestObject<std::shared_ptr<N>>>& objects)
+    : dataFile(dataFile),
+      distance(distance),
+      count(count),
+      maxDistance(maxDistance),
+      objects(objects),
+      error(false)
+    {
+      // no code
+    }
+
+    bool Visit(FileOffset offset,
+               double boxDistance)
+    {
+      // All following objects are at least as far away as the current box,
+      // objects at the same distance may still win by their file offset
+      if (objects.size()>=count &&
+          boxDistance>objects.back().distance) {
+        return false;
+      }
+
+      std::shared_ptr<N> object;
+
+      if (!dataFile.GetByOffset(offset,
+                                object)) {
+        error=true;
+        return false;
+      }
+
+      size_t oldSize=objects.size();
+
+      AddClosestObject(distance,
+                       object,
+                       count,
+                       objects);
+
+      // The box distance is only a lower bound, drop objects beyond the limit
+      if (objects.size()>oldSize &&
+          objects.back().distance>maxDistance) {
+        objects.pop_back();
+      }
+
+      return true;
+    }
+
+    inline bool HasError() const
+    {
+      return error;
+    }
+  };
+
+  template<class N>
+  static bool GetClosestObjectsByRTree(const PackedRTreeIndex& index,
+                                       const DataFile<N>& dataFile,
+                                       const EquirectangularDistance& distance,
+                                       const TypeInfoSet& types,
+                                       size_t count,
+                                       double maxDistance,
+                                       std::vector<ClosestObject<std::shared_ptr<N>>>& objects)
+  {
+    ClosestObjectCollector<N> collector(dataFile,
+                                        distance,
+                                        count,
+                                        maxDistance,
+                                        objects);
+
+    return index.VisitNearest(distance,
+                              types,
+                              maxDistance,
+                              collector) &&
+           !collector.HasError();
+  }
+
+  /**
+   * Search for the closest objects without an R-tree index by querying boxes of increasing
+   * size until enough objects have been found. The loader must return all
+   * objects of the requested types intersecting the given bounding box.
+   */
+  template<class R>
+  static bool GetClosestObjectsByBox(const GeoBox& databaseBoundingBox,
+                                     const EquirectangularDistance& distance,
+                                     size_t count,
+                                     double maxDistance,
+                                     std::function<bool(const GeoBox&,std::vector<R>&)> loader,
+                                     std::vector<ClosestObject<R>>& objects)
+  {
+    double         radius=std::min(0.1,maxDistance);
+    std::vector<R> candidates;
+
+    while (true) {
+      GeoBox searchBox=distance.GetBoundingBox(radius);
+      bool   coversDatabase=searchBox.GetMinLat()<=databaseBoundingBox.GetMinLat() &&
+                            searchBox.GetMinLon()<=databaseBoundingBox.GetMinLon() &&
+                            searchBox.GetMaxLat()>=databaseBoundingBox.GetMaxLat() &&
+                            searchBox.GetMaxLon()>=databaseBoundingBox.GetMaxLon();
+      bool   isLast=coversDatabase || radius>=maxDistance;
+      double limit=isLast ? maxDistance : radius;
+
+      candidates.clear();
+      objects.clear();
+
+      if (!loader(searchBox,
+                  candidates)) {
+        return false;
+      }
+
+      // Objects beyond the radius may be missing objects closer than them,
+      // since they might be outside of the search box
+      for (const auto& candidate : candidates) {
+        AddClosestObject(distance,
+                         candidate,
+                         std::numeric_limits<size_t>::max(),
+                         objects);
+      }
+
+      while (!objects.empty() &&
+             objects.back().distance>limit) {
+        objects.pop_back();
+      }
+
+      if (objects.size()>count) {
+        objects.resize(count);
+      }
+
+      if (objects.size()>=count ||
+          isLast) {
+        return true;
+      }
+
+      radius=std::min(radius*2.0,maxDistance);
+    }
+  }
+
+  /**
+   * Return the (up to) count nodes of the given types that are closest to the
+   * given coordinate and not further away than maxDistance (in km),
+   * ordered by increasing distance. Nodes with the same distance are
+   * ordered by their file offset.
+   *
+   * If the optional R-tree index is available a best-first search over
+   * the index is used, else the area node index is queried with increasing
+   * radius.
+   *
+   * Method is thread-safe.
+   */
+  bool Database::GetClosestNodes(const GeoCoord& coord,
+                                 const TypeInfoSet& types,
+                                 size_t count,
+                                 double maxDistance,
+                                 std::vector<ClosestNode>& nodes) const
+  {
+    NodeDataFileRef nodeDataFile=GetNodeDataFile();
+
+    nodes.clear();
+
+    if (!nodeDataFile) {
+      return false;
+    }
+
+    if (count==0 ||
+        types.Empty()) {
+      return true;
+    }
+
+    EquirectangularDistance distance(coord);
+    PackedRTreeIndexRef     rtreeIndex=GetNodeRTreeIndex();
+
+    if (rtreeIndex) {
+      return GetClosestObjectsByRTree(*rtreeIndex,
+                                      *nodeDataFile,
+                                      distance,
+                                      types,
+                                      count,
+                                      maxDistance,
+                                      nodes);
+    }
+
+    AreaNodeIndexRef areaNodeIndex=GetAreaNodeIndex();
+
+    if (!areaNodeIndex) {
+      return false;
+    }
+
+    return GetClosestObjectsByBox<NodeRef>(boundingBox,
+                                           distance,
+                                           count,
+                                           maxDistance,
+                                           [&](const GeoBox& box,
+                                               std::vector<NodeRef>& candidates) {
+                                             std::vector<FileOffset> offsets;
+                                             TypeInfoSet             loadedTypes;
+
+                                             return areaNodeIndex->GetOffsets(box,
+                                                                              types,
+                                                                              offsets,
+                                                                              loadedTypes) &&
+                                                    nodeDataFile->GetByOffset(offsets,
+                                                                              candidates);
+                                           },
+                                           nodes);
+  }
+
+  /**
+   * Return the (up to) count ways of the given types that are closest to the
+   * given coordinate and not further away than maxDistance (in km),
+   * ordered by increasing distance.
+   *
+   * See GetClosestNodes().
+   *
+   * Method is thread-safe.
+   */
+  bool Database::GetClosestWays(const GeoCoord& coord,
+                                const TypeInfoSet& types,
+                                size_t count,
+                                double maxDistance,
+                                std::vector<ClosestWay>& ways) const
+  {
+    WayDataFileRef wayDataFile=GetWayDataFile();
+
+    ways.clear();
+
+    if (!wayDataFile) {
+      return false;
+    }
+
+    if (count==0 ||
+        types.Empty()) {
+      return true;
+    }
+
+    EquirectangularDistance distance(coord);
+    PackedRTreeIndexRef     rtreeIndex=GetWayRTreeIndex();
+
+    if (rtreeIndex) {
+      return GetClosestObjectsByRTree(*rtreeIndex,
+                                      *wayDataFile,
+                                      distance,
+                                      types,
+                                      count,
+                                      maxDistance,
+                                      ways);
+    }
+
+    AreaWayIndexRef areaWayIndex=GetAreaWayIndex();
+
+    if (!areaWayIndex) {
+      return false;
+    }
+
+    return GetClosestObjectsByBox<WayRef>(boundingBox,
+                                          distance,
+                                          count,
+                                          maxDistance,
+                                          [&](const GeoBox& box,
+                                              std::vector<WayRef>& candidates) {
+                                            std::vector<FileOffset> offsets;
+                                            TypeInfoSet             loadedTypes;
+
+                                            return areaWayIndex->GetOffsets(box,
+                                                                            types,
+                                                                            offsets,
+                                                                            loadedTypes) &&
+                                                   wayDataFile->GetByOffset(offsets,
+                                                                            candidates);
+                                          },
+                                          ways);
+  }
+
+  /**
+   * Return the (up to) count areas of the given types that are closest to the
+   * given coordinate and not further away than maxDistance (in km),
+   * ordered by increasing distance. Areas containing the coordinate have a
+   * distance of 0.0.
+   *
+   * See GetClosestNodes().
+   *
+   * Method is thread-safe.
+   */
+  bool Database::GetClosestAreas(const GeoCoord& coord,
+                                 const TypeInfoSet& types,
+                                 size_t count,
+                                 double maxDistance,
+                                 std::vector<ClosestArea>& areas) const
+  {
+    AreaDataFileRef areaDataFile=GetAreaDataFile();
+
+    areas.clear();
+
+    if (!areaDataFile) {
+      return false;
+    }
+
+    if (count==0 ||
+        types.Empty()) {
+      return true;
+    }
+
+    EquirectangularDistance distance(coord);
+    PackedRTreeIndexRef     rtreeIndex=GetAreaRTreeIndex();
+
+    if (rtreeIndex) {
+      return GetClosestObjectsByRTree(*rtreeIndex,
+                                      *areaDataFile,
+                                      distance,
+                                      types,
+                                      count,
+                                      maxDistance,
+                                      areas);
+    }
+
+    AreaAreaIndexRef areaAreaIndex=GetAreaAreaIndex();
+
+    if (!areaAreaIndex) {
+      return false;
+    }
+
+    return GetClosestObjectsByBox<AreaRef>(boundingBox,
+                                           distance,
+                                           count,
+                                           maxDistance,
+                                           [&](const GeoBox& box,
+                                               std::vector<AreaRef>& candidates) {
+                                             std::vector<DataBlockSpan> spans;
+                                             TypeInfoSet                loadedTypes;
+
+                                             return areaAreaIndex->GetAreasInArea(*typeConfig,
+                                                                                  box,
+                                                                                  std::numeric_limits<size_t>::max(),
+                                                                                  types,
+                                                                                  spans,
+                                                                                  loadedTypes) &&
+                                                    areaDataFile->GetByBlockSpans(spans,
+                                                                                  candidates);
+                                           },
+                                           areas);
+  }
+
   void Database::DumpStatistics()
   {
     if (areaAreaIndex) {
@@ -19,27 +19,52 @@
 
 #include <osmscout/LocationIndex.h>
 
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <unordered_map>
+
 #include <osmscout/system/Assert.h>
+#include <osmscout/system/Math.h>
 
 #include <osmscout/util/File.h>
 #include <osmscout/util/Logger.h>
 #include <osmscout/util/StopClock.h>
+#include <osmscout/util/String.h>
 #include <iostream>
 namespace osmscout {
 
   const char* const LocationIndex::FILENAME_LOCATION_IDX = "location.idx";
+  const char* const LocationIndex::FILENAME_LOCATION_TOKEN_IDX = "locationtoken.idx";
+  const char* const LocationIndex::FILENAME_LOCATION_REGION_IDX = "locationregion.idx";
 
   LocationIndex::LocationIndex()
+  : indexOffset(0),
+    regionsInMemory(false),
+    hasRegionLookupIndex(false)
   {
     // no code
   }
 
   LocationIndex::~LocationIndex()
   {
-    // no code
+    CloseScanners(indexScanners);
+    CloseScanners(tokenScanners);
+    CloseScanners(regionScanners);
   }
 
-  bool LocationIndex::Load(const std::string& path)
+  /**
+   * Load the location index from the given directory.
+   *
+   * If loadRegions is true, all admin regions are loaded into memory, else they
+   * are read from disk on each access.
+   *
+   * If loadRegionLookup is false, the optional region lookup index is not used,
+   * even if it is available.
+   */
+  bool LocationIndex::Load(const std::string& path,
+                           bool loadRegions,
+                           bool loadRegionLookup)
   {
     this->path=path;
 
@@ -80,14 +105,164 @@ namespace osmscout {
       indexOffset=scanner.GetPos();
 
       scanner.Close();
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      scanner.CloseFailsafe();
+      return false;
+    }
+
+    if (loadRegions &&
+        !LoadRegions()) {
+      return false;
+    }
+
+    // The token index is optional, without it searches visit the region tree
+    if (!LoadTokenIndex()) {
+      tokens.clear();
+      tokenEntryOffsets.clear();
+    }
+
+    // The region lookup index is optional, without it reverse lookups test the region areas
+    if (!loadRegionLookup ||
+        !LoadRegionLookupIndex()) {
+      hasRegionLookupIndex=false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Load the token directory of the optional token index into memory. The posting
+   * lists stay on disk and are read on demand.
+   */
+  bool LocationIndex::LoadTokenIndex()
+  {
+    std::string filename=AppendFileToDir(path,
+                                         FILENAME_LOCATION_TOKEN_IDX);
+    FileScanner scanner;
 
+    tokens.clear();
+    tokenEntryOffsets.clear();
+
+    if (!ExistsInFilesystem(filename)) {
+      log.Debug() << "No token index '" << filename << "' available";
       return true;
     }
+
+    try {
+      FileOffset directoryOffset;
+      uint32_t   tokenCount;
+
+      scanner.Open(filename,
+                   FileScanner::Sequential,
+                   true);
+
+      scanner.ReadFileOffset(directoryOffset);
+      scanner.SetPos(directoryOffset);
+
+      scanner.ReadNumber(tokenCount);
+
+      tokens.resize(tokenCount);
+      tokenEntryOffsets.resize(tokenCount);
+
+      for (size_t i=0; i<tokenCount; i++) {
+        scanner.Read(tokens[i]);
+        scanner.ReadNumber(tokenEntryOffsets[i]);
+      }
+
+      scanner.Close();
+    }
     catch (IOException& e) {
       log.Error() << e.GetDescription();
       scanner.CloseFailsafe();
       return false;
     }
+
+    return true;
+  }
+
+  /**
+   * Load the header of the optional region lookup index. The cells are read on
+   * demand.
+   */
+  bool LocationIndex::LoadRegionLookupIndex()
+  {
+    std::string filename=AppendFileToDir(path,
+                                         FILENAME_LOCATION_REGION_IDX);
+    FileScanner scanner;
+
+    hasRegionLookupIndex=false;
+
+    if (!ExistsInFilesystem(filename)) {
+      log.Debug() << "No region lookup index '" << filename << "' available";
+      return true;
+    }
+
+    try {
+      uint32_t level;
+
+      scanner.Open(filename,
+                   FileScanner::Sequential,
+                   true);
+
+      scanner.ReadFileOffset(regionLookupGrid.tableOffset);
+      scanner.Read(regionLookupGrid.entryOffsetBytes);
+
+      scanner.ReadNumber(level);
+      scanner.ReadNumber(regionLookupGrid.cellXStart);
+      scanner.ReadNumber(regionLookupGrid.cellXEnd);
+      scanner.ReadNumber(regionLookupGrid.cellYStart);
+      scanner.ReadNumber(regionLookupGrid.cellYEnd);
+
+      regionLookupGrid.cellWidth=360.0/pow(2.0,level);
+      regionLookupGrid.cellHeight=180.0/pow(2.0,level);
+
+      scanner.Close();
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      scanner.CloseFailsafe();
+      return false;
+    }
+
+    hasRegionLookupIndex=true;
+
+    return true;
+  }
+
+  /**
+   * Split the given name into normalized tokens as stored in the token index. Tokens are
+   * separated by any ASCII character that is neither a letter nor a digit and are
+   * converted to lower case (including the umlauts of the Latin-1 supplement).
+   */
+  void LocationIndex::GetNameTokens(const std::string& name,
+                                    std::vector<std::string>& tokens)
+  {
+    std::string lowerName=UTF8StringToLower(name);
+    std::string token;
+
+    tokens.clear();
+
+    for (const char character : lowerName) {
+      unsigned char c=(unsigned char)character;
+
+      if (c<0x80 &&
+          !std::isalnum(c)) {
+        if (!token.empty()) {
+          tokens.push_back(token);
+          token.clear();
+        }
+
+        continue;
+      }
+
+      token.push_back(character);
+    }
+
+    if (!token.empty()) {
+      tokens.push_back(token);
+    }
   }
 
   bool LocationIndex::IsRegionIgnoreToken(const std::string& token) const
@@ -226,6 +401,213 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Returns the number of UTF-8 characters of the given string
+   */
+  static size_t GetCharacterCount(const std::string& text)
+  {
+    size_t count=0;
+
+    for (const auto& c : text) {
+      if ((((unsigned char)c) & 0xC0)!=0x80) {
+        count++;
+      }
+    }
+
+    return count;
+  }
+
+  /**
+   * Append the posting lists of all tokens starting with the given prefix. If maxEntries
+   * is not 0 and the posting lists hold more than maxEntries entries in total, reading
+   * stops early and false is returned in complete.
+   */
+  bool LocationIndex::GetTokenEntries(FileScanner& scanner,
+                                      const std::string& prefix,
+                                      size_t maxEntries,
+                                      std::vector<TokenEntry>& entries,
+                                      bool& complete) const
+  {
+    size_t totalCount=0;
+
+    complete=true;
+
+    for (auto token=std::lower_bound(tokens.begin(),
+                                     tokens.end(),
+                                     prefix);
+         token!=tokens.end() &&
+         token->compare(0,prefix.length(),prefix)==0;
+         ++token) {
+      uint32_t entryCount;
+
+      scanner.SetPos(tokenEntryOffsets[token-tokens.begin()]);
+      scanner.ReadNumber(entryCount);
+
+      totalCount+=entryCount;
+
+      // Every token has at least one entry, so this also bounds the number of tokens visited
+      if (maxEntries!=0 &&
+          totalCount>maxEntries) {
+        complete=false;
+        break;
+      }
+
+      for (size_t i=0; i<entryCount; i++) {
+        TokenEntry entry;
+        uint8_t    type;
+
+        scanner.Read(type);
+        scanner.ReadNumber(entry.offset);
+        scanner.ReadNumber(entry.regionOffset);
+
+        entry.type=(TokenEntryType)type;
+
+        if (entry.type==tokenPOI) {
+          scanner.Read(entry.object);
+        }
+
+        entries.push_back(entry);
+      }
+    }
+
+    return !scanner.HasError();
+  }
+
+  /**
+   * Return all entries of the token index, that have a token starting with each of the
+   * tokens of the given pattern. The result is sorted by type and offset.
+   *
+   * Pattern tokens with less than SHORT_TOKEN_LENGTH characters usually match
+   * a large part of the index. Their posting lists are only read up to
+   * MAX_SHORT_TOKEN_ENTRIES entries, if there are more, the token is not used for
+   * restricting the result. If no token of the pattern restricts the result,
+   * false is returned in selective and the caller has to fall back to visiting
+   * all entries.
+   */
+  bool LocationIndex::GetTokenEntries(const std::string& pattern,
+                                      std::vector<TokenEntry>& entries,
+                                      bool& selective) const
+  {
+    std::vector<std::string>     patternTokens;
+    std::unique_ptr<FileScanner> scanner;
+
+    entries.clear();
+    selective=false;
+
+    GetNameTokens(pattern,
+                  patternTokens);
+
+    if (patternTokens.empty()) {
+      return true;
+    }
+
+    try {
+      scanner=AcquireScanner(tokenScanners,
+                             FILENAME_LOCATION_TOKEN_IDX);
+
+      for (size_t i=0; i<patternTokens.size(); i++) {
+        std::vector<TokenEntry> tokenEntries;
+        size_t                  maxEntries=0;
+        bool                    complete;
+
+        if (GetCharacterCount(patternTokens[i])<SHORT_TOKEN_LENGTH) {
+          maxEntries=MAX_SHORT_TOKEN_ENTRIES;
+        }
+
+        if (!GetTokenEntries(*scanner,
+                             patternTokens[i],
+                             maxEntries,
+                             tokenEntries,
+                             complete)) {
+          scanner->CloseFailsafe();
+          return false;
+        }
+
+        if (!complete) {
+          continue;
+        }
+
+        std::sort(tokenEntries.begin(),
+                  tokenEntries.end());
+        tokenEntries.erase(std::unique(tokenEntries.begin(),
+                                       tokenEntries.end()),
+                           tokenEntries.end());
+
+        if (!selective) {
+          entries.swap(tokenEntries);
+          selective=true;
+        }
+        else {
+          std::vector<TokenEntry> intersection;
+
+          std::set_intersection(entries.begin(),
+                                entries.end(),
+                                tokenEntries.begin(),
+                                tokenEntries.end(),
+                                std::back_inserter(intersection));
+
+          entries.swap(intersection);
+        }
+
+        if (entries.empty()) {
+          break;
+        }
+      }
+
+      ReleaseScanner(tokenScanners,
+                     scanner);
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+
+      if (scanner) {
+        scanner->CloseFailsafe();
+      }
+
+      return false;
+    }
+
+    return true;
+  }
+
+  void LocationIndex::LoadLocation(FileScanner& scanner,
+                                   FileOffset regionOffset,
+                                   Location& location) const
+  {
+    uint32_t objectCount;
+    bool     hasAddresses;
+
+    location.locationOffset=scanner.GetPos();
+
+    scanner.Read(location.name);
+
+    location.regionOffset=regionOffset;
+
+    scanner.ReadNumber(objectCount);
+
+    location.objects.clear();
+    location.objects.reserve(objectCount);
+
+    scanner.Read(hasAddresses);
+
+    if (hasAddresses) {
+      scanner.ReadFileOffset(location.addressesOffset);
+    }
+    else {
+      location.addressesOffset=0;
+    }
+
+    ObjectFileRefStreamReader objectFileRefReader(scanner);
+
+    for (size_t j=0; j<objectCount; j++) {
+      ObjectFileRef ref;
+
+      objectFileRefReader.Read(ref);
+
+      location.objects.push_back(ref);
+    }
+  }
+
   bool LocationIndex::LoadRegionDataEntry(FileScanner& scanner,
                                           const AdminRegion& adminRegion,
                                           LocationVisitor& visitor,
@@ -258,38 +640,10 @@ namespace osmscout {
 
     for (size_t i=0; i<locationCount; i++) {
       Location location;
-      uint32_t  objectCount;
-
-      location.locationOffset=scanner.GetPos();
 
-      scanner.Read(location.name);
-
-      location.regionOffset=adminRegion.regionOffset;
-
-      scanner.ReadNumber(objectCount);
-
-      location.objects.reserve(objectCount);
-
-      bool hasAddresses;
-
-      scanner.Read(hasAddresses);
-
-      if (hasAddresses) {
-        scanner.ReadFileOffset(location.addressesOffset);
-      }
-      else {
-        location.addressesOffset=0;
-      }
-
-      objectFileRefReader.Reset();
-
-      for (size_t j=0; j<objectCount; j++) {
-        ObjectFileRef ref;
-
-        objectFileRefReader.Read(ref);
-
-        location.objects.push_back(ref);
-      }
+      LoadLocation(scanner,
+                   adminRegion.regionOffset,
+                   location);
 
       if (!visitor.Visit(adminRegion,
                          location)) {
@@ -392,51 +746,238 @@ namespace osmscout {
     return !scanner.HasError();
   }
 
-  bool LocationIndex::VisitAdminRegions(AdminRegionVisitor& visitor) const
+  /**
+   * Return an open scanner for the given file, either from the given pool of
+   * unused scanners or a newly opened one.
+   *
+   * @throws IOException
+   */
+  std::unique_ptr<FileScanner> LocationIndex::AcquireScanner(std::vector<std::unique_ptr<FileScanner>>& pool,
+                                                             const std::string& filename) const
+  {
+    {
+      std::lock_guard<std::mutex> guard(scannerMutex);
+
+      if (!pool.empty()) {
+        std::unique_ptr<FileScanner> scanner(std::move(pool.back()));
+
+        pool.pop_back();
+
+        return scanner;
+      }
+    }
+
+    std::unique_ptr<FileScanner> scanner(new FileScanner());
+
+    scanner->Open(AppendFileToDir(path,
+                                  filename),
+                  FileScanner::LowMemRandom,
+                  true);
+
+    return scanner;
+  }
+
+  /**
+   * Return the scanner to the given pool for reuse by later calls. Scanners in
+   * error state are closed instead.
+   */
+  void LocationIndex::ReleaseScanner(std::vector<std::unique_ptr<FileScanner>>& pool,
+                                     std::unique_ptr<FileScanner>& scanner) const
+  {
+    if (!scanner) {
+      return;
+    }
+
+    if (scanner->HasError()) {
+      scanner->CloseFailsafe();
+      scanner.reset();
+      return;
+    }
+
+    std::lock_guard<std::mutex> guard(scannerMutex);
+
+    pool.push_back(std::move(scanner));
+  }
+
+  void LocationIndex::CloseScanners(std::vector<std::unique_ptr<FileScanner>>& pool)
+  {
+    for (auto& scanner : pool) {
+      scanner->CloseFailsafe();
+    }
+
+    pool.clear();
+  }
+
+  /**
+   * Load the region entry and all its children in depth first order into
+   * the in memory region tree.
+   */
+  void LocationIndex::LoadRegionTree(FileScanner& scanner)
+  {
+    AdminRegion region;
+    uint32_t    childCount;
+    size_t      index=regions.size();
+
+    if (!LoadAdminRegion(scanner,
+                         region)) {
+      throw IOException(scanner.GetFilename(),"Cannot load admin region");
+    }
+
+    regionIndexes[region.regionOffset]=(uint32_t)index;
+    regions.push_back(region);
+    regionSubtreeEnds.push_back(0);
+
+    scanner.ReadNumber(childCount);
+
+    for (size_t i=0; i<childCount; i++) {
+      FileOffset nextChildOffset;
+
+      scanner.ReadFileOffset(nextChildOffset);
+
+      LoadRegionTree(scanner);
+    }
+
+    regionSubtreeEnds[index]=(uint32_t)regions.size();
+  }
+
+  /**
+   * Load all admin regions into memory, so that traversal of the region
+   * tree and resolving of parent regions does not need any disk access.
+   */
+  bool LocationIndex::LoadRegions()
   {
     FileScanner scanner;
 
     try {
+      uint32_t regionCount;
+
       scanner.Open(AppendFileToDir(path,
                                    FILENAME_LOCATION_IDX),
-                   FileScanner::LowMemRandom,
-                   false);
+                   FileScanner::Sequential,
+                   true);
 
       scanner.SetPos(indexOffset);
 
+      scanner.ReadNumber(regionCount);
+
+      for (size_t i=0; i<regionCount; i++) {
+        FileOffset nextChildOffset;
+
+        scanner.ReadFileOffset(nextChildOffset);
+
+        LoadRegionTree(scanner);
+      }
+
+      scanner.Close();
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      scanner.CloseFailsafe();
+
+      return false;
+    }
+
+    regionsInMemory=true;
+
+    return true;
+  }
+
+  /**
+   * Load the admin region at the given offset, from memory if the regions
+   * have been loaded into memory, else from the given scanner.
+   */
+  bool LocationIndex::LoadAdminRegion(FileScanner& scanner,
+                                      FileOffset offset,
+                                      AdminRegion& region) const
+  {
+    if (regionsInMemory) {
+      auto entry=regionIndexes.find(offset);
+
+      if (entry!=regionIndexes.end()) {
+        region=regions[entry->second];
+
+        return true;
+      }
+    }
+
+    scanner.SetPos(offset);
+
+    return LoadAdminRegion(scanner,
+                           region);
+  }
+
+  bool LocationIndex::VisitAdminRegions(AdminRegionVisitor& visitor) const
+  {
+    if (regionsInMemory) {
+      size_t i=0;
+
+      while (i<regions.size()) {
+        AdminRegionVisitor::Action action=visitor.Visit(regions[i]);
+
+        switch (action) {
+        case AdminRegionVisitor::error:
+          return false;
+        case AdminRegionVisitor::stop:
+          return true;
+        case AdminRegionVisitor::skipChildren:
+          i=regionSubtreeEnds[i];
+          break;
+        case AdminRegionVisitor::visitChildren:
+          i++;
+          break;
+        }
+      }
+
+      return true;
+    }
+
+    std::unique_ptr<FileScanner> scanner;
+
+    try {
+      scanner=AcquireScanner(indexScanners,
+                             FILENAME_LOCATION_IDX);
+
+      scanner->SetPos(indexOffset);
+
       uint32_t regionCount;
 
-      scanner.ReadNumber(regionCount);
+      scanner->ReadNumber(regionCount);
 
       for (size_t i=0; i<regionCount; i++) {
         AdminRegionVisitor::Action action;
         FileOffset nextChildOffset;
 
-        scanner.ReadFileOffset(nextChildOffset);
+        scanner->ReadFileOffset(nextChildOffset);
 
-        action=VisitRegionEntries(scanner,
+        action=VisitRegionEntries(*scanner,
                                   visitor);
 
         if (action==AdminRegionVisitor::error) {
+          scanner->CloseFailsafe();
           return false;
         }
         else if (action==AdminRegionVisitor::stop) {
-          return true;
+          break;
         }
         else if (action==AdminRegionVisitor::skipChildren) {
           if (i+1<regionCount) {
-            scanner.SetPos(nextChildOffset);
+            scanner->SetPos(nextChildOffset);
           }
         }
       }
 
-      scanner.Close();
+      ReleaseScanner(indexScanners,
+                     scanner);
 
       return true;
     }
     catch (IOException& e) {
       log.Error() << e.GetDescription();
-      scanner.CloseFailsafe();
+
+      if (scanner) {
+        scanner->CloseFailsafe();
+      }
+
       return false;
     }
   }
@@ -445,32 +986,56 @@ namespace osmscout {
                                                 LocationVisitor& visitor,
                                                 bool recursive) const
   {
-    FileScanner scanner;
-    bool        stopped=false;
+    std::unique_ptr<FileScanner> scanner;
+    bool                         stopped=false;
 
     try {
-      scanner.Open(AppendFileToDir(path,
-                                   FILENAME_LOCATION_IDX),
-                   FileScanner::LowMemRandom,
-                   true);
+      scanner=AcquireScanner(indexScanners,
+                             FILENAME_LOCATION_IDX);
 
-      scanner.SetPos(indexOffset);
-      scanner.SetPos(region.regionOffset);
+      auto entry=regionIndexes.find(region.regionOffset);
 
-      if (!VisitRegionLocationEntries(scanner,
-                                      visitor,
-                                      recursive,
-                                      stopped)) {
-        return false;
+      if (regionsInMemory &&
+          entry!=regionIndexes.end()) {
+        size_t start=entry->second;
+        size_t end=recursive ? regionSubtreeEnds[start] : start+1;
+
+        for (size_t i=start; i<end && !stopped; i++) {
+          scanner->SetPos(regions[i].dataOffset);
+
+          if (!LoadRegionDataEntry(*scanner,
+                                   regions[i],
+                                   visitor,
+                                   stopped)) {
+            scanner->CloseFailsafe();
+            return false;
+          }
+        }
       }
+      else {
+        scanner->SetPos(region.regionOffset);
 
-      scanner.Close();
+        if (!VisitRegionLocationEntries(*scanner,
+                                        visitor,
+                                        recursive,
+                                        stopped)) {
+          scanner->CloseFailsafe();
+          return false;
+        }
+      }
+
+      ReleaseScanner(indexScanners,
+                     scanner);
 
       return true;
     }
     catch (IOException& e) {
       log.Error() << e.GetDescription();
-      scanner.CloseFailsafe();
+
+      if (scanner) {
+        scanner->CloseFailsafe();
+      }
+
       return false;
     }
   }
@@ -479,32 +1044,440 @@ namespace osmscout {
                                              const Location& location,
                                              AddressVisitor& visitor) const
   {
-    FileScanner scanner;
-    bool        stopped=false;
+    std::unique_ptr<FileScanner> scanner;
+    bool                         stopped=false;
 
     try {
-      scanner.Open(AppendFileToDir(path,
-                                   FILENAME_LOCATION_IDX),
-                   FileScanner::LowMemRandom,
-                   true);
-
-      scanner.SetPos(indexOffset);
+      scanner=AcquireScanner(indexScanners,
+                             FILENAME_LOCATION_IDX);
 
-      if (!VisitLocationAddressEntries(scanner,
+      if (!VisitLocationAddressEntries(*scanner,
                                        region,
                                        location,
                                        visitor,
                                        stopped)) {
+        scanner->CloseFailsafe();
         return false;
       }
 
-      scanner.Close();
+      ReleaseScanner(indexScanners,
+                     scanner);
 
       return true;
     }
     catch (IOException& e) {
       log.Error() << e.GetDescription();
-      scanner.CloseFailsafe();
+
+      if (scanner) {
+        scanner->CloseFailsafe();
+      }
+
+      return false;
+    }
+  }
+
+  /**
+   * Returns true, if the segment a-b crosses the segment c-d. Points on one of the
+   * lines are treated as lying on its right side, so that a crossing at the shared
+   * node of two consecutive segments is counted only once.
+   */
+  static bool IsSegmentCrossing(const GeoCoord& a,
+                                const GeoCoord& b,
+                                const GeoCoord& c,
+                                const GeoCoord& d)
+  {
+    auto isLeft=[](const GeoCoord& p,
+                   const GeoCoord& q,
+                   const GeoCoord& r) {
+      return (q.GetLon()-p.GetLon())*(r.GetLat()-p.GetLat())-
+             (q.GetLat()-p.GetLat())*(r.GetLon()-p.GetLon())>0.0;
+    };
+
+    return isLeft(a,b,c)!=isLeft(a,b,d) &&
+           isLeft(c,d,a)!=isLeft(c,d,b);
+  }
+
+  /**
+   * Append the offsets of all regions, whose area contains the given coordinate, to the
+   * given vector, using the region lookup index. The coordinate is within a region
+   * crossing the cell, if the number of boundary segments crossed on the way from the
+   * cell center to the coordinate does not change the inside state of the cell center.
+   * As for GetRelationOfPointToArea() nodes of the boundary count as inside.
+   */
+  bool LocationIndex::GetRegionOffsets(FileScanner& scanner,
+                                       const GeoCoord& coord,
+                                       std::vector<FileOffset>& regionOffsets,
+                                       std::vector<GeoCoord>& run) const
+  {
+    const RegionLookupGrid& grid=regionLookupGrid;
+    double                  cellX=floor((coord.GetLon()+180.0)/grid.cellWidth);
+    double                  cellY=floor((coord.GetLat()+90.0)/grid.cellHeight);
+
+    if (cellX<grid.cellXStart ||
+        cellX>grid.cellXEnd ||
+        cellY<grid.cellYStart ||
+        cellY>grid.cellYEnd) {
+      return true;
+    }
+
+    uint32_t   x=(uint32_t)cellX;
+    uint32_t   y=(uint32_t)cellY;
+    GeoCoord   center((y+0.5)*grid.cellHeight-90.0,
+                      (x+0.5)*grid.cellWidth-180.0);
+    FileOffset entryOffset;
+    FileOffset regionOffset;
+    uint32_t   regionCount;
+    uint32_t   candidateCount;
+
+    scanner.SetPos(grid.tableOffset+
+                   ((FileOffset)(y-grid.cellYStart)*(grid.cellXEnd-grid.cellXStart+1)+x-grid.cellXStart)*grid.entryOffsetBytes);
+    scanner.ReadFileOffset(entryOffset,
+                           grid.entryOffsetBytes);
+
+    scanner.SetPos(entryOffset);
+
+    scanner.ReadNumber(regionCount);
+
+    for (size_t r=0; r<regionCount; r++) {
+      scanner.ReadNumber(regionOffset);
+
+      regionOffsets.push_back(regionOffset);
+    }
+
+    scanner.ReadNumber(candidateCount);
+
+    for (size_t c=0; c<candidateCount; c++) {
+      bool     inside;
+      bool     onBoundaryNode=false;
+      uint32_t runCount;
+
+      scanner.ReadNumber(regionOffset);
+      scanner.Read(inside);
+      scanner.ReadNumber(runCount);
+
+      for (size_t r=0; r<runCount; r++) {
+        scanner.Read(run);
+
+        for (size_t i=0; i<run.size(); i++) {
+          if (run[i]==coord) {
+            onBoundaryNode=true;
+          }
+
+          if (i>0 &&
+              IsSegmentCrossing(run[i-1],
+                                run[i],
+                                center,
+                                coord)) {
+            inside=!inside;
+          }
+        }
+      }
+
+      if (inside ||
+          onBoundaryNode) {
+        regionOffsets.push_back(regionOffset);
+      }
+    }
+
+    return !scanner.HasError();
+  }
+
+  /**
+   * Add the offsets of all admin regions, that contain at least one of the given
+   * coordinates, to the given set. As for the traversal of the region tree a region
+   * only contains a coordinate, if all its parent regions contain it, too.
+   *
+   * Requires the region lookup index.
+   */
+  bool LocationIndex::GetRegionOffsets(const std::vector<GeoCoord>& coords,
+                                       std::set<FileOffset>& regionOffsets) const
+  {
+    std::unique_ptr<FileScanner>              regionScanner;
+    std::unique_ptr<FileScanner>              scanner;
+    std::vector<FileOffset>                   offsets;
+    std::vector<GeoCoord>                     run;
+    std::unordered_map<FileOffset,FileOffset> parentOffsets;
+
+    if (!hasRegionLookupIndex) {
+      log.Error() << "Region lookup index '" << FILENAME_LOCATION_REGION_IDX << "' not available";
+      return false;
+    }
+
+    try {
+      regionScanner=AcquireScanner(regionScanners,
+                                   FILENAME_LOCATION_REGION_IDX);
+      scanner=AcquireScanner(indexScanners,
+                             FILENAME_LOCATION_IDX);
+
+      for (const auto& coord : coords) {
+        offsets.clear();
+
+        if (!GetRegionOffsets(*regionScanner,
+                              coord,
+                              offsets,
+                              run)) {
+          regionScanner->CloseFailsafe();
+          scanner->CloseFailsafe();
+          return false;
+        }
+
+        std::sort(offsets.begin(),
+                  offsets.end());
+
+        for (const auto& offset : offsets) {
+          FileOffset parentOffset=offset;
+          bool       isContained=true;
+
+          while (isContained) {
+            auto parent=parentOffsets.find(parentOffset);
+
+            if (parent==parentOffsets.end()) {
+              AdminRegion region;
+
+              if (!LoadAdminRegion(*scanner,
+                                   parentOffset,
+                                   region)) {
+                regionScanner->CloseFailsafe();
+                scanner->CloseFailsafe();
+                return false;
+              }
+
+              parent=parentOffsets.insert(std::make_pair(parentOffset,
+                                                         region.parentRegionOffset)).first;
+            }
+
+            parentOffset=parent->second;
+
+            if (parentOffset==0) {
+              break;
+            }
+
+            isContained=std::binary_search(offsets.begin(),
+                                           offsets.end(),
+                                           parentOffset);
+          }
+
+          if (isContained) {
+            regionOffsets.insert(offset);
+          }
+        }
+      }
+
+      ReleaseScanner(regionScanners,
+                     regionScanner);
+      ReleaseScanner(indexScanners,
+                     scanner);
+
+      return true;
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+
+      if (regionScanner) {
+        regionScanner->CloseFailsafe();
+      }
+
+      if (scanner) {
+        scanner->CloseFailsafe();
+      }
+
+      return false;
+    }
+  }
+
+  /**
+   * Visit all admin regions, whose name or aliases contain tokens starting with each
+   * token of the given pattern. Requires the token index, the visitor is responsible
+   * for the final matching. If the pattern only consists of short, unselective tokens,
+   * all admin regions are visited.
+   */
+  bool LocationIndex::VisitMatchingAdminRegions(const std::string& pattern,
+                                                AdminRegionVisitor& visitor) const
+  {
+    std::vector<TokenEntry>      entries;
+    std::unique_ptr<FileScanner> scanner;
+    bool                         selective;
+
+    if (!GetTokenEntries(pattern,
+                         entries,
+                         selective)) {
+      return false;
+    }
+
+    if (!selective) {
+      return VisitAdminRegions(visitor);
+    }
+
+    if (entries.empty() ||
+        entries.front().type!=tokenRegion) {
+      return true;
+    }
+
+    try {
+      scanner=AcquireScanner(indexScanners,
+                             FILENAME_LOCATION_IDX);
+
+      for (const auto& entry : entries) {
+        if (entry.type!=tokenRegion) {
+          break;
+        }
+
+        AdminRegion region;
+
+        if (!LoadAdminRegion(*scanner,
+                             entry.offset,
+                             region)) {
+          scanner->CloseFailsafe();
+          return false;
+        }
+
+        AdminRegionVisitor::Action action=visitor.Visit(region);
+
+        if (action==AdminRegionVisitor::error) {
+          ReleaseScanner(indexScanners,
+                         scanner);
+          return false;
+        }
+        else if (action==AdminRegionVisitor::stop) {
+          break;
+        }
+      }
+
+      ReleaseScanner(indexScanners,
+                     scanner);
+
+      return true;
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+
+      if (scanner) {
+        scanner->CloseFailsafe();
+      }
+
+      return false;
+    }
+  }
+
+  /**
+   * Visit all POIs and locations in the given region and its sub regions, whose name
+   * contains tokens starting with each token of the given pattern. Requires the token
+   * index, the visitor is responsible for the final matching. If the pattern only
+   * consists of short, unselective tokens, all locations of the region are visited.
+   */
+  bool LocationIndex::VisitMatchingAdminRegionLocations(const AdminRegion& region,
+                                                        const std::string& pattern,
+                                                        LocationVisitor& visitor) const
+  {
+    std::vector<TokenEntry>                    entries;
+    std::unordered_map<FileOffset,AdminRegion> entryRegions;
+    std::unordered_map<FileOffset,bool>        inRegion;
+    std::unique_ptr<FileScanner>               scanner;
+    bool                                       selective;
+
+    if (!GetTokenEntries(pattern,
+                         entries,
+                         selective)) {
+      return false;
+    }
+
+    if (!selective) {
+      return VisitAdminRegionLocations(region,
+                                       visitor);
+    }
+
+    entryRegions[region.regionOffset]=region;
+    inRegion[region.regionOffset]=true;
+
+    try {
+      scanner=AcquireScanner(indexScanners,
+                             FILENAME_LOCATION_IDX);
+
+      for (const auto& entry : entries) {
+        if (entry.type==tokenRegion) {
+          continue;
+        }
+
+        // Walk up the region tree until we either reach the requested region
+        // or a region we already know the answer for
+        std::vector<FileOffset> regionPath;
+        FileOffset              offset=entry.regionOffset;
+        bool                    isInRegion=false;
+
+        while (offset!=0) {
+          auto known=inRegion.find(offset);
+
+          if (known!=inRegion.end()) {
+            isInRegion=known->second;
+            break;
+          }
+
+          regionPath.push_back(offset);
+
+          AdminRegion& pathRegion=entryRegions[offset];
+
+          if (!LoadAdminRegion(*scanner,
+                               offset,
+                               pathRegion)) {
+            scanner->CloseFailsafe();
+            return false;
+          }
+
+          offset=pathRegion.parentRegionOffset;
+        }
+
+        for (const auto& pathOffset : regionPath) {
+          inRegion[pathOffset]=isInRegion;
+        }
+
+        if (!isInRegion) {
+          continue;
+        }
+
+        const AdminRegion& entryRegion=entryRegions[entry.regionOffset];
+        bool               proceed;
+
+        scanner->SetPos(entry.offset);
+
+        if (entry.type==tokenPOI) {
+          POI poi;
+
+          poi.regionOffset=entry.regionOffset;
+          poi.object=entry.object;
+
+          scanner->Read(poi.name);
+
+          proceed=visitor.Visit(entryRegion,
+                                poi);
+        }
+        else {
+          Location location;
+
+          LoadLocation(*scanner,
+                       entry.regionOffset,
+                       location);
+
+          proceed=visitor.Visit(entryRegion,
+                                location);
+        }
+
+        if (!proceed) {
+          break;
+        }
+      }
+
+      ReleaseScanner(indexScanners,
+                     scanner);
+
+      return true;
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+
+      if (scanner) {
+        scanner->CloseFailsafe();
+      }
+
       return false;
     }
   }
@@ -512,15 +1485,11 @@ namespace osmscout {
   bool LocationIndex::ResolveAdminRegionHierachie(const AdminRegionRef& adminRegion,
                                                   std::map<FileOffset,AdminRegionRef >& refs) const
   {
-    FileScanner scanner;
+    std::unique_ptr<FileScanner> scanner;
 
     try  {
-      scanner.Open(AppendFileToDir(path,
-                                   FILENAME_LOCATION_IDX),
-                   FileScanner::LowMemRandom,
-                   true);
-
-      scanner.SetPos(indexOffset);
+      scanner=AcquireScanner(indexScanners,
+                             FILENAME_LOCATION_IDX);
 
       std::list<FileOffset> offsets;
 
@@ -538,12 +1507,12 @@ namespace osmscout {
             continue;
           }
 
-          scanner.SetPos(offset);
-
           AdminRegion adminRegion;
 
-          if (!LoadAdminRegion(scanner,
+          if (!LoadAdminRegion(*scanner,
+                               offset,
                                adminRegion)) {
+            scanner->CloseFailsafe();
             return false;
           }
 
@@ -560,13 +1529,18 @@ namespace osmscout {
                   newOffsets);
       }
 
-      scanner.Close();
+      ReleaseScanner(indexScanners,
+                     scanner);
 
       return true;
     }
     catch (IOException& e) {
       log.Error() << e.GetDescription();
-      scanner.CloseFailsafe();
+
+      if (scanner) {
+        scanner->CloseFailsafe();
+      }
+
       return false;
     }
   }
@@ -575,7 +1549,23 @@ namespace osmscout {
   {
     size_t memory=0;
 
-    log.Info() << "CityStreetIndex: Memory " << memory;
+    for (const auto& region : regions) {
+      memory+=sizeof(region)+region.name.capacity();
+
+      for (const auto& alias : region.aliases) {
+        memory+=sizeof(alias)+alias.name.capacity();
+      }
+    }
+
+    memory+=regionSubtreeEnds.size()*sizeof(uint32_t);
+    memory+=regionIndexes.size()*(sizeof(FileOffset)+sizeof(uint32_t));
+
+    for (const auto& token : tokens) {
+      memory+=sizeof(token)+token.capacity();
+    }
+
+    memory+=tokenEntryOffsets.size()*sizeof(FileOffset);
+
+    log.Info() << "LocationIndex: Memory " << memory;
   }
 }
-
@@ -19,13 +19,23 @@
 
 #include <osmscout/LocationService.h>
 
+#include <algorithm>
+#include <future>
+#include <limits>
+
 #include <osmscout/util/Geometry.h>
 #include <osmscout/util/Logger.h>
 #include <osmscout/util/String.h>
+#include <osmscout/util/ThreadPool.h>
 #include <osmscout/TypeFeatures.h>
 
+#include <osmscout/system/Math.h>
+
 namespace osmscout {
 
+  static const double DESCRIBE_CLUSTER_CELL_SIZE=0.01;  //!< Size of the cells used for clustering locations in DescribeLocations() in degrees
+  static const size_t DESCRIBE_CLUSTER_MAX_SIZE=1000;   //!< Maximum number of locations in a cluster
+
   LocationCoordDescription::LocationCoordDescription(const GeoCoord& location)
     : location(location)
   {
@@ -78,51 +88,24 @@ namespace osmscout {
   }
 
   LocationService::VisitorMatcher::VisitorMatcher(const std::string& searchPattern)
-  :pattern(searchPattern)
+  :pattern(UTF8StringToLower(searchPattern))
   {
-    TolowerUmlaut(pattern);
+    // no code
   }
 
   void LocationService::VisitorMatcher::Match(const std::string& name,
                                               bool& match,
                                               bool& candidate) const
   {
-    std::string            tmpname=name;
+    std::string            tmpname=UTF8StringToLower(name);
     std::string::size_type matchPosition;
 
-    TolowerUmlaut(tmpname);
-
     matchPosition=tmpname.find(pattern);
 
     match=matchPosition==0 && tmpname.length()==pattern.length();
     candidate=matchPosition!=std::string::npos;
   }
 
-  void LocationService::VisitorMatcher::TolowerUmlaut(std::string& s) const
-  {
-    for (std::string::iterator it=s.begin();
-         it!=s.end();
-         ++it)
-    {
-      /* this filter matches all character from the table
-       * http://en.wikipedia.org/wiki/Latin-1_Supplement_%28Unicode_block%29#Compact_table
-       * beginning at U+0x00C0 to U+0x00DE
-       */
-      if((uint8_t)*it == 0xC3)
-      {
-        ++it;
-
-        if((uint8_t)*it>=0x80 && (uint8_t)*it<=0x9E) {
-          // 0x9F is german "sz" which is already small caps.
-          *it+=0x20;
-        }
-      }
-      else {
-        *it=tolower(*it);
-      }
-    }
-  }
-
   LocationService::AdminRegionMatchVisitor::AdminRegionMatchVisitor(const std::string& pattern,
                                                                     size_t limit)
   : VisitorMatcher(pattern),
@@ -311,7 +294,8 @@ namespace osmscout {
   }
 
   LocationSearch::LocationSearch()
-  : limit(50)
+  : limit(50),
+    useTokenIndex(false)
   {
     // no code
   }
@@ -535,13 +519,26 @@ namespace osmscout {
 
     //std::cout << "  Search for location '" << searchEntry.locationPattern << "'" << " in " << adminRegionResult.adminRegion->name << "/" << adminRegionResult.adminRegion->aliasName << std::endl;
 
+    LocationIndexRef     locationIndex=database->GetLocationIndex();
     LocationMatchVisitor visitor(adminRegionResult.adminRegion,
                                  searchEntry.locationPattern,
                                  search.limit>=result.results.size() ? search.limit-result.results.size() : 0);
 
+    if (!locationIndex) {
+      return false;
+    }
 
-    if (!VisitAdminRegionLocations(*adminRegionResult.adminRegion,
-                                   visitor)) {
+    if (search.useTokenIndex &&
+        locationIndex->HasTokenIndex()) {
+      if (!locationIndex->VisitMatchingAdminRegionLocations(*adminRegionResult.adminRegion,
+                                                            searchEntry.locationPattern,
+                                                            visitor)) {
+        log.Error() << "Error during lookup of region locations in token index";
+        return false;
+      }
+    }
+    else if (!locationIndex->VisitAdminRegionLocations(*adminRegionResult.adminRegion,
+                                                       visitor)) {
       log.Error() << "Error during traversal of region location list";
       return false;
     }
@@ -885,6 +882,14 @@ namespace osmscout {
 
   /**
    * Search for the given location patterns
+   *
+   * By default the complete region tree is visited and a pattern matches any
+   * substring of a name. If LocationSearch::useTokenIndex is set and the location
+   * index has a token index, only regions, locations and POIs having tokens
+   * starting with every token of the pattern are checked. This is much faster,
+   * but a pattern then only matches at token boundaries ("straße" does not find
+   * "Weinstraße").
+   *
    * @param search
    *    Data structure holding the search requests
    * @param result
@@ -895,9 +900,15 @@ namespace osmscout {
   bool LocationService::SearchForLocations(const LocationSearch& search,
                                            LocationSearchResult& result) const
   {
+    LocationIndexRef locationIndex=database->GetLocationIndex();
+
     result.limitReached=false;
     result.results.clear();
 
+    if (!locationIndex) {
+      return false;
+    }
+
     for (const auto& searchEntry : search.searches) {
       if (searchEntry.adminRegionPattern.empty()) {
         continue;
@@ -908,7 +919,15 @@ namespace osmscout {
       AdminRegionMatchVisitor adminRegionVisitor(searchEntry.adminRegionPattern,
                                                  search.limit);
 
-      if (!VisitAdminRegions(adminRegionVisitor)) {
+      if (search.useTokenIndex &&
+          locationIndex->HasTokenIndex()) {
+        if (!locationIndex->VisitMatchingAdminRegions(searchEntry.adminRegionPattern,
+                                                      adminRegionVisitor)) {
+          log.Error() << "Error during lookup of regions in token index";
+          return false;
+        }
+      }
+      else if (!locationIndex->VisitAdminRegions(adminRegionVisitor)) {
         log.Error() << "Error during traversal of region tree";
         return false;
       }
@@ -949,6 +968,11 @@ namespace osmscout {
     std::list<LocationService::ReverseLookupResult>& results;
 
     std::list<SearchEntry>                           searchEntries;
+    const std::set<FileOffset>*                      regionOffsets;
+
+  private:
+    bool IsCandidate(const AdminRegion& region,
+                     bool& candidate) const;
 
   public:
     std::map<FileOffset,AdminRegionRef>              adminRegions;
@@ -958,6 +982,7 @@ namespace osmscout {
                                     std::list<LocationService::ReverseLookupResult>& results);
 
     void AddSearchEntry(const SearchEntry& searchEntry);
+    void SetRegionOffsets(const std::set<FileOffset>& regionOffsets);
 
     Action Visit(const AdminRegion& region);
   };
@@ -965,7 +990,8 @@ namespace osmscout {
   AdminRegionReverseLookupVisitor::AdminRegionReverseLookupVisitor(const Database& database,
                                                                    std::list<LocationService::ReverseLookupResult>& results)
   : database(database),
-    results(results)
+    results(results),
+    regionOffsets(NULL)
   {
     // no code
   }
@@ -975,67 +1001,90 @@ namespace osmscout {
     searchEntries.push_back(searchEntry);
   }
 
-  AdminRegionVisitor::Action AdminRegionReverseLookupVisitor::Visit(const AdminRegion& region)
+  /**
+   * Set the offsets of all regions containing at least one of the search entries,
+   * as returned by the region lookup index. The areas of the visited regions then
+   * do not need to be loaded and tested.
+   */
+  void AdminRegionReverseLookupVisitor::SetRegionOffsets(const std::set<FileOffset>& regionOffsets)
+  {
+    this->regionOffsets=&regionOffsets;
+  }
+
+  bool AdminRegionReverseLookupVisitor::IsCandidate(const AdminRegion& region,
+                                                    bool& candidate) const
   {
+    candidate=false;
+
+    if (regionOffsets!=NULL) {
+      candidate=regionOffsets->find(region.regionOffset)!=regionOffsets->end();
+
+      return true;
+    }
+
     AreaRef area;
-    bool    atLeastOneCandidate=false;
 
     if (!database.GetAreaByOffset(region.object.GetFileOffset(),
                                   area)) {
-      return error;
+      return false;
     }
 
-    for (std::list<SearchEntry>::const_iterator entry=searchEntries.begin();
-        entry!=searchEntries.end();
-        ++entry) {
-      if (region.Match(entry->object)) {
-        LocationService::ReverseLookupResult result;
+    for (size_t r=0; r<area->rings.size(); r++) {
+      if (area->rings[r].ring!=Area::outerRingId) {
+        continue;
+      }
 
-        result.object=entry->object;
-        result.adminRegion=std::make_shared<AdminRegion>(region);
+      for (const auto& entry : searchEntries) {
+        if (entry.coords.size()==1) {
+          if (!IsCoordInArea(entry.coords.front(),
+                             area->rings[r].nodes)) {
+            continue;
+          }
+        }
+        else {
+          if (!IsAreaAtLeastPartlyInArea(entry.coords,
+                                         area->rings[r].nodes)) {
+            continue;
+          }
+        }
 
-        results.push_back(result);
+        candidate=true;
+
+        return true;
       }
+    }
 
-      bool candidate=false;
+    return true;
+  }
 
-      for (size_t r=0; r<area->rings.size(); r++) {
-        if (area->rings[r].ring!=Area::outerRingId) {
-          continue;
-        }
+  AdminRegionVisitor::Action AdminRegionReverseLookupVisitor::Visit(const AdminRegion& region)
+  {
+    bool candidate;
 
-        for (const auto& entry : searchEntries) {
-          if (entry.coords.size()==1) {
-            if (!IsCoordInArea(entry.coords.front(),
-                               area->rings[r].nodes)) {
-              continue;
-            }
-          }
-          else {
-            if (!IsAreaAtLeastPartlyInArea(entry.coords,
-                                           area->rings[r].nodes)) {
-              continue;
-            }
-          }
+    if (searchEntries.empty()) {
+      return skipChildren;
+    }
 
-          // candidate
-          candidate=true;
-          break;
-        }
+    if (!IsCandidate(region,
+                     candidate)) {
+      return error;
+    }
 
-        if (candidate) {
-          break;
-        }
-      }
+    for (const auto& entry : searchEntries) {
+      if (region.Match(entry.object)) {
+        LocationService::ReverseLookupResult result;
+
+        result.object=entry.object;
+        result.adminRegion=std::make_shared<AdminRegion>(region);
 
-      if (candidate) {
-        atLeastOneCandidate = true;
-        adminRegions.insert(std::make_pair(region.regionOffset,
-                                           std::make_shared<AdminRegion>(region)));
+        results.push_back(result);
       }
     }
 
-    if (atLeastOneCandidate) {
+    if (candidate) {
+      adminRegions.insert(std::make_pair(region.regionOffset,
+                                         std::make_shared<AdminRegion>(region)));
+
       return visitChildren;
     }
     else {
@@ -1190,6 +1239,8 @@ namespace osmscout {
 
     AdminRegionReverseLookupVisitor adminRegionVisitor(*database,
                                                        result);
+    std::vector<GeoCoord>           searchCoords;
+    std::set<FileOffset>            regionOffsets;
 
     for (const auto& object : objects) {
       std::vector<GeoCoord> coords;
@@ -1207,6 +1258,10 @@ namespace osmscout {
         searchEntry.object=object;
         searchEntry.coords.push_back(node->GetCoords());
 
+        searchCoords.insert(searchCoords.end(),
+                            searchEntry.coords.begin(),
+                            searchEntry.coords.end());
+
         adminRegionVisitor.AddSearchEntry(searchEntry);
       }
       else if (object.GetType()==refArea) {
@@ -1224,6 +1279,10 @@ namespace osmscout {
             searchEntry.object=object;
             searchEntry.coords=area->rings[r].nodes;
 
+            searchCoords.insert(searchCoords.end(),
+                                searchEntry.coords.begin(),
+                                searchEntry.coords.end());
+
             adminRegionVisitor.AddSearchEntry(searchEntry);
           }
         }
@@ -1241,6 +1300,10 @@ namespace osmscout {
         searchEntry.object=object;
         searchEntry.coords=way->nodes;
 
+        searchCoords.insert(searchCoords.end(),
+                            searchEntry.coords.begin(),
+                            searchEntry.coords.end());
+
         adminRegionVisitor.AddSearchEntry(searchEntry);
       }
       else {
@@ -1248,6 +1311,15 @@ namespace osmscout {
       }
     }
 
+    if (locationIndex->HasRegionLookupIndex()) {
+      if (!locationIndex->GetRegionOffsets(searchCoords,
+                                           regionOffsets)) {
+        return false;
+      }
+
+      adminRegionVisitor.SetRegionOffsets(regionOffsets);
+    }
+
     if (!VisitAdminRegions(adminRegionVisitor)) {
       return false;
     }
@@ -1307,19 +1379,18 @@ namespace osmscout {
                                 result);
   }
 
-  bool LocationService::DescribeLocationByAddress(const GeoCoord& location,
-                                                  LocationDescription& description)
+  /**
+   * Return the set of area types, that can hold an address.
+   */
+  bool LocationService::GetAddressTypes(TypeInfoSet& addressTypes) const
   {
-    TypeConfigRef    typeConfig=database->GetTypeConfig();
-    AreaAreaIndexRef areaAreaIndex=database->GetAreaAreaIndex();
-    GeoBox           box100=GeoBox::BoxByCenterAndRadius(location,100);
+    TypeConfigRef typeConfig=database->GetTypeConfig();
 
-    if (!typeConfig ||
-        !areaAreaIndex) {
+    if (!typeConfig) {
       return false;
     }
 
-    TypeInfoSet addressTypes;
+    addressTypes.Clear();
 
     for (const auto& type : typeConfig->GetTypes()) {
       if (type->CanBeArea() &&
@@ -1328,15 +1399,134 @@ namespace osmscout {
       }
     }
 
-    if (addressTypes.Empty()) {
-      return true;
+    return true;
+  }
+
+  /**
+   * The address area closest to a location (or containing the location)
+   */
+  struct AddressPlace
+  {
+    AreaRef area;
+    bool    atPlace;
+    double  distance; //!< Distance in km
+    double  bearing;
+
+    AddressPlace()
+    : atPlace(false),
+      distance(std::numeric_limits<double>::max()),
+      bearing(0.0)
+    {
+      // no code
+    }
+  };
+
+  static const double ADDRESS_PLACE_MAX_DISTANCE=0.1; //!< Maximum distance of an address area to a location in km
+
+  /**
+   * Set the given area as the place of the location. distance and closest are the
+   * result of GetAreaDistance().
+   */
+  static void SetAddressPlace(const GeoCoord& location,
+                              const AreaRef& area,
+                              double distance,
+                              const GeoCoord& closest,
+                              AddressPlace& place)
+  {
+    place.area=area;
+
+    if (distance==0.0) {
+      place.atPlace=true;
+      place.distance=0.0;
+      place.bearing=0;
+    }
+    else {
+      place.atPlace=false;
+      place.distance=GetEllipsoidalDistance(location,
+                                            closest);
+      place.bearing=GetSphericalBearingInitial(closest,
+                                               location);
+    }
+  }
+
+  /**
+   * Find the address area containing or closest to each location of the cluster using
+   * the nearest neighbour search of the database.
+   */
+  static bool GetClosestAddressPlaces(const Database& database,
+                                      const std::vector<GeoCoord>& locations,
+                                      const std::vector<size_t>& cluster,
+                                      const TypeInfoSet& addressTypes,
+                                      std::vector<AddressPlace>& places)
+  {
+    std::vector<ClosestArea> areas;
+
+    for (size_t l=0; l<cluster.size(); l++) {
+      const GeoCoord& location=locations[cluster[l]];
+
+      if (!database.GetClosestAreas(location,
+                                    addressTypes,
+                                    1,
+                                    ADDRESS_PLACE_MAX_DISTANCE,
+                                    areas)) {
+        return false;
+      }
+
+      if (areas.empty()) {
+        continue;
+      }
+
+      SetAddressPlace(location,
+                      areas.front().object,
+                      areas.front().distance,
+                      areas.front().coord,
+                      places[l]);
+    }
+
+    return true;
+  }
+
+  /**
+   * Find the address area containing or closest to each location of the cluster by
+   * loading all address areas in the bounding box of the cluster at once.
+   *
+   * Candidates and distances are the same as for GetClosestAddressPlaces(), so both
+   * functions return the same places.
+   */
+  static bool GetAddressPlacesInBox(const Database& database,
+                                    const std::vector<GeoCoord>& locations,
+                                    const std::vector<size_t>& cluster,
+                                    const TypeInfoSet& addressTypes,
+                                    std::vector<AddressPlace>& places)
+  {
+    TypeConfigRef       typeConfig=database.GetTypeConfig();
+    AreaAreaIndexRef    areaAreaIndex=database.GetAreaAreaIndex();
+    std::vector<GeoBox> locationBoxes;
+    GeoBox              clusterBox;
+
+    if (!typeConfig ||
+        !areaAreaIndex) {
+      return false;
+    }
+
+    locationBoxes.reserve(cluster.size());
+
+    for (size_t index : cluster) {
+      locationBoxes.push_back(EquirectangularDistance(locations[index]).GetBoundingBox(ADDRESS_PLACE_MAX_DISTANCE));
+
+      if (clusterBox.IsValid()) {
+        clusterBox.Include(locationBoxes.back());
+      }
+      else {
+        clusterBox=locationBoxes.back();
+      }
     }
 
     std::vector<DataBlockSpan> areaSpans;
     TypeInfoSet                loadedAddressTypes;
 
     if (!areaAreaIndex->GetAreasInArea(*typeConfig,
-                                       box100,
+                                       clusterBox,
                                        std::numeric_limits<size_t>::max(),
                                        addressTypes,
                                        areaSpans,
@@ -1350,104 +1540,300 @@ namespace osmscout {
 
     std::vector<AreaRef> areas;
 
-    if (!database->GetAreasByBlockSpans(areaSpans,
-                                        areas)) {
+    if (!database.GetAreasByBlockSpans(areaSpans,
+                                       areas)) {
       return false;
     }
 
-    if (areas.empty()) {
-      return true;
+    std::vector<GeoBox> areaBoxes(areas.size());
+
+    for (size_t a=0; a<areas.size(); a++) {
+      areas[a]->GetBoundingBox(areaBoxes[a]);
     }
 
-    bool    atPlace=false;
-    AreaRef placeArea;
-    double  distance=std::numeric_limits<double>::max(); // In Km
-    double  bearing;
+    for (size_t l=0; l<cluster.size(); l++) {
+      const GeoCoord&         location=locations[cluster[l]];
+      EquirectangularDistance distance(location);
+      size_t                  bestArea=areas.size();
+      double                  bestDistance=std::numeric_limits<double>::max();
+      GeoCoord                bestCoord;
 
-    for (const auto& area : areas) {
-      for (const auto& ring : area->rings) {
-        if (ring.ring==Area::outerRingId) {
-          if (!atPlace && IsCoordInArea(location,
-                                        ring.nodes)) {
-            atPlace=true;
-            placeArea=area;
-            distance=0.0;
-            bearing=0;
-          }
+      for (size_t a=0; a<areas.size(); a++) {
+        if (!areaBoxes[a].Intersects(locationBoxes[l])) {
+          continue;
+        }
 
-          for (size_t i=0; i<ring.nodes.size(); i++) {
-            double   currentDistance;
-            GeoCoord a;
-            GeoCoord b;
-            GeoCoord intersection;
-
-            if (i>0) {
-              a=ring.nodes[i-1];
-              b=ring.nodes[i];
-            }
-            else {
-              a=ring.nodes[ring.nodes.size()-1];
-              b=ring.nodes[i];
-            }
-
-            currentDistance=CalculateDistancePointToLineSegment(location,
-                                                                a,
-                                                                b,
-                                                                intersection);
-
-            currentDistance=GetEllipsoidalDistance(location,intersection);
-
-            if (!atPlace &&
-                currentDistance<distance) {
-              placeArea=area;
-              distance=currentDistance;
-              //distance=GetEllipsoidalDistance(location,intersection);
-              bearing=GetSphericalBearingInitial(intersection,location);
-            }
-          }
+        GeoCoord closest;
+        double   areaDistance=GetAreaDistance(distance,
+                                              *areas[a],
+                                              closest);
+
+        if (areaDistance>ADDRESS_PLACE_MAX_DISTANCE) {
+          continue;
+        }
+
+        // Same order as Database::GetClosestAreas()
+        if (bestArea==areas.size() ||
+            areaDistance<bestDistance ||
+            (areaDistance==bestDistance &&
+             areas[a]->GetFileOffset()<areas[bestArea]->GetFileOffset())) {
+          bestArea=a;
+          bestDistance=areaDistance;
+          bestCoord=closest;
         }
       }
+
+      if (bestArea<areas.size()) {
+        SetAddressPlace(location,
+                        areas[bestArea],
+                        bestDistance,
+                        bestCoord,
+                        places[l]);
+      }
     }
 
-    if (placeArea) {
-      std::list<ReverseLookupResult> result;
+    return true;
+  }
 
-      if (!ReverseLookupObject(ObjectFileRef(placeArea->GetFileOffset(),
-                                             refArea),
-                               result)) {
+  /**
+   * Set the address description for the given cluster of nearby locations. The reverse
+   * lookup of the found places is done in one call.
+   *
+   * If the database has an R-tree index of areas, the address area of each location
+   * is found by a nearest neighbour search, else the address areas for all locations
+   * of the cluster are loaded at once. Both ways return the same places.
+   *
+   * Only address areas within 100 meters of a location are taken into account.
+   *
+   * Method is thread-safe.
+   */
+  bool LocationService::DescribeLocationsByAddress(const std::vector<GeoCoord>& locations,
+                                                   const std::vector<size_t>& cluster,
+                                                   const TypeInfoSet& addressTypes,
+                                                   std::vector<LocationDescription>& descriptions) const
+  {
+    if (addressTypes.Empty() ||
+        cluster.empty()) {
+      return true;
+    }
+
+    std::vector<AddressPlace> places(cluster.size());
+    std::set<FileOffset>      placeOffsets;
+    std::list<ObjectFileRef>  placeObjects;
+
+    if (database->GetAreaRTreeIndex()) {
+      if (!GetClosestAddressPlaces(*database,
+                                   locations,
+                                   cluster,
+                                   addressTypes,
+                                   places)) {
         return false;
       }
+    }
+    else if (!GetAddressPlacesInBox(*database,
+                                    locations,
+                                    cluster,
+                                    addressTypes,
+                                    places)) {
+      return false;
+    }
+
+    for (const auto& place : places) {
+      if (place.area &&
+          placeOffsets.insert(place.area->GetFileOffset()).second) {
+        placeObjects.push_back(ObjectFileRef(place.area->GetFileOffset(),
+                                             refArea));
+      }
+    }
+
+    if (placeObjects.empty()) {
+      return true;
+    }
 
-      if (!result.empty()) {
-        Place place=Place(result.front().object,
-                          result.front().adminRegion,
-                          result.front().poi,
-                          result.front().location,
-                          result.front().address);
+    std::list<ReverseLookupResult>                                result;
+    std::map<FileOffset,std::list<ReverseLookupResult>::iterator> placeResults;
 
-        if (atPlace) {
-          description.SetAtAddressDescription(std::make_shared<LocationAtPlaceDescription>(place));
-        }
-        else {
-          description.SetAtAddressDescription(std::make_shared<LocationAtPlaceDescription>(place,distance*1000,bearing));
-        }
+    if (!ReverseLookupObjects(placeObjects,
+                              result)) {
+      return false;
+    }
+
+    for (auto entry=result.begin();
+         entry!=result.end();
+         ++entry) {
+      // Only the first result of each object is used
+      placeResults.insert(std::make_pair(entry->object.GetFileOffset(),
+                                         entry));
+    }
+
+    for (size_t l=0; l<cluster.size(); l++) {
+      const AddressPlace& addressPlace=places[l];
+
+      if (!addressPlace.area) {
+        continue;
+      }
+
+      auto placeResult=placeResults.find(addressPlace.area->GetFileOffset());
+
+      if (placeResult==placeResults.end()) {
+        continue;
+      }
+
+      Place place=Place(placeResult->second->object,
+                        placeResult->second->adminRegion,
+                        placeResult->second->poi,
+                        placeResult->second->location,
+                        placeResult->second->address);
+
+      if (addressPlace.atPlace) {
+        descriptions[cluster[l]].SetAtAddressDescription(std::make_shared<LocationAtPlaceDescription>(place));
+      }
+      else {
+        descriptions[cluster[l]].SetAtAddressDescription(std::make_shared<LocationAtPlaceDescription>(place,addressPlace.distance*1000,addressPlace.bearing));
       }
     }
 
     return true;
   }
 
+  /**
+   * Return the worker pool used by DescribeLocations(). The pool has one worker per
+   * CPU core and is created on first use, so services that never describe more than
+   * one cluster of locations at once do not start any threads. The pool is shared
+   * by all calls and lives as long as the service.
+   *
+   * Method is thread-safe.
+   */
+  ThreadPool& LocationService::GetWorkerPool()
+  {
+    std::lock_guard<std::mutex> lock(workerPoolMutex);
+
+    if (!workerPool) {
+      workerPool.reset(new ThreadPool());
+    }
+
+    return *workerPool;
+  }
+
   bool LocationService::DescribeLocation(const GeoCoord& location,
                                          LocationDescription& description)
   {
-    description.SetCoordDescription(std::make_shared<LocationCoordDescription>(location));
-
+    std::vector<GeoCoord>            locations(1,location);
+    std::vector<LocationDescription> descriptions;
 
-    if (!DescribeLocationByAddress(location,description)) {
+    if (!DescribeLocations(locations,
+                           descriptions,
+                           false)) {
       return false;
     }
 
+    description=descriptions.front();
+
     return true;
   }
 
+  /**
+   * Describe all the given locations, the same as calling DescribeLocation() for each of
+   * them, but faster for a larger number of locations.
+   *
+   * The locations are grouped into clusters of nearby locations, that share the index
+   * lookups, the loading of address areas and the reverse lookup of the resulting
+   * places. If requested, the clusters are processed in parallel by the worker pool of
+   * the service (see GetWorkerPool()), else in the calling thread.
+   *
+   * @param locations
+   *    The locations to describe
+   * @param descriptions
+   *    The description of each location, in the order of the locations
+   * @param parallel
+   *    Process clusters in parallel, if there is more than one
+   * @return
+   *    True, if there was no error
+   */
+  bool LocationService::DescribeLocations(const std::vector<GeoCoord>& locations,
+                                          std::vector<LocationDescription>& descriptions,
+                                          bool parallel)
+  {
+    TypeInfoSet addressTypes;
+
+    descriptions.clear();
+    descriptions.resize(locations.size());
+
+    for (size_t i=0; i<locations.size(); i++) {
+      descriptions[i].SetCoordDescription(std::make_shared<LocationCoordDescription>(locations[i]));
+    }
+
+    if (!GetAddressTypes(addressTypes)) {
+      return false;
+    }
+
+    if (addressTypes.Empty()) {
+      return true;
+    }
+
+    // Sort the locations by cell and split them into clusters of the same cell
+    std::vector<std::pair<uint64_t,size_t> > cellLocations;
+    std::vector<std::vector<size_t> >        clusters;
+
+    cellLocations.reserve(locations.size());
+
+    for (size_t i=0; i<locations.size(); i++) {
+      uint64_t cellX=(uint64_t)floor((locations[i].GetLon()+180.0)/DESCRIBE_CLUSTER_CELL_SIZE);
+      uint64_t cellY=(uint64_t)floor((locations[i].GetLat()+90.0)/DESCRIBE_CLUSTER_CELL_SIZE);
+
+      cellLocations.push_back(std::make_pair((cellY << 32) | cellX,
+                                             i));
+    }
+
+    std::sort(cellLocations.begin(),
+              cellLocations.end());
+
+    for (size_t i=0; i<cellLocations.size(); i++) {
+      if (i==0 ||
+          cellLocations[i].first!=cellLocations[i-1].first ||
+          clusters.back().size()>=DESCRIBE_CLUSTER_MAX_SIZE) {
+        clusters.push_back(std::vector<size_t>());
+      }
+
+      clusters.back().push_back(cellLocations[i].second);
+    }
+
+    if (!parallel ||
+        clusters.size()<=1) {
+      for (const auto& cluster : clusters) {
+        if (!DescribeLocationsByAddress(locations,
+                                        cluster,
+                                        addressTypes,
+                                        descriptions)) {
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    ThreadPool&                    pool=GetWorkerPool();
+    std::vector<std::future<bool>> results;
+    bool                           success=true;
+
+    results.reserve(clusters.size());
+
+    for (const auto& cluster : clusters) {
+      results.push_back(pool.Submit([this,&locations,&cluster,&addressTypes,&descriptions]() {
+        return DescribeLocationsByAddress(locations,
+                                          cluster,
+                                          addressTypes,
+                                          descriptions);
+      }));
+    }
+
+    for (auto& result : results) {
+      if (!result.get()) {
+        success=false;
+      }
+    }
+
+    return success;
+  }
+
 }
@@ -0,0 +1,282 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2016 Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/ObjectView.h>
+
+namespace osmscout {
+
+  CoordsView::Iterator::Iterator(const uint8_t* data,
+                                 size_t deltaSize,
+                                 size_t index,
+                                 size_t nodeCount)
+  : delta(data+coordByteSize),
+    deltaSize(deltaSize),
+    index(index),
+    nodeCount(nodeCount),
+    latValue(0),
+    lonValue(0)
+  {
+    if (index<nodeCount) {
+      latValue=  (data[0] <<  0)
+               | (data[1] <<  8)
+               | (data[2] << 16)
+               | ((data[6] & 0x0f) << 24);
+
+      lonValue=  (data[3] <<  0)
+               | (data[4] <<  8)
+               | (data[5] << 16)
+               | ((data[6] & 0xf0) << 20);
+    }
+  }
+
+  /**
+   * Move to the next coordinate by applying the next delta. The deltas are
+   * signed little endian values with 8, 16 or 24 bit for each of latitude
+   * and longitude.
+   */
+  CoordsView::Iterator& CoordsView::Iterator::operator++()
+  {
+    index++;
+
+    if (index>=nodeCount) {
+      return *this;
+    }
+
+    uint32_t latDelta=0;
+    uint32_t lonDelta=0;
+
+    for (size_t i=0; i<deltaSize; i++) {
+      latDelta|=delta[i] << (i*8);
+      lonDelta|=delta[deltaSize+i] << (i*8);
+    }
+
+    // Sign extension
+    uint32_t signBit=1u << (deltaSize*8-1);
+
+    if (latDelta & signBit) {
+      latDelta|=~(signBit*2-1);
+    }
+
+    if (lonDelta & signBit) {
+      lonDelta|=~(signBit*2-1);
+    }
+
+    latValue+=latDelta;
+    lonValue+=lonDelta;
+
+    delta+=2*deltaSize;
+
+    return *this;
+  }
+
+  CoordsView::CoordsView()
+  : data(NULL),
+    nodeCount(0),
+    coordBitSize(16)
+  {
+    // no code
+  }
+
+  /**
+   * Create a view of the encoded coordinate array in the given buffer. The
+   * buffer must stay valid as long as the view is used.
+   */
+  CoordsView::CoordsView(const char* buffer)
+  : data(NULL),
+    nodeCount(0),
+    coordBitSize(16)
+  {
+    if (buffer[0]==0) {
+      return;
+    }
+
+    const uint8_t* header=(const uint8_t*)buffer;
+    size_t         headerSize=DecodeCoordsHeader(header,
+                                                 nodeCount,
+                                                 coordBitSize);
+
+    data=header+headerSize;
+  }
+
+  /**
+   * Decode all coordinates into the given vector.
+   */
+  void CoordsView::CopyTo(std::vector<GeoCoord>& nodes) const
+  {
+    nodes.clear();
+    nodes.reserve(nodeCount);
+
+    for (const auto& coord : *this) {
+      nodes.push_back(coord);
+    }
+  }
+
+  NodeView::NodeView()
+  : fileOffset(0)
+  {
+    // no code
+  }
+
+  /**
+   * Read the node at the current position of the scanner into the view.
+   *
+   * @throws IOException
+   */
+  void NodeView::Read(const TypeConfig& typeConfig,
+                      FileScanner& scanner)
+  {
+    TypeId typeId;
+
+    fileOffset=scanner.GetPos();
+
+    scanner.ReadTypeId(typeId,
+                       typeConfig.GetNodeTypeIdBytes());
+
+    featureValueBuffer.SetType(typeConfig.GetNodeTypeInfo(typeId));
+
+    featureValueBuffer.Read(scanner);
+
+    scanner.ReadCoord(coords);
+  }
+
+  WayView::WayView()
+  : fileOffset(0)
+  {
+    // no code
+  }
+
+  /**
+   * Read the way at the current position of the scanner into the view.
+   *
+   * @throws IOException
+   */
+  void WayView::Read(const TypeConfig& typeConfig,
+                     FileScanner& scanner)
+  {
+    TypeId typeId;
+
+    fileOffset=scanner.GetPos();
+
+    scanner.ReadTypeId(typeId,
+                       typeConfig.GetWayTypeIdBytes());
+
+    featureValueBuffer.SetType(typeConfig.GetWayTypeInfo(typeId));
+
+    featureValueBuffer.Read(scanner);
+
+    scanner.ReadBox(boundingBox);
+
+    coords=CoordsView(scanner.ReadCoordsInPlace(coordsBuffer));
+
+    if (featureValueBuffer.GetType()->CanRoute() ||
+        featureValueBuffer.GetType()->GetOptimizeLowZoom()) {
+      idsBuffer.clear();
+      scanner.ReadIdsEncoded(coords.GetNodeCount(),
+                             idsBuffer);
+    }
+  }
+
+  AreaView::RingView::RingView()
+  : ring(0)
+  {
+    // no code
+  }
+
+  AreaView::AreaView()
+  : fileOffset(0),
+    ringCount(0)
+  {
+    // no code
+  }
+
+  /**
+   * Read the area at the current position of the scanner into the view.
+   *
+   * @throws IOException
+   */
+  void AreaView::Read(const TypeConfig& typeConfig,
+                      FileScanner& scanner)
+  {
+    TypeId   ringType;
+    bool     multipleRings;
+    uint32_t count=1;
+
+    fileOffset=scanner.GetPos();
+
+    scanner.ReadTypeId(ringType,
+                       typeConfig.GetAreaTypeIdBytes());
+
+    if (rings.empty()) {
+      rings.resize(1);
+    }
+
+    rings[0].featureValueBuffer.SetType(typeConfig.GetAreaTypeInfo(ringType));
+    rings[0].featureValueBuffer.Read(scanner,
+                                     multipleRings);
+
+    if (multipleRings) {
+      scanner.ReadNumber(count);
+
+      count++;
+    }
+
+    scanner.ReadBox(boundingBox);
+
+    if (rings.size()<count) {
+      rings.resize(count);
+    }
+
+    ringCount=count;
+
+    rings[0].ring=ringCount>1 ? Area::masterRingId : Area::outerRingId;
+    rings[0].coords=CoordsView(scanner.ReadCoordsInPlace(rings[0].coordsBuffer));
+
+    if (!rings[0].coords.IsEmpty() &&
+        rings[0].GetType()->CanRoute()) {
+      idsBuffer.clear();
+      scanner.ReadIdsEncoded(rings[0].coords.GetNodeCount(),
+                             idsBuffer);
+    }
+
+    for (size_t i=1; i<ringCount; i++) {
+      RingView& ring=rings[i];
+
+      scanner.ReadTypeId(ringType,
+                         typeConfig.GetAreaTypeIdBytes());
+
+      ring.featureValueBuffer.SetType(typeConfig.GetAreaTypeInfo(ringType));
+
+      if (ring.GetType()->GetAreaId()!=typeIgnore) {
+        ring.featureValueBuffer.Read(scanner);
+      }
+
+      scanner.Read(ring.ring);
+
+      ring.coords=CoordsView(scanner.ReadCoordsInPlace(ring.coordsBuffer));
+
+      if (!ring.coords.IsEmpty() &&
+          ring.GetType()->GetAreaId()!=typeIgnore &&
+          ring.GetType()->CanRoute()) {
+        idsBuffer.clear();
+        scanner.ReadIdsEncoded(ring.coords.GetNodeCount(),
+                               idsBuffer);
+      }
+    }
+  }
+}
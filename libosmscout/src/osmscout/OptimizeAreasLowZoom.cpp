@@ -27,6 +27,7 @@
 #include <osmscout/util/File.h>
 #include <osmscout/util/Geometry.h>
 #include <osmscout/util/Logger.h>
+#include <osmscout/util/MemoryArena.h>
 #include <osmscout/util/Projection.h>
 #include <osmscout/util/StopClock.h>
 #include <osmscout/util/String.h>
@@ -247,7 +248,7 @@ namespace osmscout
     for (const auto& offset : offsets) {
       scanner.SetPos(offset);
 
-      AreaRef area=std::make_shared<Area>();
+      AreaRef area=AllocateShared<Area>();
 
       area->ReadOptimized(*typeConfig,
                           scanner);
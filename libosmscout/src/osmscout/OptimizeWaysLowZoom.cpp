@@ -27,6 +27,7 @@
 #include <osmscout/util/File.h>
 #include <osmscout/util/Geometry.h>
 #include <osmscout/util/Logger.h>
+#include <osmscout/util/MemoryArena.h>
 #include <osmscout/util/Projection.h>
 #include <osmscout/util/StopClock.h>
 #include <osmscout/util/String.h>
@@ -244,7 +245,7 @@ namespace osmscout
     for (const auto& offset : offsets) {
       scanner.SetPos(offset);
 
-      WayRef way=std::make_shared<Way>();
+      WayRef way=AllocateShared<Way>();
 
       way->ReadOptimized(*typeConfig,
                          scanner);
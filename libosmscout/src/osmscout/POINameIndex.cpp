@@ -0,0 +1,530 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2016  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/POINameIndex.h>
+
+#include <algorithm>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/Geometry.h>
+#include <osmscout/util/Logger.h>
+#include <osmscout/util/String.h>
+
+#include <osmscout/system/Math.h>
+
+namespace osmscout {
+
+  const char* const POINameIndex::FILENAME_POI_NAME_IDX="poiname.idx";
+
+  static const double minKmPerDegreeLat=110.5; //!< Lower bound of the length of a degree of latitude
+  static const double minEarthRadius=6356.0;   //!< Lower bound of the earth radius in km
+
+  static inline bool IsWordSeparator(char c)
+  {
+    unsigned char u=(unsigned char)c;
+
+    return u<0x80 &&
+           !(u>='0' && u<='9') &&
+           !(u>='a' && u<='z') &&
+           !(u>='A' && u<='Z');
+  }
+
+  /**
+   * Returns true, if the given (already lower case) pattern is a prefix of the name
+   * or of one of the words of the name. Comparison ignores the case of the characters
+   * converted by UTF8StringToLower().
+   */
+  static bool MatchesPattern(const std::string& name,
+                             const std::string& pattern)
+  {
+    if (pattern.empty()) {
+      return true;
+    }
+
+    if (pattern.length()>name.length()) {
+      return false;
+    }
+
+    std::string lowerName=UTF8StringToLower(name);
+
+    for (size_t start=0; start+pattern.length()<=name.length(); start++) {
+      if (start>0 &&
+          !IsWordSeparator(name[start-1])) {
+        continue;
+      }
+
+      size_t i=0;
+
+      while (i<pattern.length() &&
+             lowerName[start+i]==pattern[i]) {
+        i++;
+      }
+
+      if (i==pattern.length()) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  static inline bool IsCloser(const POINameIndex::Entry& a,
+                              const POINameIndex::Entry& b)
+  {
+    if (a.distance!=b.distance) {
+      return a.distance<b.distance;
+    }
+
+    return a.object<b.object;
+  }
+
+  /**
+   * Returns a lower bound of the distance in km between the given coordinate and
+   * any coordinate that is at least latDelta degrees of latitude or at least lonDelta
+   * degrees of longitude away.
+   */
+  static double GetMinDistance(const GeoCoord& coord,
+                               double latDelta,
+                               double lonDelta)
+  {
+    double latDistance=latDelta*minKmPerDegreeLat;
+
+    if (lonDelta>=90.0) {
+      return latDistance;
+    }
+
+    double lonDistance=minEarthRadius*asin(cos(coord.GetLat()*M_PI/180.0)*sin(lonDelta*M_PI/180.0));
+
+    return std::min(latDistance,
+                    lonDistance)*0.99;
+  }
+
+  POINameIndex::POINameIndex()
+  : tableOffset(0),
+    entryOffsetBytes(0),
+    cellXStart(0),
+    cellXEnd(0),
+    cellYStart(0),
+    cellYEnd(0),
+    cellWidth(0.0),
+    cellHeight(0.0)
+  {
+    // no code
+  }
+
+  void POINameIndex::Close()
+  {
+    try {
+      if (scanner.IsOpen()) {
+        scanner.Close();
+      }
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      scanner.CloseFailsafe();
+    }
+  }
+
+  bool POINameIndex::Open(const TypeConfigRef& typeConfig,
+                          const std::string& path)
+  {
+    this->typeConfig=typeConfig;
+
+    datafilename=AppendFileToDir(path,FILENAME_POI_NAME_IDX);
+
+    try {
+      uint32_t level;
+
+      scanner.Open(datafilename,FileScanner::FastRandom,true);
+
+      scanner.ReadFileOffset(tableOffset);
+      scanner.Read(entryOffsetBytes);
+
+      scanner.ReadNumber(level);
+      scanner.ReadNumber(cellXStart);
+      scanner.ReadNumber(cellXEnd);
+      scanner.ReadNumber(cellYStart);
+      scanner.ReadNumber(cellYEnd);
+
+      cellWidth=360.0/pow(2.0,level);
+      cellHeight=180.0/pow(2.0,level);
+
+      return !scanner.HasError();
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      scanner.CloseFailsafe();
+      return false;
+    }
+  }
+
+  /**
+   * Read the given cell and add all matching POIs to the result. If a limit is
+   * given, entries are held as a heap with the most distant entry on top.
+   *
+   * Method is not thread-safe.
+   *
+   * @throws IOException
+   */
+  void POINameIndex::ReadCell(uint32_t x,
+                              uint32_t y,
+                              const GeoCoord& center,
+                              const GeoBox& boundingBox,
+                              double maxDistance,
+                              const std::string& pattern,
+                              const TypeInfoSet& types,
+                              size_t limit,
+                              std::vector<Entry>& entries) const
+  {
+    FileOffset cellOffset;
+
+    scanner.SetPos(tableOffset+((FileOffset)(y-cellYStart)*(cellXEnd-cellXStart+1)+x-cellXStart)*entryOffsetBytes);
+    scanner.ReadFileOffset(cellOffset,
+                           entryOffsetBytes);
+
+    if (cellOffset==0) {
+      return;
+    }
+
+    scanner.SetPos(cellOffset);
+
+    uint32_t entryCount;
+    Entry    entry;
+
+    scanner.ReadNumber(entryCount);
+
+    for (size_t e=0; e<entryCount; e++) {
+      uint32_t   typeIndex;
+      uint8_t    refType;
+      FileOffset offset;
+
+      scanner.Read(entry.name);
+      scanner.ReadNumber(typeIndex);
+      scanner.Read(refType);
+      scanner.ReadNumber(offset);
+      scanner.ReadCoord(entry.coord);
+
+      if (typeIndex>=typeConfig->GetTypeCount()) {
+        throw IOException(datafilename,"Cannot read POI","Illegal type index");
+      }
+
+      entry.type=typeConfig->GetTypeInfo(typeIndex);
+
+      if (!types.Empty() &&
+          !types.IsSet(entry.type)) {
+        continue;
+      }
+
+      if (!boundingBox.Includes(entry.coord) ||
+          !MatchesPattern(entry.name,
+                          pattern)) {
+        continue;
+      }
+
+      entry.distance=GetEllipsoidalDistance(center,
+                                            entry.coord);
+
+      if (entry.distance>maxDistance) {
+        continue;
+      }
+
+      entry.object.Set(offset,
+                       (RefType)refType);
+
+      if (limit==0) {
+        entries.push_back(entry);
+      }
+      else if (entries.size()<limit) {
+        entries.push_back(entry);
+        std::push_heap(entries.begin(),
+                       entries.end(),
+                       IsCloser);
+      }
+      else if (IsCloser(entry,
+                        entries.front())) {
+        std::pop_heap(entries.begin(),
+                      entries.end(),
+                      IsCloser);
+        entries.back()=entry;
+        std::push_heap(entries.begin(),
+                       entries.end(),
+                       IsCloser);
+      }
+    }
+  }
+
+  /**
+   * Add the matching POIs of the cells of the given bounding box to the result. Cells
+   * are visited in rings of growing size around the cell of the center. The visit
+   * stops, as soon as the next ring cannot contain any POI closer than the maximum
+   * distance or - if a limit is given - than the most distant POI of the result.
+   *
+   * Method is not thread-safe.
+   *
+   * @throws IOException
+   */
+  void POINameIndex::VisitCells(const GeoCoord& center,
+                                const GeoBox& boundingBox,
+                                double maxDistance,
+                                const std::string& pattern,
+                                const TypeInfoSet& types,
+                                size_t limit,
+                                std::vector<Entry>& entries) const
+  {
+    if (!boundingBox.IsValid()) {
+      return;
+    }
+
+    // Cells of the bounding box, clipped to the cells of the index
+    int64_t minX=std::max((int64_t)floor((boundingBox.GetMinLon()+180.0)/cellWidth),(int64_t)cellXStart);
+    int64_t maxX=std::min((int64_t)floor((boundingBox.GetMaxLon()+180.0)/cellWidth),(int64_t)cellXEnd);
+    int64_t minY=std::max((int64_t)floor((boundingBox.GetMinLat()+90.0)/cellHeight),(int64_t)cellYStart);
+    int64_t maxY=std::min((int64_t)floor((boundingBox.GetMaxLat()+90.0)/cellHeight),(int64_t)cellYEnd);
+
+    if (minX>maxX ||
+        minY>maxY) {
+      return;
+    }
+
+    int64_t centerX=(int64_t)floor((center.GetLon()+180.0)/cellWidth);
+    int64_t centerY=(int64_t)floor((center.GetLat()+90.0)/cellHeight);
+
+    int64_t firstRing=std::max(std::max(minX-centerX,centerX-maxX),
+                               std::max(minY-centerY,centerY-maxY));
+    int64_t lastRing=std::max(std::max(maxX-centerX,centerX-minX),
+                              std::max(maxY-centerY,centerY-minY));
+
+    firstRing=std::max(firstRing,(int64_t)0);
+
+    for (int64_t ring=firstRing; ring<=lastRing; ring++) {
+      // Every cell of this and all following rings is at least ring-1 complete cells
+      // away from the center. Going west or east, the distance wraps at the antimeridian,
+      // so the cells of the last ring may be closer than ring-1 cells.
+      if (ring>1) {
+        double lonDelta=std::max(std::min((ring-1)*cellWidth,
+                                          360.0-(lastRing+1)*cellWidth),
+                                 0.0);
+        double minDistance=GetMinDistance(center,
+                                          (ring-1)*cellHeight,
+                                          lonDelta);
+
+        if (minDistance>maxDistance ||
+            (limit>0 &&
+             entries.size()==limit &&
+             minDistance>entries.front().distance)) {
+          break;
+        }
+      }
+
+      for (int64_t y=std::max(centerY-ring,minY); y<=std::min(centerY+ring,maxY); y++) {
+        if (y==centerY-ring ||
+            y==centerY+ring) {
+          for (int64_t x=std::max(centerX-ring,minX); x<=std::min(centerX+ring,maxX); x++) {
+            ReadCell((uint32_t)x,(uint32_t)y,
+                     center,boundingBox,maxDistance,pattern,types,limit,
+                     entries);
+          }
+        }
+        else {
+          if (centerX-ring>=minX &&
+              centerX-ring<=maxX) {
+            ReadCell((uint32_t)(centerX-ring),(uint32_t)y,
+                     center,boundingBox,maxDistance,pattern,types,limit,
+                     entries);
+          }
+
+          if (ring>0 &&
+              centerX+ring>=minX &&
+              centerX+ring<=maxX) {
+            ReadCell((uint32_t)(centerX+ring),(uint32_t)y,
+                     center,boundingBox,maxDistance,pattern,types,limit,
+                     entries);
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * Return the matching POIs of all given bounding boxes, sorted by distance to the center.
+   *
+   * Method is thread-safe.
+   */
+  bool POINameIndex::GetClosestEntries(const GeoCoord& center,
+                                       const std::vector<GeoBox>& boundingBoxes,
+                                       double maxDistance,
+                                       const std::string& pattern,
+                                       const TypeInfoSet& types,
+                                       size_t limit,
+                                       std::vector<Entry>& entries) const
+  {
+    std::string lowerPattern=UTF8StringToLower(pattern);
+
+    entries.clear();
+
+    try {
+      std::lock_guard<std::mutex> guard(lookupMutex);
+
+      for (const auto& boundingBox : boundingBoxes) {
+        VisitCells(center,
+                   boundingBox,
+                   maxDistance,
+                   lowerPattern,
+                   types,
+                   limit,
+                   entries);
+      }
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      entries.clear();
+      return false;
+    }
+
+    std::sort(entries.begin(),
+              entries.end(),
+              IsCloser);
+
+    return true;
+  }
+
+  /**
+   * Return the POIs of the given types within the given bounding box and the given
+   * distance to the given center, whose name matches the given pattern. The result
+   * is sorted by distance to the center.
+   *
+   * Cells are visited in rings of growing size around the cell of the center. The
+   * search stops, as soon as the next ring cannot contain any POI closer than the
+   * maximum distance or - if a limit is given - than the most distant POI
+   * of the result.
+   *
+   * Method is thread-safe.
+   *
+   * @param center
+   *    Center of the search, the result is ranked by the distance to this coordinate
+   * @param boundingBox
+   *    Bounding box the POIs must be in
+   * @param maxDistance
+   *    Maximum distance in km of the POIs to the center
+   * @param pattern
+   *    The name of the POIs or one of the words of the name must start with this
+   *    pattern. Case of ASCII characters is ignored. An empty pattern matches all POIs,
+   *    including POIs without a name.
+   * @param types
+   *    The POIs must be of one of these types. An empty set matches all types.
+   * @param limit
+   *    Maximum number of POIs returned, 0 for no limit
+   * @param entries
+   *    Result of the query
+   * @return
+   *    False in case of an error, else true
+   */
+  bool POINameIndex::GetClosestEntries(const GeoCoord& center,
+                                       const GeoBox& boundingBox,
+                                       double maxDistance,
+                                       const std::string& pattern,
+                                       const TypeInfoSet& types,
+                                       size_t limit,
+                                       std::vector<Entry>& entries) const
+  {
+    return GetClosestEntries(center,
+                             std::vector<GeoBox>(1,boundingBox),
+                             maxDistance,
+                             pattern,
+                             types,
+                             limit,
+                             entries);
+  }
+
+  /**
+   * Return the POIs of the given types within the given distance to the given
+   * center, whose name matches the given pattern. The result is sorted by distance
+   * to the center.
+   *
+   * Only the cells within the bounding box of the circle around the center are
+   * read. If the circle crosses the antimeridian, the bounding box is split into
+   * a western and an eastern part.
+   *
+   * Method is thread-safe.
+   *
+   * @param center
+   *    Center of the search
+   * @param maxDistance
+   *    Maximum distance in km of the POIs to the center
+   * @param pattern
+   *    The name of the POIs or one of the words of the name must start with this
+   *    pattern, see GetClosestEntries() above
+   * @param types
+   *    The POIs must be of one of these types. An empty set matches all types.
+   * @param limit
+   *    Maximum number of POIs returned, 0 for no limit
+   * @param entries
+   *    Result of the query
+   * @return
+   *    False in case of an error, else true
+   */
+  bool POINameIndex::GetClosestEntries(const GeoCoord& center,
+                                       double maxDistance,
+                                       const std::string& pattern,
+                                       const TypeInfoSet& types,
+                                       size_t limit,
+                                       std::vector<Entry>& entries) const
+  {
+    // A degree of latitude is at least minKmPerDegreeLat long, a degree of longitude
+    // at least that length multiplied by the cosine of the latitude
+    double              latDelta=maxDistance/minKmPerDegreeLat;
+    double              minLat=std::max(center.GetLat()-latDelta,-90.0);
+    double              maxLat=std::min(center.GetLat()+latDelta,90.0);
+    double              cosLat=cos(std::max(fabs(minLat),fabs(maxLat))*M_PI/180.0);
+    std::vector<GeoBox> boundingBoxes;
+
+    if (cosLat<=0.0 ||
+        latDelta/cosLat>=180.0) {
+      boundingBoxes.push_back(GeoBox(GeoCoord(minLat,-180.0),
+                                     GeoCoord(maxLat,180.0)));
+    }
+    else {
+      double minLon=center.GetLon()-latDelta/cosLat;
+      double maxLon=center.GetLon()+latDelta/cosLat;
+
+      if (minLon<-180.0) {
+        boundingBoxes.push_back(GeoBox(GeoCoord(minLat,minLon+360.0),
+                                       GeoCoord(maxLat,180.0)));
+        minLon=-180.0;
+      }
+
+      if (maxLon>180.0) {
+        boundingBoxes.push_back(GeoBox(GeoCoord(minLat,-180.0),
+                                       GeoCoord(maxLat,maxLon-360.0)));
+        maxLon=180.0;
+      }
+
+      boundingBoxes.push_back(GeoBox(GeoCoord(minLat,minLon),
+                                     GeoCoord(maxLat,maxLon)));
+    }
+
+    return GetClosestEntries(center,
+                             boundingBoxes,
+                             maxDistance,
+                             pattern,
+                             types,
+                             limit,
+                             entries);
+  }
+}
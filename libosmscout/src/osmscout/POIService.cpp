@@ -20,6 +20,7 @@
 #include <osmscout/POIService.h>
 
 #include <algorithm>
+#include <limits>
 
 #include <osmscout/util/Logger.h>
 
@@ -258,4 +259,104 @@ namespace osmscout {
 
     return true;
   }
+
+  /**
+   * Return the POIs of the given types closest to the given coordinate, whose name
+   * or one of the words of the name starts with the given pattern. Only the cells
+   * of the POI name index near the center are read.
+   *
+   * @param center
+   *    Center of the search
+   * @param maxDistance
+   *    Maximum distance in km of the POIs to the center
+   * @param pattern
+   *    Prefix of the name or of one of the words of the name, case of ASCII characters
+   *    is ignored. An empty pattern matches all POIs.
+   * @param types
+   *    The resulting POIs must be of one of these types. An empty set matches all types.
+   * @param limit
+   *    Maximum number of POIs returned, 0 for no limit
+   * @param pois
+   *    Result of the query, sorted by distance to the center. In case of errors
+   *    the result is empty.
+   * @return
+   *    True, if success, else false
+   */
+  bool POIService::SearchPOIsByName(const GeoCoord& center,
+                                    double maxDistance,
+                                    const std::string& pattern,
+                                    const TypeInfoSet& types,
+                                    size_t limit,
+                                    std::vector<POINameIndex::Entry>& pois) const
+  {
+    POINameIndexRef poiNameIndex=database->GetPOINameIndex();
+
+    pois.clear();
+
+    if (!poiNameIndex) {
+      log.Error() << "POI name index is not available!";
+      return false;
+    }
+
+    if (!poiNameIndex->GetClosestEntries(center,
+                                         maxDistance,
+                                         pattern,
+                                         types,
+                                         limit,
+                                         pois)) {
+      log.Error() << "Error searching POIs in POI name index!";
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Return the POIs of the given types in the given bounding box, whose name or
+   * one of the words of the name starts with the given pattern. The POIs are ranked
+   * by the distance to the center of the bounding box.
+   *
+   * @param boundingBox
+   *    Bounding box, POIs must be in
+   * @param pattern
+   *    Prefix of the name or of one of the words of the name, case of ASCII characters
+   *    is ignored. An empty pattern matches all POIs.
+   * @param types
+   *    The resulting POIs must be of one of these types. An empty set matches all types.
+   * @param limit
+   *    Maximum number of POIs returned, 0 for no limit
+   * @param pois
+   *    Result of the query, sorted by distance to the center of the bounding box.
+   *    In case of errors the result is empty.
+   * @return
+   *    True, if success, else false
+   */
+  bool POIService::SearchPOIsByName(const GeoBox& boundingBox,
+                                    const std::string& pattern,
+                                    const TypeInfoSet& types,
+                                    size_t limit,
+                                    std::vector<POINameIndex::Entry>& pois) const
+  {
+    POINameIndexRef poiNameIndex=database->GetPOINameIndex();
+
+    pois.clear();
+
+    if (!poiNameIndex) {
+      log.Error() << "POI name index is not available!";
+      return false;
+    }
+
+    if (!poiNameIndex->GetClosestEntries(boundingBox.GetCenter(),
+                                         boundingBox,
+                                         std::numeric_limits<double>::max(),
+                                         pattern,
+                                         types,
+                                         limit,
+                                         pois)) {
+      log.Error() << "Error searching POIs in POI name index!";
+      return false;
+    }
+
+    return true;
+  }
 }
@@ -0,0 +1,453 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2016  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/PackedRTreeIndex.h>
+
+#include <algorithm>
+#include <queue>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/Logger.h>
+#include <osmscout/util/RadixSort.h>
+
+#include <osmscout/system/Math.h>
+
+namespace osmscout {
+
+  const char* PackedRTreeIndex::NODE_RTREE_IDX="rtreenode.idx";
+  const char* PackedRTreeIndex::WAY_RTREE_IDX="rtreeway.idx";
+  const char* PackedRTreeIndex::AREA_RTREE_IDX="rtreearea.idx";
+
+  static inline uint16_t DecodeUInt16(const unsigned char* buffer)
+  {
+    return (uint16_t)(buffer[0] | (buffer[1] << 8));
+  }
+
+  static inline uint32_t DecodeUInt32(const unsigned char* buffer)
+  {
+    return  ((uint32_t)buffer[0] <<  0)
+          | ((uint32_t)buffer[1] <<  8)
+          | ((uint32_t)buffer[2] << 16)
+          | ((uint32_t)buffer[3] << 24);
+  }
+
+  static inline uint64_t DecodeUInt64(const unsigned char* buffer)
+  {
+    return (uint64_t)DecodeUInt32(buffer) | ((uint64_t)DecodeUInt32(buffer+4) << 32);
+  }
+
+  static uint32_t EncodeFixedPoint(double value,
+                                   double factor,
+                                   bool roundUp)
+  {
+    double fixedValue=roundUp ? ceil(value*factor) : floor(value*factor);
+
+    if (fixedValue<0.0) {
+      return 0;
+    }
+
+    if (fixedValue>4294967295.0) {
+      return 4294967295u;
+    }
+
+    return (uint32_t)fixedValue;
+  }
+
+  /**
+   * Convert the given bounding box to the fixed point representation. The
+   * result is rounded outwards, so that it covers at least the given box.
+   */
+  PackedRTreeIndex::Box PackedRTreeIndex::Box::FromGeoBox(const GeoBox& boundingBox)
+  {
+    Box box;
+
+    box.minLat=EncodeFixedPoint(boundingBox.GetMinLat()+90.0,latConversionFactor,false);
+    box.minLon=EncodeFixedPoint(boundingBox.GetMinLon()+180.0,lonConversionFactor,false);
+    box.maxLat=EncodeFixedPoint(boundingBox.GetMaxLat()+90.0,latConversionFactor,true);
+    box.maxLon=EncodeFixedPoint(boundingBox.GetMaxLon()+180.0,lonConversionFactor,true);
+
+    return box;
+  }
+
+  PackedRTreeIndex::NearestVisitor::~NearestVisitor()
+  {
+    // no code
+  }
+
+  PackedRTreeIndex::PackedRTreeIndex()
+  : data(NULL),
+    nodeSize(0),
+    itemCount(0),
+    boxes(NULL),
+    fileOffsets(NULL),
+    typeIndexes(NULL)
+  {
+    // no code
+  }
+
+  PackedRTreeIndex::~PackedRTreeIndex()
+  {
+    Close();
+  }
+
+  void PackedRTreeIndex::Close()
+  {
+    data=NULL;
+    boxes=NULL;
+    fileOffsets=NULL;
+    typeIndexes=NULL;
+    itemCount=0;
+    levelEnds.clear();
+    content.clear();
+
+    try  {
+      if (scanner.IsOpen()) {
+        scanner.Close();
+      }
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      scanner.CloseFailsafe();
+    }
+  }
+
+  /**
+   * Open the index file with the given name in the given directory. The file
+   * is memory mapped if possible, else its content is loaded into memory.
+   */
+  bool PackedRTreeIndex::Open(const TypeConfigRef& typeConfig,
+                              const std::string& path,
+                              const std::string& filename)
+  {
+    this->typeConfig=typeConfig;
+
+    datafilename=AppendFileToDir(path,filename);
+
+    try {
+      scanner.Open(datafilename,FileScanner::FastRandom,true);
+
+      FileOffset size=scanner.GetSize();
+
+      if (size<headerSize) {
+        throw IOException(datafilename,"Cannot open file","File is too small");
+      }
+
+      const char* mappedData=scanner.GetMappedData();
+
+      if (mappedData!=NULL) {
+        data=(const unsigned char*)mappedData;
+      }
+      else {
+        content.resize((size_t)size);
+        scanner.Read(content.data(),
+                     content.size());
+        scanner.Close();
+
+        data=(const unsigned char*)content.data();
+      }
+
+      nodeSize=DecodeUInt32(data);
+
+      uint32_t levelCount=DecodeUInt32(data+4);
+
+      itemCount=DecodeUInt64(data+8);
+
+      if (nodeSize<2 ||
+          (itemCount>0 && levelCount==0) ||
+          size<headerSize+levelCount*(FileOffset)8) {
+        throw IOException(datafilename,"Cannot open file","Illegal header");
+      }
+
+      levelEnds.resize(levelCount);
+
+      for (size_t level=0; level<levelCount; level++) {
+        levelEnds[level]=DecodeUInt64(data+headerSize+level*8);
+      }
+
+      uint64_t boxCount=levelCount>0 ? levelEnds.back() : 0;
+
+      boxes=data+headerSize+levelCount*8;
+      fileOffsets=boxes+boxCount*boxSize;
+      typeIndexes=fileOffsets+itemCount*offsetSize;
+
+      if ((levelCount>0 && levelEnds.front()!=itemCount) ||
+          size!=headerSize+levelCount*(FileOffset)8+boxCount*boxSize+itemCount*(offsetSize+typeSize)) {
+        throw IOException(datafilename,"Cannot open file","File size does not match header");
+      }
+
+      return true;
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      Close();
+      return false;
+    }
+  }
+
+  PackedRTreeIndex::Box PackedRTreeIndex::GetBox(uint64_t index) const
+  {
+    const unsigned char* buffer=boxes+index*boxSize;
+    Box                  box;
+
+    box.minLat=DecodeUInt32(buffer);
+    box.minLon=DecodeUInt32(buffer+4);
+    box.maxLat=DecodeUInt32(buffer+8);
+    box.maxLon=DecodeUInt32(buffer+12);
+
+    return box;
+  }
+
+  GeoBox PackedRTreeIndex::GetGeoBox(uint64_t index) const
+  {
+    Box box=GetBox(index);
+
+    return GeoBox(GeoCoord(box.minLat/latConversionFactor-90.0,
+                           box.minLon/lonConversionFactor-180.0),
+                  GeoCoord(box.maxLat/latConversionFactor-90.0,
+                           box.maxLon/lonConversionFactor-180.0));
+  }
+
+  /**
+   * Return the file offsets of all objects of the given types, whose bounding box
+   * intersects the given bounding box. The offsets are appended sorted.
+   *
+   * If statistics is not NULL, the number of bytes of the index read by the query
+   * is added to it.
+   *
+   * The tree is traversed level by level, visiting the nodes of a level in
+   * file order.
+   *
+   * Method is thread-safe.
+   */
+  bool PackedRTreeIndex::GetOffsets(const GeoBox& boundingBox,
+                                    const TypeInfoSet& types,
+                                    std::vector<FileOffset>& offsets,
+                                    TypeInfoSet& loadedTypes,
+                                    QueryStatistics* statistics) const
+  {
+    if (!IsOpen()) {
+      return false;
+    }
+
+    loadedTypes=types;
+
+    if (itemCount==0 ||
+        types.Empty()) {
+      return true;
+    }
+
+    std::vector<bool> typeFilter(typeConfig->GetTypeCount(),false);
+
+    for (const auto& type : types) {
+      typeFilter[type->GetIndex()]=true;
+    }
+
+    Box                   box=Box::FromGeoBox(boundingBox);
+    size_t                topLevel=levelEnds.size()-1;
+    uint64_t              topLevelStart=topLevel>0 ? levelEnds[topLevel-1] : 0;
+    std::vector<uint64_t> current;
+    std::vector<uint64_t> next;
+    uint64_t              bytes=(levelEnds[topLevel]-topLevelStart)*boxSize;
+
+    for (uint64_t index=topLevelStart; index<levelEnds[topLevel]; index++) {
+      if (GetBox(index).Intersects(box)) {
+        current.push_back(index);
+      }
+    }
+
+    for (size_t level=topLevel; level>0; level--) {
+      uint64_t levelStart=level>1 ? levelEnds[level-2] : 0;
+      uint64_t parentStart=levelEnds[level-1];
+
+      next.clear();
+
+      for (const auto& index : current) {
+        uint64_t childStart=levelStart+(index-parentStart)*nodeSize;
+        uint64_t childEnd=std::min(childStart+nodeSize,
+                                   levelEnds[level-1]);
+
+        bytes+=(childEnd-childStart)*boxSize;
+
+        for (uint64_t child=childStart; child<childEnd; child++) {
+          if (GetBox(child).Intersects(box)) {
+            next.push_back(child);
+          }
+        }
+      }
+
+      current.swap(next);
+    }
+
+    std::vector<FileOffset> itemOffsets;
+
+    itemOffsets.reserve(current.size());
+
+    for (const auto& index : current) {
+      uint16_t typeIndex=DecodeUInt16(typeIndexes+index*typeSize);
+
+      if (typeIndex<typeFilter.size() &&
+          typeFilter[typeIndex]) {
+        itemOffsets.push_back(DecodeUInt64(fileOffsets+index*offsetSize));
+      }
+    }
+
+    if (statistics!=NULL) {
+      statistics->bytesRead+=bytes+current.size()*typeSize+itemOffsets.size()*offsetSize;
+    }
+
+    RadixSort(itemOffsets);
+
+    offsets.insert(offsets.end(),
+                   itemOffsets.begin(),
+                   itemOffsets.end());
+
+    return true;
+  }
+
+  /**
+   * Entry in the queue of a nearest neighbour search
+   */
+  struct NearestQueueEntry
+  {
+    double   distance;
+    uint64_t index;
+    size_t   level;
+
+    NearestQueueEntry(double distance,
+                      uint64_t index,
+                      size_t level)
+    : distance(distance),
+      index(index),
+      level(level)
+    {
+      // no code
+    }
+
+    inline bool operator<(const NearestQueueEntry& other) const
+    {
+      // std::priority_queue returns the largest entry first
+      return distance>other.distance;
+    }
+  };
+
+  /**
+   * Visit all objects of the given types with a bounding box not farther away than
+   * maxDistance from the reference coordinate of the given distance calculation
+   * in the order of increasing bounding box distance (best first search).
+   *
+   * If statistics is not NULL, the number of bytes of the index read by the query
+   * is added to it.
+   *
+   * Method is thread-safe.
+   */
+  bool PackedRTreeIndex::VisitNearest(const EquirectangularDistance& distance,
+                                      const TypeInfoSet& types,
+                                      double maxDistance,
+                                      NearestVisitor& visitor,
+                                      QueryStatistics* statistics) const
+  {
+    if (!IsOpen()) {
+      return false;
+    }
+
+    if (itemCount==0 ||
+        types.Empty()) {
+      return true;
+    }
+
+    std::vector<bool> typeFilter(typeConfig->GetTypeCount(),false);
+
+    for (const auto& type : types) {
+      typeFilter[type->GetIndex()]=true;
+    }
+
+    std::priority_queue<NearestQueueEntry> queue;
+    size_t                                 topLevel=levelEnds.size()-1;
+    uint64_t                               bytes=0;
+
+    for (uint64_t index=topLevel>0 ? levelEnds[topLevel-1] : 0;
+         index<levelEnds[topLevel];
+         index++) {
+      bytes+=boxSize;
+
+      double boxDistance=distance.GetDistance(GetGeoBox(index));
+
+      if (boxDistance<=maxDistance) {
+        queue.push(NearestQueueEntry(boxDistance,index,topLevel));
+      }
+    }
+
+    while (!queue.empty()) {
+      NearestQueueEntry entry=queue.top();
+
+      queue.pop();
+
+      if (entry.level==0) {
+        uint16_t typeIndex=DecodeUInt16(typeIndexes+entry.index*typeSize);
+
+        bytes+=typeSize;
+
+        if (typeIndex<typeFilter.size() &&
+            typeFilter[typeIndex]) {
+          bytes+=offsetSize;
+
+          if (!visitor.Visit(DecodeUInt64(fileOffsets+entry.index*offsetSize),
+                             entry.distance)) {
+            break;
+          }
+        }
+
+        continue;
+      }
+
+      uint64_t levelStart=entry.level>1 ? levelEnds[entry.level-2] : 0;
+      uint64_t childStart=levelStart+(entry.index-levelEnds[entry.level-1])*nodeSize;
+      uint64_t childEnd=std::min(childStart+nodeSize,
+                                 levelEnds[entry.level-1]);
+
+      for (uint64_t child=childStart; child<childEnd; child++) {
+        if (entry.level==1) {
+          uint16_t typeIndex=DecodeUInt16(typeIndexes+child*typeSize);
+
+          bytes+=typeSize;
+
+          // Skip objects of other types early
+          if (typeIndex>=typeFilter.size() ||
+              !typeFilter[typeIndex]) {
+            continue;
+          }
+        }
+
+        bytes+=boxSize;
+
+        double boxDistance=distance.GetDistance(GetGeoBox(child));
+
+        if (boxDistance<=maxDistance) {
+          queue.push(NearestQueueEntry(boxDistance,child,entry.level-1));
+        }
+      }
+    }
+
+    if (statistics!=NULL) {
+      statistics->bytesRead+=bytes;
+    }
+
+    return true;
+  }
+}
@@ -33,6 +33,8 @@
 
 namespace osmscout {
 
+  static const size_t CLOSEST_ROUTABLE_OBJECT_COUNT=10; //!< Initial number of objects requested by GetClosestRoutableNode()
+
   RouterParameter::RouterParameter()
   : debugPerformance(false)
   {
@@ -1636,37 +1638,15 @@ namespace osmscout {
   }
 
   /**
-   * Returns the closed routeable object (area or way) relative
-   * to the given coordinate.
-   *
-   * @note The actual object may not be within the given radius
-   * due to internal search index resolution.
-   *
-   * @param lat
-   *    Latitude value of the search center
-   * @param lon
-   *    Longitude value of the search center
-   * @param vehicle
-   *    Vehicle to use (may differ from the vehicle the router was initialized
-   *    but tin this case the route will not return a valid route based on this
-   *    object).
-   * @param radius
-   *    The maximum radius to search in from the search center in meter
-   * @param object
-   *    The resulting object if one was found
-   * @param nodeIndex
-   *    The index of the closed node to the search center.
-   * @return
+   * Load all routable areas and ways in the given bounding box using the area
+   * indexes.
    */
-  bool RoutingService::GetClosestRoutableNode(double lat,
-                                              double lon,
-                                              const osmscout::Vehicle& vehicle,
-                                              double radius,
-                                              osmscout::ObjectFileRef& object,
-                                              size_t& nodeIndex) const
+  bool RoutingService::GetRoutableObjectsInBox(const GeoBox& boundingBox,
+                                               const TypeInfoSet& wayRoutableTypes,
+                                               const TypeInfoSet& areaRoutableTypes,
+                                               std::vector<AreaRef>& areas,
+                                               std::vector<WayRef>& ways) const
   {
-    object.Invalidate();
-
     TypeConfigRef    typeConfig=database->GetTypeConfig();
     AreaAreaIndexRef areaAreaIndex=database->GetAreaAreaIndex();
     AreaWayIndexRef  areaWayIndex=database->GetAreaWayIndex();
@@ -1682,29 +1662,10 @@ namespace osmscout {
       return false;
     }
 
-    GeoBox      boundingBox=GeoBox::BoxByCenterAndRadius(GeoCoord(lat,lon),radius);
-    TypeInfoSet wayRoutableTypes;
-    TypeInfoSet areaRoutableTypes;
-    TypeInfoSet wayLoadedTypes;
-    TypeInfoSet areaLoadedTypes;
-
-    for (const auto& type : database->GetTypeConfig()->GetTypes()) {
-      if (!type->GetIgnore() &&
-          type->CanRoute(vehicle)) {
-        if (type->CanBeWay()) {
-          wayRoutableTypes.Set(type);
-        }
-
-        if (type->CanBeArea()) {
-          areaRoutableTypes.Set(type);
-        }
-      }
-    }
-
-    std::vector<FileOffset>        wayWayOffsets;
-    std::vector<DataBlockSpan>     wayAreaSpans;
-    std::vector<osmscout::AreaRef> areas;
-    std::vector<osmscout::WayRef>  ways;
+    TypeInfoSet                wayLoadedTypes;
+    TypeInfoSet                areaLoadedTypes;
+    std::vector<FileOffset>    wayWayOffsets;
+    std::vector<DataBlockSpan> wayAreaSpans;
 
     if (!areaWayIndex->GetOffsets(boundingBox,
                                   wayRoutableTypes,
@@ -1713,7 +1674,7 @@ namespace osmscout {
       log.Error() << "Error getting ways from area way index!";
     }
 
-    if (!areaAreaIndex->GetAreasInArea(*database->GetTypeConfig(),
+    if (!areaAreaIndex->GetAreasInArea(*typeConfig,
                                        boundingBox,
                                        std::numeric_limits<size_t>::max(),
                                        areaRoutableTypes,
@@ -1737,19 +1698,40 @@ namespace osmscout {
       return false;
     }
 
-    double minDistance=std::numeric_limits<double>::max();
+    return true;
+  }
+
+  /**
+   * Return the routable node of the given areas and ways closest to the reference
+   * coordinate of the given distance calculation and its distance in km.
+   * object is invalid and the distance is std::numeric_limits<double>::max(),
+   * if no object has a routable node.
+   */
+  double RoutingService::GetClosestRoutableNode(const EquirectangularDistance& distance,
+                                                const std::vector<AreaRef>& areas,
+                                                const std::vector<WayRef>& ways,
+                                                ObjectFileRef& object,
+                                                size_t& nodeIndex) const
+  {
+    std::vector<GeoCoord> nodes;
+    std::vector<Id>       ids;
+    double                minDistance=std::numeric_limits<double>::max();
+
+    object.Invalidate();
 
     for (const auto& area : areas) {
-      if (!HasNodeWithId(area->rings[0].ids)) {
+      area->rings[0].DecodeGeometry(nodes,
+                                    ids);
+
+      if (!HasNodeWithId(ids)) {
         continue;
       }
 
-      for (size_t i=0; i<area->rings[0].nodes.size(); i++) {
-        double distance=sqrt((area->rings[0].nodes[i].GetLat()-lat)*(area->rings[0].nodes[i].GetLat()-lat)+
-                             (area->rings[0].nodes[i].GetLon()-lon)*(area->rings[0].nodes[i].GetLon()-lon));
+      for (size_t i=0; i<nodes.size(); i++) {
+        double nodeDistance=distance.GetDistance(nodes[i]);
 
-        if (distance<minDistance) {
-          minDistance=distance;
+        if (nodeDistance<minDistance) {
+          minDistance=nodeDistance;
 
           object.Set(area->GetFileOffset(),osmscout::refArea);
           nodeIndex=i;
@@ -1758,15 +1740,18 @@ namespace osmscout {
     }
 
     for (const auto& way : ways) {
-      if (!HasNodeWithId(way->ids)) {
+      way->DecodeGeometry(nodes,
+                          ids);
+
+      if (!HasNodeWithId(ids)) {
         continue;
       }
 
-      for (size_t i=0;  i<way->nodes.size(); i++) {
-        double distance=sqrt((way->nodes[i].GetLat()-lat)*(way->nodes[i].GetLat()-lat)+
-                             (way->nodes[i].GetLon()-lon)*(way->nodes[i].GetLon()-lon));
-        if (distance<minDistance) {
-          minDistance=distance;
+      for (size_t i=0; i<nodes.size(); i++) {
+        double nodeDistance=distance.GetDistance(nodes[i]);
+
+        if (nodeDistance<minDistance) {
+          minDistance=nodeDistance;
 
           object.Set(way->GetFileOffset(),osmscout::refWay);
           nodeIndex=i;
@@ -1774,6 +1759,150 @@ namespace osmscout {
       }
     }
 
+    return minDistance;
+  }
+
+  /**
+   * Returns the closed routeable object (area or way) relative
+   * to the given coordinate.
+   *
+   * If the database has R-tree indexes for ways and areas, the routable objects
+   * closest to the coordinate are fetched using the nearest neighbour search of
+   * the database, the number of objects requested is increased until the closest
+   * node is known for sure. Else all routable objects in the bounding box of the
+   * search radius are loaded at once.
+   *
+   * @note The geometry of the object is within the given radius, the closest
+   * node of the object may not be.
+   *
+   * @param lat
+   *    Latitude value of the search center
+   * @param lon
+   *    Longitude value of the search center
+   * @param vehicle
+   *    Vehicle to use (may differ from the vehicle the router was initialized
+   *    but tin this case the route will not return a valid route based on this
+   *    object).
+   * @param radius
+   *    The maximum radius to search in from the search center in meter
+   * @param object
+   *    The resulting object if one was found
+   * @param nodeIndex
+   *    The index of the closed node to the search center.
+   * @return
+   */
+  bool RoutingService::GetClosestRoutableNode(double lat,
+                                              double lon,
+                                              const osmscout::Vehicle& vehicle,
+                                              double radius,
+                                              osmscout::ObjectFileRef& object,
+                                              size_t& nodeIndex) const
+  {
+    object.Invalidate();
+
+    TypeConfigRef typeConfig=database->GetTypeConfig();
+
+    if (!typeConfig) {
+      log.Error() << "At least one index file is invalid!";
+      return false;
+    }
+
+    GeoCoord                coord(lat,lon);
+    EquirectangularDistance distance(coord);
+    TypeInfoSet             wayRoutableTypes;
+    TypeInfoSet             areaRoutableTypes;
+
+    for (const auto& type : typeConfig->GetTypes()) {
+      if (!type->GetIgnore() &&
+          type->CanRoute(vehicle)) {
+        if (type->CanBeWay()) {
+          wayRoutableTypes.Set(type);
+        }
+
+        if (type->CanBeArea()) {
+          areaRoutableTypes.Set(type);
+        }
+      }
+    }
+
+    std::vector<AreaRef> areas;
+    std::vector<WayRef>  ways;
+
+    // Without R-tree indexes each nearest neighbour query would load the objects of
+    // a growing box again, so we load all candidates at once
+    if (!database->GetWayRTreeIndex() ||
+        !database->GetAreaRTreeIndex()) {
+      if (!GetRoutableObjectsInBox(GeoBox::BoxByCenterAndRadius(coord,radius),
+                                   wayRoutableTypes,
+                                   areaRoutableTypes,
+                                   areas,
+                                   ways)) {
+        return false;
+      }
+
+      GetClosestRoutableNode(distance,
+                             areas,
+                             ways,
+                             object,
+                             nodeIndex);
+
+      return true;
+    }
+
+    // The distance of an object is a lower bound for the distance of its nodes,
+    // so we are done as soon as the most distant returned object of both kinds is
+    // not closer than the closest node found or less objects than requested are returned.
+    std::vector<ClosestArea> closestAreas;
+    std::vector<ClosestWay>  closestWays;
+    size_t                   count=CLOSEST_ROUTABLE_OBJECT_COUNT;
+    double                   minDistance;
+
+    while (true) {
+      if (!database->GetClosestAreas(coord,
+                                     areaRoutableTypes,
+                                     count,
+                                     radius/1000.0,
+                                     closestAreas)) {
+        log.Error() << "Error reading areas in area!";
+        return false;
+      }
+
+      if (!database->GetClosestWays(coord,
+                                    wayRoutableTypes,
+                                    count,
+                                    radius/1000.0,
+                                    closestWays)) {
+        log.Error() << "Error reading ways in area!";
+        return false;
+      }
+
+      areas.clear();
+      ways.clear();
+
+      for (const auto& area : closestAreas) {
+        areas.push_back(area.object);
+      }
+
+      for (const auto& way : closestWays) {
+        ways.push_back(way.object);
+      }
+
+      minDistance=GetClosestRoutableNode(distance,
+                                         areas,
+                                         ways,
+                                         object,
+                                         nodeIndex);
+
+      if ((closestAreas.size()<count ||
+           closestAreas.back().distance>=minDistance) &&
+          (closestWays.size()<count ||
+           closestWays.back().distance>=minDistance)) {
+        break;
+      }
+
+      count*=4;
+    }
+
     return true;
   }
 }
@@ -1,5 +1,8 @@
 #include <osmscout/TextSearchIndex.h>
 
+#include <algorithm>
+#include <unordered_set>
+
 #include <osmscout/util/File.h>
 #include <osmscout/util/String.h>
 #include <osmscout/util/Logger.h>
@@ -18,13 +21,7 @@ namespace osmscout
 
   TextSearchIndex::~TextSearchIndex()
   {
-    for(size_t i=0; i < tries.size(); i++) {
-      tries[i].isAvail=false;
-      if(tries[i].trie){
-        delete tries[i].trie;
-        tries[i].trie = 0;
-      }
-    }
+    // no code
   }
 
   bool TextSearchIndex::Load(const std::string& path)
@@ -34,34 +31,30 @@ namespace osmscout
       fixedPath.push_back('/');
     }
 
-    TrieInfo trie;
-    trie.file=AppendFileToDir(fixedPath,TEXT_POI_DAT);
-    tries.push_back(trie);
-
-    trie.file=AppendFileToDir(fixedPath,TEXT_LOC_DAT);
-    tries.push_back(trie);
+    tries.clear();
+    tries.resize(4);
 
-    trie.file=AppendFileToDir(fixedPath,TEXT_REGION_DAT);
-    tries.push_back(trie);
-
-    trie.file=AppendFileToDir(fixedPath,TEXT_OTHER_DAT);
-    tries.push_back(trie);
+    tries[0].file=AppendFileToDir(fixedPath,TEXT_POI_DAT);
+    tries[1].file=AppendFileToDir(fixedPath,TEXT_LOC_DAT);
+    tries[2].file=AppendFileToDir(fixedPath,TEXT_REGION_DAT);
+    tries[3].file=AppendFileToDir(fixedPath,TEXT_OTHER_DAT);
 
     uint8_t triesAvail=0;
     for(size_t i=0; i < tries.size(); i++) {
-      // open/load the data file
+      // open/map the data file, the trie is used
+      // in place and shared by all searches
       try {
         triesAvail++;
         tries[i].isAvail=true;
-        tries[i].trie = new marisa::Trie;
-        tries[i].trie->load(tries[i].file.c_str());
+        tries[i].trie.reset(new marisa::Trie);
+        tries[i].trie->mmap(tries[i].file.c_str());
       }
       catch(const marisa::Exception &ex) {
         // We don't return false on a failed load attempt
         // since its possible that the user does not want
         // to include a specific trie (ie. textother)
         log.Error() << "Warn, could not open " << tries[i].file << ":"  << ex.what();
-        delete tries[i].trie;
+        tries[i].trie.reset();
         tries[i].isAvail=false;
         triesAvail--;
       }
@@ -102,10 +95,263 @@ namespace osmscout
       }
     }
 
+    // Load the characters used by the texts of each trie,
+    // they are the candidates for the children of a trie
+    // node in fuzzy searches. The key is optional, older
+    // data files do not have it.
+    for(size_t i=0; i < tries.size(); i++) {
+      if(tries[i].isAvail) {
+        // 0x05: ENQ
+        std::string charactersQuery;
+        charactersQuery.push_back(5);
+
+        marisa::Agent agent;
+        agent.set_query(charactersQuery.c_str(),
+                        charactersQuery.length());
+
+        if(tries[i].trie->predictive_search(agent)) {
+          SplitUTF8String(std::string(agent.key().ptr()+1,
+                                      agent.key().length()-1),
+                          tries[i].characters);
+        }
+      }
+    }
+
     return true;
   }
 
+  /**
+   * Depth first walk over a trie simulating a Levenshtein automaton
+   * (including transpositions of neighbouring characters) for the query.
+   *
+   * The walk returns all trie prefixes within the maximum edit distance
+   * of the query. A node is only visited, if the edit distance can still
+   * become smaller than the best distance found on the path to the node,
+   * so each text is matched by the prefix with the smallest distance.
+   *
+   * marisa does not offer access to the children of a trie node, so
+   * children are found by probing the trie with each candidate character.
+   * A successful probe returns the first key below the probed prefix, so
+   * the child on the path to this key is known without another probe.
+   */
+  class FuzzyTrieWalker
+  {
+  private:
+    const marisa::Trie&      trie;
+    std::vector<std::string> characters;      //!< All candidate characters, the characters of the trie and the query
+    std::vector<size_t>      query;           //!< The characters of the query as indexes into characters
+    std::vector<size_t>      editCharacters;  //!< Candidate characters, if an edit is still possible
+    std::vector<size_t>      exactCharacters; //!< Candidate characters, if only exact matches are possible
+    marisa::Agent            agent;
+    std::string              prefix;
 
+  public:
+    std::vector<std::vector<std::string> > matches; //!< Matching prefixes by their distance
+
+  private:
+    void Walk(const std::vector<size_t>& previousRow,
+              const std::vector<size_t>& row,
+              size_t lastCharacter,
+              size_t bestDistance,
+              const std::string& firstKey);
+
+  public:
+    FuzzyTrieWalker(const marisa::Trie& trie,
+                    const std::vector<std::string>& trieCharacters,
+                    const std::vector<std::string>& queryCharacters,
+                    size_t maxDistance);
+
+    void Walk();
+  };
+
+  FuzzyTrieWalker::FuzzyTrieWalker(const marisa::Trie& trie,
+                                   const std::vector<std::string>& trieCharacters,
+                                   const std::vector<std::string>& queryCharacters,
+                                   size_t maxDistance)
+  : trie(trie),
+    matches(maxDistance+1)
+  {
+    // Without the characters of the trie only the characters
+    // of the query are used for substitutions and insertions
+    characters=trieCharacters;
+    characters.insert(characters.end(),
+                      queryCharacters.begin(),
+                      queryCharacters.end());
+
+    std::sort(characters.begin(),
+              characters.end());
+    characters.erase(std::unique(characters.begin(),
+                                 characters.end()),
+                     characters.end());
+
+    // Characters are compared by their index, which is much cheaper than comparing strings
+    for (const auto& character : queryCharacters) {
+      query.push_back(std::lower_bound(characters.begin(),
+                                       characters.end(),
+                                       character)-characters.begin());
+    }
+
+    for (size_t i=0; i<characters.size(); i++) {
+      editCharacters.push_back(i);
+    }
+
+    exactCharacters=query;
+
+    std::sort(exactCharacters.begin(),
+              exactCharacters.end());
+    exactCharacters.erase(std::unique(exactCharacters.begin(),
+                                      exactCharacters.end()),
+                          exactCharacters.end());
+  }
+
+  void FuzzyTrieWalker::Walk()
+  {
+    std::vector<size_t> row(query.size()+1);
+
+    for (size_t j=0; j<row.size(); j++) {
+      row[j]=j;
+    }
+
+    prefix.clear();
+
+    agent.set_query(prefix.c_str(),
+                    prefix.length());
+
+    if (!trie.predictive_search(agent)) {
+      return;
+    }
+
+    // There is no character before the first one
+    Walk(row,
+         row,
+         characters.size(),
+         matches.size(),
+         std::string(agent.key().ptr(),
+                     agent.key().length()));
+  }
+
+  void FuzzyTrieWalker::Walk(const std::vector<size_t>& previousRow,
+                             const std::vector<size_t>& row,
+                             size_t lastCharacter,
+                             size_t bestDistance,
+                             const std::string& firstKey)
+  {
+    size_t queryLength=query.size();
+
+    if (row[queryLength]<bestDistance) {
+      bestDistance=row[queryLength];
+      matches[bestDistance].push_back(prefix);
+    }
+
+    // The minimum of a row never decreases along a path
+    size_t minDistance=*std::min_element(row.begin(),
+                                         row.end());
+
+    if (minDistance>=bestDistance) {
+      return;
+    }
+
+    const std::vector<size_t>& candidates=minDistance+1<bestDistance ? editCharacters : exactCharacters;
+    std::vector<size_t>        nextRow(queryLength+1);
+    size_t                     prefixLength=prefix.length();
+
+    for (size_t character : candidates) {
+      nextRow[0]=row[0]+1;
+
+      size_t nextMinDistance=nextRow[0];
+
+      for (size_t j=1; j<=queryLength; j++) {
+        size_t cost=query[j-1]==character ? 0 : 1;
+
+        nextRow[j]=std::min(std::min(row[j]+1,
+                                     nextRow[j-1]+1),
+                            row[j-1]+cost);
+
+        if (j>1 &&
+            character==query[j-2] &&
+            lastCharacter==query[j-1]) {
+          nextRow[j]=std::min(nextRow[j],
+                              previousRow[j-2]+1);
+        }
+
+        nextMinDistance=std::min(nextMinDistance,
+                                 nextRow[j]);
+      }
+
+      if (nextMinDistance>=bestDistance) {
+        continue;
+      }
+
+      prefix.append(characters[character]);
+
+      // The first key below the prefix is also the first key below its first child
+      if (firstKey.compare(0,
+                           prefix.length(),
+                           prefix)==0) {
+        Walk(row,
+             nextRow,
+             character,
+             bestDistance,
+             firstKey);
+      }
+      else {
+        agent.set_query(prefix.c_str(),
+                        prefix.length());
+
+        if (trie.predictive_search(agent)) {
+          Walk(row,
+               nextRow,
+               character,
+               bestDistance,
+               std::string(agent.key().ptr(),
+                           agent.key().length()));
+        }
+      }
+
+      prefix.resize(prefixLength);
+    }
+  }
+
+
+  void TextSearchIndex::ResultBuffer::Clear()
+  {
+    texts.clear();
+    entries.clear();
+  }
+
+  void TextSearchIndex::ResultBuffer::Append(const char* text,
+                                             size_t textLength,
+                                             const ObjectFileRef& object)
+  {
+    Entry entry;
+
+    // Results with the same text are mostly returned one after the other
+    if(!entries.empty() &&
+       entries.back().textLength==textLength &&
+       texts.compare(entries.back().textOffset,
+                     textLength,
+                     text,
+                     textLength)==0) {
+      entry.textOffset=entries.back().textOffset;
+    }
+    else {
+      entry.textOffset=texts.length();
+      texts.append(text,
+                   textLength);
+    }
+
+    entry.textLength=textLength;
+    entry.object=object;
+
+    entries.push_back(entry);
+  }
+
+  /**
+   * Return all objects with a text starting with the query, grouped by
+   * their text.
+   *
+   * Method is thread-safe.
+   */
   bool TextSearchIndex::Search(const std::string& query,
                                bool searchPOIs,
                                bool searchLocations,
@@ -113,8 +359,50 @@ namespace osmscout
                                bool searchOther,
                                ResultsMap& results) const
   {
+    ResultBuffer buffer;
+
     results.clear();
 
+    if(!Search(query,
+               searchPOIs,
+               searchLocations,
+               searchRegions,
+               searchOther,
+               buffer)) {
+      return false;
+    }
+
+    ResultsMap::iterator entry=results.end();
+
+    for(size_t i=0; i < buffer.GetSize(); i++) {
+      if(i==0 ||
+         !buffer.HasSameText(i-1,i)) {
+        // Returns the existing entry, if the text has already been added
+        entry=results.insert(std::make_pair(buffer.GetText(i),
+                                            std::vector<ObjectFileRef>())).first;
+      }
+
+      entry->second.push_back(buffer.GetObject(i));
+    }
+
+    return true;
+  }
+
+  /**
+   * Return all objects with a text starting with the query in the
+   * given result buffer. The buffer is cleared first.
+   *
+   * Method is thread-safe.
+   */
+  bool TextSearchIndex::Search(const std::string& query,
+                               bool searchPOIs,
+                               bool searchLocations,
+                               bool searchRegions,
+                               bool searchOther,
+                               ResultBuffer& results) const
+  {
+    results.Clear();
+
     if(query.empty()) {
       return true;
     }
@@ -126,34 +414,22 @@ namespace osmscout
     searchGroups.push_back(searchRegions);
     searchGroups.push_back(searchOther);
 
+    marisa::Agent agent;
+
     for(size_t i=0; i < tries.size(); i++) {
       if(searchGroups[i] && tries[i].isAvail) {
-        marisa::Agent agent;
-
         try {
           agent.set_query(query.c_str(),
                           query.length());
           while(tries[i].trie->predictive_search(agent)) {
-            std::string result(agent.key().ptr(),
-                               agent.key().length());
-            std::string text;
             ObjectFileRef ref;
+            size_t        textLength=decodeSearchResult(agent.key().ptr(),
+                                                        agent.key().length(),
+                                                        ref);
 
-            splitSearchResult(result,text,ref);
-
-            ResultsMap::iterator it=results.find(text);
-            if(it==results.end()) {
-              // If the text has not been added to the
-              // search results yet, insert a new entry
-              std::pair<std::string,std::vector<ObjectFileRef> > entry;
-              entry.first = text;
-              entry.second.push_back(ref);
-              results.insert(entry);
-            }
-            else {
-              // Else add the offset to the existing entry
-              it->second.push_back(ref);
-            }
+            results.Append(agent.key().ptr(),
+                           textLength,
+                           ref);
           }
         }
         catch(const marisa::Exception &ex) {
@@ -166,9 +442,238 @@ namespace osmscout
     return true;
   }
 
-  void TextSearchIndex::splitSearchResult(const std::string& result,
-                                          std::string& text,
-                                          ObjectFileRef& ref) const
+  /**
+   * Search for texts starting with the query, tolerating up to maxDistance
+   * typos (inserted, deleted, substituted or swapped characters). Searches are
+   * case-sensitive.
+   *
+   * Results are ranked by the edit distance, then by the importance of the
+   * index (regions before locations before POIs before other objects) and then
+   * by the length of the text, so complete matches come before longer
+   * completions. At most limit results are returned.
+   *
+   * Complete matches of a rank are always visited, while the enumeration of longer
+   * completions stops as soon as limit texts have been found. In this case the
+   * completions of the last rank are the shortest of the enumerated ones, but not
+   * necessarily the shortest of the index. Lower ranked matches are not visited.
+   *
+   * Method is thread-safe.
+   *
+   * @param query
+   *    The prefix to search for
+   * @param searchPOIs
+   *    Search in the POI index
+   * @param searchLocations
+   *    Search in the location index
+   * @param searchRegions
+   *    Search in the region index
+   * @param searchOther
+   *    Search in the index of other objects
+   * @param maxDistance
+   *    Maximum edit distance, reduced to the number of characters of the query
+   *    minus one
+   * @param limit
+   *    Maximum number of results
+   * @param results
+   *    The results, in the order of their rank
+   * @return
+   *    True, if there was no error
+   */
+  bool TextSearchIndex::SearchRanked(const std::string& query,
+                                     bool searchPOIs,
+                                     bool searchLocations,
+                                     bool searchRegions,
+                                     bool searchOther,
+                                     size_t maxDistance,
+                                     size_t limit,
+                                     std::vector<RankedResult>& results) const
+  {
+    results.clear();
+
+    if(query.empty() ||
+       limit==0) {
+      return true;
+    }
+
+    std::vector<std::string> queryCharacters;
+
+    SplitUTF8String(query,
+                    queryCharacters);
+
+    // Else the empty prefix matches and all texts are returned
+    maxDistance=std::min(maxDistance,
+                         queryCharacters.size()-1);
+
+    std::vector<bool> searchGroups;
+
+    searchGroups.push_back(searchPOIs);
+    searchGroups.push_back(searchLocations);
+    searchGroups.push_back(searchRegions);
+    searchGroups.push_back(searchOther);
+
+    // Indexes of the tries in the order of their importance
+    static const size_t trieOrder[]={2,1,0,3};
+
+    try {
+      std::unordered_map<std::string,size_t>   resultIndexes;
+      std::vector<std::unordered_set<size_t> > visitedKeys(tries.size());
+      marisa::Agent                            agent;
+
+      // Add the objects of all keys found by the agent in trie i. New texts are
+      // only added while there are less than limit results, if limited is set.
+      auto addKeys=[&](size_t i,
+                       size_t distance,
+                       bool limited) {
+        while(tries[i].trie->predictive_search(agent)) {
+          // Texts below a prefix with a smaller distance were already added
+          if(!visitedKeys[i].insert(agent.key().id()).second) {
+            continue;
+          }
+
+          ObjectFileRef ref;
+          size_t        textLength=decodeSearchResult(agent.key().ptr(),
+                                                      agent.key().length(),
+                                                      ref);
+          std::string   text(agent.key().ptr(),
+                             textLength);
+
+          auto entry=resultIndexes.find(text);
+
+          if(entry!=resultIndexes.end()) {
+            results[entry->second].objects.push_back(ref);
+            continue;
+          }
+
+          RankedResult rankedResult;
+
+          rankedResult.text=text;
+          rankedResult.distance=distance;
+          rankedResult.objects.push_back(ref);
+
+          resultIndexes.insert(std::make_pair(text,results.size()));
+          results.push_back(rankedResult);
+
+          if(limited &&
+             results.size()>=limit) {
+            return;
+          }
+        }
+      };
+
+      // Add the objects of all keys of trie i with exactly the given text. The text
+      // of a key is followed by the type of the object, see decodeSearchResult().
+      auto addTextKeys=[&](size_t i,
+                           size_t distance,
+                           const std::string& text) {
+        static const RefType refTypes[]={refNode,refArea,refWay};
+
+        for(RefType refType : refTypes) {
+          std::string key(text);
+
+          key.push_back(static_cast<char>(refType));
+
+          agent.set_query(key.c_str(),
+                          key.length());
+
+          addKeys(i,
+                  distance,
+                  false);
+        }
+      };
+
+      for(size_t distance=0; distance <= maxDistance; distance++) {
+        for(size_t i : trieOrder) {
+          if(!searchGroups[i] ||
+             !tries[i].isAvail) {
+            continue;
+          }
+
+          // The trie is walked again for each distance instead of once for the maximum
+          // distance, since walks with a smaller distance visit far less nodes and most
+          // limited searches are complete before the maximum distance is reached
+          FuzzyTrieWalker walker(*tries[i].trie,
+                                 tries[i].characters,
+                                 queryCharacters,
+                                 distance);
+
+          walker.Walk();
+
+          const std::vector<std::string>& prefixes=walker.matches[distance];
+
+          if(prefixes.empty()) {
+            continue;
+          }
+
+          size_t firstResult=results.size();
+
+          // Complete matches of the prefixes are always added
+          for(const auto& prefix : prefixes) {
+            addTextKeys(i,
+                        distance,
+                        prefix);
+          }
+
+          // Longer completions are enumerated until limit texts have been found
+          for(const auto& prefix : prefixes) {
+            if(results.size() >= limit) {
+              break;
+            }
+
+            agent.set_query(prefix.c_str(),
+                            prefix.length());
+
+            addKeys(i,
+                    distance,
+                    true);
+          }
+
+          if(results.size() >= limit) {
+            // Enumeration may have stopped before all objects of the found texts were visited
+            for(size_t r=firstResult; r < results.size(); r++) {
+              addTextKeys(i,
+                          distance,
+                          results[r].text);
+            }
+          }
+
+          std::sort(results.begin()+firstResult,
+                    results.end(),
+                    [](const RankedResult& a,
+                       const RankedResult& b) {
+            if(a.text.length()!=b.text.length()) {
+              return a.text.length()<b.text.length();
+            }
+
+            return a.text<b.text;
+          });
+
+          for(size_t r=firstResult; r < results.size(); r++) {
+            resultIndexes[results[r].text]=r;
+          }
+
+          if(results.size() >= limit) {
+            results.resize(limit);
+
+            return true;
+          }
+        }
+      }
+    }
+    catch(const marisa::Exception &ex) {
+      log.Error() << "Error searching for text: " << ex.what();
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Decode the object reference of a trie key and return the
+   * length of the text at the start of the key.
+   */
+  size_t TextSearchIndex::decodeSearchResult(const char* result,
+                                             size_t resultLength,
+                                             ObjectFileRef& ref) const
   {
     // Get the index that marks the end of the
     // the text and where the FileOffset begins
@@ -179,7 +684,7 @@ namespace osmscout
 
     FileOffset offset=0;
     FileOffset add=0;
-    size_t idx=result.size()-1;
+    size_t idx=resultLength-1;
     for(size_t i=0; i < offsetSizeBytes; i++) {
       add = (unsigned char)(result[idx]);
       offset |= (add << (i*8));
@@ -192,6 +697,7 @@ namespace osmscout
     RefType reftype=static_cast<RefType>((unsigned char)(result[idx]));
 
     ref.Set(offset,reftype);
-    text=result.substr(0,idx);
+
+    return idx;
   }
 }
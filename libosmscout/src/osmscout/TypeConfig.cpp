@@ -20,6 +20,7 @@
 #include <osmscout/TypeConfig.h>
 
 #include <algorithm>
+#include <cstring>
 
 #include <osmscout/TypeFeatures.h>
 
@@ -189,6 +190,21 @@ namespace osmscout {
 
   void FeatureValueBuffer::SetType(const TypeInfoRef& type)
   {
+    // Keep the already allocated buffer if the type does not change, only drop the values
+    if (this->type &&
+        this->type==type &&
+        featureValueBuffer!=NULL) {
+      for (size_t i=0; i<type->GetFeatureCount(); i++) {
+        if (HasFeature(i)) {
+          FreeValue(i);
+        }
+      }
+
+      memset(featureBits,0,type->GetFeatureMaskBytes());
+
+      return;
+    }
+
     if (this->type) {
       DeleteData();
     }
@@ -207,23 +223,43 @@ namespace osmscout {
         }
       }
 
-      ::operator delete((void*)featureValueBuffer);
-      featureValueBuffer=NULL;
-    }
+      // Memory allocated from an arena is freed together with the arena
+      if (arena) {
+        arena.reset();
+      }
+      else {
+        ::operator delete((void*)featureValueBuffer);
+      }
 
-    if (featureBits!=NULL) {
-      delete [] featureBits;
+      featureValueBuffer=NULL;
       featureBits=NULL;
     }
 
     type=NULL;
   }
 
+  /**
+   * Allocates one block of memory holding the feature values followed by the feature bit mask.
+   * If a MemoryArena is active for the current thread, the block is allocated from the arena.
+   */
   void FeatureValueBuffer::AllocateData()
   {
     if (type && type->HasFeatures()) {
-      featureBits=new uint8_t[type->GetFeatureMaskBytes()]();
-      featureValueBuffer=static_cast<char*>(::operator new(type->GetFeatureValueBufferSize()));
+      size_t       valueBufferSize=type->GetFeatureValueBufferSize();
+      size_t       size=valueBufferSize+type->GetFeatureMaskBytes();
+      MemoryArena* currentArena=MemoryArena::GetCurrentArena();
+
+      if (currentArena!=NULL) {
+        arena=currentArena->shared_from_this();
+        featureValueBuffer=static_cast<char*>(arena->Allocate(size));
+      }
+      else {
+        featureValueBuffer=static_cast<char*>(::operator new(size));
+      }
+
+      featureBits=reinterpret_cast<uint8_t*>(featureValueBuffer+valueBufferSize);
+
+      memset(featureBits,0,type->GetFeatureMaskBytes());
     }
     else
     {
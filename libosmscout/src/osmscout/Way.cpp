@@ -21,6 +21,7 @@
 
 #include <limits>
 
+#include <osmscout/util/Number.h>
 #include <osmscout/util/String.h>
 
 #include <osmscout/system/Assert.h>
@@ -30,6 +31,18 @@ namespace osmscout {
 
   bool Way::GetCenter(GeoCoord& center) const
   {
+    if (HasEncodedGeometry() ||
+        HasCompactNodes()) {
+      GeoBox boundingBox;
+
+      GetBoundingBox(boundingBox);
+
+      center.Set(boundingBox.GetMinLat()+(boundingBox.GetMaxLat()-boundingBox.GetMinLat())/2,
+                 boundingBox.GetMinLon()+(boundingBox.GetMaxLon()-boundingBox.GetMinLon())/2);
+
+      return true;
+    }
+
     if (nodes.empty()) {
       return false;
     }
@@ -58,10 +71,61 @@ namespace osmscout {
     // attributes.SetLayer(std::numeric_limits<int8_t>::max());
   }
 
+  /**
+   * Move the coordinates from nodes to the compact, fixed point representation
+   * in compactNodes, halving the memory required for the coordinates.
+   *
+   * Code that directly accesses nodes must either check HasCompactNodes() or
+   * call ExpandNodes() before. Compacted ways cannot be written.
+   */
+  void Way::CompactNodes()
+  {
+    DecodeGeometry();
+
+    if (nodes.empty()) {
+      return;
+    }
+
+    compactNodes.Set(nodes);
+
+    nodes.clear();
+    nodes.shrink_to_fit();
+  }
+
+  /**
+   * Restore the coordinates in nodes from compactNodes.
+   */
+  void Way::ExpandNodes()
+  {
+    if (!HasCompactNodes()) {
+      return;
+    }
+
+    compactNodes.Get(nodes);
+    compactNodes.Clear();
+  }
+
+  /**
+   * Return the coordinates of the node with the given index.
+   *
+   * The geometry of a way read by ReadLazy() must be decoded using DecodeGeometry()
+   * before, since decoding it for each call would make iterating the nodes quadratic.
+   */
   void Way::GetCoordinates(size_t nodeIndex,
                            double& lat,
                            double& lon) const
   {
+    assert(!HasEncodedGeometry());
+
+    if (HasCompactNodes()) {
+      GeoCoord coord=compactNodes.Get(nodeIndex);
+
+      lat=coord.GetLat();
+      lon=coord.GetLon();
+
+      return;
+    }
+
     assert(nodeIndex<nodes.size());
 
     lat=nodes[nodeIndex].GetLat();
@@ -82,6 +146,57 @@ namespace osmscout {
     return false;
   }
 
+  /**
+   * Decode the nodes and ids of a way read by ReadLazy(). Does nothing,
+   * if the geometry is already decoded.
+   */
+  void Way::DecodeGeometry()
+  {
+    if (!HasEncodedGeometry()) {
+      return;
+    }
+
+    DecodeGeometry(nodes,
+                   ids);
+
+    encodedGeometry.clear();
+    encodedGeometry.shrink_to_fit();
+  }
+
+  /**
+   * Decode the nodes and ids of a way read by ReadLazy() into the given
+   * buffers, without changing the way itself. This allows to access the
+   * geometry of a way shared between multiple threads.
+   */
+  void Way::DecodeGeometry(std::vector<GeoCoord>& nodes,
+                           std::vector<Id>& ids) const
+  {
+    if (!HasEncodedGeometry()) {
+      nodes=this->nodes;
+      ids=this->ids;
+
+      return;
+    }
+
+    size_t bytes=DecodeCoords(encodedGeometry.data(),
+                              nodes);
+
+    if (HasIds()) {
+      DecodeIds(encodedGeometry.data()+bytes,
+                nodes.size(),
+                ids);
+    }
+    else {
+      ids.clear();
+    }
+  }
+
+  bool Way::HasIds() const
+  {
+    return featureValueBuffer.GetType()->CanRoute() ||
+           featureValueBuffer.GetType()->GetOptimizeLowZoom();
+  }
+
   void Way::ReadIds(FileScanner& scanner)
   {
     ids.resize(nodes.size());
@@ -137,14 +252,51 @@ namespace osmscout {
 
     featureValueBuffer.Read(scanner);
 
+    scanner.ReadBox(boundingBox);
+
     scanner.Read(nodes);
 
-    if (type->CanRoute() ||
-        type->GetOptimizeLowZoom()) {
+    if (HasIds()) {
       ReadIds(scanner);
     }
   }
 
+  /**
+   * Read the data from the given FileScanner, but only copy the still encoded
+   * nodes and ids instead of decoding them. Type, features and bounding box
+   * are available directly, the geometry must be decoded using DecodeGeometry()
+   * before accessing nodes or ids.
+   *
+   * @throws IOException
+   */
+  void Way::ReadLazy(const TypeConfig& typeConfig,
+                     FileScanner& scanner)
+  {
+    TypeId typeId;
+
+    fileOffset=scanner.GetPos();
+
+    scanner.ReadTypeId(typeId,
+                       typeConfig.GetWayTypeIdBytes());
+
+    featureValueBuffer.SetType(typeConfig.GetWayTypeInfo(typeId));
+
+    featureValueBuffer.Read(scanner);
+
+    scanner.ReadBox(boundingBox);
+
+    nodes.clear();
+    ids.clear();
+    encodedGeometry.clear();
+
+    scanner.ReadCoordsEncoded(encodedGeometry);
+
+    if (HasIds()) {
+      scanner.ReadIdsEncoded(GetEncodedCoordCount(encodedGeometry.data()),
+                             encodedGeometry);
+    }
+  }
+
   /**
    * Read the data from the given FileScanner. Node Ids are not read.
    *
@@ -225,15 +377,21 @@ namespace osmscout {
   {
     assert(!nodes.empty());
 
+    GeoBox boundingBox;
+
+    osmscout::GetBoundingBox(nodes,
+                             boundingBox);
+
     writer.WriteTypeId(featureValueBuffer.GetType()->GetWayId(),
                        typeConfig.GetWayTypeIdBytes());
 
     featureValueBuffer.Write(writer);
 
+    writer.WriteBox(boundingBox);
+
     writer.Write(nodes);
 
-    if (featureValueBuffer.GetType()->CanRoute() ||
-        featureValueBuffer.GetType()->GetOptimizeLowZoom()) {
+    if (HasIds()) {
       WriteIds(writer);
     }
   }
@@ -29,5 +29,25 @@ namespace osmscout {
   {
     // no code
   }
+
+  /**
+   * Read the way lazily (see Way::ReadLazy()), if lazyGeometry is true.
+   *
+   * @throws IOException
+   */
+  void WayDataFile::ReadObject(const TypeConfig& typeConfig,
+                               FileScanner& scanner,
+                               bool lazyGeometry,
+                               Way& data) const
+  {
+    if (lazyGeometry) {
+      data.ReadLazy(typeConfig,
+                    scanner);
+    }
+    else {
+      data.Read(typeConfig,
+                scanner);
+    }
+  }
 }
 
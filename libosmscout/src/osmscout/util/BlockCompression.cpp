@@ -0,0 +1,377 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2016 Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/util/BlockCompression.h>
+
+#include <osmscout/private/Config.h>
+
+#include <string.h>
+
+#include <algorithm>
+
+#if defined(HAVE_LIB_ZLIB)
+#include <zlib.h>
+#endif
+
+#include <osmscout/util/Exception.h>
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/Logger.h>
+
+namespace osmscout {
+
+  /**
+   * Magic at the start of block compressed files. It is chosen so that
+   * it cannot be confused with the start of any other data file.
+   */
+  static const char   blockCompressionMagic[8]={'O','S','M','S','C','B','L','K'};
+
+  /**
+   * Size of the header: magic, block size, uncompressed size and offset of the block table
+   */
+  static const size_t blockCompressionHeaderSize=8+4+8+8;
+
+  static uint64_t DecodeUInt64(const unsigned char* buffer)
+  {
+    uint64_t number=0;
+
+    for (size_t i=0; i<8; i++) {
+      number|=static_cast<uint64_t>(buffer[i]) << (i*8);
+    }
+
+    return number;
+  }
+
+  static void ReadFully(const std::string& filename,
+                        std::FILE* file,
+                        FileOffset offset,
+                        void* buffer,
+                        size_t bytes)
+  {
+#if defined(HAVE_FSEEKO)
+    if (fseeko(file,(off_t)offset,SEEK_SET)!=0) {
+      throw IOException(filename,"Cannot set position in file");
+    }
+#else
+    if (fseek(file,(long)offset,SEEK_SET)!=0) {
+      throw IOException(filename,"Cannot set position in file");
+    }
+#endif
+
+    if (fread(buffer,1,bytes,file)!=bytes) {
+      throw IOException(filename,"Cannot read compressed data");
+    }
+  }
+
+  BlockCompressedFileReader::BlockCompressedFileReader(size_t cacheSize)
+  : file(NULL),
+    blockSize(0),
+    size(0),
+    blockCache(std::max(cacheSize,(size_t)1)),
+    currentIndex(0)
+  {
+    // no code
+  }
+
+  /**
+   * Read the header and the block table of the given file.
+   *
+   * @throws IOException
+   */
+  void BlockCompressedFileReader::Open(const std::string& filename,
+                                       std::FILE* file)
+  {
+    unsigned char header[blockCompressionHeaderSize];
+
+    this->filename=filename;
+    this->file=file;
+
+#if !defined(HAVE_LIB_ZLIB)
+    throw IOException(filename,"Cannot open file","Block compressed files are not supported");
+#endif
+
+    ReadFully(filename,
+              file,
+              0,
+              header,
+              blockCompressionHeaderSize);
+
+    if (memcmp(header,blockCompressionMagic,sizeof(blockCompressionMagic))!=0) {
+      throw IOException(filename,"Cannot open file","File is not block compressed");
+    }
+
+    blockSize=  (header[8] <<  0)
+              | (header[9] <<  8)
+              | (header[10] << 16)
+              | (header[11] << 24);
+
+    size=DecodeUInt64(&header[12]);
+
+    FileOffset tableOffset=DecodeUInt64(&header[20]);
+
+    if (blockSize==0) {
+      throw IOException(filename,"Cannot open file","Illegal block size");
+    }
+
+    size_t                     blockCount=(size+blockSize-1)/blockSize;
+    std::vector<unsigned char> table((blockCount+1)*8);
+
+    ReadFully(filename,
+              file,
+              tableOffset,
+              table.data(),
+              table.size());
+
+    blockOffsets.resize(blockCount+1);
+
+    for (size_t i=0; i<=blockCount; i++) {
+      blockOffsets[i]=DecodeUInt64(&table[i*8]);
+    }
+
+    blockCache.Flush();
+    currentIndex=blockOffsets.size();
+  }
+
+  /**
+   * Make the block with the given index the current block, decompressing it
+   * if it is not in the cache.
+   *
+   * @throws IOException
+   */
+  void BlockCompressedFileReader::LoadBlock(size_t index)
+  {
+    if (blockCache.GetEntry(index,
+                            currentBlock)) {
+      currentIndex=index;
+      return;
+    }
+
+#if defined(HAVE_LIB_ZLIB)
+    size_t compressedSize=blockOffsets[index+1]-blockOffsets[index];
+    uLongf uncompressedSize=(uLongf)std::min((FileOffset)blockSize,
+                                             size-index*(FileOffset)blockSize);
+
+    readBuffer.resize(compressedSize);
+
+    ReadFully(filename,
+              file,
+              blockOffsets[index],
+              readBuffer.data(),
+              compressedSize);
+
+    std::vector<char> block(uncompressedSize);
+
+    if (uncompress((Bytef*)block.data(),
+                   &uncompressedSize,
+                   (const Bytef*)readBuffer.data(),
+                   (uLong)compressedSize)!=Z_OK ||
+        uncompressedSize!=block.size()) {
+      throw IOException(filename,"Cannot decompress block");
+    }
+
+    // Inserting may evict the current block
+    currentBlock=blockCache.SetEntry(BlockCache::CacheEntry(index));
+    currentBlock->value.swap(block);
+
+    currentIndex=index;
+#else
+    throw IOException(filename,"Cannot decompress block","Block compressed files are not supported");
+#endif
+  }
+
+  /**
+   * Copy up to the given number of bytes starting at the given position of the uncompressed
+   * data into the buffer. Returns the number of bytes copied, which is only smaller
+   * than requested if the end of the data is reached.
+   *
+   * @throws IOException
+   */
+  size_t BlockCompressedFileReader::Read(FileOffset pos,
+                                         char* buffer,
+                                         size_t bytes)
+  {
+    size_t read=0;
+
+    while (read<bytes &&
+           pos<size) {
+      size_t index=(size_t)(pos/blockSize);
+
+      if (index!=currentIndex) {
+        LoadBlock(index);
+      }
+
+      const std::vector<char>& block=currentBlock->value;
+      size_t                   blockPos=(size_t)(pos-index*(FileOffset)blockSize);
+      size_t                   count=std::min(bytes-read,
+                                              block.size()-blockPos);
+
+      memcpy(buffer+read,
+             block.data()+blockPos,
+             count);
+
+      read+=count;
+      pos+=count;
+    }
+
+    return read;
+  }
+
+  /**
+   * Return true, if the given file starts with the block compression magic. The file
+   * position is reset to the start of the file.
+   */
+  bool BlockCompressedFileReader::IsBlockCompressed(std::FILE* file)
+  {
+    char magic[sizeof(blockCompressionMagic)];
+    bool result=fread(magic,1,sizeof(magic),file)==sizeof(magic) &&
+                memcmp(magic,blockCompressionMagic,sizeof(magic))==0;
+
+    rewind(file);
+
+    return result;
+  }
+
+  /**
+   * Return true, if the file with the given name is block compressed.
+   */
+  bool IsBlockCompressedFile(const std::string& filename)
+  {
+    std::FILE* file=fopen(filename.c_str(),"rb");
+
+    if (file==NULL) {
+      return false;
+    }
+
+    bool result=BlockCompressedFileReader::IsBlockCompressed(file);
+
+    fclose(file);
+
+    return result;
+  }
+
+  /**
+   * Return true, if reading and writing of block compressed files is supported.
+   */
+  bool HasBlockCompressionSupport()
+  {
+#if defined(HAVE_LIB_ZLIB)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  /**
+   * Write a block compressed copy of the given source file to the target file. The
+   * source file is split into blocks of the given size which are compressed individually.
+   * The last block may be shorter. The block size must not be 0. The copy can be read
+   * by FileScanner like the original file.
+   */
+  bool CompressFile(const std::string& sourceFilename,
+                    const std::string& targetFilename,
+                    uint32_t blockSize)
+  {
+#if defined(HAVE_LIB_ZLIB)
+    FileScanner scanner;
+    FileWriter  writer;
+
+    if (blockSize==0) {
+      log.Error() << "Cannot compress file '" << sourceFilename << "', block size must not be 0";
+      return false;
+    }
+
+    try {
+      scanner.Open(sourceFilename,
+                   FileScanner::Sequential,
+                   false);
+
+      FileOffset size=GetFileSize(sourceFilename);
+
+      if (IsBlockCompressedFile(sourceFilename)) {
+        throw IOException(sourceFilename,"Cannot compress file","File is already block compressed");
+      }
+
+      writer.Open(targetFilename);
+
+      writer.Write(blockCompressionMagic,
+                   sizeof(blockCompressionMagic));
+      writer.Write(blockSize);
+      writer.Write((uint64_t)size);
+
+      FileOffset tableOffsetOffset=writer.GetPos();
+
+      writer.Write((uint64_t)0);
+
+      std::vector<FileOffset> blockOffsets;
+      std::vector<char>       block(blockSize);
+      std::vector<char>       compressed(compressBound(blockSize));
+      FileOffset              pos=0;
+
+      while (pos<size) {
+        size_t blockBytes=(size_t)std::min((FileOffset)blockSize,size-pos);
+        uLongf compressedSize=(uLongf)compressed.size();
+
+        scanner.Read(block.data(),
+                     blockBytes);
+
+        if (compress2((Bytef*)compressed.data(),
+                      &compressedSize,
+                      (const Bytef*)block.data(),
+                      (uLong)blockBytes,
+                      Z_DEFAULT_COMPRESSION)!=Z_OK) {
+          throw IOException(targetFilename,"Cannot compress block");
+        }
+
+        blockOffsets.push_back(writer.GetPos());
+
+        writer.Write(compressed.data(),
+                     compressedSize);
+
+        pos+=blockBytes;
+      }
+
+      FileOffset tableOffset=writer.GetPos();
+
+      blockOffsets.push_back(tableOffset);
+
+      for (const auto& offset : blockOffsets) {
+        writer.Write((uint64_t)offset);
+      }
+
+      writer.SetPos(tableOffsetOffset);
+      writer.Write((uint64_t)tableOffset);
+
+      scanner.Close();
+      writer.Close();
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      scanner.CloseFailsafe();
+      writer.CloseFailsafe();
+      return false;
+    }
+
+    return true;
+#else
+    log.Error() << "Cannot compress file '" << sourceFilename << "' to '" << targetFilename << "', block compression is not supported";
+    return false;
+#endif
+  }
+}
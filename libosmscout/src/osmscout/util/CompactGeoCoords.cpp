@@ -0,0 +1,132 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2016  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/util/CompactGeoCoords.h>
+
+#include <algorithm>
+
+#include <osmscout/system/Assert.h>
+#include <osmscout/system/Math.h>
+
+#ifdef OSMSCOUT_HAVE_SSE2
+#include <osmscout/system/SSEMath.h>
+#endif
+
+namespace osmscout {
+
+#ifdef OSMSCOUT_HAVE_SSE2
+  static const ALIGN16_BEG double sseCoordConversionOffset[] ALIGN16_END = {90.0, 180.0};
+#endif
+
+  void ConvertFixedPointCoords(const uint32_t* values,
+                               size_t count,
+                               GeoCoord* coords)
+  {
+#ifdef OSMSCOUT_HAVE_SSE2
+    const v2df factor=_mm_set_pd(lonConversionFactor,latConversionFactor);
+    const v2df offset=ARRAY2V2DF(sseCoordConversionOffset);
+
+    for (size_t i=0; i<count; i++) {
+      ALIGN16_BEG double result[2] ALIGN16_END;
+
+      // Values are 27 bit, so the signed conversion is exact
+      v2df value=_mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(values+i*2)));
+
+      _mm_store_pd(result,_mm_sub_pd(_mm_div_pd(value,factor),offset));
+
+      coords[i].Set(result[0],
+                    result[1]);
+    }
+#else
+    for (size_t i=0; i<count; i++) {
+      coords[i].Set(values[i*2]/latConversionFactor-90.0,
+                    values[i*2+1]/lonConversionFactor-180.0);
+    }
+#endif
+  }
+
+  CompactGeoCoords::CompactGeoCoords()
+  {
+    // no code
+  }
+
+  void CompactGeoCoords::Set(const std::vector<GeoCoord>& coords)
+  {
+    values.clear();
+    values.reserve(coords.size()*2);
+
+    for (const auto& coord : coords) {
+      values.push_back((uint32_t)round((coord.GetLat()+90.0)*latConversionFactor));
+      values.push_back((uint32_t)round((coord.GetLon()+180.0)*lonConversionFactor));
+    }
+  }
+
+  void CompactGeoCoords::Get(std::vector<GeoCoord>& coords) const
+  {
+    coords.resize(GetSize());
+
+    ConvertFixedPointCoords(values.data(),
+                            coords.size(),
+                            coords.data());
+  }
+
+  GeoCoord CompactGeoCoords::Get(size_t index) const
+  {
+    assert(index<GetSize());
+
+    return GeoCoord(GetLat(index),
+                    GetLon(index));
+  }
+
+  /**
+   * Calculates the bounding box. Since the conversion to GeoCoord is monotone,
+   * minimum and maximum are calculated on the fixed point values and only
+   * the result is converted.
+   */
+  void CompactGeoCoords::GetBoundingBox(GeoBox& boundingBox) const
+  {
+    if (values.empty()) {
+      boundingBox.Invalidate();
+      return;
+    }
+
+    uint32_t minLat=values[0];
+    uint32_t minLon=values[1];
+    uint32_t maxLat=minLat;
+    uint32_t maxLon=minLon;
+
+    for (size_t i=2; i<values.size(); i+=2) {
+      minLat=std::min(minLat,values[i]);
+      maxLat=std::max(maxLat,values[i]);
+      minLon=std::min(minLon,values[i+1]);
+      maxLon=std::max(maxLon,values[i+1]);
+    }
+
+    boundingBox.Set(GeoCoord(minLat/latConversionFactor-90.0,
+                             minLon/lonConversionFactor-180.0),
+                    GeoCoord(maxLat/latConversionFactor-90.0,
+                             maxLon/lonConversionFactor-180.0));
+  }
+
+  void CompactGeoCoords::Clear()
+  {
+    values.clear();
+    values.shrink_to_fit();
+  }
+}
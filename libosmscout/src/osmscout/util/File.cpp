@@ -78,6 +78,19 @@ namespace osmscout {
 #endif
   }
 
+  bool ExistsInFilesystem(const std::string& filename)
+  {
+    FILE *file=fopen(filename.c_str(),"rb");
+
+    if (file==NULL) {
+      return false;
+    }
+
+    fclose(file);
+
+    return true;
+  }
+
   bool RemoveFile(const std::string& filename)
   {
     return remove(filename.c_str())==0;
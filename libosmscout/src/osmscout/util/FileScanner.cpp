@@ -25,6 +25,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
 #include <limits>
 
 #if defined(HAVE_MMAP)
@@ -46,12 +47,244 @@
 
 #include <osmscout/system/Assert.h>
 
+#ifdef OSMSCOUT_HAVE_SSE2
+#include <osmscout/system/SSEMath.h>
+#endif
+
+#include <osmscout/util/BlockCompression.h>
+#include <osmscout/util/CompactGeoCoords.h>
 #include <osmscout/util/Exception.h>
 #include <osmscout/util/Logger.h>
 #include <osmscout/util/Number.h>
 
 namespace osmscout {
 
+#ifdef OSMSCOUT_HAVE_SSE2
+  /**
+   * Adds the running (lat,lon) value to the two (lat,lon) delta pairs in deltas
+   * (prefix sum) and stores the resulting absolute values. Returns the new running
+   * value in both halves of the register.
+   */
+  static inline __m128i AccumulateCoordDeltas(__m128i deltas,
+                                              __m128i current,
+                                              uint32_t* values)
+  {
+    // (lat0,lon0,lat1,lon1) => (lat0,lon0,lat0+lat1,lon0+lon1)
+    deltas=_mm_add_epi32(deltas,_mm_slli_si128(deltas,8));
+    deltas=_mm_add_epi32(deltas,current);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(values),deltas);
+
+    return _mm_shuffle_epi32(deltas,_MM_SHUFFLE(3,2,3,2));
+  }
+#endif
+
+  /**
+   * Decodes count coordinates encoded as 2 x 8 bit signed deltas into
+   * absolute (lat,lon) fixed point values.
+   */
+  static void DecodeCoordDeltas16(const uint8_t* bytes,
+                                  size_t count,
+                                  uint32_t latValue,
+                                  uint32_t lonValue,
+                                  uint32_t* values)
+  {
+    size_t i=0;
+
+#ifdef OSMSCOUT_HAVE_SSE2
+    __m128i current=_mm_set_epi32(lonValue,latValue,lonValue,latValue);
+
+    for (; i+2<=count; i+=2) {
+      int32_t packed;
+
+      memcpy(&packed,bytes+i*2,sizeof(packed));
+
+      // Sign extend 4x 8 bit to 4x 32 bit
+      __m128i deltas=_mm_cvtsi32_si128(packed);
+
+      deltas=_mm_unpacklo_epi8(deltas,deltas);
+      deltas=_mm_unpacklo_epi16(deltas,deltas);
+      deltas=_mm_srai_epi32(deltas,24);
+
+      current=AccumulateCoordDeltas(deltas,current,values+i*2);
+    }
+
+    latValue=(uint32_t)_mm_cvtsi128_si32(current);
+    lonValue=(uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(current,4));
+#endif
+
+    for (; i<count; i++) {
+      latValue+=(int32_t)(int8_t)bytes[i*2];
+      lonValue+=(int32_t)(int8_t)bytes[i*2+1];
+
+      values[i*2]=latValue;
+      values[i*2+1]=lonValue;
+    }
+  }
+
+  /**
+   * Decodes count coordinates encoded as 2 x 16 bit signed deltas into
+   * absolute (lat,lon) fixed point values.
+   */
+  static void DecodeCoordDeltas32(const uint8_t* bytes,
+                                  size_t count,
+                                  uint32_t latValue,
+                                  uint32_t lonValue,
+                                  uint32_t* values)
+  {
+    size_t i=0;
+
+#ifdef OSMSCOUT_HAVE_SSE2
+    __m128i current=_mm_set_epi32(lonValue,latValue,lonValue,latValue);
+
+    for (; i+2<=count; i+=2) {
+      // Sign extend 4x 16 bit (little endian) to 4x 32 bit
+      __m128i deltas=_mm_loadl_epi64(reinterpret_cast<const __m128i*>(bytes+i*4));
+
+      deltas=_mm_unpacklo_epi16(deltas,deltas);
+      deltas=_mm_srai_epi32(deltas,16);
+
+      current=AccumulateCoordDeltas(deltas,current,values+i*2);
+    }
+
+    latValue=(uint32_t)_mm_cvtsi128_si32(current);
+    lonValue=(uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(current,4));
+#endif
+
+    for (; i<count; i++) {
+      const uint8_t* delta=bytes+i*4;
+
+      latValue+=(int32_t)(int16_t)(delta[0] | (delta[1]<<8));
+      lonValue+=(int32_t)(int16_t)(delta[2] | (delta[3]<<8));
+
+      values[i*2]=latValue;
+      values[i*2+1]=lonValue;
+    }
+  }
+
+  /**
+   * Decodes count coordinates encoded as 2 x 24 bit signed deltas into
+   * absolute (lat,lon) fixed point values.
+   */
+  static void DecodeCoordDeltas48(const uint8_t* bytes,
+                                  size_t count,
+                                  uint32_t latValue,
+                                  uint32_t lonValue,
+                                  uint32_t* values)
+  {
+    for (size_t i=0; i<count; i++) {
+      const uint8_t* delta=bytes+i*6;
+      uint32_t       latUDelta=delta[0] | (delta[1]<<8) | (delta[2]<<16);
+      uint32_t       lonUDelta=delta[3] | (delta[4]<<8) | (delta[5]<<16);
+
+      if (latUDelta & 0x800000) {
+        latUDelta|=0xff000000;
+      }
+
+      if (lonUDelta & 0x800000) {
+        lonUDelta|=0xff000000;
+      }
+
+      latValue+=latUDelta;
+      lonValue+=lonUDelta;
+
+      values[i*2]=latValue;
+      values[i*2+1]=lonValue;
+    }
+  }
+
+  /**
+   * Decodes the variable length header of a non-empty encoded coordinate array
+   * (see FileScanner::ReadCoordsEncoded()). Returns the size of the header in bytes.
+   */
+  size_t DecodeCoordsHeader(const uint8_t* header,
+                            size_t& nodeCount,
+                            size_t& coordBitSize)
+  {
+    size_t headerSize=1;
+
+    if ((header[0] & 0x03) == 0) {
+      coordBitSize=16;
+    }
+    else if ((header[0] & 0x03) == 1) {
+      coordBitSize=32;
+    }
+    else {
+      coordBitSize=48;
+    }
+
+    nodeCount=(header[0] & 0x7c) >> 2;
+
+    if ((header[0] & 0x80) != 0) {
+      nodeCount|=(header[1] & 0x7f) << 5;
+      headerSize++;
+
+      if ((header[1] & 0x80) != 0) {
+        nodeCount|=header[2] << 12;
+        headerSize++;
+      }
+    }
+
+    return headerSize;
+  }
+
+  /**
+   * Decodes nodeCount coordinates from data, which holds the first coordinate
+   * followed by the deltas of the following coordinates. First pass:
+   * Calculate the absolute fixed point values of all following coordinates,
+   * second pass: convert them to GeoCoords in bulk.
+   */
+  static void DecodeCoordsData(const uint8_t* data,
+                               size_t nodeCount,
+                               size_t coordBitSize,
+                               std::vector<GeoCoord>& nodes,
+                               std::vector<uint32_t>& coordBuffer)
+  {
+    nodes.resize(nodeCount);
+
+    nodes[0].DecodeFromBuffer(data);
+
+    uint32_t latValue=  (data[0] <<  0)
+                      | (data[1] <<  8)
+                      | (data[2] << 16)
+                      | ((data[6] & 0x0f) << 24);
+
+    uint32_t lonValue=  (data[3] <<  0)
+                      | (data[4] <<  8)
+                      | (data[5] << 16)
+                      | ((data[6] & 0xf0) << 20);
+
+    const uint8_t* deltas=data+coordByteSize;
+
+    coordBuffer.resize((nodeCount-1)*2);
+
+    if (coordBitSize==16) {
+      DecodeCoordDeltas16(deltas,
+                          nodeCount-1,
+                          latValue,
+                          lonValue,
+                          coordBuffer.data());
+    }
+    else if (coordBitSize==32) {
+      DecodeCoordDeltas32(deltas,
+                          nodeCount-1,
+                          latValue,
+                          lonValue,
+                          coordBuffer.data());
+    }
+    else {
+      DecodeCoordDeltas48(deltas,
+                          nodeCount-1,
+                          latValue,
+                          lonValue,
+                          coordBuffer.data());
+    }
+
+    ConvertFixedPointCoords(coordBuffer.data(),
+                            nodeCount-1,
+                            nodes.data()+1);
+  }
+
   FileScanner::FileScanner()
    : file(NULL),
      hasError(true),
@@ -59,7 +292,11 @@ namespace osmscout {
      size(0),
      offset(0),
      byteBuffer(NULL),
-     byteBufferSize(0)
+     byteBufferSize(0),
+     compressedFile(NULL),
+     rangeStart(0),
+     bytesRead(0),
+     readStart(0)
 #if defined(__WIN32__) || defined(WIN32)
      ,mmfHandle((HANDLE)0)
 #endif
@@ -92,6 +329,12 @@ namespace osmscout {
 
   void FileScanner::FreeBuffer()
   {
+    delete compressedFile;
+    compressedFile=NULL;
+
+    rangeData.clear();
+    rangeData.shrink_to_fit();
+
 #if defined(HAVE_MMAP)
     if (buffer!=NULL) {
       if (munmap(buffer,size)!=0) {
@@ -122,6 +365,8 @@ namespace osmscout {
 
     hasError=true;
     this->filename=filename;
+    bytesRead=0;
+    readStart=0;
 
     file=fopen(filename.c_str(),"rb");
 
@@ -170,6 +415,18 @@ namespace osmscout {
     }
 #endif
 
+    if (BlockCompressedFileReader::IsBlockCompressed(file)) {
+      compressedFile=new BlockCompressedFileReader();
+
+      compressedFile->Open(filename,
+                           file);
+
+      // Positions refer to the uncompressed data, mapping the compressed file does not make sense
+      this->size=compressedFile->GetSize();
+      offset=0;
+      useMmap=false;
+    }
+
 #if defined(HAVE_POSIX_FADVISE)
     if (mode==FastRandom) {
       if (posix_fadvise(fileno(file),0,size,POSIX_FADV_WILLNEED)<0) {
@@ -310,6 +567,11 @@ namespace osmscout {
     }
 #endif
 
+    if (compressedFile!=NULL ||
+        !rangeData.empty()) {
+      return offset>=size;
+    }
+
     return feof(file)!=0;
   }
 
@@ -346,12 +608,37 @@ namespace osmscout {
         throw IOException(filename,"Cannot set position in file","Position beyond file end");
       }
 
+      // Reads only move forward, so the bytes read since the last position are known
+      bytesRead+=offset-readStart;
+      readStart=pos;
       offset=pos;
 
       return;
     }
 #endif
 
+    if (compressedFile!=NULL) {
+      if (pos>size) {
+        hasError=true;
+        throw IOException(filename,"Cannot set position in file","Position beyond file end");
+      }
+
+      offset=pos;
+
+      return;
+    }
+
+    if (!rangeData.empty()) {
+      if (pos>=rangeStart &&
+          pos<rangeStart+rangeData.size()) {
+        offset=pos;
+
+        return;
+      }
+
+      rangeData.clear();
+    }
+
     clearerr(file);
 
 #if defined(HAVE_FSEEKO)
@@ -365,6 +652,23 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Returns the number of bytes read since the file was opened. For memory mapped
+   * files these are the bytes read from the memory, else the bytes read from the
+   * file (or the uncompressed data of a block compressed file). Reading the same
+   * data again counts again.
+   */
+  FileOffset FileScanner::GetBytesRead() const
+  {
+#if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
+    if (buffer!=NULL) {
+      return bytesRead+offset-readStart;
+    }
+#endif
+
+    return bytesRead;
+  }
+
   /**
    * Returns the current position of the reading cursor in relation to the begining of the file
    *
@@ -382,6 +686,11 @@ namespace osmscout {
     }
 #endif
 
+    if (compressedFile!=NULL ||
+        !rangeData.empty()) {
+      return offset;
+    }
+
 #if defined(HAVE_FSEEKO)
     off_t filepos=ftello(file);
 
@@ -403,6 +712,152 @@ namespace osmscout {
 #endif
   }
 
+  /**
+   * Hint the operating system that the given range of the file will be read soon,
+   * so that it can start reading it in the background. The current position is not
+   * changed. Since this is only a hint, errors are ignored and the method does
+   * nothing for block compressed files or if the platform does not support it.
+   */
+  void FileScanner::Prefetch(FileOffset pos,
+                             FileOffset bytes)
+  {
+    if (file==NULL ||
+        compressedFile!=NULL ||
+        pos>=size ||
+        bytes==0) {
+      return;
+    }
+
+    bytes=std::min(bytes,size-pos);
+
+#if defined(HAVE_MMAP) && defined(HAVE_POSIX_MADVISE)
+    if (buffer!=NULL) {
+      // Address must be page aligned
+      FileOffset pageSize=(FileOffset)sysconf(_SC_PAGESIZE);
+      FileOffset start=pos-pos%pageSize;
+
+      posix_madvise(buffer+start,
+                    (size_t)(pos+bytes-start),
+                    POSIX_MADV_WILLNEED);
+      return;
+    }
+#endif
+
+#if defined(HAVE_POSIX_FADVISE)
+    posix_fadvise(fileno(file),
+                  (off_t)pos,
+                  (off_t)bytes,
+                  POSIX_FADV_WILLNEED);
+#endif
+  }
+
+  /**
+   * Read the given range of the file into memory using one read operation and move
+   * the reading cursor to the start of the range. All following reads within the
+   * range are served from memory without accessing the file. Reading beyond the end
+   * of the range or moving the cursor outside of the range continues with normal
+   * file access.
+   *
+   * For memory mapped files the range is only prefetched, for block compressed files
+   * the method is the same as SetPos().
+   *
+   * throws IOException on error
+   */
+  void FileScanner::ReadRange(FileOffset pos,
+                              FileOffset bytes)
+  {
+#if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
+    if (buffer!=NULL) {
+      Prefetch(pos,
+               bytes);
+      SetPos(pos);
+
+      return;
+    }
+#endif
+
+    if (compressedFile!=NULL) {
+      SetPos(pos);
+
+      return;
+    }
+
+    rangeData.clear();
+
+    SetPos(pos);
+
+    if (pos>=size) {
+      return;
+    }
+
+    rangeData.resize((size_t)std::min(bytes,size-pos));
+
+    size_t read=fread(rangeData.data(),1,rangeData.size(),file);
+
+    bytesRead+=read;
+
+    if (read!=rangeData.size()) {
+      rangeData.clear();
+      hasError=true;
+      throw IOException(filename,"Cannot read range");
+    }
+
+    rangeStart=pos;
+    offset=pos;
+  }
+
+  /**
+   * Reads the given number of bytes from the file (or the uncompressed data of a block
+   * compressed file or the range read by ReadRange()) if the file is not memory
+   * mapped. Returns the number of bytes read.
+   */
+  size_t FileScanner::ReadFromFile(void* buffer, size_t bytes)
+  {
+    if (compressedFile!=NULL) {
+      size_t read=compressedFile->Read(offset,
+                                       static_cast<char*>(buffer),
+                                       bytes);
+
+      offset+=read;
+      bytesRead+=read;
+
+      return read;
+    }
+
+    if (!rangeData.empty()) {
+      if (offset+bytes<=rangeStart+rangeData.size()) {
+        memcpy(buffer,
+               rangeData.data()+(offset-rangeStart),
+               bytes);
+
+        offset+=bytes;
+
+        return bytes;
+      }
+
+      // Leaving the range, continue with reading from the file
+      FileOffset pos=offset;
+
+      rangeData.clear();
+
+#if defined(HAVE_FSEEKO)
+      if (fseeko(file,(off_t)pos,SEEK_SET)!=0) {
+        return 0;
+      }
+#else
+      if (fseek(file,pos,SEEK_SET)!=0) {
+        return 0;
+      }
+#endif
+    }
+
+    size_t read=fread(buffer,1,bytes,file);
+
+    bytesRead+=read;
+
+    return read;
+  }
+
   void FileScanner::Read(char* buffer, size_t bytes)
   {
     if (HasError()) {
@@ -424,7 +879,7 @@ namespace osmscout {
     }
 #endif
 
-    hasError=fread(buffer,1,bytes,file)!=bytes;
+    hasError=ReadFromFile(buffer,bytes)!=bytes;
 
     if (hasError) {
       throw IOException(filename,"Cannot read byte array");
@@ -468,7 +923,7 @@ namespace osmscout {
 
     char character;
 
-    hasError=fread(&character,1,1,file)!=1;
+    hasError=ReadFromFile(&character,1)!=1;
 
     if (hasError) {
       throw IOException(filename,"Cannot read string");
@@ -477,7 +932,7 @@ namespace osmscout {
     while (character!='\0') {
       value.append(1,character);
 
-      hasError=fread(&character,1,1,file)!=1;
+      hasError=ReadFromFile(&character,1)!=1;
 
       if (hasError) {
         throw IOException(filename,"Cannot read string");
@@ -508,7 +963,7 @@ namespace osmscout {
 
     char value;
 
-    hasError=fread(&value,1,1,file)!=1;
+    hasError=ReadFromFile(&value,1)!=1;
 
     if (hasError) {
       throw IOException(filename,"Cannot read bool");
@@ -540,7 +995,7 @@ namespace osmscout {
     }
 #endif
 
-    hasError=fread(&number,1,1,file)!=1;
+    hasError=ReadFromFile(&number,1)!=1;
 
     if (hasError) {
       throw IOException(filename,"Cannot read int8_t");
@@ -582,7 +1037,7 @@ namespace osmscout {
 
     unsigned char buffer[2];
 
-    hasError=fread(&buffer,1,2,file)!=2;
+    hasError=ReadFromFile(&buffer,2)!=2;
 
     if (hasError) {
       throw IOException(filename,"Cannot read int16_t");
@@ -646,7 +1101,7 @@ namespace osmscout {
 
     unsigned char buffer[4];
 
-    hasError=fread(&buffer,1,4,file)!=4;
+    hasError=ReadFromFile(&buffer,4)!=4;
 
     if (hasError) {
       throw IOException(filename,"Cannot read int32_t");
@@ -740,7 +1195,7 @@ namespace osmscout {
 
     unsigned char buffer[8];
 
-    hasError=fread(&buffer,1,8,file)!=8;
+    hasError=ReadFromFile(&buffer,8)!=8;
 
     if (hasError) {
       throw IOException(filename,"Cannot read int64_t");
@@ -812,7 +1267,7 @@ namespace osmscout {
     }
 #endif
 
-    hasError=fread(&number,1,1,file)!=1;
+    hasError=ReadFromFile(&number,1)!=1;
 
     if (hasError) {
       throw IOException(filename,"Cannot read int64_t");
@@ -854,7 +1309,7 @@ namespace osmscout {
 
     unsigned char buffer[2];
 
-    hasError=fread(&buffer,1,2,file)!=2;
+    hasError=ReadFromFile(&buffer,2)!=2;
 
     if (hasError) {
       throw IOException(filename,"Cannot read int16_t");
@@ -918,7 +1373,7 @@ namespace osmscout {
 
     unsigned char buffer[4];
 
-    hasError=fread(&buffer,1,4,file)!=4;
+    hasError=ReadFromFile(&buffer,4)!=4;
 
     if (hasError) {
       throw IOException(filename,"Cannot read int32_t");
@@ -1012,7 +1467,7 @@ namespace osmscout {
 
     unsigned char buffer[8];
 
-    hasError=fread(&buffer,1,8,file)!=8;
+    hasError=ReadFromFile(&buffer,8)!=8;
 
     if (hasError) {
       throw IOException(filename,"Cannot read int64_t");
@@ -1099,7 +1554,7 @@ namespace osmscout {
 
     unsigned char buffer[2];
 
-    hasError=fread(&buffer,1,bytes,file)!=bytes;
+    hasError=ReadFromFile(&buffer,bytes)!=bytes;
 
     if (hasError) {
       throw IOException(filename,"Cannot read size limited uint16_t");
@@ -1172,7 +1627,7 @@ namespace osmscout {
 
     unsigned char buffer[4];
 
-    hasError=fread(&buffer,1,bytes,file)!=bytes;
+    hasError=ReadFromFile(&buffer,bytes)!=bytes;
 
     if (hasError) {
       throw IOException(filename,"Cannot read size limited uint32_t");
@@ -1287,7 +1742,7 @@ namespace osmscout {
 
     unsigned char buffer[8];
 
-    hasError=fread(&buffer,1,bytes,file)!=bytes;
+    hasError=ReadFromFile(&buffer,bytes)!=bytes;
 
     if (hasError) {
       throw IOException(filename,"Cannot read size limited uint64_t");
@@ -1426,7 +1881,7 @@ namespace osmscout {
 
     unsigned char buffer[8];
 
-    hasError=fread(&buffer,1,8,file)!=8;
+    hasError=ReadFromFile(&buffer,8)!=8;
 
     if (hasError) {
       throw IOException(filename,"Cannot read file offset");
@@ -1557,7 +2012,7 @@ namespace osmscout {
 
     unsigned char buffer[8];
 
-    hasError=fread(&buffer,1,bytes,file)!=bytes;
+    hasError=ReadFromFile(&buffer,bytes)!=bytes;
 
     if (hasError) {
       throw IOException(filename,"Cannot read file offset");
@@ -1645,7 +2100,7 @@ namespace osmscout {
 
     char buffer;
 
-    if (fread(&buffer,1,1,file)!=1) {
+    if (ReadFromFile(&buffer,1)!=1) {
       hasError=true;
       throw IOException(filename,"Cannot read int16_t number");
     }
@@ -1664,7 +2119,7 @@ namespace osmscout {
 
       while ((buffer & 0x80)!=0) {
 
-        if (fread(&buffer,1,1,file)!=1) {
+        if (ReadFromFile(&buffer,1)!=1) {
           hasError=true;
           throw IOException(filename,"Cannot read int16_t number");
         }
@@ -1685,7 +2140,7 @@ namespace osmscout {
 
       while ((buffer & 0x80)!=0) {
 
-        if (fread(&buffer,1,1,file)!=1) {
+        if (ReadFromFile(&buffer,1)!=1) {
           hasError=true;
           throw IOException(filename,"Cannot read int16_t number");
         }
@@ -1725,7 +2180,7 @@ namespace osmscout {
 
     char buffer;
 
-    if (fread(&buffer,1,1,file)!=1) {
+    if (ReadFromFile(&buffer,1)!=1) {
       hasError=true;
       throw IOException(filename,"Cannot read int32_t number");
     }
@@ -1745,7 +2200,7 @@ namespace osmscout {
 
       while ((buffer & 0x80)!=0) {
 
-        if (fread(&buffer,1,1,file)!=1) {
+        if (ReadFromFile(&buffer,1)!=1) {
           hasError=true;
           throw IOException(filename,"Cannot read int32_t number");
         }
@@ -1766,7 +2221,7 @@ namespace osmscout {
 
       while ((buffer & 0x80)!=0) {
 
-        if (fread(&buffer,1,1,file)!=1) {
+        if (ReadFromFile(&buffer,1)!=1) {
           hasError=true;
           throw IOException(filename,"Cannot read int32_t number");
         }
@@ -1806,7 +2261,7 @@ namespace osmscout {
 
     char buffer;
 
-    if (fread(&buffer,1,1,file)!=1) {
+    if (ReadFromFile(&buffer,1)!=1) {
       hasError=true;
       throw IOException(filename,"Cannot read int64_t number");
     }
@@ -1825,7 +2280,7 @@ namespace osmscout {
 
       while ((buffer & 0x80)!=0) {
 
-        if (fread(&buffer,1,1,file)!=1) {
+        if (ReadFromFile(&buffer,1)!=1) {
           hasError=true;
           throw IOException(filename,"Cannot read int64_t number");
         }
@@ -1846,7 +2301,7 @@ namespace osmscout {
 
       while ((buffer & 0x80)!=0) {
 
-        if (fread(&buffer,1,1,file)!=1) {
+        if (ReadFromFile(&buffer,1)!=1) {
           hasError=true;
           throw IOException(filename,"Cannot read int64_t number");
         }
@@ -1891,7 +2346,7 @@ namespace osmscout {
 
     char buffer;
 
-    if (fread(&buffer,1,1,file)!=1) {
+    if (ReadFromFile(&buffer,1)!=1) {
       hasError=true;
       throw IOException(filename,"Cannot read uint16_t number");
     }
@@ -1905,7 +2360,7 @@ namespace osmscout {
         return;
       }
 
-      if (fread(&buffer,1,1,file)!=1) {
+      if (ReadFromFile(&buffer,1)!=1) {
         hasError=true;
         throw IOException(filename,"Cannot read uint16_t number");
       }
@@ -1944,7 +2399,7 @@ namespace osmscout {
 
     char buffer;
 
-    if (fread(&buffer,1,1,file)!=1) {
+    if (ReadFromFile(&buffer,1)!=1) {
       hasError=true;
       throw IOException(filename,"Cannot read uint32_t number");
     }
@@ -1958,7 +2413,7 @@ namespace osmscout {
         return;
       }
 
-      if (fread(&buffer,1,1,file)!=1) {
+      if (ReadFromFile(&buffer,1)!=1) {
         hasError=true;
         throw IOException(filename,"Cannot read uint32_t number");
       }
@@ -1980,7 +2435,7 @@ namespace osmscout {
       unsigned int shift=0;
 
       for (; offset<size; offset++) {
-        number|=(buffer[offset] & 127) << shift;
+        number|=static_cast<uint64_t>(buffer[offset] & 127) << shift;
 
         if ((buffer[offset] & 128)==0) {
           offset++;
@@ -1997,7 +2452,7 @@ namespace osmscout {
 
     char buffer;
 
-    if (fread(&buffer,1,1,file)!=1) {
+    if (ReadFromFile(&buffer,1)!=1) {
       hasError=true;
       throw IOException(filename,"Cannot read uint64_t number");
     }
@@ -2011,7 +2466,7 @@ namespace osmscout {
         return;
       }
 
-      if (fread(&buffer,1,1,file)!=1) {
+      if (ReadFromFile(&buffer,1)!=1) {
         hasError=true;
         throw IOException(filename,"Cannot read uint64_t number");
       }
@@ -2060,7 +2515,7 @@ namespace osmscout {
 
     unsigned char buffer[coordByteSize];
 
-    hasError=fread(&buffer,1,coordByteSize,file)!=coordByteSize;
+    hasError=ReadFromFile(&buffer,coordByteSize)!=coordByteSize;
 
     if (hasError) {
       throw IOException(filename,"Cannot read coordinate");
@@ -2128,7 +2583,7 @@ namespace osmscout {
 
     unsigned char buffer[coordByteSize];
 
-    hasError=fread(&buffer,1,coordByteSize,file)!=coordByteSize;
+    hasError=ReadFromFile(&buffer,coordByteSize)!=coordByteSize;
 
     if (hasError) {
       throw IOException(filename,"Cannot read coordinate");
@@ -2155,151 +2610,194 @@ namespace osmscout {
     }
   }
 
-  void FileScanner::Read(std::vector<GeoCoord>& nodes)
+  /**
+   * Reads the variable length header of an encoded coordinate array
+   * into the given buffer (with space for at least 3 bytes).
+   *
+   * Returns the size of the header in bytes.
+   */
+  size_t FileScanner::ReadCoordsHeader(uint8_t header[])
   {
-    size_t  coordBitSize;
-    uint8_t sizeByte;
+    size_t headerSize=1;
 
-    Read(sizeByte);
+    Read(header[0]);
 
-    // Fast exit for empty arrays
-    if (sizeByte==0) {
-      return;
-    }
+    if ((header[0] & 0x80) != 0) {
+      Read(header[1]);
+      headerSize++;
 
-    if ((sizeByte & 0x03) == 0) {
-      coordBitSize=16;
-    }
-    else if ((sizeByte & 0x03) == 1) {
-      coordBitSize=32;
-    }
-    else {
-      coordBitSize=48;
+      if ((header[1] & 0x80) != 0) {
+        Read(header[2]);
+        headerSize++;
+      }
     }
 
-    size_t nodeCount=(sizeByte & 0x7c) >> 2;
-
-    if ((sizeByte & 0x80) != 0) {
-      Read(sizeByte);
+    return headerSize;
+  }
 
-      nodeCount|=(sizeByte & 0x7f) << 5;
+  void FileScanner::Read(std::vector<GeoCoord>& nodes)
+  {
+    uint8_t header[3];
 
-      if ((sizeByte & 0x80) != 0) {
-        Read(sizeByte);
+    ReadCoordsHeader(header);
 
-        nodeCount|=sizeByte << 12;
-      }
+    // Fast exit for empty arrays
+    if (header[0]==0) {
+      return;
     }
 
+    size_t nodeCount;
+    size_t coordBitSize;
+
+    DecodeCoordsHeader(header,
+                       nodeCount,
+                       coordBitSize);
+
     //std::cout << "Read " << std::dec << nodeCount << " nodes, " << coordBitSize << " bits per coordinate pair" << std::endl;
 
-    nodes.resize(nodeCount);
+    size_t dataSize=coordByteSize+(nodeCount-1)*coordBitSize/8;
 
-    size_t byteBufferSize=(nodeCount-1)*coordBitSize/8;
+    AssureByteBufferSize(dataSize);
 
-    AssureByteBufferSize(byteBufferSize);
+    Read((char*)byteBuffer,dataSize);
 
-    ReadCoord(nodes[0]);
+    DecodeCoordsData(byteBuffer,
+                     nodeCount,
+                     coordBitSize,
+                     nodes,
+                     coordBuffer);
+  }
 
-    uint32_t latValue=(uint32_t)round((nodes[0].GetLat()+90.0)*latConversionFactor);
-    uint32_t lonValue=(uint32_t)round((nodes[0].GetLon()+180.0)*lonConversionFactor);
+  /**
+   * Reads a coordinate array as written by FileWriter::Write(const std::vector<GeoCoord>&)
+   * without decoding it. The encoded bytes are appended to the given buffer and can
+   * later be decoded using DecodeCoords().
+   */
+  void FileScanner::ReadCoordsEncoded(std::vector<char>& data)
+  {
+    uint8_t header[3];
+    size_t  headerSize=ReadCoordsHeader(header);
+    size_t  pos=data.size();
 
-    Read((char*)byteBuffer,byteBufferSize);
+    if (header[0]==0) {
+      data.push_back(0);
 
-    /* std::cout << "Read - byte buffer: ";
-    for (size_t i=0; i<byteBufferSize; i++) {
-      std::cout << std::hex << (unsigned int) byteBuffer[i] << " ";
+      return;
     }
-    std::cout << std::endl;*/
 
-    //std::cout << "Read - calculated deltas: ";
-    if (coordBitSize==16) {
-      size_t currentCoordPos=1;
+    size_t nodeCount;
+    size_t coordBitSize;
 
-      for (size_t i=0; i<byteBufferSize; i+=2) {
-        int32_t latDelta=(int8_t)byteBuffer[i];
-        int32_t lonDelta=(int8_t)byteBuffer[i+1];
+    DecodeCoordsHeader(header,
+                       nodeCount,
+                       coordBitSize);
 
-        latValue+=latDelta;
-        lonValue+=lonDelta;
+    size_t dataSize=coordByteSize+(nodeCount-1)*coordBitSize/8;
 
-        //std::cout << std::hex << latDelta << " " << lonDelta << " ";
+    data.resize(pos+headerSize+dataSize);
 
-        nodes[currentCoordPos].Set(latValue/latConversionFactor-90.0,
-                                   lonValue/lonConversionFactor-180.0);
+    memcpy(&data[pos],header,headerSize);
 
-        currentCoordPos++;
-      }
-      //std::cout << std::endl;
-    }
-    else if (coordBitSize==32) {
-      size_t currentCoordPos=1;
+    Read(&data[pos+headerSize],dataSize);
+  }
+
+  /**
+   * Reads the ids of nodeCount nodes as written by Way::WriteIds() and
+   * Area::WriteIds() without decoding them. The encoded bytes are appended
+   * to the given buffer and can later be decoded using DecodeIds().
+   */
+  void FileScanner::ReadIdsEncoded(size_t nodeCount,
+                                   std::vector<char>& data)
+  {
+    size_t  minIdPos=data.size();
+    uint8_t byte;
 
-      for (size_t i=0; i<byteBufferSize; i+=4) {
-        uint32_t latUDelta=byteBuffer[i+0] | (byteBuffer[i+1]<<8);
-        uint32_t lonUDelta=byteBuffer[i+2] | (byteBuffer[i+3]<<8);
-        int32_t  latDelta;
-        int32_t  lonDelta;
+    do {
+      Read(byte);
+      data.push_back((char)byte);
+    } while ((byte & 0x80)!=0);
 
-        if (latUDelta & 0x8000) {
-          latDelta=(int32_t)(latUDelta | 0xffff0000);
-        }
-        else {
-          latDelta=(int32_t)latUDelta;
-        }
+    // minId==0 => no further data
+    if (data.size()==minIdPos+1 &&
+        data[minIdPos]==0) {
+      return;
+    }
 
-        latValue+=latDelta;
+    size_t idCurrent=0;
 
-        if (lonUDelta & 0x8000) {
-          lonDelta=(int32_t)(lonUDelta | 0xffff0000);
-        }
-        else {
-          lonDelta=(int32_t)lonUDelta;
-        }
+    while (idCurrent<nodeCount) {
+      uint8_t bitset;
+      size_t  bitmask=1;
 
-        lonValue+=lonDelta;
+      Read(bitset);
+      data.push_back((char)bitset);
 
-        //std::cout << std::hex << latDelta << " " << lonDelta << " ";
+      for (size_t i=0; i<8 && idCurrent<nodeCount; i++) {
+        if (bitset & bitmask) {
+          do {
+            Read(byte);
+            data.push_back((char)byte);
+          } while ((byte & 0x80)!=0);
+        }
 
-        nodes[currentCoordPos].Set(latValue/latConversionFactor-90.0,
-                                   lonValue/lonConversionFactor-180.0);
-        currentCoordPos++;
+        bitmask*=2;
+        idCurrent++;
       }
-      //std::cout << std::endl;
     }
-    else {
-      size_t currentCoordPos=1;
+  }
 
-      for (size_t i=0; i<byteBufferSize; i+=6) {
-        uint32_t latUDelta=(byteBuffer[i+0]) | (byteBuffer[i+1]<<8) | (byteBuffer[i+2]<<16);
-        uint32_t lonUDelta=(byteBuffer[i+3]) | (byteBuffer[i+4]<<8) | (byteBuffer[i+5]<<16);
-        int32_t  latDelta;
-        int32_t  lonDelta;
+  /**
+   * Skips a coordinate array as written by FileWriter::Write(const std::vector<GeoCoord>&)
+   * and returns a pointer to its still encoded bytes, suitable for DecodeCoords()
+   * and CoordsView.
+   *
+   * If the file is memory mapped, the returned pointer points directly into the
+   * mapped memory and stays valid as long as the file is open. Else the encoded
+   * bytes are copied into the given buffer (which is cleared first) and the result
+   * points into the buffer.
+   *
+   * @throws IOException
+   */
+  const char* FileScanner::ReadCoordsInPlace(std::vector<char>& data)
+  {
+#if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
+    if (buffer!=NULL) {
+      if (HasError()) {
+        throw IOException(filename,"Cannot read coordinates","File already in error state");
+      }
 
-        if (latUDelta & 0x800000) {
-          latDelta=(int32_t)(latUDelta | 0xff000000);
-        }
-        else {
-          latDelta=(int32_t)latUDelta;
-        }
+      const char* start=&buffer[offset];
+      uint8_t     header[3];
 
-        latValue+=latDelta;
+      ReadCoordsHeader(header);
 
-        if (lonUDelta & 0x800000) {
-          lonDelta=(int32_t)(lonUDelta | 0xff000000);
-        }
-        else {
-          lonDelta=(int32_t)lonUDelta;
-        }
+      if (header[0]!=0) {
+        size_t nodeCount;
+        size_t coordBitSize;
 
-        lonValue+=lonDelta;
+        DecodeCoordsHeader(header,
+                           nodeCount,
+                           coordBitSize);
 
-        nodes[currentCoordPos].Set(latValue/latConversionFactor-90.0,
-                                   lonValue/lonConversionFactor-180.0);
+        FileOffset dataSize=coordByteSize+(nodeCount-1)*coordBitSize/8;
 
-        currentCoordPos++;
+        if (offset+dataSize>size) {
+          hasError=true;
+          throw IOException(filename,"Cannot read coordinates","Cannot read beyond end of file");
+        }
+
+        offset+=dataSize;
       }
+
+      return start;
     }
+#endif
+
+    data.clear();
+
+    ReadCoordsEncoded(data);
+
+    return data.data();
   }
 
   void FileScanner::ReadBox(GeoBox& box)
@@ -2344,6 +2842,100 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Returns the number of coordinates of a coordinate array encoded as read by
+   * FileScanner::ReadCoordsEncoded(), without decoding the coordinates.
+   */
+  size_t GetEncodedCoordCount(const char* buffer)
+  {
+    size_t nodeCount;
+    size_t coordBitSize;
+
+    if (buffer[0]==0) {
+      return 0;
+    }
+
+    DecodeCoordsHeader((const uint8_t*)buffer,
+                       nodeCount,
+                       coordBitSize);
+
+    return nodeCount;
+  }
+
+  /**
+   * Decodes a coordinate array encoded as read by FileScanner::ReadCoordsEncoded()
+   * from the given buffer. Returns the number of bytes consumed.
+   */
+  size_t DecodeCoords(const char* buffer,
+                      std::vector<GeoCoord>& nodes)
+  {
+    const uint8_t*        data=(const uint8_t*)buffer;
+    size_t                nodeCount;
+    size_t                coordBitSize;
+    std::vector<uint32_t> coordBuffer;
+
+    if (data[0]==0) {
+      nodes.clear();
+
+      return 1;
+    }
+
+    size_t headerSize=DecodeCoordsHeader(data,
+                                         nodeCount,
+                                         coordBitSize);
+
+    DecodeCoordsData(data+headerSize,
+                     nodeCount,
+                     coordBitSize,
+                     nodes,
+                     coordBuffer);
+
+    return headerSize+coordByteSize+(nodeCount-1)*coordBitSize/8;
+  }
+
+  /**
+   * Decodes the ids of nodeCount nodes as read by FileScanner::ReadIdsEncoded()
+   * from the given buffer. Returns the number of bytes consumed.
+   */
+  size_t DecodeIds(const char* buffer,
+                   size_t nodeCount,
+                   std::vector<Id>& ids)
+  {
+    const char* start=buffer;
+    Id          minId;
+
+    ids.resize(nodeCount);
+
+    buffer+=DecodeNumber(buffer,minId);
+
+    if (minId>0) {
+      size_t idCurrent=0;
+
+      while (idCurrent<ids.size()) {
+        uint8_t bitset=(uint8_t)*buffer;
+        size_t  bitmask=1;
+
+        buffer++;
+
+        for (size_t i=0; i<8 && idCurrent<ids.size(); i++) {
+          if (bitset & bitmask) {
+            buffer+=DecodeNumber(buffer,ids[idCurrent]);
+
+            ids[idCurrent]+=minId;
+          }
+          else {
+            ids[idCurrent]=0;
+          }
+
+          bitmask*=2;
+          idCurrent++;
+        }
+      }
+    }
+
+    return buffer-start;
+  }
+
   ObjectFileRefStreamReader::ObjectFileRefStreamReader(FileScanner& reader)
   : reader(reader),
     lastFileOffset(0)
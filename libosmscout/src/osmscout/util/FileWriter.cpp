@@ -973,6 +973,18 @@ namespace osmscout {
     std::cout << std::endl;*/
   }
 
+  /**
+   * Writes the given bounding box as written by two calls to WriteCoord(),
+   * the minimum coordinate first.
+   *
+   * @throws IOException
+   */
+  void FileWriter::WriteBox(const GeoBox& box)
+  {
+    WriteCoord(box.GetMinCoord());
+    WriteCoord(box.GetMaxCoord());
+  }
+
   /**
    *
    * @throws IOException
@@ -787,6 +787,88 @@ namespace osmscout {
     return true;
   }
 
+  const double EquirectangularDistance::kmPerDegree=6371.01*M_PI/180.0;
+
+  EquirectangularDistance::EquirectangularDistance(const GeoCoord& reference)
+  : reference(reference),
+    lonFactor(cos(reference.GetLat()*M_PI/180.0))
+  {
+    // no code
+  }
+
+  /**
+   * Return the distance of the line segment from a to b and the closest
+   * point of the segment.
+   */
+  double EquirectangularDistance::GetDistance(const GeoCoord& a,
+                                              const GeoCoord& b,
+                                              GeoCoord& closest) const
+  {
+    double ax=(a.GetLon()-reference.GetLon())*lonFactor;
+    double ay=a.GetLat()-reference.GetLat();
+    double bx=(b.GetLon()-reference.GetLon())*lonFactor;
+    double by=b.GetLat()-reference.GetLat();
+    double xDelta=bx-ax;
+    double yDelta=by-ay;
+    double length=xDelta*xDelta+yDelta*yDelta;
+    double u=0.0;
+
+    if (length>0.0) {
+      // The reference is the origin of the plane
+      u=std::max(0.0,std::min(1.0,-(ax*xDelta+ay*yDelta)/length));
+    }
+
+    closest.Set(a.GetLat()+u*(b.GetLat()-a.GetLat()),
+                a.GetLon()+u*(b.GetLon()-a.GetLon()));
+
+    double x=ax+u*xDelta;
+    double y=ay+u*yDelta;
+
+    return sqrt(x*x+y*y)*kmPerDegree;
+  }
+
+  /**
+   * Return the distance of the closest point of the given bounding box, 0.0
+   * if the reference coordinate is inside the box.
+   */
+  double EquirectangularDistance::GetDistance(const GeoBox& boundingBox) const
+  {
+    double latDelta=0.0;
+    double lonDelta=0.0;
+
+    if (reference.GetLat()<boundingBox.GetMinLat()) {
+      latDelta=boundingBox.GetMinLat()-reference.GetLat();
+    }
+    else if (reference.GetLat()>boundingBox.GetMaxLat()) {
+      latDelta=reference.GetLat()-boundingBox.GetMaxLat();
+    }
+
+    if (reference.GetLon()<boundingBox.GetMinLon()) {
+      lonDelta=boundingBox.GetMinLon()-reference.GetLon();
+    }
+    else if (reference.GetLon()>boundingBox.GetMaxLon()) {
+      lonDelta=reference.GetLon()-boundingBox.GetMaxLon();
+    }
+
+    return GetDistance(latDelta,
+                       lonDelta);
+  }
+
+  /**
+   * Return the bounding box containing all coordinates with at most the
+   * given distance.
+   */
+  GeoBox EquirectangularDistance::GetBoundingBox(double distance) const
+  {
+    double latDelta=distance/kmPerDegree;
+    double lonDelta=lonFactor>0.0 ? std::min(180.0,latDelta/lonFactor) : 180.0;
+
+    return GeoBox(GeoCoord(std::max(-90.0,reference.GetLat()-latDelta),
+                           std::max(-180.0,reference.GetLon()-lonDelta)),
+                  GeoCoord(std::min(90.0,reference.GetLat()+latDelta),
+                           std::min(180.0,reference.GetLon()+lonDelta)));
+  }
+
   CellDimension cellDimension[] = {
       { 360.0,                      180.0                      }, //  0
       { 180.0,                       90.0                      }, //  1
@@ -0,0 +1,112 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2016 Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/util/MemoryArena.h>
+
+namespace osmscout {
+
+  /**
+   * All allocations are aligned to this size, which is sufficient
+   * for all fundamental types.
+   */
+  static const size_t arenaAlignment=16;
+
+  /**
+   * Allocations bigger than this fraction of the slab size get a slab of their own
+   * to not waste the remaining space of the current slab.
+   */
+  static const size_t arenaDedicatedSlabFraction=4;
+
+  static thread_local MemoryArena* currentArena=NULL;
+
+  MemoryArena::MemoryArena(size_t slabSize)
+  : slabSize(slabSize),
+    current(NULL),
+    available(0),
+    memorySize(0)
+  {
+    // no code
+  }
+
+  MemoryArena::~MemoryArena()
+  {
+    for (auto slab : slabs) {
+      ::operator delete(slab);
+    }
+  }
+
+  char* MemoryArena::AllocateSlab(size_t size)
+  {
+    char* slab=static_cast<char*>(::operator new(size));
+
+    slabs.push_back(slab);
+    memorySize+=size;
+
+    return slab;
+  }
+
+  /**
+   * Return a block of memory with the given size. The memory is valid
+   * until the arena gets destroyed.
+   */
+  void* MemoryArena::Allocate(size_t size)
+  {
+    size=(size+arenaAlignment-1)/arenaAlignment*arenaAlignment;
+
+    if (size==0) {
+      size=arenaAlignment;
+    }
+
+    if (size>slabSize/arenaDedicatedSlabFraction) {
+      return AllocateSlab(size);
+    }
+
+    if (size>available) {
+      current=AllocateSlab(slabSize);
+      available=slabSize;
+    }
+
+    void* result=current;
+
+    current+=size;
+    available-=size;
+
+    return result;
+  }
+
+  /**
+   * Return the arena active for the current thread or NULL, if
+   * there is none.
+   */
+  MemoryArena* MemoryArena::GetCurrentArena()
+  {
+    return currentArena;
+  }
+
+  MemoryArenaScope::MemoryArenaScope(const MemoryArenaRef& arena)
+  : previousArena(currentArena)
+  {
+    currentArena=arena.get();
+  }
+
+  MemoryArenaScope::~MemoryArenaScope()
+  {
+    currentArena=previousArena;
+  }
+}
@@ -51,6 +51,30 @@ namespace osmscout {
 
   static const double gradtorad=2*M_PI/360;
 
+  /*
+   * Uniform access to the coordinates of std::vector<GeoCoord> and
+   * CompactGeoCoords for the bulk transformations
+   */
+  static inline double GetCoordLat(const std::vector<GeoCoord>& coords, size_t index)
+  {
+    return coords[index].GetLat();
+  }
+
+  static inline double GetCoordLon(const std::vector<GeoCoord>& coords, size_t index)
+  {
+    return coords[index].GetLon();
+  }
+
+  static inline double GetCoordLat(const CompactGeoCoords& coords, size_t index)
+  {
+    return coords.GetLat(index);
+  }
+
+  static inline double GetCoordLon(const CompactGeoCoords& coords, size_t index)
+  {
+    return coords.GetLon(index);
+  }
+
   Projection::Projection()
   : lon(0),
     lat(0),
@@ -75,6 +99,24 @@ namespace osmscout {
     // no code
   }
 
+  void Projection::GeoToPixel(const std::vector<GeoCoord>& coords,
+                              double* x, double* y) const
+  {
+    for (size_t i=0; i<coords.size(); i++) {
+      GeoToPixel(coords[i],
+                 x[i],y[i]);
+    }
+  }
+
+  void Projection::GeoToPixel(const CompactGeoCoords& coords,
+                              double* x, double* y) const
+  {
+    for (size_t i=0; i<coords.GetSize(); i++) {
+      GeoToPixel(coords.GetLon(i),coords.GetLat(i),
+                 x[i],y[i]);
+    }
+  }
+
   MercatorProjection::MercatorProjection()
   : valid(false),
     latOffset(0.0),
@@ -257,6 +299,75 @@ namespace osmscout {
     x+=width/2;
   }
 
+  /**
+   * Transformation of all coordinates in one go. Two coordinates are transformed
+   * at once using SSE2 (if available), rotation and the transformation to canvas
+   * coordinates are done in a second, simple loop.
+   */
+  template<class C>
+  void MercatorProjection::TransformCoords(const C& coords,
+                                           size_t count,
+                                           double* x, double* y) const
+  {
+    assert(valid);
+
+    size_t i=0;
+
+#ifdef OSMSCOUT_HAVE_SSE2
+    v2df sse2Lon=_mm_set1_pd(this->lon);
+    v2df sse2LatOffset=_mm_set1_pd(latOffset);
+    v2df sse2Scale=_mm_set1_pd(scale);
+    v2df sse2ScaleGradtorad=_mm_set1_pd(scaleGradtorad);
+
+    for (; i+1<count; i+=2) {
+      v2df lon=_mm_setr_pd(GetCoordLon(coords,i),GetCoordLon(coords,i+1));
+      v2df lat=_mm_setr_pd(GetCoordLat(coords,i),GetCoordLat(coords,i+1));
+
+      _mm_storeu_pd(&x[i],_mm_mul_pd(_mm_sub_pd(lon,sse2Lon),sse2ScaleGradtorad));
+      _mm_storeu_pd(&y[i],_mm_mul_pd(_mm_sub_pd(atanh_sin_pd(_mm_mul_pd(lat,ARRAY2V2DF(sseGradtorad))),
+                                                sse2LatOffset),
+                                     sse2Scale));
+    }
+#endif
+
+    for (; i<count; i++) {
+      x[i]=(GetCoordLon(coords,i)-this->lon)*scaleGradtorad;
+      y[i]=(atanh(sin(GetCoordLat(coords,i)*gradtorad))-latOffset)*scale;
+    }
+
+    if (angle!=0.0) {
+      for (i=0; i<count; i++) {
+        double xn=x[i]*angleNegCos-y[i]*angleNegSin;
+        double yn=x[i]*angleNegSin+y[i]*angleNegCos;
+
+        x[i]=xn;
+        y[i]=yn;
+      }
+    }
+
+    // Transform to canvas coordinate
+    for (i=0; i<count; i++) {
+      y[i]=height/2-y[i];
+      x[i]+=width/2;
+    }
+  }
+
+  void MercatorProjection::GeoToPixel(const std::vector<GeoCoord>& coords,
+                                      double* x, double* y) const
+  {
+    TransformCoords(coords,
+                    coords.size(),
+                    x,y);
+  }
+
+  void MercatorProjection::GeoToPixel(const CompactGeoCoords& coords,
+                                      double* x, double* y) const
+  {
+    TransformCoords(coords,
+                    coords.GetSize(),
+                    x,y);
+  }
+
   void MercatorProjection::GeoToPixel(const BatchTransformer& /*transformData*/) const
   {
     assert(false); //should not be called
@@ -429,6 +540,29 @@ namespace osmscout {
       _mm_storeh_pd (transformData.yPointer[1], y);
     }
 
+    template<class C>
+    void TileProjection::TransformCoords(const C& coords,
+                                         size_t count,
+                                         double* x, double* y) const
+    {
+      size_t i=0;
+
+      for (; i+1<count; i+=2) {
+        v2df lon=_mm_setr_pd(GetCoordLon(coords,i),GetCoordLon(coords,i+1));
+        v2df lat=_mm_setr_pd(GetCoordLat(coords,i),GetCoordLat(coords,i+1));
+
+        _mm_storeu_pd(&x[i],_mm_sub_pd(_mm_mul_pd(lon,sse2ScaleGradtorad),sse2LonOffset));
+        _mm_storeu_pd(&y[i],_mm_sub_pd(sse2Height,
+                                       _mm_sub_pd(_mm_mul_pd(sse2Scale,atanh_sin_pd(_mm_mul_pd(lat,ARRAY2V2DF(sseGradtorad)))),
+                                                  sse2LatOffset)));
+      }
+
+      if (i<count) {
+        GeoToPixel(GetCoordLon(coords,i),GetCoordLat(coords,i),
+                   x[i],y[i]);
+      }
+    }
+
   #else
 
     void TileProjection::GeoToPixel(double lon, double lat,
@@ -445,10 +579,37 @@ namespace osmscout {
       y=height-(scale*atanh(sin(coord.GetLat()*gradtorad))-latOffset);
     }
 
+    template<class C>
+    void TileProjection::TransformCoords(const C& coords,
+                                         size_t count,
+                                         double* x, double* y) const
+    {
+      for (size_t i=0; i<count; i++) {
+        x[i]=GetCoordLon(coords,i)*scaleGradtorad-lonOffset;
+        y[i]=height-(scale*atanh(sin(GetCoordLat(coords,i)*gradtorad))-latOffset);
+      }
+    }
+
     void TileProjection::GeoToPixel(const BatchTransformer& /*transformData*/) const
     {
       assert(false); //should not be called
     }
 
   #endif
+
+  void TileProjection::GeoToPixel(const std::vector<GeoCoord>& coords,
+                                  double* x, double* y) const
+  {
+    TransformCoords(coords,
+                    coords.size(),
+                    x,y);
+  }
+
+  void TileProjection::GeoToPixel(const CompactGeoCoords& coords,
+                                  double* x, double* y) const
+  {
+    TransformCoords(coords,
+                    coords.GetSize(),
+                    x,y);
+  }
 }
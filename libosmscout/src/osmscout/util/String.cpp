@@ -19,6 +19,7 @@
 
 #include <osmscout/util/String.h>
 
+#include <algorithm>
 #include <cctype>
 #include <iomanip>
 #include <locale>
@@ -308,6 +309,71 @@ namespace osmscout {
     }
   }
 
+  void SplitUTF8String(const std::string& text,
+                       std::vector<std::string>& characters)
+  {
+    characters.clear();
+    characters.reserve(text.length());
+
+    size_t idx=0;
+
+    while (idx<text.length()) {
+      unsigned char lead=(unsigned char)text[idx];
+      size_t        length=1;
+
+      if ((lead & 0xe0)==0xc0) {
+        length=2;
+      }
+      else if ((lead & 0xf0)==0xe0) {
+        length=3;
+      }
+      else if ((lead & 0xf8)==0xf0) {
+        length=4;
+      }
+
+      // Continuation bytes and truncated sequences are returned as they are
+      length=std::min(length,text.length()-idx);
+
+      for (size_t i=1; i<length; i++) {
+        if (((unsigned char)text[idx+i] & 0xc0)!=0x80) {
+          length=i;
+          break;
+        }
+      }
+
+      characters.push_back(text.substr(idx,length));
+      idx+=length;
+    }
+  }
+
+  std::string UTF8StringToLower(const std::string& text)
+  {
+    std::string result(text);
+
+    for (size_t i=0; i<result.length(); i++) {
+      unsigned char c=(unsigned char)result[i];
+
+      if (c>='A' && c<='Z') {
+        result[i]=(char)(c-'A'+'a');
+      }
+      else if (c==0xC3 &&
+               i+1<result.length()) {
+        unsigned char next=(unsigned char)result[i+1];
+
+        // U+00D7 is the multiplication sign, U+00DF (german "sz") has no upper case
+        if (next>=0x80 &&
+            next<=0x9E &&
+            next!=0x97) {
+          result[i+1]=(char)(next+0x20);
+        }
+
+        i++;
+      }
+    }
+
+    return result;
+  }
+
 #if defined(OSMSCOUT_HAVE_STD_WSTRING)
 
   /**
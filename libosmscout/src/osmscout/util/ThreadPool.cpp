@@ -0,0 +1,226 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2016 Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/util/ThreadPool.h>
+
+#include <algorithm>
+
+namespace osmscout {
+
+  /**
+   * State of the pool the current thread is a worker of, NULL for threads
+   * outside of any pool
+   */
+  static thread_local const void* currentWorkerState=NULL;
+
+  /**
+   * Index of the current thread in the pool it is a worker of
+   */
+  static thread_local size_t      currentWorkerIndex=0;
+
+  ThreadPool::State::State()
+  : nextQueue(0),
+    pendingJobs(0),
+    running(true)
+  {
+    // no code
+  }
+
+  /**
+   * Create a thread pool with the given number of worker threads. If
+   * workerCount is 0, one worker per hardware thread is started.
+   */
+  ThreadPool::ThreadPool(size_t workerCount)
+  : state(std::make_shared<State>())
+  {
+    if (workerCount==0) {
+      workerCount=std::max(1u,std::thread::hardware_concurrency());
+    }
+
+    state->queues.reserve(workerCount);
+
+    for (size_t i=0; i<workerCount; i++) {
+      state->queues.push_back(std::make_shared<WorkerQueue>());
+    }
+
+    workers.reserve(workerCount);
+
+    for (size_t i=0; i<workerCount; i++) {
+      workers.push_back(std::thread(&ThreadPool::WorkerLoop,state,i));
+    }
+  }
+
+  ThreadPool::~ThreadPool()
+  {
+    Stop();
+  }
+
+  size_t ThreadPool::GetWorkerCount() const
+  {
+    return state->queues.size();
+  }
+
+  /**
+   * Return the index of the worker executing the current thread or
+   * the number of workers, if called from a thread outside the pool.
+   */
+  size_t ThreadPool::GetCurrentWorkerIndex() const
+  {
+    if (currentWorkerState==state.get()) {
+      return currentWorkerIndex;
+    }
+
+    return state->queues.size();
+  }
+
+  /**
+   * Push a job for execution in the pool. Returns false and drops the job,
+   * if the pool has already been stopped.
+   */
+  bool ThreadPool::Push(const Job& job)
+  {
+    size_t queueIndex=GetCurrentWorkerIndex();
+
+    if (queueIndex>=state->queues.size()) {
+      queueIndex=state->nextQueue++ % state->queues.size();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+
+      if (!state->running) {
+        return false;
+      }
+
+      // The job must not be taken from the queue before it is counted
+      std::lock_guard<std::mutex> queueLock(state->queues[queueIndex]->mutex);
+
+      state->queues[queueIndex]->jobs.push_back(job);
+      state->pendingJobs++;
+    }
+
+    state->condition.notify_one();
+
+    return true;
+  }
+
+  /**
+   * Take the next job from the own queue or - if empty - steal
+   * one from the other queues.
+   */
+  bool ThreadPool::PopJob(State& state,
+                          size_t workerIndex,
+                          Job& job)
+  {
+    {
+      WorkerQueue& queue=*state.queues[workerIndex];
+
+      std::lock_guard<std::mutex> lock(queue.mutex);
+
+      if (!queue.jobs.empty()) {
+        job=std::move(queue.jobs.back());
+        queue.jobs.pop_back();
+
+        return true;
+      }
+    }
+
+    for (size_t i=1; i<state.queues.size(); i++) {
+      WorkerQueue& queue=*state.queues[(workerIndex+i) % state.queues.size()];
+
+      std::lock_guard<std::mutex> lock(queue.mutex);
+
+      if (!queue.jobs.empty()) {
+        job=std::move(queue.jobs.front());
+        queue.jobs.pop_front();
+
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void ThreadPool::WorkerLoop(StateRef state,
+                              size_t workerIndex)
+  {
+    Job job;
+
+    currentWorkerState=state.get();
+    currentWorkerIndex=workerIndex;
+
+    while (true) {
+      if (PopJob(*state,workerIndex,job)) {
+        {
+          std::lock_guard<std::mutex> lock(state->mutex);
+
+          state->pendingJobs--;
+        }
+
+        job();
+        job=nullptr;
+
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(state->mutex);
+
+      state->condition.wait(lock,[&state]{return state->pendingJobs>0 || !state->running;});
+
+      if (!state->running && state->pendingJobs==0) {
+        break;
+      }
+    }
+
+    currentWorkerState=NULL;
+  }
+
+  /**
+   * Stop the pool. Already queued jobs will still be executed, the method
+   * returns after all workers have finished. If called from within a job of
+   * the pool, the calling worker is detached and finishes after the method
+   * has returned.
+   */
+  void ThreadPool::Stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+
+      if (!state->running) {
+        return;
+      }
+
+      state->running=false;
+    }
+
+    state->condition.notify_all();
+
+    std::thread::id currentId=std::this_thread::get_id();
+
+    for (auto& worker : workers) {
+      if (worker.get_id()==currentId) {
+        // Joining ourself would dead lock
+        worker.detach();
+      }
+      else {
+        worker.join();
+      }
+    }
+  }
+}
@@ -21,150 +21,161 @@
 
 #include <limits>
 
-namespace osmscout {
-
-  class LineSegment
-  {
-  private:
-    TransPolygon::TransPoint ref;
-    double                   xdelta;
-    double                   ydelta;
-    double                   inverseLength;
-
-  public:
-
-    LineSegment(const TransPolygon::TransPoint& a,
-                const TransPolygon::TransPoint& b)
-    :ref(a)
-    {
-      xdelta=b.x-a.x;
-      ydelta=b.y-a.y;
-      inverseLength=1/(xdelta*xdelta+ydelta*ydelta);
-    }
-
-    bool IsValid()
-    {
-      return !(xdelta==0 && ydelta==0);
-    }
-
-    double CalculateDistanceSquared(const TransPolygon::TransPoint& p)
-    {
-      double cx=p.x-ref.x;
-      double cy=p.y-ref.y;
-      double u=(cx*xdelta+cy*ydelta)*inverseLength;
-
-      u=std::min(1.0,std::max(0.0,u));
-
-      double dx=cx-u*xdelta; // *-1 but we square below
-      double dy=cy-u*ydelta; // *-1 but we square below
+#ifdef OSMSCOUT_HAVE_SSE2
+#include <osmscout/system/SSEMath.h>
+#endif
 
-      return dx*dx+dy*dy;
-    }
-
-    double CalculateDistance(const TransPolygon::TransPoint& p)
-    {
-      return sqrt(CalculateDistanceSquared(p));
-    }
-  };
+namespace osmscout {
 
   /**
    * Calculates the distance between a point p and a line defined by the points a and b.
-   * @param p
+   * @param px, py
    *    The point in distance to a line
-   * @param a
+   * @param ax, ay
    *    One point defining the line
-   * @param b
+   * @param bx, by
    *    Another point defining the line
    * @return
    *    The distance
    */
-  static double CalculateDistancePointToLineSegment(const TransPolygon::TransPoint& p,
-                                                    const TransPolygon::TransPoint& a,
-                                                    const TransPolygon::TransPoint& b)
+  static double CalculateDistancePointToLineSegment(double px, double py,
+                                                    double ax, double ay,
+                                                    double bx, double by)
   {
-    double xdelta=b.x-a.x;
-    double ydelta=b.y-a.y;
+    double xdelta=bx-ax;
+    double ydelta=by-ay;
 
     if (xdelta==0 && ydelta==0) {
       return std::numeric_limits<double>::infinity();
     }
 
-    double u=((p.x-a.x)*xdelta+(p.y-a.y)*ydelta)/(xdelta*xdelta+ydelta*ydelta);
+    double u=((px-ax)*xdelta+(py-ay)*ydelta)/(xdelta*xdelta+ydelta*ydelta);
 
     double cx,cy;
 
     if (u<0) {
-      cx=a.x;
-      cy=a.y;
+      cx=ax;
+      cy=ay;
     }
     else if (u>1) {
-      cx=b.x;
-      cy=b.y;
+      cx=bx;
+      cy=by;
     }
     else {
-      cx=a.x+u*xdelta;
-      cy=a.y+u*ydelta;
+      cx=ax+u*xdelta;
+      cy=ay+u*ydelta;
     }
 
-    double dx=cx-p.x;
-    double dy=cy-p.y;
+    double dx=cx-px;
+    double dy=cy-py;
 
     return sqrt(dx*dx+dy*dy);
   }
 
-  static double CalculateDistancePointToPoint(const TransPolygon::TransPoint& a,
-                                              const TransPolygon::TransPoint& b)
+  /**
+   * Returns the index of the point in the range [beginIndex,endIndex[ with the largest
+   * (squared) distance to the line segment a-b. If there are multiple points with the same
+   * distance, the one with the lowest index is returned. If no point has a distance
+   * larger than 0 the index beginIndex-1 is returned.
+   *
+   * x and y are expected to hold the coordinates as structure of arrays, which allows
+   * processing of multiple points at once if SSE2 is available.
+   */
+  static size_t FindFarthestPointToLineSegment(const double* x,
+                                               const double* y,
+                                               size_t beginIndex,
+                                               size_t endIndex,
+                                               double ax, double ay,
+                                               double bx, double by,
+                                               double& maxDistanceSquared)
   {
-    double xdelta=b.x-a.x;
-    double ydelta=b.y-a.y;
+    double xdelta=bx-ax;
+    double ydelta=by-ay;
+    double lengthSquared=xdelta*xdelta+ydelta*ydelta;
+    // For a degenerated segment all points are projected onto a
+    double inverseLength=lengthSquared!=0.0 ? 1/lengthSquared : 0.0;
+    size_t maxDistanceIndex=beginIndex-1;
+    size_t i=beginIndex;
+
+    maxDistanceSquared=0.0;
+
+#ifdef OSMSCOUT_HAVE_SSE2
+    if (endIndex>=beginIndex+2) {
+      const v2df zero=_mm_setzero_pd();
+      const v2df one=_mm_set1_pd(1.0);
+      const v2df two=_mm_set1_pd(2.0);
+      const v2df vax=_mm_set1_pd(ax);
+      const v2df vay=_mm_set1_pd(ay);
+      const v2df vxdelta=_mm_set1_pd(xdelta);
+      const v2df vydelta=_mm_set1_pd(ydelta);
+      const v2df vinverseLength=_mm_set1_pd(inverseLength);
+      v2df       vmax=zero;
+      v2df       vmaxIndex=_mm_set1_pd(-1.0);
+      v2df       vindex=_mm_set_pd(1.0,0.0);
+
+      for (; i+1<endIndex; i+=2) {
+        v2df cx=_mm_sub_pd(_mm_loadu_pd(x+i),vax);
+        v2df cy=_mm_sub_pd(_mm_loadu_pd(y+i),vay);
+        v2df u=_mm_mul_pd(_mm_add_pd(_mm_mul_pd(cx,vxdelta),
+                                     _mm_mul_pd(cy,vydelta)),
+                          vinverseLength);
+
+        u=_mm_min_pd(one,_mm_max_pd(zero,u));
+
+        v2df dx=_mm_sub_pd(cx,_mm_mul_pd(u,vxdelta));
+        v2df dy=_mm_sub_pd(cy,_mm_mul_pd(u,vydelta));
+        v2df distanceSquared=_mm_add_pd(_mm_mul_pd(dx,dx),
+                                        _mm_mul_pd(dy,dy));
+        v2df mask=_mm_cmpgt_pd(distanceSquared,vmax);
+
+        vmax=_mm_or_pd(_mm_and_pd(mask,distanceSquared),
+                       _mm_andnot_pd(mask,vmax));
+        vmaxIndex=_mm_or_pd(_mm_and_pd(mask,vindex),
+                            _mm_andnot_pd(mask,vmaxIndex));
+        vindex=_mm_add_pd(vindex,two);
+      }
 
-    return sqrt(xdelta*xdelta + ydelta*ydelta);
-  }
+      ALIGN16_BEG double maxValues[2] ALIGN16_END;
+      ALIGN16_BEG double maxIndices[2] ALIGN16_END;
 
-  static void SimplifyPolyLineDouglasPeucker(TransPolygon::TransPoint* points,
-                                             size_t beginIndex,
-                                             size_t endIndex,
-                                             size_t endValueIndex,
-                                             double optimizeErrorToleranceSquared)
-  {
-    LineSegment lineSegment(points[beginIndex], points[endValueIndex]);
+      _mm_store_pd(maxValues,vmax);
+      _mm_store_pd(maxIndices,vmaxIndex);
 
-    double maxDistanceSquared=0;
-    size_t maxDistanceIndex=beginIndex;
+      // Merge both lanes, on equal distance prefer the lower index
+      for (size_t lane=0; lane<2; lane++) {
+        if (maxIndices[lane]<0.0) {
+          continue;
+        }
 
-    for(size_t i=beginIndex+1; i<endIndex; ++i){
-      if (points[i].draw) {
-        double distanceSquared=lineSegment.CalculateDistanceSquared(points[i]);
+        size_t index=beginIndex+(size_t)maxIndices[lane];
 
-        if (distanceSquared>maxDistanceSquared) {
-          maxDistanceSquared=distanceSquared;
-          maxDistanceIndex=i;
+        if (maxValues[lane]>maxDistanceSquared ||
+            (maxValues[lane]==maxDistanceSquared && index<maxDistanceIndex)) {
+          maxDistanceSquared=maxValues[lane];
+          maxDistanceIndex=index;
         }
       }
     }
+#endif
 
-    if (maxDistanceSquared<=optimizeErrorToleranceSquared) {
+    for (; i<endIndex; i++) {
+      double cx=x[i]-ax;
+      double cy=y[i]-ay;
+      double u=(cx*xdelta+cy*ydelta)*inverseLength;
 
-      //we don't need to draw any extra points
-      for(size_t i=beginIndex+1; i<endIndex; ++i){
-        points[i].draw=false;
-      }
+      u=std::min(1.0,std::max(0.0,u));
 
-      return;
-    }
+      double dx=cx-u*xdelta; // *-1 but we square below
+      double dy=cy-u*ydelta; // *-1 but we square below
+      double distanceSquared=dx*dx+dy*dy;
 
-    //we need to split this line in two pieces
-    SimplifyPolyLineDouglasPeucker(points,
-                                   beginIndex,
-                                   maxDistanceIndex,
-                                   maxDistanceIndex,
-                                   optimizeErrorToleranceSquared);
+      if (distanceSquared>maxDistanceSquared) {
+        maxDistanceSquared=distanceSquared;
+        maxDistanceIndex=i;
+      }
+    }
 
-    SimplifyPolyLineDouglasPeucker(points,
-                                   maxDistanceIndex,
-                                   endIndex,
-                                   endValueIndex,
-                                   optimizeErrorToleranceSquared);
+    return maxDistanceIndex;
   }
 
   TransPolygon::TransPolygon()
@@ -182,41 +193,78 @@ namespace osmscout {
     delete [] points;
   }
 
-  void TransPolygon::TransformGeoToPixel(const Projection& projection,
-                                         const std::vector<GeoCoord>& nodes)
+  /**
+   * Make sure, that points can hold count entries
+   */
+  void TransPolygon::AllocatePoints(size_t count)
   {
-    Projection::BatchTransformer batchTransformer(projection);
-
-    if (!nodes.empty()) {
-      start=0;
-      length=nodes.size();
-      end=length-1;
-
-      for (size_t i=start; i<=end; i++) {
-         batchTransformer.GeoToPixel(nodes[i].GetLon(),
-                                     nodes[i].GetLat(),
-                                     points[i].x,
-                                     points[i].y);
-        points[i].draw=true;
-      }
+    if (pointsSize<count) {
+      delete [] points;
+
+      points=new TransPoint[count];
+      pointsSize=count;
     }
-    else {
-      start=0;
-      end=0;
-      length=0;
+
+    if (pixelX.size()<count) {
+      pixelX.resize(count);
+      pixelY.resize(count);
     }
   }
 
+  /**
+   * Initialize points from the pixel coordinates of the first count nodes
+   * calculated in pixelX and pixelY
+   */
+  void TransPolygon::InitializePoints(size_t count)
+  {
+    start=0;
+    length=count;
+    end=length-1;
+
+    for (size_t i=start; i<=end; i++) {
+      points[i].x=pixelX[i];
+      points[i].y=pixelY[i];
+      points[i].draw=true;
+    }
+  }
+
+  void TransPolygon::TransformGeoToPixel(const Projection& projection,
+                                         const std::vector<GeoCoord>& nodes)
+  {
+    AllocatePoints(nodes.size());
+
+    projection.GeoToPixel(nodes,
+                          pixelX.data(),
+                          pixelY.data());
+
+    InitializePoints(nodes.size());
+  }
+
+  void TransPolygon::TransformGeoToPixel(const Projection& projection,
+                                         const CompactGeoCoords& nodes)
+  {
+    AllocatePoints(nodes.GetSize());
+
+    projection.GeoToPixel(nodes,
+                          pixelX.data(),
+                          pixelY.data());
+
+    InitializePoints(nodes.GetSize());
+  }
+
   void TransPolygon::DropSimilarPoints(double optimizeErrorTolerance)
   {
+    const double* x=pixelX.data();
+    const double* y=pixelY.data();
+
     for (size_t i=0; i<length; i++) {
       if (points[i].draw) {
         size_t j=i+1;
         while (j<length-1) {
           if (points[j].draw)
           {
-            if (std::fabs(points[j].x-points[i].x)<=optimizeErrorTolerance &&
-                std::fabs(points[j].y-points[i].y)<=optimizeErrorTolerance) {
+            if (std::fabs(x[j]-x[i])<=optimizeErrorTolerance &&
+                std::fabs(y[j]-y[i])<=optimizeErrorTolerance) {
               points[j].draw=false;
             }
             else {
@@ -232,6 +280,9 @@ namespace osmscout {
 
   void TransPolygon::DropRedundantPointsFast(double optimizeErrorTolerance)
   {
+    const double* x=pixelX.data();
+    const double* y=pixelY.data();
+
     // Drop every point that is (more or less) on direct line between two points A and B
     size_t prev=0;
     while (prev<length) {
@@ -264,9 +315,9 @@ namespace osmscout {
         break;
       }
 
-      double distance=CalculateDistancePointToLineSegment(points[cur],
-                                                          points[prev],
-                                                          points[next]);
+      double distance=CalculateDistancePointToLineSegment(x[cur],y[cur],
+                                                          x[prev],y[prev],
+                                                          x[next],y[next]);
 
       if (distance<=optimizeErrorTolerance) {
         points[cur].draw=false;
@@ -279,128 +330,202 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Iterative variant of the Douglas-Peucker algorithm working on the densely packed
+   * drawable points in simplifyX/simplifyY. Points that are dropped are marked as
+   * not drawn in points.
+   */
+  void TransPolygon::SimplifyPolyLineDouglasPeucker(size_t beginIndex,
+                                                    size_t endIndex,
+                                                    size_t endValueIndex,
+                                                    double optimizeErrorToleranceSquared)
+  {
+    const double* x=simplifyX.data();
+    const double* y=simplifyY.data();
+
+    simplifyStack.clear();
+    simplifyStack.push_back({beginIndex,endIndex,endValueIndex});
+
+    while (!simplifyStack.empty()) {
+      SimplifySegment segment=simplifyStack.back();
+
+      simplifyStack.pop_back();
+
+      if (segment.begin+1>=segment.end) {
+        continue;
+      }
+
+      double maxDistanceSquared;
+      size_t maxDistanceIndex=FindFarthestPointToLineSegment(x,
+                                                             y,
+                                                             segment.begin+1,
+                                                             segment.end,
+                                                             x[segment.begin],
+                                                             y[segment.begin],
+                                                             x[segment.endValue],
+                                                             y[segment.endValue],
+                                                             maxDistanceSquared);
+
+      if (maxDistanceSquared<=optimizeErrorToleranceSquared) {
+        //we don't need to draw any extra points
+        for (size_t i=segment.begin+1; i<segment.end; ++i) {
+          points[simplifyIndex[i]].draw=false;
+        }
+
+        continue;
+      }
+
+      //we need to split this line in two pieces, first piece is handled first
+      simplifyStack.push_back({maxDistanceIndex,segment.end,segment.endValue});
+      simplifyStack.push_back({segment.begin,maxDistanceIndex,maxDistanceIndex});
+    }
+  }
+
   void TransPolygon::DropRedundantPointsDouglasPeucker(double optimizeErrorTolerance,
                                                        bool isArea)
   {
     // An implementation of Douglas-Peuker algorithm http://softsurfer.com/Archive/algorithm_0205/algorithm_0205.htm
 
     double optimizeErrorToleranceSquared=optimizeErrorTolerance*optimizeErrorTolerance;
-    size_t begin=0;
 
-    while (begin<length &&
-           !points[begin].draw) {
-      begin++;
+    // Pack all drawable points densely, so that the distance calculations do not
+    // have to check the draw flag
+    simplifyIndex.clear();
+    simplifyX.clear();
+    simplifyY.clear();
+
+    for (size_t i=0; i<length; i++) {
+      if (points[i].draw) {
+        simplifyIndex.push_back(i);
+        simplifyX.push_back(pixelX[i]);
+        simplifyY.push_back(pixelY[i]);
+      }
     }
 
-    if (begin>=length) {
+    size_t count=simplifyIndex.size();
+
+    if (count==0) {
       return; //we found no single point that is drawn.
     }
 
     //if this polyon is an area, we start by finding the largest distance from begin point to all other points
     if (isArea) {
-
       double maxDist=0.0;
-      size_t maxDistIndex=begin;
+      size_t maxDistIndex=0;
 
-      for(size_t i=begin; i<length; ++i) {
-        if (points[i].draw) {
-          double dist=CalculateDistancePointToPoint(points[begin], points[i]);
+      for (size_t i=1; i<count; ++i) {
+        double xdelta=simplifyX[i]-simplifyX[0];
+        double ydelta=simplifyY[i]-simplifyY[0];
+        double dist=xdelta*xdelta+ydelta*ydelta;
 
-          if (dist>maxDist) {
-            maxDist=dist;
-            maxDistIndex=i;
-          }
+        if (dist>maxDist) {
+          maxDist=dist;
+          maxDistIndex=i;
         }
       }
 
-      if (maxDistIndex==begin) {
+      if (maxDistIndex==0) {
         return; //we only found 1 point to draw
       }
 
-      SimplifyPolyLineDouglasPeucker(points,
-                                     begin,
+      SimplifyPolyLineDouglasPeucker(0,
                                      maxDistIndex,
                                      maxDistIndex,
                                      optimizeErrorToleranceSquared);
-      SimplifyPolyLineDouglasPeucker(points,
-                                     maxDistIndex,
-                                     length,
-                                     begin,
+      SimplifyPolyLineDouglasPeucker(maxDistIndex,
+                                     count,
+                                     0,
                                      optimizeErrorToleranceSquared);
     }
     else {
-      //not an area but polyline
-      //find last drawable point;
-      size_t end=length-1;
-      while (end>begin &&
-          !points[end].draw) {
-        end--;
-      }
-
-      if (end<=begin) {
+      if (count<2) {
         return; //we only found 1 drawable point;
       }
 
-      SimplifyPolyLineDouglasPeucker(points,
-                                     begin,
-                                     end,
-                                     end,
+      SimplifyPolyLineDouglasPeucker(0,
+                                     count-1,
+                                     count-1,
                                      optimizeErrorToleranceSquared);
     }
   }
 
-  void TransPolygon::TransformArea(const Projection& projection,
-                                   OptimizeMethod optimize,
-                                   const std::vector<GeoCoord>& nodes,
-                                   double optimizeErrorTolerance)
+  /**
+   * Calculate start, end and length from the draw flags of the points
+   */
+  void TransPolygon::UpdateDrawRange()
   {
-    if (nodes.size()<2) {
-      length=0;
+    size_t count=length;
+
+    length=0;
+    start=count;
+    end=0;
+
+    for (size_t i=0; i<count; i++) {
+      if (points[i].draw) {
+        length++;
+
+        if (i<start) {
+          start=i;
+        }
+
+        end=i;
+      }
+    }
+  }
 
+  void TransPolygon::OptimizeArea(OptimizeMethod optimize,
+                                  double optimizeErrorTolerance)
+  {
+    if (optimize==none) {
       return;
     }
 
-    if (pointsSize<nodes.size()) {
-      delete [] points;
+    if (optimize==fast) {
+      DropSimilarPoints(optimizeErrorTolerance);
+      DropRedundantPointsFast(optimizeErrorTolerance);
+    }
+    else {
+      DropRedundantPointsDouglasPeucker(optimizeErrorTolerance,true);
+    }
 
-      points=new TransPoint[nodes.size()];
-      pointsSize=nodes.size();
+    UpdateDrawRange();
+  }
+
+  void TransPolygon::OptimizeWay(OptimizeMethod optimize,
+                                 double optimizeErrorTolerance)
+  {
+    if (optimize==none) {
+      return;
     }
 
-    if (optimize!=none) {
-      TransformGeoToPixel(projection,
-                          nodes);
+    DropSimilarPoints(optimizeErrorTolerance);
 
+    if (optimize==fast) {
+      DropRedundantPointsFast(optimizeErrorTolerance);
+    }
+    else {
+      DropRedundantPointsDouglasPeucker(optimizeErrorTolerance,false);
+    }
 
-      if (optimize==fast) {
-        DropSimilarPoints(optimizeErrorTolerance);
-        DropRedundantPointsFast(optimizeErrorTolerance);
-      }
-      else {
-        DropRedundantPointsDouglasPeucker(optimizeErrorTolerance,true);
-      }
+    UpdateDrawRange();
+  }
 
+  void TransPolygon::TransformArea(const Projection& projection,
+                                   OptimizeMethod optimize,
+                                   const std::vector<GeoCoord>& nodes,
+                                   double optimizeErrorTolerance)
+  {
+    if (nodes.size()<2) {
       length=0;
-      start=nodes.size();
-      end=0;
 
-      // Calculate start, end and length
-      for (size_t i=0; i<nodes.size(); i++) {
-        if (points[i].draw) {
-          length++;
+      return;
+    }
 
-          if (i<start) {
-            start=i;
-          }
+    TransformGeoToPixel(projection,
+                        nodes);
 
-          end=i;
-        }
-      }
-    }
-    else {
-      TransformGeoToPixel(projection,
-                          nodes);
-    }
+    OptimizeArea(optimize,
+                 optimizeErrorTolerance);
   }
 
   void TransPolygon::TransformWay(const Projection& projection,
@@ -414,46 +539,55 @@ namespace osmscout {
       return;
     }
 
-    if (pointsSize<nodes.size()) {
-      delete [] points;
+    TransformGeoToPixel(projection,
+                        nodes);
 
-      points=new TransPoint[nodes.size()];
-      pointsSize=nodes.size();
-    }
+    OptimizeWay(optimize,
+                optimizeErrorTolerance);
+  }
+
+  /**
+   * Transform the area given as compact coordinates. The coordinates are
+   * transformed directly from their fixed point representation.
+   */
+  void TransPolygon::TransformArea(const Projection& projection,
+                                   OptimizeMethod optimize,
+                                   const CompactGeoCoords& nodes,
+                                   double optimizeErrorTolerance)
+  {
+    if (nodes.GetSize()<2) {
+      length=0;
 
-    if (optimize!=none) {
-      TransformGeoToPixel(projection,
-                          nodes);
+      return;
+    }
 
-      DropSimilarPoints(optimizeErrorTolerance);
+    TransformGeoToPixel(projection,
+                        nodes);
 
-      if (optimize==fast) {
-        DropRedundantPointsFast(optimizeErrorTolerance);
-      }
-      else {
-        DropRedundantPointsDouglasPeucker(optimizeErrorTolerance,false);
-      }
+    OptimizeArea(optimize,
+                 optimizeErrorTolerance);
+  }
 
+  /**
+   * Transform the way given as compact coordinates. The coordinates are
+   * transformed directly from their fixed point representation.
+   */
+  void TransPolygon::TransformWay(const Projection& projection,
+                                  OptimizeMethod optimize,
+                                  const CompactGeoCoords& nodes,
+                                  double optimizeErrorTolerance)
+  {
+    if (nodes.IsEmpty()) {
       length=0;
-      start=nodes.size();
-      end=0;
 
-      // Calculate start & end
-      for (size_t i=0; i<nodes.size(); i++) {
-        if (points[i].draw) {
-          length++;
-
-          if (i<start) {
-            start=i;
-          }
-          end=i;
-        }
-      }
-    }
-    else {
-      TransformGeoToPixel(projection,
-                          nodes);
+      return;
     }
+
+    TransformGeoToPixel(projection,
+                        nodes);
+
+    OptimizeWay(optimize,
+                optimizeErrorTolerance);
   }
 
   bool TransPolygon::GetBoundingBox(double& xmin, double& ymin,
@@ -527,19 +661,9 @@ namespace osmscout {
     buffer->Reset();
   }
 
-  void TransBuffer::TransformArea(const Projection& projection,
-                                  TransPolygon::OptimizeMethod optimize,
-                                  const std::vector<GeoCoord>& nodes,
-                                  size_t& start, size_t &end,
-                                  double optimizeErrorTolerance)
+  void TransBuffer::CopyTransformedPoints(size_t& start,
+                                          size_t& end)
   {
-    transPolygon.TransformArea(projection,
-                               optimize,
-                               nodes,
-                               optimizeErrorTolerance);
-
-    assert(!transPolygon.IsEmpty());
-
     bool isStart=true;
     for (size_t i=transPolygon.GetStart(); i<=transPolygon.GetEnd(); i++) {
       if (transPolygon.points[i].draw) {
@@ -554,6 +678,22 @@ namespace osmscout {
     }
   }
 
+  void TransBuffer::TransformArea(const Projection& projection,
+                                  TransPolygon::OptimizeMethod optimize,
+                                  const std::vector<GeoCoord>& nodes,
+                                  size_t& start, size_t &end,
+                                  double optimizeErrorTolerance)
+  {
+    transPolygon.TransformArea(projection,
+                               optimize,
+                               nodes,
+                               optimizeErrorTolerance);
+
+    assert(!transPolygon.IsEmpty());
+
+    CopyTransformedPoints(start,end);
+  }
+
   bool TransBuffer::TransformWay(const Projection& projection,
                                  TransPolygon::OptimizeMethod optimize,
                                  const std::vector<GeoCoord>& nodes,
@@ -566,19 +706,41 @@ namespace osmscout {
       return false;
     }
 
-    bool isStart=true;
-    for (size_t i=transPolygon.GetStart(); i<=transPolygon.GetEnd(); i++) {
-      if (transPolygon.points[i].draw) {
-        end=buffer->PushCoord(transPolygon.points[i].x,
-                              transPolygon.points[i].y);
+    CopyTransformedPoints(start,end);
 
-        if (isStart) {
-          start=end;
-          isStart=false;
-        }
-      }
+    return true;
+  }
+
+  void TransBuffer::TransformArea(const Projection& projection,
+                                  TransPolygon::OptimizeMethod optimize,
+                                  const CompactGeoCoords& nodes,
+                                  size_t& start, size_t &end,
+                                  double optimizeErrorTolerance)
+  {
+    transPolygon.TransformArea(projection,
+                               optimize,
+                               nodes,
+                               optimizeErrorTolerance);
+
+    assert(!transPolygon.IsEmpty());
+
+    CopyTransformedPoints(start,end);
+  }
+
+  bool TransBuffer::TransformWay(const Projection& projection,
+                                 TransPolygon::OptimizeMethod optimize,
+                                 const CompactGeoCoords& nodes,
+                                 size_t& start, size_t &end,
+                                 double optimizeErrorTolerance)
+  {
+    transPolygon.TransformWay(projection, optimize, nodes, optimizeErrorTolerance);
+
+    if (transPolygon.IsEmpty()) {
+      return false;
     }
 
+    CopyTransformedPoints(start,end);
+
     return true;
   }
 }